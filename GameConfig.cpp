@@ -5,6 +5,9 @@ GameConfig::GameConfig() {
     maxSpeed = 6.0f;
     accelerationStep = 0.7f;
     drag = 0.94f;
+    tickRate = 60.0f;
+    workerThreads = 0;
+    worldSeed = 0;
     numCells = 20;
     scale = 0.4f;
 
@@ -1,6 +1,8 @@
 #ifndef GAME_CONFIG_H
 #define GAME_CONFIG_H
 
+#include <cstdint>
+
 // 游戏配置结构体，集中管理所有游戏参数
 struct GameConfig {
     // 基本游戏参数
@@ -9,6 +11,9 @@ struct GameConfig {
     float maxSpeed;
     float accelerationStep;
     float drag;
+    float tickRate;  // 固定步长模拟频率(Hz)；移动按CellStore::referenceTickRate换算，AI按步掷骰的行为概率仍是每步的
+    int workerThreads;  // 逐实体更新阶段的并行线程数，0表示使用硬件并发数
+    uint64_t worldSeed;  // 世界随机种子，0表示启动时随机选取
     
     // 攻击和防御参数
     float attackDuration;
@@ -3,8 +3,10 @@
 #include "physics.h"
 #include "entities/PlayerCell.h"
 #include "entities/AICell.h"
+#include "simulation/ParticleSystem.h"
 #include <chrono>
 #include <algorithm>
+#include <iostream>
 
 GameEngine::GameEngine() 
     : running(true), canvasSize(800, 600), scale(0.4f),
@@ -14,8 +16,15 @@ GameEngine::GameEngine()
     // 初始化游戏配置
     initializeConfig();
     
-    // 加载资源
-    loadShieldImage();
+    // 模拟以固定步长推进，deltaTime即每步的时长
+    simClock.setTickRate(gameConfig.tickRate);
+    deltaTime = simClock.getTickDelta();
+    
+    // 逐实体更新阶段的线程池
+    threadPool = std::make_unique<ThreadPool>(gameConfig.workerThreads);
+    
+    // 固定世界种子后再创建实体，相同种子得到相同的初始世界和AI行为
+    gameConfig.worldSeed = Random::beginWorld(gameConfig.worldSeed);
     
     // 初始化随机数生成器
     initializeRandomGenerators();
@@ -26,19 +35,24 @@ GameEngine::GameEngine()
 }
 
 void GameEngine::run() {
+    // 加载资源（仅窗口模式需要，无头模式不加载）
+    loadShieldImage();
+    
     while (running) {
         try {
-            // 计算帧时间
-            updateFrameTime();
+            // 计算帧时间，换算成本帧要执行的模拟步数
+            int ticks = updateFrameTime();
             
-            // 创建画布
-            cv::Mat canvas = cv::Mat(canvasSize, CV_8UC3, cv::Scalar(255, 255, 255));
+            // 取一块预分配的画布并清成白色背景
+            cv::Mat& canvas = frameBuffers.acquire(canvasSize);
             
-            // 更新所有实体
-            updateEntities();
+            // 以固定步长推进世界状态，可能为0步或多步；负载高时少渲染而不拖慢模拟
+            for (int i = 0; i < ticks; ++i) {
+                stepWorld();
+            }
             
-            // 处理玩家攻击和碰撞检测
-            handleCombat();
+            // 渲染时在最近两个模拟步之间插值
+            CellStore::instance().setRenderAlpha(simClock.getAlpha());
             
             // 绘制所有实体
             renderEntities(canvas);
@@ -47,7 +61,7 @@ void GameEngine::run() {
             displayControls(canvas);
             
             // 显示画布
-            cv::imshow("Multi-Cell Simulation", canvas);
+            cv::imshow("Multi-Cell Simulation", frameBuffers.present());
             
             // 处理用户输入
             handleInput();
@@ -65,11 +79,46 @@ void GameEngine::run() {
     cv::destroyAllWindows();
 }
 
+void GameEngine::runHeadless(int ticks, float fixedDeltaTime) {
+    // 无头模式：不创建画布、不调用imshow/waitKey，以固定步长尽可能快地推进世界
+    time = 0.0f;
+    deltaTime = fixedDeltaTime;
+    
+    auto wallStart = std::chrono::high_resolution_clock::now();
+    
+    int tick = 0;
+    for (; tick < ticks && running; ++tick) {
+        time += fixedDeltaTime;
+        stepWorld();
+    }
+    
+    double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wallStart).count();
+    double ticksPerSecond = wallSeconds > 0.0 ? tick / wallSeconds : 0.0;
+    
+    std::cout << "无头模式完成: " << tick << " ticks, 墙钟时间 " << wallSeconds << " s, "
+              << ticksPerSecond << " ticks/s, 模拟时间 " << tick * fixedDeltaTime << " s, "
+              << "剩余实体 " << entities.size() << std::endl;
+}
+
+void GameEngine::stepWorld() {
+    // 保存上一步的位置，供渲染插值
+    CellStore::instance().savePreviousPositions();
+    
+    // 更新所有实体
+    updateEntities();
+    
+    // 处理玩家攻击和碰撞检测
+    handleCombat();
+}
+
 void GameEngine::initializeConfig() {
     // 基本游戏参数
     gameConfig.maxSpeed = 6.0f;
     gameConfig.accelerationStep = 0.7f;
     gameConfig.drag = 0.94f;
+    gameConfig.tickRate = 60.0f;
+    gameConfig.workerThreads = 0;
+    gameConfig.worldSeed = 0;
     gameConfig.numCells = 20;
     gameConfig.scale = 0.4f;
     
@@ -103,7 +152,7 @@ void GameEngine::initializeConfig() {
 }
 
 void GameEngine::initializeRandomGenerators() {
-    gen = std::mt19937(rd());
+    gen = Random::makeStream();
     xDist = std::uniform_real_distribution<float>(0, canvasSize.width);
     yDist = std::uniform_real_distribution<float>(0, canvasSize.height);
     moveDist = std::uniform_real_distribution<float>(-gameConfig.randomMoveStrength, gameConfig.randomMoveStrength);
@@ -159,43 +208,69 @@ void GameEngine::createAICells() {
     }
 }
 
-void GameEngine::updateFrameTime() {
+int GameEngine::updateFrameTime() {
     auto currentTime = std::chrono::high_resolution_clock::now();
     time = std::chrono::duration<float>(currentTime - startTime).count();
-    deltaTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
+    float frameTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
     lastUpdateTime = currentTime;
     
-    // 更新屏蔽冷却时间
-    for (auto player : playerCells) {
-        player->updateShieldCooldown(deltaTime);
-    }
+    // 真实帧时间只用于累加，模拟始终以固定的deltaTime推进
+    return simClock.advance(frameTime);
 }
 
 void GameEngine::updateEntities() {
-    for (auto& entity : entities) {
-        if (entity->isAlive() || !entity->getBloodDrops().empty()) {
-            entity->update(deltaTime, gameConfig, canvasSize);
+    // 逐实体阶段只读写实体自身的状态，分块并行执行，每个parallelFor返回即为一道屏障
+    const size_t grainSize = 256;
+    threadPool->parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // 跳过已死亡细胞的行为决策
+            if (entities[i]->isAlive()) {
+                entities[i]->updateBehavior(deltaTime, gameConfig);
+            }
         }
-    }
+    });
+    
+    // 物理、攻击动画和盾牌状态由CellStore按槽位区间并行推进
+    CellStore::instance().step(deltaTime, gameConfig, canvasSize, *threadPool);
+    
+    // 血滴粒子由世界级粒子池统一推进，与细胞是否存活无关
+    ParticleSystem::instance().update(deltaTime);
+    
+    // 位置已更新完毕，重建本帧共用的空间索引
+    rebuildSpatialIndex();
+}
+
+void GameEngine::rebuildSpatialIndex() {
+    // 以细胞宽度为格子尺寸
+    spatialIndex.build(entities, cellConfig.at("cell_width") * gameConfig.scale);
 }
 
 void GameEngine::handleCombat() {
+    // 空间索引已在updateEntities中重建，每个攻击者只检查矛尖附近的实体
+    float cellWidth = cellConfig.at("cell_width");
+    float hitRadius = spearHitRadius(gameConfig.scale, cellWidth);
+    
+    // 攻击者直接从CellStore的标志和攻击进度数组中筛选（前刺阶段），按槽位顺序处理
+    CellStore::instance().collectAttackers(combatAttackers);
+    
     // 检查玩家攻击
-    for (auto& attacker : entities) {
-        if (attacker->isAttacking() && attacker->getAttackTime() < 0.5f) {
-            for (auto& target : entities) {
-                if (attacker.get() != target.get() && target->isAlive()) {
-                    cv::Point2f hitPosition;
-                    cv::Point2f spearTipPosition;
-                    
-                    bool hit = checkSpearCollision(
-                        *attacker, *target, gameConfig.scale, 
-                        cellConfig.at("cell_width"), hitPosition, spearTipPosition
-                    );
-                    
-                    if (hit) {
-                        handleHit(attacker.get(), target.get(), hitPosition, spearTipPosition);
-                    }
+    for (BaseCell* attacker : combatAttackers) {
+        cv::Point2f spearTip = computeSpearTip(*attacker, gameConfig.scale);
+        spatialIndex.queryRadius(spearTip, hitRadius, neighborCandidates);
+        
+        for (int index : neighborCandidates) {
+            auto& target = entities[index];
+            if (attacker != target.get() && target->isAlive()) {
+                cv::Point2f hitPosition;
+                cv::Point2f spearTipPosition;
+                
+                bool hit = checkSpearCollision(
+                    *attacker, *target, gameConfig.scale, 
+                    cellWidth, hitPosition, spearTipPosition
+                );
+                
+                if (hit) {
+                    handleHit(attacker, target.get(), hitPosition, spearTipPosition);
                 }
             }
         }
@@ -225,7 +300,7 @@ void GameEngine::handleHit(BaseCell* attacker, BaseCell* target,
             
             // 创建小规模的血液效果
             cv::Point2f reducedHitPos = target->getPosition();
-            createBloodEffect(*target, reducedHitPos, attacker->isFacingRight(), spearTipPosition);
+            createBloodEffect(reducedHitPos, attacker->isFacingRight(), spearTipPosition);
         }
     } else {
         // 直接命中，没有格挡
@@ -233,7 +308,7 @@ void GameEngine::handleHit(BaseCell* attacker, BaseCell* target,
         target->takeDamage(damage);
         
         // 创建血液效果
-        createBloodEffect(*target, hitPosition, attacker->isFacingRight(), spearTipPosition);
+        createBloodEffect(hitPosition, attacker->isFacingRight(), spearTipPosition);
         
         // 添加击退效果
         float knockbackStrength = 5.0f;
@@ -244,42 +319,51 @@ void GameEngine::handleHit(BaseCell* attacker, BaseCell* target,
 }
 
 void GameEngine::renderEntities(cv::Mat& canvas) {
+    // 死亡细胞不再绘制，它留下的血滴由粒子池统一绘制
     for (auto& entity : entities) {
-        if (entity->isAlive() || !entity->getBloodDrops().empty()) {
+        if (entity->isAlive()) {
             entity->render(canvas, cellConfig, gameConfig.scale, time);
         }
     }
+    drawBloodDrops(canvas, ParticleSystem::instance());
 }
 
 void GameEngine::displayControls(cv::Mat& canvas) {
-    cv::putText(canvas,
-               "Player 1: WASD to move, F to attack, G to shield, Q/E to change aggression",
-               cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+    // 文字缓存在HUD层里，只有键变化的行才重新构造字符串和光栅化
+    hud.beginFrame();
+    hud.setLine(0, 0, cv::Point(10, 30), TextStyle(0.5), [] {
+        return std::string("Player 1: WASD to move, F to attack, G to shield, Q/E to change aggression");
+    });
+    hud.setLine(1, 0, cv::Point(10, 50), TextStyle(0.5), [] {
+        return std::string("Player 2: Arrow keys to move, F to attack, G to shield, Q/E to change aggression");
+    });
     
-    cv::putText(canvas,
-               "Player 2: Arrow keys to move, F to attack, G to shield, Q/E to change aggression",
-               cv::Point(10, 50), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
-    
-    // 显示屏蔽状态
+    // 显示屏蔽状态，剩余时间按0.1秒分档
     for (int i = 0; i < playerCells.size() && i < 2; i++) {
-        std::string shieldStatus;
         auto player = playerCells[i];
+        float remainingTime = player->getShieldDuration() - player->getShieldTime();
+        bool inParryWindow = player->getShieldTime() < gameConfig.parryWindowDuration;
+        int state = player->isShielding() ? 1 : (player->getShieldCooldownTime() > 0 ? 2 : 0);
+        int tenths = state == 1 ? int(remainingTime * 10) : (state == 2 ? int(player->getShieldCooldownTime() * 10) : 0);
+        uint64_t key = HudLayer::mixKey(HudLayer::mixKey(state, tenths), state == 1 && inParryWindow);
         
-        if (player->isShielding()) {
-            float remainingTime = player->getShieldDuration() - player->getShieldTime();
-            shieldStatus = "Shield: " + std::to_string(int(remainingTime * 10) / 10.0) + "s";
-            if (player->getShieldTime() < gameConfig.parryWindowDuration) {
-                shieldStatus += " (PERFECT PARRY)";
+        hud.setLine(2 + i, key, cv::Point(10, 70 + i*20), TextStyle(0.4), [&] {
+            std::string shieldStatus;
+            if (state == 1) {
+                shieldStatus = "Shield: " + std::to_string(tenths / 10.0) + "s";
+                if (inParryWindow) {
+                    shieldStatus += " (PERFECT PARRY)";
+                }
+            } else if (state == 2) {
+                shieldStatus = "Shield CD: " + std::to_string(tenths / 10.0) + "s";
+            } else {
+                shieldStatus = "Shield Ready";
             }
-        } else if (player->getShieldCooldownTime() > 0) {
-            shieldStatus = "Shield CD: " + std::to_string(int(player->getShieldCooldownTime() * 10) / 10.0) + "s";
-        } else {
-            shieldStatus = "Shield Ready";
-        }
-        
-        cv::putText(canvas, shieldStatus, 
-                  cv::Point(10, 70 + i*20), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            return shieldStatus;
+        });
     }
+    
+    hud.composite(canvas);
 }
 
 void GameEngine::handleInput() {
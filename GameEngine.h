@@ -8,6 +8,12 @@
 #include <map>
 #include <chrono>
 #include "GameConfig.h"
+#include "simulation/SpatialGrid.h"
+#include "simulation/FixedTimestep.h"
+#include "simulation/ThreadPool.h"
+#include "rendering/FrameBuffers.h"
+#include "rendering/HudLayer.h"
+#include "simulation/Random.h"
 
 class BaseCell;
 class PlayerCell;
@@ -16,6 +22,9 @@ class GameEngine {
 public:
     GameEngine();
     void run();
+    
+    // 无头模式：以固定步长运行ticks帧，不渲染，结束后输出ticks/s和墙钟时间
+    void runHeadless(int ticks, float fixedDeltaTime = 1.0f / 60.0f);
 
 private:
     // 初始化方法
@@ -25,8 +34,10 @@ private:
     void createAICells();
     
     // 游戏循环方法
-    void updateFrameTime();
+    int updateFrameTime();
+    void stepWorld();
     void updateEntities();
+    void rebuildSpatialIndex();
     void handleCombat();
     void handleHit(BaseCell* attacker, BaseCell* target, 
                   const cv::Point2f& hitPosition, 
@@ -50,13 +61,29 @@ private:
     std::vector<std::shared_ptr<BaseCell>> entities;
     std::vector<PlayerCell*> playerCells; // 不拥有这些指针，只是便于访问
     
+    // 空间索引，每帧实体更新后重建一次，战斗和繁殖等跨实体阶段共用
+    SpatialGrid spatialIndex;
+    std::vector<int> neighborCandidates;
+    std::vector<BaseCell*> combatAttackers;
+    
+    // 固定步长调度，按gameConfig.tickRate换算每帧的模拟步数
+    FixedTimestep simClock;
+    
+    // 逐实体更新阶段使用的线程池，线程数取自gameConfig.workerThreads
+    std::unique_ptr<ThreadPool> threadPool;
+    
+    // 预分配的画布，逐帧轮换
+    FrameBuffers frameBuffers;
+    
+    // 控制提示和盾牌状态的缓存文字层
+    HudLayer hud;
+    
     // 计时
     std::chrono::high_resolution_clock::time_point startTime;
     std::chrono::high_resolution_clock::time_point lastUpdateTime;
     
-    // 随机数生成
-    std::random_device rd;
-    std::mt19937 gen;
+    // 随机数生成，gen从世界种子派生
+    Pcg32 gen;
     std::uniform_real_distribution<float> xDist;
     std::uniform_real_distribution<float> yDist;
     std::uniform_real_distribution<float> moveDist;
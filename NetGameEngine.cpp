@@ -3,9 +3,12 @@
 #include "physics.h"
 #include "entities/PlayerCell.h"
 #include "entities/AICell.h"
+#include "simulation/ParticleSystem.h"
+#include "simulation/Random.h"
 #include <chrono>
 #include <algorithm>
 #include <iostream>
+#include <random>
 
 NetGameEngine::NetGameEngine()
     : running(true), canvasSize(800, 600), scale(0.4f),
@@ -22,6 +25,13 @@ NetGameEngine::NetGameEngine()
     // 初始化游戏配置
     initializeConfig();
     
+    // 模拟以固定步长推进，deltaTime即每步的时长
+    simClock.setTickRate(gameConfig.tickRate);
+    deltaTime = simClock.getTickDelta();
+    
+    // 逐实体更新阶段的线程池
+    threadPool = std::make_unique<ThreadPool>(gameConfig.workerThreads);
+    
     // 加载资源
     loadShieldImage();
 }
@@ -48,9 +58,8 @@ bool NetGameEngine::initialize(NetGameMode mode, const std::string& serverIP, in
         windowTitle = "Multi-Cell Standalone";
     }
     
-    // 初始化随机数生成器
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // 固定世界种子后再创建实体，相同种子得到相同的初始世界和AI行为
+    gameConfig.worldSeed = Random::beginWorld(gameConfig.worldSeed);
     
     // 创建玩家
     createPlayers();
@@ -64,10 +73,7 @@ bool NetGameEngine::initialize(NetGameMode mode, const std::string& serverIP, in
     if (mode != NetGameMode::STANDALONE) {
         networkInitialized = networkManager->initialize();
         
-        // 设置消息回调
-        networkManager->setMessageCallback([this](const NetworkMessage& msg) {
-            this->onNetworkMessage(msg);
-        });
+        // 消息由processNetworkMessages在游戏线程上处理，不再另设回调
         
         // 如果是服务器，开始监听
         if (mode == NetGameMode::SERVER && networkInitialized) {
@@ -104,22 +110,24 @@ bool NetGameEngine::initialize(NetGameMode mode, const std::string& serverIP, in
 void NetGameEngine::run() {
     while (running) {
         try {
-            // 计算帧时间
-            updateFrameTime();
+            // 计算帧时间，换算成本帧要执行的模拟步数
+            int ticks = updateFrameTime();
             
-            // 创建画布
-            cv::Mat canvas = cv::Mat(canvasSize, CV_8UC3, cv::Scalar(255, 255, 255));
+            // 取一块预分配的画布并清成白色背景
+            cv::Mat& canvas = frameBuffers.acquire(canvasSize);
             
             // 处理网络消息
             if (networkInitialized) {
                 processNetworkMessages();
             }
             
-            // 更新所有实体
-            updateEntities();
+            // 以固定步长推进世界状态，可能为0步或多步；负载高时少渲染而不拖慢模拟
+            for (int i = 0; i < ticks; ++i) {
+                stepWorld();
+            }
             
-            // 处理玩家攻击和碰撞检测
-            handleCombat();
+            // 渲染时在最近两个模拟步之间插值
+            CellStore::instance().setRenderAlpha(simClock.getAlpha());
             
             // 发送本地玩家状态（如果是网络模式）
             if (networkInitialized && localPlayer && 
@@ -134,35 +142,8 @@ void NetGameEngine::run() {
             // 显示控制提示和网络状态
             displayControls(canvas);
             
-            // 显示游戏模式
-            std::string modeText;
-            if (gameMode == NetGameMode::SERVER) {
-                modeText = "服务器模式";
-                NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
-                if (server && server->hasClient()) {
-                    modeText += " - 客户端已连接";
-                } else {
-                    modeText += " - 等待客户端连接";
-                }
-            }
-            else if (gameMode == NetGameMode::CLIENT) {
-                modeText = "客户端模式";
-                NetworkClient* client = dynamic_cast<NetworkClient*>(networkManager.get());
-                if (client && client->isConnected()) {
-                    modeText += " - 已连接";
-                } else {
-                    modeText += " - 未连接";
-                }
-            }
-            else {
-                modeText = "单机模式";
-            }
-            
-            cv::putText(canvas, modeText,
-                       cv::Point(10, 90), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
-            
             // 显示画布
-            cv::imshow(windowTitle, canvas);
+            cv::imshow(windowTitle, frameBuffers.present());
             
             // 处理用户输入
             handleInput();
@@ -187,6 +168,9 @@ void NetGameEngine::initializeConfig() {
     gameConfig.accelerationStep = 0.5f;  // 从0.7f减小到0.5f
     // 调整阻力使移动更丝滑
     gameConfig.drag = 0.96f;  // 从0.94f调整到0.96f
+    gameConfig.tickRate = 60.0f;
+    gameConfig.workerThreads = 0;
+    gameConfig.worldSeed = 0;
     gameConfig.numCells = 5; // 联机模式下减少AI数量
     gameConfig.scale = 0.3f;  // 从0.4f减小到0.3f以缩小所有细胞
     
@@ -228,7 +212,7 @@ void NetGameEngine::createPlayers() {
         cv::Vec3b player1Color(200, 230, 255); // 蓝色基础
         PlayerCell* player1 = new PlayerCell(
             cv::Point2f(canvasSize.width/3, canvasSize.height/2),
-            1, player1Color, 0.0f, 0.0f, "53535" // 均衡型基因
+            1, player1Color, 0.0f, 0.0f, Gene("53535") // 均衡型基因，循环补齐到16位
         );
         player1->setShieldDuration(gameConfig.shieldDuration);
         player1->setDamageReduction(gameConfig.damageReduction);
@@ -241,7 +225,7 @@ void NetGameEngine::createPlayers() {
         cv::Vec3b player2Color(200, 255, 220); // 绿色基础
         PlayerCell* player2 = new PlayerCell(
             cv::Point2f(canvasSize.width*2/3, canvasSize.height/2),
-            2, player2Color, 0.0f, 0.0f, "35735" // 攻击型基因
+            2, player2Color, 0.0f, 0.0f, Gene("35735") // 攻击型基因，循环补齐到16位
         );
         player2->setShieldDuration(gameConfig.shieldDuration);
         player2->setDamageReduction(gameConfig.damageReduction);
@@ -300,8 +284,7 @@ void NetGameEngine::createPlayers() {
 }
 
 void NetGameEngine::createAICells() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    Pcg32& gen = Random::world();
     std::uniform_real_distribution<float> xDist(0, canvasSize.width);
     std::uniform_real_distribution<float> yDist(0, canvasSize.height);
     std::uniform_real_distribution<float> aggressionDist(0, gameConfig.maxAggression);
@@ -335,32 +318,48 @@ void NetGameEngine::createAICells() {
     }
 }
 
-void NetGameEngine::updateFrameTime() {
+int NetGameEngine::updateFrameTime() {
     auto currentTime = std::chrono::high_resolution_clock::now();
     time = std::chrono::duration<float>(currentTime - startTime).count();
-    deltaTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
+    float frameTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
     lastUpdateTime = currentTime;
     
-    // 更新盾牌冷却时间
-    for (auto player : playerCells) {
-        player->updateShieldCooldown(deltaTime);
-    }
+    // 真实帧时间只用于累加，模拟始终以固定的deltaTime推进
+    return simClock.advance(frameTime);
+}
+
+void NetGameEngine::stepWorld() {
+    // 保存上一步的位置，供渲染插值
+    CellStore::instance().savePreviousPositions();
+    
+    // 更新所有实体
+    updateEntities();
+    
+    // 处理玩家攻击和碰撞检测
+    handleCombat();
 }
 
 void NetGameEngine::updateEntities() {
-    for (auto& entity : entities) {
-        if (entity->isAlive() || !entity->getBloodDrops().empty()) {
-            // 如果是网络模式，只更新本地玩家和AI
-            if ((gameMode == NetGameMode::SERVER || gameMode == NetGameMode::CLIENT) &&
-                entity.get() == remotePlayer) {
-                // 远程玩家的状态由网络更新，只更新血液滴
-                entity->update(deltaTime, gameConfig, canvasSize);
-            }
-            else {
-                entity->update(deltaTime, gameConfig, canvasSize);
+    // 远程玩家的输入由网络驱动，但同样参与本地的物理推进
+    // 逐实体阶段只读写实体自身的状态，分块并行执行，每个parallelFor返回即为一道屏障
+    const size_t grainSize = 256;
+    threadPool->parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // 跳过已死亡细胞的行为决策
+            if (entities[i]->isAlive()) {
+                entities[i]->updateBehavior(deltaTime, gameConfig);
             }
         }
-    }
+    });
+    
+    // 物理、攻击动画和盾牌状态由CellStore按槽位区间并行推进
+    CellStore::instance().step(deltaTime, gameConfig, canvasSize, *threadPool);
+    
+    // 血滴粒子由世界级粒子池统一推进，与细胞是否存活无关
+    ParticleSystem::instance().update(deltaTime);
+    
+    // 位置已更新完毕，重建本帧共用的空间索引
+    rebuildSpatialIndex();
     
     // 检查细胞繁殖
     checkCellReproduction();
@@ -368,72 +367,78 @@ void NetGameEngine::updateEntities() {
 
 void NetGameEngine::checkCellReproduction() {
     // 每帧有较小概率检查繁殖
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    Pcg32& gen = Random::world();
     
-    if (probDist(gen) > 0.05f) return; // 只有5%的帧会检查繁殖
+    if (gen.nextFloat() > 0.05f) return; // 只有5%的帧会检查繁殖
     
-    // 检查每对细胞是否满足繁殖条件
-    for (size_t i = 0; i < entities.size(); i++) {
-        for (size_t j = i + 1; j < entities.size(); j++) {
-            BaseCell* cell1 = entities[i].get();
-            BaseCell* cell2 = entities[j].get();
-            
-            // 两个细胞都必须存活
-            if (!cell1->isAlive() || !cell2->isAlive()) continue;
-            
-            // 检查距离
-            float distance = cv::norm(cell1->getPosition() - cell2->getPosition());
-            if (distance > 150.0f) continue; // 必须足够近
-            
-            // 繁殖概率 - 与距离和健康度相关
-            float reproductionChance = 0.05f * (1.0f - distance / 150.0f) * 
-                                       (cell1->getHealth() / cell1->getMaxHealth()) * 
-                                       (cell2->getHealth() / cell2->getMaxHealth());
-            
-            // 同阵营繁殖概率更高
-            if (cell1->getFaction() == cell2->getFaction()) {
-                reproductionChance *= 2.0f;
-            } else {
-                reproductionChance *= 0.5f;
-            }
+    // 只检查空间索引给出的足够近的细胞对（距离不超过150）
+    // 本帧新生的后代不在索引中，下一帧才参与繁殖
+    spatialIndex.findPairsWithin(150.0f, neighborPairs);
+    
+    for (const auto& pair : neighborPairs) {
+        BaseCell* cell1 = entities[pair.first].get();
+        BaseCell* cell2 = entities[pair.second].get();
+        
+        // 两个细胞都必须存活
+        if (!cell1->isAlive() || !cell2->isAlive()) continue;
+        
+        float distance = cv::norm(cell1->getPosition() - cell2->getPosition());
+        
+        // 繁殖概率 - 与距离和健康度相关
+        float reproductionChance = 0.05f * (1.0f - distance / 150.0f) * 
+                                   (cell1->getHealth() / cell1->getMaxHealth()) * 
+                                   (cell2->getHealth() / cell2->getMaxHealth());
+        
+        // 同阵营繁殖概率更高
+        if (cell1->getFaction() == cell2->getFaction()) {
+            reproductionChance *= 2.0f;
+        } else {
+            reproductionChance *= 0.5f;
+        }
+        
+        // 决定是否繁殖，实体数量达到上限时不再创建后代
+        if (gen.chance(reproductionChance) && entities.size() < gameConfig.numCells * 2) {
+            entities.push_back(std::shared_ptr<BaseCell>(
+                BaseCell::createOffspring(*cell1, *cell2, canvasSize)));
             
-            // 决定是否繁殖
-            if (probDist(gen) < reproductionChance) {
-                // 创建后代
-                BaseCell* offspring = BaseCell::createOffspring(*cell1, *cell2, canvasSize);
-                
-                // 如果实体数量没有达到上限，添加后代
-                if (entities.size() < gameConfig.numCells * 2) {
-                    entities.push_back(std::shared_ptr<BaseCell>(offspring));
-                    
-                    // 繁殖消耗健康度
-                    cell1->takeDamage(15.0f);
-                    cell2->takeDamage(15.0f);
-                }
-            }
+            // 繁殖消耗健康度
+            cell1->takeDamage(15.0f);
+            cell2->takeDamage(15.0f);
         }
     }
 }
 
+void NetGameEngine::rebuildSpatialIndex() {
+    // 以细胞宽度为格子尺寸
+    spatialIndex.build(entities, cellConfig.at("cell_width") * gameConfig.scale);
+}
+
 void NetGameEngine::handleCombat() {
+    // 空间索引已在updateEntities中重建，每个攻击者只检查矛尖附近的实体
+    float cellWidth = cellConfig.at("cell_width");
+    float hitRadius = spearHitRadius(gameConfig.scale, cellWidth);
+    
+    // 攻击者直接从CellStore的标志和攻击进度数组中筛选（前刺阶段），按槽位顺序处理
+    CellStore::instance().collectAttackers(combatAttackers);
+    
     // 检查玩家攻击
-    for (auto& attacker : entities) {
-        if (attacker->isAttacking() && attacker->getAttackTime() < 0.5f) {
-            for (auto& target : entities) {
-                if (attacker.get() != target.get() && target->isAlive()) {
-                    cv::Point2f hitPosition;
-                    cv::Point2f spearTipPosition;
-                    
-                    bool hit = checkSpearCollision(
-                        *attacker, *target, gameConfig.scale, 
-                        cellConfig.at("cell_width"), hitPosition, spearTipPosition
-                    );
-                    
-                    if (hit) {
-                        handleHit(attacker.get(), target.get(), hitPosition, spearTipPosition);
-                    }
+    for (BaseCell* attacker : combatAttackers) {
+        cv::Point2f spearTip = computeSpearTip(*attacker, gameConfig.scale);
+        spatialIndex.queryRadius(spearTip, hitRadius, neighborCandidates);
+        
+        for (int index : neighborCandidates) {
+            auto& target = entities[index];
+            if (attacker != target.get() && target->isAlive()) {
+                cv::Point2f hitPosition;
+                cv::Point2f spearTipPosition;
+                
+                bool hit = checkSpearCollision(
+                    *attacker, *target, gameConfig.scale, 
+                    cellWidth, hitPosition, spearTipPosition
+                );
+                
+                if (hit) {
+                    handleHit(attacker, target.get(), hitPosition, spearTipPosition);
                 }
             }
         }
@@ -478,7 +483,7 @@ void NetGameEngine::handleHit(BaseCell* attacker, BaseCell* target,
             
             // 创建小规模的血液效果
             cv::Point2f reducedHitPos = target->getPosition();
-            createBloodEffect(*target, reducedHitPos, attacker->isFacingRight(), spearTipPosition);
+            createBloodEffect(reducedHitPos, attacker->isFacingRight(), spearTipPosition);
         }
     } else {
         // 直接命中，没有格挡
@@ -492,7 +497,7 @@ void NetGameEngine::handleHit(BaseCell* attacker, BaseCell* target,
         target->takeDamage(damage);
         
         // 创建血液效果
-        createBloodEffect(*target, hitPosition, attacker->isFacingRight(), spearTipPosition);
+        createBloodEffect(hitPosition, attacker->isFacingRight(), spearTipPosition);
         
         // 添加击退效果
         float knockbackStrength = 5.0f * attacker->getSizeMultiplier();
@@ -503,87 +508,122 @@ void NetGameEngine::handleHit(BaseCell* attacker, BaseCell* target,
 }
 
 void NetGameEngine::renderEntities(cv::Mat& canvas) {
+    // 死亡细胞不再绘制，它留下的血滴由粒子池统一绘制
     for (auto& entity : entities) {
-        if (entity->isAlive() || !entity->getBloodDrops().empty()) {
+        if (entity->isAlive()) {
             entity->render(canvas, cellConfig, gameConfig.scale, time);
         }
     }
+    drawBloodDrops(canvas, ParticleSystem::instance());
 }
 
 void NetGameEngine::displayControls(cv::Mat& canvas) {
+    // 文字缓存在HUD层里，只有键变化的行才重新构造字符串和光栅化
+    hud.beginFrame();
+    
     // 显示控制提示，统一控制方式
     if (gameMode == NetGameMode::SERVER || gameMode == NetGameMode::STANDALONE) {
-        cv::putText(canvas,
-                   "Player 1 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression",
-                   cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(0, 0, cv::Point(10, 30), TextStyle(0.5), [] {
+            return std::string("Player 1 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression");
+        });
     }
     
     if (gameMode == NetGameMode::CLIENT) {
-        cv::putText(canvas,
-                   "Player 2 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression",
-                   cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(0, 1, cv::Point(10, 30), TextStyle(0.5), [] {
+            return std::string("Player 2 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression");
+        });
     }
     
     if (gameMode == NetGameMode::STANDALONE) {
-        cv::putText(canvas,
-                   "Player 2 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression",
-                   cv::Point(10, 50), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(1, 0, cv::Point(10, 50), TextStyle(0.5), [] {
+            return std::string("Player 2 (本地): WASD to move, J to attack, K to shield, Q/E to change aggression");
+        });
     }
     
     // 在服务器模式下还要显示远程玩家2的控制方式
     if (gameMode == NetGameMode::SERVER) {
-        cv::putText(canvas,
-                   "Player 2 (远程): 由客户端控制",
-                   cv::Point(10, 50), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(1, 1, cv::Point(10, 50), TextStyle(0.5), [] {
+            return std::string("Player 2 (远程): 由客户端控制");
+        });
     }
     
     // 在客户端模式下还要显示远程玩家1的控制方式
     if (gameMode == NetGameMode::CLIENT) {
-        cv::putText(canvas,
-                   "Player 1 (远程): 由服务器控制",
-                   cv::Point(10, 50), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(1, 2, cv::Point(10, 50), TextStyle(0.5), [] {
+            return std::string("Player 1 (远程): 由服务器控制");
+        });
     }
-    
-    // 显示盾牌状态
+
+    // 显示盾牌状态，剩余时间按0.1秒分档
     for (int i = 0; i < playerCells.size() && i < 2; i++) {
-        std::string shieldStatus;
         auto player = playerCells[i];
+        float remainingTime = player->getShieldDuration() - player->getShieldTime();
+        bool inParryWindow = player->getShieldTime() < gameConfig.parryWindowDuration;
+        int state = player->isShielding() ? 1 : (player->getShieldCooldownTime() > 0 ? 2 : 0);
+        int tenths = state == 1 ? int(remainingTime * 10) : (state == 2 ? int(player->getShieldCooldownTime() * 10) : 0);
+        uint64_t key = HudLayer::mixKey(HudLayer::mixKey(state, tenths), state == 1 && inParryWindow);
         
-        if (player->isShielding()) {
-            float remainingTime = player->getShieldDuration() - player->getShieldTime();
-            shieldStatus = "Shield: " + std::to_string(int(remainingTime * 10) / 10.0) + "s";
-            if (player->getShieldTime() < gameConfig.parryWindowDuration) {
-                shieldStatus += " (PERFECT PARRY)";
+        hud.setLine(2 + i, key, cv::Point(10, 70 + i*20), TextStyle(0.4), [&] {
+            std::string shieldStatus;
+            if (state == 1) {
+                shieldStatus = "Shield: " + std::to_string(tenths / 10.0) + "s";
+                if (inParryWindow) {
+                    shieldStatus += " (PERFECT PARRY)";
+                }
+            } else if (state == 2) {
+                shieldStatus = "Shield CD: " + std::to_string(tenths / 10.0) + "s";
+            } else {
+                shieldStatus = "Shield Ready";
             }
-        } else if (player->getShieldCooldownTime() > 0) {
-            shieldStatus = "Shield CD: " + std::to_string(int(player->getShieldCooldownTime() * 10) / 10.0) + "s";
-        } else {
-            shieldStatus = "Shield Ready";
-        }
-        
-        cv::putText(canvas, shieldStatus, 
-                  cv::Point(10, 70 + i*20), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            return shieldStatus;
+        });
+    }
+    
+    // 显示游戏模式和连接状态
+    bool connected = false;
+    if (gameMode == NetGameMode::SERVER) {
+        NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
+        connected = server && server->hasClient();
+    }
+    else if (gameMode == NetGameMode::CLIENT) {
+        NetworkClient* client = dynamic_cast<NetworkClient*>(networkManager.get());
+        connected = client && client->isConnected();
     }
+    hud.setLine(4, HudLayer::mixKey(static_cast<int>(gameMode), connected), cv::Point(10, 90), TextStyle(0.4), [&] {
+        std::string modeText;
+        if (gameMode == NetGameMode::SERVER) {
+            modeText = "服务器模式";
+            modeText += connected ? " - 客户端已连接" : " - 等待客户端连接";
+        }
+        else if (gameMode == NetGameMode::CLIENT) {
+            modeText = "客户端模式";
+            modeText += connected ? " - 已连接" : " - 未连接";
+        }
+        else {
+            modeText = "单机模式";
+        }
+        return modeText;
+    });
     
-    // 显示基因和阵营信息
+    // 显示基因和阵营信息，键取基因字符和阵营
     for (int i = 0; i < playerCells.size() && i < 2; i++) {
         auto player = playerCells[i];
+        uint64_t key = static_cast<uint64_t>(player->getFaction());
+        for (char c : player->getGene()) {
+            key = HudLayer::mixKey(key, static_cast<unsigned char>(c));
+        }
         
-        // 显示基因信息
-        std::string geneInfo = "Player " + std::to_string(i+1) + 
-                               " Gene: " + player->getGene() + 
-                               " Faction: " + std::to_string(player->getFaction());
-        
-        cv::putText(canvas, geneInfo, 
-                   cv::Point(10, 130 + i*20), cv::FONT_HERSHEY_SIMPLEX, 
-                   0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(5 + i, key, cv::Point(10, 130 + i*20), TextStyle(0.4), [&] {
+            return "Player " + std::to_string(i+1) + " Gene: " + player->getGene().toString() + " Faction: " + std::to_string(player->getFaction());
+        });
     }
     
     // 显示实体数量
-    std::string entitiesInfo = "Entities: " + std::to_string(entities.size());
-    cv::putText(canvas, entitiesInfo, 
-               cv::Point(10, 170), cv::FONT_HERSHEY_SIMPLEX, 
-               0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+    hud.setLine(7, entities.size(), cv::Point(10, 170), TextStyle(0.4), [&] {
+        return "Entities: " + std::to_string(entities.size());
+    });
+    
+    hud.composite(canvas);
 }
 
 void NetGameEngine::handleInput() {
@@ -715,9 +755,12 @@ void NetGameEngine::onNetworkMessage(const NetworkMessage& msg) {
         case MessageType::CONNECT_REQUEST:
             // 客户端请求连接
             if (gameMode == NetGameMode::SERVER) {
-                // 发送接受连接的响应
+                // 只回复发起连接的会话
                 NetworkMessage acceptMsg(MessageType::CONNECT_ACCEPT, {});
-                networkManager->sendMessage(acceptMsg);
+                NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
+                if (server) {
+                    server->sendTo(msg.sessionId, acceptMsg);
+                }
                 std::cout << "客户端已连接，发送接受连接响应" << std::endl;
             }
             break;
@@ -749,7 +792,12 @@ void NetGameEngine::onNetworkMessage(const NetworkMessage& msg) {
             // 收到Ping，回应Pong
             {
                 NetworkMessage pongMsg(MessageType::PONG, {});
-                networkManager->sendMessage(pongMsg);
+                NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
+                if (server) {
+                    server->sendTo(msg.sessionId, pongMsg);
+                } else {
+                    networkManager->sendMessage(pongMsg);
+                }
             }
             break;
             
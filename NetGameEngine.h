@@ -5,6 +5,11 @@
 #include <memory>
 #include <string>
 #include "GameConfig.h"
+#include "simulation/SpatialGrid.h"
+#include "simulation/FixedTimestep.h"
+#include "simulation/ThreadPool.h"
+#include "rendering/FrameBuffers.h"
+#include "rendering/HudLayer.h"
 #include "network/NetworkManager.h"
 #include "network/NetworkServer.h"
 #include "network/NetworkClient.h"
@@ -36,8 +41,10 @@ private:
     void createAICells();
     
     // 游戏循环方法
-    void updateFrameTime();
+    int updateFrameTime();
+    void stepWorld();
     void updateEntities();
+    void rebuildSpatialIndex();
     void handleCombat();
     void handleHit(BaseCell* attacker, BaseCell* target, 
                   const cv::Point2f& hitPosition, 
@@ -71,9 +78,28 @@ private:
     // 实体管理
     std::vector<std::shared_ptr<BaseCell>> entities;
     std::vector<PlayerCell*> playerCells; // 不拥有这些指针，只是便于访问
+    
+    // 空间索引，每帧实体更新后重建一次，战斗和繁殖等跨实体阶段共用
+    SpatialGrid spatialIndex;
+    std::vector<int> neighborCandidates;
+    std::vector<BaseCell*> combatAttackers;
+    std::vector<std::pair<int, int>> neighborPairs;
+    
     PlayerCell* localPlayer;   // 本地玩家
     PlayerCell* remotePlayer;  // 远程玩家
     
+    // 固定步长调度，按gameConfig.tickRate换算每帧的模拟步数
+    FixedTimestep simClock;
+    
+    // 逐实体更新阶段使用的线程池，线程数取自gameConfig.workerThreads
+    std::unique_ptr<ThreadPool> threadPool;
+    
+    // 预分配的画布，逐帧轮换
+    FrameBuffers frameBuffers;
+    
+    // 控制提示、盾牌状态、连接状态等的缓存文字层
+    HudLayer hud;
+    
     // 计时
     std::chrono::high_resolution_clock::time_point startTime;
     std::chrono::high_resolution_clock::time_point lastUpdateTime;
@@ -0,0 +1,2265 @@
+#include "Benchmarks.h"
+#include "../physics.h"
+#include "../drawing.h"
+#include "../entities/AICell.h"
+#include "../entities/Gene.h"
+#include "../simulation/SpatialGrid.h"
+#include "../simulation/CellStore.h"
+#include "../simulation/ThreadPool.h"
+#include "../simulation/ParticleSystem.h"
+#include "../simulation/Random.h"
+#include "../rendering/Compositor.h"
+#include "../rendering/ShieldSprites.h"
+#include "../rendering/FrameBuffers.h"
+#include "../rendering/CellSprites.h"
+#include "../rendering/RenderSnapshot.h"
+#include "../rendering/TiledRenderer.h"
+#include "../rendering/DetailBudget.h"
+#include "../rendering/CellGeometry.h"
+#include "../rendering/FrameExporter.h"
+#include "../rendering/HudLayer.h"
+#include "../simulation/TripleBuffer.h"
+#include "../network/MessageFraming.h"
+#include "../network/Reactor.h"
+#include "../network/NetworkServer.h"
+#include "../network/DatagramChannel.h"
+#include "../network/WorldState.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 重复执行fn直到累计时间超过minSeconds，返回单次平均耗时（毫秒）
+double measureMs(const std::function<void()>& fn, double minSeconds = 0.2) {
+    int iterations = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed * 1000.0 / iterations;
+}
+
+// 每轮先调用reset（不计时）再连续执行framesPerRun帧，重复直到计时累计超过minSeconds，返回单帧平均耗时（毫秒）
+// 用于会随帧数改变状态的更新，避免速度经阻力衰减成非规格化浮点数而拖慢后测的一方
+double measureFramesMs(const std::function<void()>& reset, const std::function<void()>& frame,
+                       int framesPerRun = 30, double minSeconds = 0.2) {
+    int frames = 0;
+    double elapsed = 0.0;
+    do {
+        reset();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < framesPerRun; ++i) {
+            frame();
+        }
+        elapsed += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        frames += framesPerRun;
+    } while (elapsed < minSeconds);
+    return elapsed * 1000.0 / frames;
+}
+
+// 在画布内随机生成AI细胞，约四分之一处于攻击前刺阶段
+std::vector<std::shared_ptr<BaseCell>> makePopulation(int count, const cv::Size& canvasSize, std::mt19937& gen) {
+    std::uniform_real_distribution<float> xDist(0.0f, canvasSize.width);
+    std::uniform_real_distribution<float> yDist(0.0f, canvasSize.height);
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> attackDist(0.0f, 0.5f);
+
+    std::vector<std::shared_ptr<BaseCell>> entities;
+    entities.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto cell = std::make_shared<AICell>(cv::Point2f(xDist(gen), yDist(gen)), 0,
+                                             cv::Vec3b(200, 230, 255), 0.0f, 0.5f);
+        cell->setFacingRight(probDist(gen) < 0.5f);
+        if (probDist(gen) < 0.25f) {
+            cell->setAttacking(true);
+            cell->setAttackTime(attackDist(gen));
+        }
+        entities.push_back(cell);
+    }
+    return entities;
+}
+
+// 战斗检测：逐对暴力检测 vs 空间哈希网格
+int benchCombat() {
+    const cv::Size canvasSize(800, 600);
+    const float scale = 0.4f;
+    const float cellWidth = 100.0f;
+    const float hitRadius = spearHitRadius(scale, cellWidth);
+
+    std::mt19937 gen(12345);
+
+    std::cout << "战斗检测基准 (画布 " << canvasSize.width << "x" << canvasSize.height
+              << ", 格子尺寸 " << cellWidth * scale << " px)" << std::endl;
+    std::cout << std::setw(8) << "细胞数" << std::setw(14) << "暴力(ms)" << std::setw(14) << "网格(ms)"
+              << std::setw(10) << "加速比" << std::setw(10) << "命中数" << std::endl;
+
+    for (int count : {100, 250, 500, 1000, 2000, 5000, 10000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+
+        int bruteHits = 0;
+        double bruteMs = measureMs([&]() {
+            bruteHits = 0;
+            for (auto& attacker : entities) {
+                if (!attacker->isAttacking()) continue;
+                for (auto& target : entities) {
+                    if (attacker.get() == target.get()) continue;
+                    cv::Point2f hitPosition, spearTipPosition;
+                    if (checkSpearCollision(*attacker, *target, scale, cellWidth, hitPosition, spearTipPosition)) {
+                        ++bruteHits;
+                    }
+                }
+            }
+        });
+
+        SpatialGrid grid;
+        std::vector<int> candidates;
+        int gridHits = 0;
+        double gridMs = measureMs([&]() {
+            gridHits = 0;
+            grid.build(entities, cellWidth * scale);
+            for (auto& attacker : entities) {
+                if (!attacker->isAttacking()) continue;
+                grid.queryRadius(computeSpearTip(*attacker, scale), hitRadius, candidates);
+                for (int index : candidates) {
+                    auto& target = entities[index];
+                    if (attacker.get() == target.get()) continue;
+                    cv::Point2f hitPosition, spearTipPosition;
+                    if (checkSpearCollision(*attacker, *target, scale, cellWidth, hitPosition, spearTipPosition)) {
+                        ++gridHits;
+                    }
+                }
+            }
+        });
+
+        std::cout << std::setw(8) << count
+                  << std::setw(14) << std::fixed << std::setprecision(3) << bruteMs
+                  << std::setw(14) << gridMs
+                  << std::setw(9) << std::setprecision(1) << bruteMs / gridMs << "x"
+                  << std::setw(10) << gridHits
+                  << (gridHits == bruteHits ? "" : "  (命中数不一致!)") << std::endl;
+
+        if (gridHits != bruteHits) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 繁殖配对：逐对暴力求距离 vs 空间索引半径查询
+// 世界面积随细胞数增长以保持密度不变（每800x600放250个），体现开销随局部密度而非总数的平方增长
+int benchPairs() {
+    const float cellSize = 60.0f * 0.3f;
+    const float radius = 150.0f;
+    const float radiusSquared = radius * radius;
+
+    std::mt19937 gen(54321);
+
+    std::cout << "繁殖配对基准 (密度 250 / 800x600, 半径 " << radius << " px)" << std::endl;
+    std::cout << std::setw(8) << "细胞数" << std::setw(14) << "暴力(ms)" << std::setw(14) << "索引(ms)"
+              << std::setw(10) << "加速比" << std::setw(12) << "配对数" << std::endl;
+
+    for (int count : {250, 500, 1000, 2000, 5000, 10000}) {
+        float side = std::sqrt(count / 250.0f);
+        const cv::Size canvasSize(static_cast<int>(800 * side), static_cast<int>(600 * side));
+        auto entities = makePopulation(count, canvasSize, gen);
+
+        size_t brutePairs = 0;
+        double bruteMs = measureMs([&]() {
+            brutePairs = 0;
+            for (size_t i = 0; i < entities.size(); ++i) {
+                cv::Point2f center = entities[i]->getPosition();
+                for (size_t j = i + 1; j < entities.size(); ++j) {
+                    cv::Point2f delta = entities[j]->getPosition() - center;
+                    if (delta.x * delta.x + delta.y * delta.y <= radiusSquared) {
+                        ++brutePairs;
+                    }
+                }
+            }
+        });
+
+        // 索引的构建计入耗时，与引擎每帧重建一次的开销一致
+        SpatialGrid grid;
+        std::vector<std::pair<int, int>> pairs;
+        double gridMs = measureMs([&]() {
+            grid.build(entities, cellSize);
+            grid.findPairsWithin(radius, pairs);
+        });
+
+        std::cout << std::setw(8) << count
+                  << std::setw(14) << std::fixed << std::setprecision(3) << bruteMs
+                  << std::setw(14) << gridMs
+                  << std::setw(9) << std::setprecision(1) << bruteMs / gridMs << "x"
+                  << std::setw(12) << pairs.size()
+                  << (pairs.size() == brutePairs ? "" : "  (配对数不一致!)") << std::endl;
+
+        if (pairs.size() != brutePairs) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 改用粒子池之前的血滴更新：逐细胞的vector，过期血滴在遍历中途erase。仅用作对照
+void legacyUpdateBloodDrops(std::vector<BloodDrop>& bloodDrops, float deltaTime) {
+    const float gravity = 9.8f;
+    for (auto it = bloodDrops.begin(); it != bloodDrops.end();) {
+        it->lifetime -= deltaTime;
+        if (it->lifetime <= 0) {
+            it = bloodDrops.erase(it);
+        } else {
+            it->position += it->velocity * deltaTime;
+            it->velocity.y += gravity * deltaTime;
+            ++it;
+        }
+    }
+}
+
+// 改用CellStore之前的细胞布局：每个细胞单独分配在堆上，热数据与基因字符串、血滴数组混在同一对象里，
+// 通过虚函数逐个更新。仅用作对照，字段和更新逻辑与原BaseCell::update保持一致
+class LegacyCell {
+public:
+    explicit LegacyCell(const cv::Point2f& pos) : position(pos), gene(16, 'A') {}
+    virtual ~LegacyCell() {}
+
+    virtual void update(float deltaTime, const GameConfig& config, const cv::Size& canvasSize) {
+        float maxSpeed = config.maxSpeed * speedMultiplier;
+        velocity += acceleration;
+        velocity.x = std::clamp(velocity.x, -maxSpeed, maxSpeed);
+        velocity.y = std::clamp(velocity.y, -maxSpeed, maxSpeed);
+        position += velocity;
+        velocity *= config.drag;
+        acceleration = cv::Point2f(0, 0);
+        if (position.x < 0) { position.x = 0; velocity.x *= -0.5f; }
+        if (position.x > canvasSize.width) { position.x = canvasSize.width; velocity.x *= -0.5f; }
+        if (position.y < 0) { position.y = 0; velocity.y *= -0.5f; }
+        if (position.y > canvasSize.height) { position.y = canvasSize.height; velocity.y *= -0.5f; }
+        if (velocity.x > 1.0f) faceRight = true; else if (velocity.x < -1.0f) faceRight = false;
+
+        if (isAttackingFlag) {
+            attackTimeValue += deltaTime / config.attackDuration;
+            if (attackTimeValue >= 1.0f) { isAttackingFlag = false; attackTimeValue = 0.0f; }
+        }
+        if (isShieldingFlag) {
+            shieldTimeValue += deltaTime;
+            if (shieldTimeValue >= shieldDurationValue) {
+                isShieldingFlag = false; shieldTimeValue = 0.0f; shieldCooldownTimeValue = 0.3f;
+            }
+        } else {
+            shieldTimeValue = 0.0f;
+        }
+        if (hasParriedFlag) {
+            parryTimeValue += deltaTime;
+            if (parryTimeValue >= 0.5f) { hasParriedFlag = false; parryTimeValue = 0.0f; }
+        }
+        legacyUpdateBloodDrops(bloodDrops, deltaTime);
+    }
+
+    cv::Point2f position;
+    cv::Point2f velocity{0, 0};
+    cv::Point2f acceleration{0, 0};
+    bool faceRight = true;
+    int playerNumber = 0;
+    cv::Vec3b color{200, 230, 255};
+    float tailPhaseOffset = 0.0f;
+    float aggressionLevel = 0.5f;
+    float health = 100.0f;
+    float maxHealth = 100.0f;
+    bool isAttackingFlag = false;
+    float attackTimeValue = 0.0f;
+    bool isShieldingFlag = false;
+    float shieldTimeValue = 0.0f;
+    bool hasParriedFlag = false;
+    float parryTimeValue = 0.0f;
+    float shieldDurationValue = 2.0f;
+    float shieldCooldownTimeValue = 0.0f;
+    float damageReductionValue = 0.75f;
+    std::vector<BloodDrop> bloodDrops;
+    std::string gene;
+    int faction = 0;
+    float sizeMultiplier = 1.0f;
+    float sharpnessMultiplier = 1.0f;
+    float speedMultiplier = 1.0f;
+    float attackMultiplier = 1.0f;
+    float defenseMultiplier = 1.0f;
+};
+
+// 细胞状态更新：旧的逐对象虚函数更新 vs 逐实体走CellStore内核 vs CellStore批量推进
+int benchCellStore() {
+    const cv::Size canvasSize(800, 600);
+    const float deltaTime = 1.0f / 60.0f;
+
+    GameConfig config{};
+    config.maxSpeed = 8.0f;
+    config.drag = 0.95f;
+    config.attackDuration = 0.5f;
+
+    std::mt19937 gen(2024);
+    std::uniform_real_distribution<float> xDist(0.0f, canvasSize.width);
+    std::uniform_real_distribution<float> yDist(0.0f, canvasSize.height);
+    std::uniform_real_distribution<float> velDist(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+
+    std::cout << "细胞状态更新基准 (每次更新全部细胞一帧)" << std::endl;
+    std::cout << std::setw(8) << "细胞数" << std::setw(14) << "旧布局(ms)" << std::setw(14) << "逐实体(ms)"
+              << std::setw(14) << "批量(ms)" << std::setw(10) << "加速比" << std::setw(16) << "细胞/ms(批量)" << std::endl;
+
+    int status = 0;
+    for (int count : {1000, 10000, 100000}) {
+        // 初始状态，每轮计时前恢复
+        std::vector<cv::Point2f> positions(count), velocities(count);
+        std::vector<bool> attacking(count), shielding(count);
+        for (int i = 0; i < count; ++i) {
+            positions[i] = cv::Point2f(xDist(gen), yDist(gen));
+            velocities[i] = cv::Point2f(velDist(gen), velDist(gen));
+            attacking[i] = probDist(gen) < 0.25f;
+            shielding[i] = probDist(gen) < 0.25f;
+        }
+
+        // 旧布局的对照组，交替分配并释放一半对象，模拟运行一段时间后对象在堆上的分散分布
+        std::vector<std::shared_ptr<LegacyCell>> legacy;
+        std::vector<std::shared_ptr<LegacyCell>> padding;
+        std::vector<std::shared_ptr<BaseCell>> cells;
+        legacy.reserve(count);
+        cells.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            legacy.push_back(std::make_shared<LegacyCell>(positions[i]));
+            padding.push_back(std::make_shared<LegacyCell>(positions[i]));
+            cells.push_back(std::make_shared<BaseCell>(positions[i], 0, cv::Vec3b(200, 230, 255), 0.0f, 0.5f));
+        }
+        padding.clear();
+
+        auto resetLegacy = [&]() {
+            for (int i = 0; i < count; ++i) {
+                legacy[i]->position = positions[i];
+                legacy[i]->velocity = velocities[i];
+                legacy[i]->isAttackingFlag = attacking[i];
+                legacy[i]->attackTimeValue = 0.0f;
+                legacy[i]->isShieldingFlag = shielding[i];
+                legacy[i]->shieldTimeValue = 0.0f;
+            }
+        };
+        auto resetCells = [&]() {
+            for (int i = 0; i < count; ++i) {
+                cells[i]->setPosition(positions[i]);
+                cells[i]->setVelocity(velocities[i]);
+                cells[i]->setAttacking(attacking[i]);
+                cells[i]->setAttackTime(0.0f);
+                cells[i]->setShielding(shielding[i]);
+                cells[i]->setShieldTime(0.0f);
+            }
+        };
+
+        double legacyMs = measureFramesMs(resetLegacy, [&]() {
+            for (auto& cell : legacy) {
+                cell->update(deltaTime, config, canvasSize);
+            }
+        });
+
+        double perEntityMs = measureFramesMs(resetCells, [&]() {
+            for (auto& cell : cells) {
+                cell->update(deltaTime, config, canvasSize);
+            }
+        });
+
+        CellStore& store = CellStore::instance();
+        double batchMs = measureFramesMs(resetCells, [&]() {
+            store.step(deltaTime, config, canvasSize);
+        });
+
+        double speedup = legacyMs / batchMs;
+        std::cout << std::setw(8) << count
+                  << std::setw(14) << std::fixed << std::setprecision(3) << legacyMs
+                  << std::setw(14) << perEntityMs
+                  << std::setw(14) << batchMs
+                  << std::setw(9) << std::setprecision(1) << speedup << "x"
+                  << std::setw(16) << std::setprecision(0) << count / batchMs << std::endl;
+
+        // 目标：10万细胞时批量推进每毫秒处理的细胞数是旧布局的10倍
+        if (count == 100000 && speedup < 10.0) {
+            std::cout << "未达到10倍目标" << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// 逐实体更新阶段（行为决策、CellStore推进）在1到N个线程上的扩展性
+int benchThreads() {
+    const cv::Size canvasSize(800, 600);
+    const float deltaTime = 1.0f / 60.0f;
+    const size_t grainSize = 256;
+
+    GameConfig config{};
+    config.maxSpeed = 6.0f;
+    config.drag = 0.94f;
+    config.attackDuration = 0.5f;
+    config.randomMoveProbability = 0.05f;
+    config.randomMoveStrength = 0.3f;
+    config.aggressionChangeProbability = 0.01f;
+    config.aggressionChangeAmount = 0.1f;
+    config.maxAggression = 1.0f;
+    config.minAggression = 0.0f;
+
+    const int maxWorkers = ThreadPool::defaultWorkerCount();
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < maxWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    std::mt19937 gen(7);
+
+    std::cout << "并行实体更新基准 (硬件并发数 " << maxWorkers << ")" << std::endl;
+    std::cout << std::setw(8) << "细胞数" << std::setw(8) << "线程" << std::setw(12) << "耗时(ms)"
+              << std::setw(10) << "加速比" << std::setw(10) << "效率" << std::endl;
+
+    for (int count : {10000, 100000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        CellStore& store = CellStore::instance();
+
+        double serialMs = 0.0;
+        for (int workers : workerCounts) {
+            ThreadPool pool(workers);
+            double ms = measureMs([&]() {
+                pool.parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        entities[i]->updateBehavior(deltaTime, config);
+                    }
+                });
+                store.step(deltaTime, config, canvasSize, pool);
+            });
+            if (workers == 1) serialMs = ms;
+
+            double speedup = serialMs / ms;
+            std::cout << std::setw(8) << count << std::setw(8) << workers
+                      << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                      << std::setw(9) << std::setprecision(2) << speedup << "x"
+                      << std::setw(9) << std::setprecision(0) << speedup / workers * 100.0 << "%" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// 血滴更新：逐细胞vector中途erase vs 粒子池批量推进 + swap-and-pop
+int benchParticles() {
+    const float deltaTime = 1.0f / 60.0f;
+
+    std::mt19937 gen(99);
+    std::uniform_real_distribution<float> posDist(0.0f, 800.0f);
+    std::uniform_real_distribution<float> velDist(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> lifeDist(0.6f, 1.3f);
+
+    std::cout << "血滴粒子更新基准 (每轮生成全部血滴并推进到全部过期)" << std::endl;
+    std::cout << std::setw(8) << "血滴数" << std::setw(14) << "vector(ms)" << std::setw(14) << "粒子池(ms)"
+              << std::setw(10) << "加速比" << std::endl;
+
+    ParticleSystem& particles = ParticleSystem::instance();
+    const size_t originalCapacity = particles.capacity();
+
+    for (int count : {100, 1000, 10000, 50000}) {
+        std::vector<BloodDrop> drops;
+        for (int i = 0; i < count; ++i) {
+            drops.emplace_back(cv::Point2f(posDist(gen), posDist(gen)), cv::Point2f(velDist(gen), velDist(gen)),
+                               5.0f, lifeDist(gen), 0.0f);
+        }
+
+        // 最长寿命1.3秒，推进到所有血滴过期
+        const int frames = static_cast<int>(1.3f / deltaTime) + 2;
+
+        double vectorMs = measureMs([&]() {
+            std::vector<BloodDrop> working = drops;
+            for (int f = 0; f < frames; ++f) {
+                legacyUpdateBloodDrops(working, deltaTime);
+            }
+        });
+
+        particles.setCapacity(count);
+        double poolMs = measureMs([&]() {
+            particles.clear();
+            for (const auto& drop : drops) {
+                particles.spawn(drop.position, drop.velocity, drop.size, drop.lifetime, drop.rotation);
+            }
+            for (int f = 0; f < frames; ++f) {
+                particles.update(deltaTime);
+            }
+        });
+
+        std::cout << std::setw(8) << count
+                  << std::setw(14) << std::fixed << std::setprecision(3) << vectorMs
+                  << std::setw(14) << poolMs
+                  << std::setw(9) << std::setprecision(1) << vectorMs / poolMs << "x" << std::endl;
+    }
+
+    particles.setCapacity(originalCapacity);
+    return 0;
+}
+
+// 改造前的字符串基因：逐字节比较相似度，变异时每个字符都经由generateRandomGene(1)生成临时字符串
+const char legacyCharset[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789!@#$%^&*()-_=+";
+
+std::string legacyRandomGene(int length, std::mt19937& gen) {
+    std::uniform_int_distribution<size_t> dist(0, sizeof(legacyCharset) - 2);
+    std::string gene;
+    gene.reserve(length);
+    for (int i = 0; i < length; i++) {
+        gene += legacyCharset[dist(gen)];
+    }
+    return gene;
+}
+
+float legacySimilarity(const std::string& s1, const std::string& s2) {
+    if (s1.empty() || s2.empty()) return 0.0f;
+    int matches = 0;
+    size_t minLength = std::min(s1.size(), s2.size());
+    for (size_t i = 0; i < minLength; i++) {
+        if (s1[i] == s2[i]) matches++;
+    }
+    return static_cast<float>(matches) / minLength;
+}
+
+std::string legacyMutateGene(const std::string& parentGene1, const std::string& parentGene2, std::mt19937& gen) {
+    std::string newGene;
+    size_t targetLength = std::max<size_t>(std::max(parentGene1.length(), parentGene2.length()), 16);
+    newGene.reserve(targetLength);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t i = 0; i < targetLength; i++) {
+        char geneChar;
+        if (dist(gen) < 0.6f && i < parentGene1.length() && i < parentGene2.length()) {
+            geneChar = (dist(gen) < 0.5f) ? parentGene1[i] : parentGene2[i];
+        } else {
+            geneChar = legacyRandomGene(1, gen)[0];
+        }
+        newGene += geneChar;
+    }
+    return newGene;
+}
+
+// 基因相似度与繁殖变异：字符串逐字节 vs 定长基因SIMD比较
+int benchGenes() {
+    const int geneCount = 1024;
+    const int rounds = 1000000;
+    volatile float sink = 0.0f;
+
+    std::mt19937 gen(31);
+    Pcg32 rng(31);
+    std::vector<std::string> legacyGenes;
+    std::vector<Gene> genes;
+    for (int i = 0; i < geneCount; ++i) {
+        legacyGenes.push_back(legacyRandomGene(16, gen));
+        genes.push_back(Gene(legacyGenes.back()));
+    }
+
+    std::cout << "基因基准 (" << geneCount << "个16字符基因)" << std::endl;
+    std::cout << "对象内存: std::string " << sizeof(std::string) << " 字节, Gene " << sizeof(Gene) << " 字节" << std::endl;
+
+    // 先逐对核对两种实现的相似度；随机基因之间几乎没有相同的位置，
+    // 所以再把另一个基因的部分位置拷进来，得到相似度在0到1之间分布的基因对
+    int mismatched = 0;
+    for (int i = 0; i < geneCount; ++i) {
+        const int j = (i * 7 + 3) & (geneCount - 1);
+        std::string related = legacyGenes[i];
+        for (size_t k = 0; k < related.size(); ++k) {
+            if (static_cast<int>(gen() % 17) < i % 17) related[k] = legacyGenes[j][k];
+        }
+        mismatched += legacySimilarity(legacyGenes[i], legacyGenes[j]) != genes[i].similarity(genes[j]);
+        mismatched += legacySimilarity(legacyGenes[i], related) != genes[i].similarity(Gene(related));
+    }
+    std::cout << "相似度核对: " << 2 * geneCount << "对, "
+              << (mismatched == 0 ? std::string("结果一致") : std::to_string(mismatched) + "对不一致!") << std::endl;
+    if (mismatched > 0) {
+        return 1;
+    }
+
+    double legacySimMs = measureMs([&]() {
+        float acc = 0.0f;
+        for (int i = 0; i < rounds; ++i) {
+            acc += legacySimilarity(legacyGenes[i & (geneCount - 1)], legacyGenes[(i * 7 + 3) & (geneCount - 1)]);
+        }
+        sink = acc;
+    });
+    double packedSimMs = measureMs([&]() {
+        float acc = 0.0f;
+        for (int i = 0; i < rounds; ++i) {
+            acc += genes[i & (geneCount - 1)].similarity(genes[(i * 7 + 3) & (geneCount - 1)]);
+        }
+        sink = acc;
+    });
+    std::cout << std::setw(16) << "相似度x" << rounds << std::fixed << std::setprecision(3)
+              << std::setw(12) << legacySimMs << " ms -> " << packedSimMs << " ms ("
+              << std::setprecision(1) << legacySimMs / packedSimMs << "x)" << std::endl;
+
+    const int mutations = 100000;
+    double legacyMixMs = measureMs([&]() {
+        size_t total = 0;
+        for (int i = 0; i < mutations; ++i) {
+            total += legacyMutateGene(legacyGenes[i & (geneCount - 1)], legacyGenes[(i + 1) & (geneCount - 1)], gen).size();
+        }
+        sink = static_cast<float>(total);
+    });
+    double packedMixMs = measureMs([&]() {
+        int total = 0;
+        for (int i = 0; i < mutations; ++i) {
+            total += Gene::mix(genes[i & (geneCount - 1)], genes[(i + 1) & (geneCount - 1)], rng)[0];
+        }
+        sink = static_cast<float>(total);
+    });
+    std::cout << std::setw(16) << "变异x" << mutations << std::fixed << std::setprecision(3)
+              << std::setw(12) << legacyMixMs << " ms -> " << packedMixMs << " ms ("
+              << std::setprecision(1) << legacyMixMs / packedMixMs << "x)" << std::endl;
+    return 0;
+}
+
+// 随机数：每次调用构造random_device + mt19937 vs 世界流；std分布 + mt19937 vs Pcg32直接取值
+int benchRng() {
+    const int calls = 10000;
+    const int draws = 10000000;
+    volatile float sink = 0.0f;
+
+    std::cout << "随机数基准" << std::endl;
+    std::cout << "每实体状态: mt19937 " << sizeof(std::mt19937) << " 字节, Pcg32 " << sizeof(Pcg32) << " 字节" << std::endl;
+
+    // 旧的createBloodEffect：每次调用都重新构造生成器，再取8个数
+    double perCallMs = measureMs([&]() {
+        float acc = 0.0f;
+        for (int i = 0; i < calls; ++i) {
+            std::random_device rd;
+            std::mt19937 gen(rd());
+            std::uniform_real_distribution<float> dist(-20.0f, 20.0f);
+            for (int k = 0; k < 8; ++k) acc += dist(gen);
+        }
+        sink = acc;
+    });
+    double worldMs = measureMs([&]() {
+        Pcg32& gen = Random::world();
+        float acc = 0.0f;
+        for (int i = 0; i < calls; ++i) {
+            for (int k = 0; k < 8; ++k) acc += gen.uniform(-20.0f, 20.0f);
+        }
+        sink = acc;
+    });
+    std::cout << std::setw(24) << "血滴生成x" << calls << std::fixed << std::setprecision(3)
+              << std::setw(12) << perCallMs << " ms -> " << worldMs << " ms ("
+              << std::setprecision(1) << perCallMs / worldMs << "x)" << std::endl;
+
+    double mtMs = measureMs([&]() {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        float acc = 0.0f;
+        for (int i = 0; i < draws; ++i) acc += dist(gen);
+        sink = acc;
+    });
+    double pcgMs = measureMs([&]() {
+        Pcg32 gen(1);
+        float acc = 0.0f;
+        for (int i = 0; i < draws; ++i) acc += gen.nextFloat();
+        sink = acc;
+    });
+    std::cout << std::setw(24) << "浮点取值x" << draws << std::fixed << std::setprecision(3)
+              << std::setw(12) << mtMs << " ms -> " << pcgMs << " ms ("
+              << std::setprecision(1) << mtMs / pcgMs << "x)" << std::endl;
+
+    // 每个AI细胞创建时派生自己的流
+    double seedMtMs = measureMs([&]() {
+        std::vector<std::mt19937> streams;
+        streams.reserve(calls);
+        std::random_device rd;
+        for (int i = 0; i < calls; ++i) streams.emplace_back(rd());
+    });
+    double seedPcgMs = measureMs([&]() {
+        std::vector<Pcg32> streams;
+        streams.reserve(calls);
+        for (int i = 0; i < calls; ++i) streams.push_back(Random::makeStream(i));
+    });
+    std::cout << std::setw(24) << "派生实体流x" << calls << std::fixed << std::setprecision(3)
+              << std::setw(12) << seedMtMs << " ms -> " << seedPcgMs << " ms ("
+              << std::setprecision(1) << seedMtMs / seedPcgMs << "x)" << std::endl;
+    return 0;
+}
+
+// 每帧画布：新建cv::Mat并填白 vs 预分配缓冲轮换
+int benchFrameBuffers() {
+    const int frames = 200;
+    volatile int sink = 0;
+
+    std::cout << "画布基准 (每轮" << frames << "帧)" << std::endl;
+    for (const cv::Size& size : {cv::Size(800, 600), cv::Size(1920, 1080)}) {
+        double allocMs = measureMs([&]() {
+            for (int i = 0; i < frames; ++i) {
+                cv::Mat canvas = cv::Mat(size, CV_8UC3, cv::Scalar(255, 255, 255));
+                canvas.ptr<uchar>(i % size.height)[0] = 0;
+                sink = sink + canvas.ptr<uchar>(0)[3];
+            }
+        }) / frames;
+        FrameBuffers frameBuffers;
+        double pooledMs = measureMs([&]() {
+            for (int i = 0; i < frames; ++i) {
+                cv::Mat& canvas = frameBuffers.acquire(size);
+                canvas.ptr<uchar>(i % size.height)[0] = 0;
+                sink = sink + frameBuffers.present().ptr<uchar>(0)[3];
+            }
+        }) / frames;
+        std::cout << std::setw(10) << size.width << "x" << size.height << std::fixed << std::setprecision(3)
+                  << std::setw(12) << allocMs << " ms -> " << pooledMs << " ms ("
+                  << std::setprecision(1) << allocMs / pooledMs << "x)" << std::endl;
+    }
+    return 0;
+}
+
+// 与游戏中一致的细胞渲染配置
+std::map<std::string, float> makeCellConfig() {
+    return {
+        {"cell_width", 100.f}, {"cell_height", 60.f},
+        {"eye_size", 20.f}, {"eye_ecc", 0.1f}, {"eye_angle", 15.f},
+        {"eye_y_off", 0.2f}, {"eye_x_off", 0.5f},
+        {"mouth_x0", 0.6f}, {"mouth_y0", 0.55f},
+        {"mouth_x1", 0.7f}, {"mouth_y1", 0.65f},
+        {"mouth_x2", 0.85f}, {"mouth_y2", 0.55f},
+        {"mouth_width", 3.f},
+        {"tail_width", 3.f}
+    };
+}
+
+// 细胞身体：逐帧光栅化椭圆、眼睛、眼睑和嘴 vs 图集精灵着色混合；另测整个drawCell
+int benchCellSprites() {
+    const cv::Size canvasSize(1600, 1200);
+    const float scale = 0.4f;
+    const float time = 1.5f;
+    const std::map<std::string, float> config = makeCellConfig();
+
+    std::mt19937 gen(23);
+    std::uniform_real_distribution<float> aggressionDist(0.0f, 1.0f);
+    cv::Mat canvas(canvasSize, CV_8UC3);
+
+    std::cout << "细胞身体绘制基准 (画布" << canvasSize.width << "x" << canvasSize.height << ")" << std::endl;
+    for (int count : {500, 3000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        for (auto& cell : entities) {
+            cell->setAggressionLevel(aggressionDist(gen));
+        }
+
+        // 与drawCell相同的尺寸计算
+        struct BodyParams { cv::Point2f pos; float width, height; bool faceRight; cv::Scalar color; float aggression; };
+        std::vector<BodyParams> bodies;
+        for (const auto& cell : entities) {
+            float sizeEffect = 1.0f + (cell->getSizeMultiplier() - 1.0f) * 0.3f;
+            float eccentricity = 0.05f + (cell->getSharpnessMultiplier() - 1.0f) * 0.15f;
+            float width = config.at("cell_width") * scale * sizeEffect;
+            float height = config.at("cell_height") * scale * sizeEffect;
+            if (cell->getSharpnessMultiplier() > 1.0f) {
+                width *= (1.0f + eccentricity * 0.3f);
+                height *= (1.0f - eccentricity * 0.1f);
+            } else {
+                width *= (1.0f - eccentricity * 0.1f);
+                height *= (1.0f + eccentricity * 0.1f);
+            }
+            const cv::Vec3b& color = cell->getColor();
+            bodies.push_back({cell->getRenderPosition(), width, height, cell->isFacingRight(),
+                              cv::Scalar(color[0], color[1], color[2]), cell->getAggressionLevel()});
+        }
+
+        double directMs = measureMs([&]() {
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            for (const BodyParams& b : bodies) {
+                drawCellBody(canvas, b.pos, b.width, b.height, b.faceRight, b.color, b.aggression, config, scale);
+            }
+        });
+        CellSprites& atlas = CellSprites::instance();
+        atlas.clear();
+        double atlasMs = measureMs([&]() {
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            for (const BodyParams& b : bodies) {
+                const CellSprite& sprite = atlas.get(config, scale, b.width, b.height, b.faceRight, b.aggression);
+                SpriteTint tint;
+                tint.gain = cv::Vec3f(static_cast<float>(b.color[0] / 255.0), static_cast<float>(b.color[1] / 255.0),
+                                      static_cast<float>(b.color[2] / 255.0));
+                blendPremultiplied(canvas, sprite.image,
+                                   cv::Point(static_cast<int>(b.pos.x), static_cast<int>(b.pos.y)) - sprite.origin, tint);
+            }
+        });
+        double fullMs = measureMs([&]() {
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            for (const auto& cell : entities) {
+                drawCell(canvas, *cell, config, scale, time);
+            }
+        });
+        std::cout << std::setw(8) << count << "个细胞" << std::fixed << std::setprecision(3)
+                  << std::setw(12) << directMs << " ms -> " << atlasMs << " ms ("
+                  << std::setprecision(1) << directMs / atlasMs << "x), 图集" << atlas.size()
+                  << "个精灵, 整个drawCell " << std::setprecision(3) << fullMs << " ms" << std::endl;
+        entities.clear();
+    }
+    return 0;
+}
+
+// 旧的尾巴几何：每个采样点重新计算相位并调用一次sin
+void legacyTailCurve(const cv::Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                     float tailPhaseOffset, float time, std::vector<cv::Point2f>& tailCurve) {
+    float directionFactor = faceRight ? 1.0f : -1.0f;
+    float tailLength = 2.5f * cellWidth;
+    float tailWaveAmplitude = 0.25f * cellHeight;
+    float tailWaveFrequency = 3.0f;
+    float tailWaveSpeed = 5.0f;
+    int numTailPoints = 30;
+    cv::Point2f tailStart(cellPos.x - directionFactor * cellWidth * 0.5f, cellPos.y);
+    cv::Point2f tailDirection(-directionFactor, 0);
+
+    tailCurve.clear();
+    for (int i = 0; i <= numTailPoints; i++) {
+        float t = static_cast<float>(i) / numTailPoints;
+        float x = tailStart.x + tailDirection.x * t * tailLength;
+        float y = tailStart.y + tailDirection.y * t * tailLength;
+        float wavePhase = time * tailWaveSpeed + tailPhaseOffset + t * tailWaveFrequency * 2 * CV_PI;
+        float perpX = -tailDirection.y;
+        float perpY = tailDirection.x;
+        float localAmplitude = tailWaveAmplitude * (t);
+        float waveOffset = std::sin(wavePhase) * localAmplitude;
+        tailCurve.push_back(cv::Point2f(x + perpX * waveOffset, y + perpY * waveOffset));
+    }
+}
+
+// 细胞折线几何（不含光栅化）：逐点sin和bezierPoint vs 相位递推（SSE2跨细胞）和预计算的Bernstein权重
+int benchGeometry() {
+    const cv::Size canvasSize(1600, 1200);
+    const float scale = 0.4f;
+    const std::map<std::string, float> config = makeCellConfig();
+    std::mt19937 gen(41);
+    std::uniform_real_distribution<float> phaseDist(0.0f, 6.28f);
+    std::uniform_real_distribution<float> timeDist(0.0f, 600.0f);
+    int status = 0;
+
+    std::cout << "细胞几何基准 (完整档尾巴31个点, 嘴26个点)" << std::endl;
+    for (int count : {1000, 10000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        RenderSnapshot snapshot;
+        snapshot.capture(entities, ParticleSystem::instance());
+        std::vector<cv::Point2f> positions;
+        std::vector<cv::Size2f> bodySizes;
+        std::vector<std::vector<cv::Point2f>> mouthControls;
+        for (CellView& cell : snapshot.cells) {
+            cell.tailPhaseOffset = phaseDist(gen);
+            positions.push_back(cell.position);
+            const cv::Size2f body = cellBodySize(cell, config, scale);
+            bodySizes.push_back(body);
+            const float direction = cell.faceRight ? 1.0f : -1.0f;
+            mouthControls.push_back({
+                cv::Point2f(cell.position.x + config.at("mouth_x0") * body.width * direction,
+                            cell.position.y + config.at("mouth_y0") * body.height),
+                cv::Point2f(cell.position.x + config.at("mouth_x1") * body.width * direction,
+                            cell.position.y + (config.at("mouth_y1") - 0.25f * cell.aggressionLevel) * body.height),
+                cv::Point2f(cell.position.x + config.at("mouth_x2") * body.width * direction,
+                            cell.position.y + config.at("mouth_y2") * body.height)});
+        }
+        const float time = timeDist(gen);
+
+        std::vector<cv::Point2f> tail, mouth;
+        volatile float sink = 0.0f;
+        double legacyMs = measureMs([&]() {
+            float acc = 0.0f;
+            for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+                const CellView& cell = snapshot.cells[i];
+                legacyTailCurve(positions[i], bodySizes[i].width, bodySizes[i].height, cell.faceRight,
+                                cell.tailPhaseOffset, time, tail);
+                mouth.clear();
+                for (float t = 0; t <= 1; t += 0.04f) {
+                    mouth.push_back(bezierPoint(mouthControls[i], t));
+                }
+                acc += tail.back().y + mouth.back().y;
+            }
+            sink = acc;
+        });
+
+        TailBatch batch;
+        double tabledMs = measureMs([&]() {
+            float acc = 0.0f;
+            batch.compute(snapshot.cells, positions, nullptr, config, scale, time);
+            for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+                evaluateMouthCurve(mouthControls[i].data(), mouth);
+                acc += batch.curve(i)[30].y + mouth.back().y;
+            }
+            sink = acc;
+        });
+
+        // 与旧几何的最大偏差，批量结果与逐个细胞计算是否逐位相同
+        float maxTailError = 0.0f, maxMouthError = 0.0f;
+        bool batchMatches = true;
+        cv::Point2f single[maxTailPoints];
+        for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+            const CellView& cell = snapshot.cells[i];
+            legacyTailCurve(positions[i], bodySizes[i].width, bodySizes[i].height, cell.faceRight,
+                            cell.tailPhaseOffset, time, tail);
+            computeTailCurve(positions[i], bodySizes[i].width, bodySizes[i].height, cell.faceRight,
+                             cell.tailPhaseOffset, time, CellDetail::Full, single);
+            for (int k = 0; k < maxTailPoints; ++k) {
+                const cv::Point2f d = tail[k] - batch.curve(i)[k];
+                maxTailError = std::max(maxTailError, std::max(std::fabs(d.x), std::fabs(d.y)));
+                batchMatches = batchMatches && single[k] == batch.curve(i)[k];
+            }
+            evaluateMouthCurve(mouthControls[i].data(), mouth);
+            int k = 0;
+            for (float t = 0; t <= 1; t += 0.04f, ++k) {
+                const cv::Point2f d = bezierPoint(mouthControls[i], t) - mouth[k];
+                maxMouthError = std::max(maxMouthError, std::max(std::fabs(d.x), std::fabs(d.y)));
+            }
+        }
+        if (maxTailError > 1.0f || maxMouthError > 0.0f || !batchMatches) status = 1;
+
+        std::cout << std::setw(8) << count << "个细胞" << std::fixed << std::setprecision(3)
+                  << std::setw(10) << legacyMs << " ms -> " << tabledMs << " ms ("
+                  << std::setprecision(1) << legacyMs / tabledMs << "x), 尾巴最大偏差 "
+                  << std::setprecision(5) << maxTailError << " px, 嘴最大偏差 " << maxMouthError
+                  << " px, 批量与逐个" << (batchMatches ? "逐位一致" : "不一致") << std::endl;
+    }
+    return status;
+}
+
+// 模拟/渲染分线程：模拟线程每次发布只付出快照复制的开销，绘制开销留在渲染线程
+int benchSnapshot() {
+    const cv::Size canvasSize(1600, 1200);
+    const float scale = 0.4f;
+    const std::map<std::string, float> config = makeCellConfig();
+    std::mt19937 gen(29);
+    cv::Mat canvas(canvasSize, CV_8UC3);
+
+    std::cout << "渲染快照基准" << std::endl;
+    for (int count : {1000, 5000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        TripleBuffer<RenderSnapshot> snapshots;
+
+        double captureMs = measureMs([&]() {
+            snapshots.writeBuffer().capture(entities, ParticleSystem::instance());
+            snapshots.publish();
+        });
+        snapshots.update();
+        double drawMs = measureMs([&]() {
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            drawSnapshot(canvas, snapshots.readBuffer(), 0.5f, config, scale, 1.0f);
+        });
+        std::cout << std::setw(8) << count << "个细胞" << std::fixed << std::setprecision(3)
+                  << "  模拟线程复制快照 " << captureMs << " ms, 渲染线程绘制 " << drawMs << " ms" << std::endl;
+    }
+
+    // 两个线程之间的交接：生产者不停发布，消费者不停取最新值，统计交接次数并检查序号单调
+    TripleBuffer<uint64_t> handoff;
+    std::atomic<bool> done(false);
+    uint64_t published = 0;
+    std::thread producer([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            handoff.writeBuffer() = ++published;
+            handoff.publish();
+        }
+    });
+    uint64_t received = 0, last = 0;
+    bool ordered = true;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() < 0.2) {
+        if (handoff.update()) {
+            ordered = ordered && handoff.readBuffer() > last;
+            last = handoff.readBuffer();
+            ++received;
+        }
+    }
+    done = true;
+    producer.join();
+    std::cout << "三缓冲交接: 0.2秒内发布" << published << "次, 取到" << received << "次, 序号"
+              << (ordered ? "单调递增" : "出现倒退") << std::endl;
+    return ordered ? 0 : 1;
+}
+
+// 逐像素的整数混合参考实现，用来校验合成器的向量化路径与标量结果逐位一致
+void referenceBlend(cv::Mat& canvas, const cv::Mat& sprite, const SpriteTint* tint) {
+    auto fixed = [](float v) { return static_cast<unsigned int>(std::lround(v * 128.0f)); };
+    for (int y = 0; y < std::min(canvas.rows, sprite.rows); ++y) {
+        for (int x = 0; x < std::min(canvas.cols, sprite.cols); ++x) {
+            const cv::Vec4b& src = sprite.at<cv::Vec4b>(y, x);
+            cv::Vec3b& dst = canvas.at<cv::Vec3b>(y, x);
+            const unsigned int alpha = src[3];
+            for (int c = 0; c < 3; ++c) {
+                unsigned int color = src[c];
+                if (tint) {
+                    color = std::min(alpha, ((color * fixed(tint->gain[c])) >> 7) + ((alpha * fixed(tint->fill[c])) >> 7));
+                }
+                unsigned int t = dst[c] * (255 - alpha) + 128;
+                dst[c] = static_cast<uchar>(color + ((t + (t >> 8)) >> 8));
+            }
+        }
+    }
+}
+
+// 精灵合成吞吐量：旧的at<>逐像素浮点混合 vs 按行的预乘alpha混合（x86上为SSE2）
+int benchBlend() {
+    const cv::Size canvasSize(800, 600);
+    const cv::Size spriteSize(256, 256);
+    const int placements = 64;
+    const double pixels = static_cast<double>(spriteSize.area()) * placements;
+
+    // alpha在精灵内从透明渐变到不透明，带一圈全透明边
+    cv::Mat straight(spriteSize, CV_8UC4);
+    for (int y = 0; y < spriteSize.height; ++y) {
+        for (int x = 0; x < spriteSize.width; ++x) {
+            const bool border = x < 16 || y < 16 || x >= spriteSize.width - 16 || y >= spriteSize.height - 16;
+            straight.at<cv::Vec4b>(y, x) = cv::Vec4b(static_cast<uchar>(x), static_cast<uchar>(y), static_cast<uchar>(x ^ y),
+                                                     border ? 0 : static_cast<uchar>((x + y) / 2));
+        }
+    }
+    const cv::Mat premultiplied = premultiplyAlpha(straight);
+
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> xDist(-spriteSize.width / 2, canvasSize.width - spriteSize.width / 2);
+    std::uniform_int_distribution<int> yDist(-spriteSize.height / 2, canvasSize.height - spriteSize.height / 2);
+    std::vector<cv::Point> positions;
+    for (int i = 0; i < placements; ++i) positions.emplace_back(xDist(gen), yDist(gen));
+
+    cv::Mat canvas(canvasSize, CV_8UC3, cv::Scalar(90, 60, 30));
+    auto legacy = [&]() {
+        for (const cv::Point& topLeft : positions) {
+            cv::Rect roi = cv::Rect(topLeft, spriteSize) & cv::Rect(0, 0, canvas.cols, canvas.rows);
+            for (int y = 0; y < roi.height; ++y) {
+                for (int x = 0; x < roi.width; ++x) {
+                    const cv::Vec4b& spritePixel = straight.at<cv::Vec4b>(y + roi.y - topLeft.y, x + roi.x - topLeft.x);
+                    cv::Vec3b& canvasPixel = canvas.at<cv::Vec3b>(y + roi.y, x + roi.x);
+                    float alpha = spritePixel[3] / 255.0f;
+                    for (int c = 0; c < 3; ++c) {
+                        canvasPixel[c] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[c] + alpha * spritePixel[c]);
+                    }
+                }
+            }
+        }
+    };
+    const SpriteTint parryGlow{cv::Vec3f(1.5f, 1.5f, 0.0f), cv::Vec3f(0.0f, 0.0f, 1.0f)};
+    auto plain = [&]() {
+        for (const cv::Point& topLeft : positions) blendPremultiplied(canvas, premultiplied, topLeft);
+    };
+    auto tinted = [&]() {
+        for (const cv::Point& topLeft : positions) blendPremultiplied(canvas, premultiplied, topLeft, parryGlow);
+    };
+
+    std::cout << "精灵合成基准 (" << placements << "个" << spriteSize.width << "x" << spriteSize.height
+              << "精灵, 含裁剪)" << std::endl;
+    auto report = [&](const char* label, double baseMs, double ms) {
+        std::cout << std::setw(16) << label << std::fixed << std::setprecision(3)
+                  << std::setw(12) << baseMs << " ms -> " << ms << " ms ("
+                  << std::setprecision(1) << baseMs / ms << "x), "
+                  << pixels / baseMs / 1000.0 << " -> " << pixels / ms / 1000.0 << " M像素/秒" << std::endl;
+    };
+    double legacyMs = measureMs(legacy);
+    report("普通", legacyMs, measureMs(plain));
+    report("格挡着色", legacyMs, measureMs(tinted));
+
+    // 与标量参考实现比对，画布尺寸取精灵大小，使每个像素都参与混合
+    bool identical = true;
+    for (const SpriteTint* tint : {static_cast<const SpriteTint*>(nullptr), &parryGlow}) {
+        cv::Mat expected(spriteSize, CV_8UC3, cv::Scalar(200, 120, 40));
+        cv::Mat actual = expected.clone();
+        referenceBlend(expected, premultiplied, tint);
+        if (tint) {
+            blendPremultiplied(actual, premultiplied, cv::Point(0, 0), *tint);
+        } else {
+            blendPremultiplied(actual, premultiplied, cv::Point(0, 0));
+        }
+        for (int y = 0; y < spriteSize.height; ++y) {
+            identical = identical && std::memcmp(expected.ptr<uchar>(y), actual.ptr<uchar>(y), spriteSize.width * 3) == 0;
+        }
+    }
+    std::cout << "与标量参考结果逐位一致: " << (identical ? "是" : "否") << std::endl;
+    return identical ? 0 : 1;
+}
+
+// 旧的盾牌绘制：每个盾牌clone并resize一次原图，再逐像素做浮点alpha混合
+void legacyBlendShield(cv::Mat& canvas, const cv::Mat& shieldImage, const cv::Point2f& shieldPos,
+                       float shieldWidth, float shieldHeight, bool hasParried) {
+    cv::Mat shieldImg = shieldImage.clone();
+    cv::Mat resizedShield;
+    cv::resize(shieldImg, resizedShield, cv::Size(static_cast<int>(shieldWidth), static_cast<int>(shieldHeight)));
+
+    const int left = static_cast<int>(shieldPos.x - shieldWidth / 2);
+    const int top = static_cast<int>(shieldPos.y - shieldHeight / 2);
+    cv::Rect roi = cv::Rect(left, top, static_cast<int>(shieldWidth), static_cast<int>(shieldHeight))
+                 & cv::Rect(0, 0, canvas.cols, canvas.rows);
+    for (int y = 0; y < roi.height; ++y) {
+        for (int x = 0; x < roi.width; ++x) {
+            int srcX = x + roi.x - left;
+            int srcY = y + roi.y - top;
+            if (srcX < 0 || srcX >= resizedShield.cols || srcY < 0 || srcY >= resizedShield.rows) continue;
+            const cv::Vec4b& shieldPixel = resizedShield.at<cv::Vec4b>(srcY, srcX);
+            cv::Vec3b& canvasPixel = canvas.at<cv::Vec3b>(y + roi.y, x + roi.x);
+            float alpha = shieldPixel[3] / 255.0f;
+            if (hasParried) {
+                canvasPixel[0] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[0] + alpha * std::min(255.0f, shieldPixel[0] * 1.5f));
+                canvasPixel[1] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[1] + alpha * std::min(255.0f, shieldPixel[1] * 1.5f));
+                canvasPixel[2] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[2] + alpha * 255);
+            } else {
+                canvasPixel[0] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[0] + alpha * shieldPixel[0]);
+                canvasPixel[1] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[1] + alpha * shieldPixel[1]);
+                canvasPixel[2] = cv::saturate_cast<uchar>((1 - alpha) * canvasPixel[2] + alpha * shieldPixel[2]);
+            }
+        }
+    }
+}
+
+// 盾牌绘制：逐帧clone + resize + 浮点混合 vs 预缩放的预乘alpha精灵
+int benchShields() {
+    const cv::Size canvasSize(800, 600);
+    const float scale = 0.4f;
+    const int shieldCount = 200;
+    const float shieldWidth = 100.0f * scale;
+    const float shieldHeight = 140.0f * scale;
+
+    // 合成一张带alpha渐变的盾牌图，尺寸与素材相近
+    cv::Mat shieldImage(360, 256, CV_8UC4);
+    for (int y = 0; y < shieldImage.rows; ++y) {
+        for (int x = 0; x < shieldImage.cols; ++x) {
+            shieldImage.at<cv::Vec4b>(y, x) = cv::Vec4b(static_cast<uchar>(x), static_cast<uchar>(y * 255 / 359), 140,
+                                                        static_cast<uchar>((x + y) * 255 / 614));
+        }
+    }
+
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> xDist(0.0f, canvasSize.width);
+    std::uniform_real_distribution<float> yDist(0.0f, canvasSize.height);
+    std::vector<cv::Point2f> positions;
+    std::vector<bool> parried;
+    for (int i = 0; i < shieldCount; ++i) {
+        positions.emplace_back(xDist(gen), yDist(gen));
+        parried.push_back(i % 4 == 0);
+    }
+
+    cv::Mat legacyCanvas(canvasSize, CV_8UC3);
+    cv::Mat cachedCanvas(canvasSize, CV_8UC3);
+    auto drawLegacy = [&]() {
+        legacyCanvas.setTo(cv::Scalar(40, 40, 40));
+        for (int i = 0; i < shieldCount; ++i) {
+            legacyBlendShield(legacyCanvas, shieldImage, positions[i], shieldWidth, shieldHeight, parried[i]);
+        }
+    };
+    ShieldSprites& sprites = ShieldSprites::instance();
+    sprites.clear();
+    const SpriteTint parryGlow{cv::Vec3f(1.5f, 1.5f, 0.0f), cv::Vec3f(0.0f, 0.0f, 1.0f)};
+    auto drawCached = [&]() {
+        cachedCanvas.setTo(cv::Scalar(40, 40, 40));
+        const cv::Size spriteSize(static_cast<int>(shieldWidth), static_cast<int>(shieldHeight));
+        const cv::Mat& sprite = sprites.get(shieldImage, spriteSize);
+        for (int i = 0; i < shieldCount; ++i) {
+            cv::Point topLeft(static_cast<int>(positions[i].x - shieldWidth / 2),
+                              static_cast<int>(positions[i].y - shieldHeight / 2));
+            if (parried[i]) {
+                blendPremultiplied(cachedCanvas, sprite, topLeft, parryGlow);
+            } else {
+                blendPremultiplied(cachedCanvas, sprite, topLeft);
+            }
+        }
+    };
+
+    std::cout << "盾牌绘制基准 (" << shieldCount << "个盾牌, 画布" << canvasSize.width << "x" << canvasSize.height << ")" << std::endl;
+    double legacyMs = measureMs(drawLegacy);
+    double cachedMs = measureMs(drawCached);
+    sprites.clear();
+
+    // 预乘、着色和混合各取整一次，与旧的浮点混合逐通道只差几个单位
+    int maxDiff = 0;
+    for (int y = 0; y < canvasSize.height; ++y) {
+        const uchar* a = legacyCanvas.ptr<uchar>(y);
+        const uchar* b = cachedCanvas.ptr<uchar>(y);
+        for (int x = 0; x < canvasSize.width * 3; ++x) {
+            maxDiff = std::max(maxDiff, std::abs(a[x] - b[x]));
+        }
+    }
+    std::cout << std::setw(16) << "每帧" << std::fixed << std::setprecision(3)
+              << std::setw(12) << legacyMs << " ms -> " << cachedMs << " ms ("
+              << std::setprecision(1) << legacyMs / cachedMs << "x), 最大像素差 " << maxDiff << std::endl;
+    return 0;
+}
+
+// 分块并行绘制：与drawSnapshot串行绘制逐像素比对，并测量1到N个线程的扩展性
+int benchTiles() {
+    const cv::Size canvasSize(1600, 1200);
+    const float scale = 0.4f;
+    const float time = 2.3f;
+    const float alpha = 0.37f;
+    const std::map<std::string, float> config = makeCellConfig();
+
+    // 合成的盾牌图，测完恢复原图
+    cv::Mat savedShield = getShieldImage();
+    cv::Mat shieldImage(360, 256, CV_8UC4);
+    for (int y = 0; y < shieldImage.rows; ++y) {
+        for (int x = 0; x < shieldImage.cols; ++x) {
+            shieldImage.at<cv::Vec4b>(y, x) = cv::Vec4b(static_cast<uchar>(x), 90, static_cast<uchar>(y * 255 / 359),
+                                                        static_cast<uchar>((x + y) * 255 / 614));
+        }
+    }
+    getShieldImage() = shieldImage;
+    ShieldSprites::instance().clear();
+
+    // 单线程时直接串行绘制，至少测到4个线程，硬件并发数不足时也能比对多线程分块的结果
+    const int maxWorkers = ThreadPool::defaultWorkerCount();
+    const int topWorkers = std::max(4, maxWorkers);
+    std::vector<int> workerCounts;
+    for (int workers = 1; workers < topWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(topWorkers);
+
+    std::mt19937 gen(31);
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> jitterDist(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> xDist(-20.0f, canvasSize.width + 20.0f);
+    std::uniform_real_distribution<float> yDist(-20.0f, canvasSize.height + 20.0f);
+    std::uniform_real_distribution<float> sizeDist(2.0f, 8.0f);
+    std::uniform_real_distribution<float> angleDist(0.0f, 6.28f);
+
+    cv::Mat serialCanvas(canvasSize, CV_8UC3);
+    cv::Mat tiledCanvas(canvasSize, CV_8UC3);
+    int status = 0;
+
+    std::cout << "分块并行绘制基准 (画布" << canvasSize.width << "x" << canvasSize.height
+              << ", 硬件并发数 " << maxWorkers << ")" << std::endl;
+    for (int count : {300, 2000}) {
+        // 包含前刺、举盾、格挡、玩家名字和血滴，覆盖所有会越过块边界的部件
+        auto entities = makePopulation(count, canvasSize, gen);
+        RenderSnapshot snapshot;
+        snapshot.capture(entities, ParticleSystem::instance());
+        for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+            CellView& cell = snapshot.cells[i];
+            cell.prevPosition = cell.position + cv::Point2f(jitterDist(gen), jitterDist(gen));
+            cell.aggressionLevel = probDist(gen);
+            if (!cell.isAttacking && probDist(gen) < 0.2f) {
+                cell.isShielding = true;
+                cell.parryTime = probDist(gen) * 0.1f;
+                cell.hasParried = probDist(gen) < 0.3f;
+            }
+            if (i % 50 == 0) {
+                cell.playerNumber = static_cast<int>(i / 50) % 4 + 1;
+            }
+        }
+        for (int i = 0; i < count / 2; ++i) {
+            snapshot.bloodX.push_back(xDist(gen));
+            snapshot.bloodY.push_back(yDist(gen));
+            snapshot.bloodSize.push_back(sizeDist(gen));
+            snapshot.bloodRotation.push_back(angleDist(gen));
+        }
+
+        double serialMs = measureMs([&]() {
+            serialCanvas.setTo(cv::Scalar(255, 255, 255));
+            drawSnapshot(serialCanvas, snapshot, alpha, config, scale, time);
+        });
+        std::cout << std::setw(8) << count << "个细胞  串行 " << std::fixed << std::setprecision(3)
+                  << serialMs << " ms" << std::endl;
+
+        for (int workers : workerCounts) {
+            TiledRenderer renderer(workers);
+            double tiledMs = measureMs([&]() {
+                tiledCanvas.setTo(cv::Scalar(255, 255, 255));
+                renderer.render(tiledCanvas, snapshot, alpha, config, scale, time);
+            });
+
+            // 逐像素比对串行结果
+            int mismatched = 0;
+            for (int y = 0; y < canvasSize.height; ++y) {
+                if (std::memcmp(serialCanvas.ptr(y), tiledCanvas.ptr(y), canvasSize.width * 3) != 0) {
+                    for (int x = 0; x < canvasSize.width; ++x) {
+                        mismatched += serialCanvas.at<cv::Vec3b>(y, x) != tiledCanvas.at<cv::Vec3b>(y, x);
+                    }
+                }
+            }
+            if (mismatched > 0) status = 1;
+
+            std::cout << std::setw(8) << workers << "线程" << std::fixed << std::setprecision(3)
+                      << std::setw(10) << serialMs << " ms -> " << tiledMs << " ms ("
+                      << std::setprecision(2) << serialMs / tiledMs << "x), "
+                      << (mismatched == 0 ? std::string("与串行逐像素一致")
+                                          : std::to_string(mismatched) + "个像素不一致") << std::endl;
+        }
+    }
+
+    getShieldImage() = savedShield;
+    ShieldSprites::instance().clear();
+    return status;
+}
+
+// 细节档位：全部完整绘制 vs 按预算自动选档，先运行若干帧让名额收敛；另比对分块绘制与串行结果
+int benchDetail() {
+    const cv::Size canvasSize(1600, 1200);
+    const float scale = 0.4f;
+    const float time = 0.8f;
+    const std::map<std::string, float> config = makeCellConfig();
+    const double budgetMs = 8.0;
+    std::mt19937 gen(37);
+    cv::Mat canvas(canvasSize, CV_8UC3);
+    cv::Mat tiledCanvas(canvasSize, CV_8UC3);
+    TiledRenderer tiled(4);
+    int status = 0;
+
+    std::cout << "细节档位基准 (画布" << canvasSize.width << "x" << canvasSize.height
+              << ", 预算 " << budgetMs << " ms)" << std::endl;
+    for (int count : {200, 2000, 8000}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        entities.front()->setPosition(cv::Point2f(canvasSize.width * 0.5f, canvasSize.height * 0.5f));
+        RenderSnapshot snapshot;
+        snapshot.capture(entities, ParticleSystem::instance());
+        snapshot.cells.front().playerNumber = 1;
+
+        double fullMs = measureMs([&]() {
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            drawSnapshot(canvas, snapshot, 1.0f, config, scale, time);
+        });
+
+        DetailBudget budget(budgetMs);
+        auto drawFrame = [&]() {
+            const std::vector<CellDetail>& details = budget.assign(snapshot, 1.0f, canvasSize, config, scale);
+            auto start = std::chrono::steady_clock::now();
+            canvas.setTo(cv::Scalar(255, 255, 255));
+            drawSnapshot(canvas, snapshot, 1.0f, config, scale, time, &details);
+            budget.report(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        };
+        for (int frame = 0; frame < 30; ++frame) {
+            drawFrame();
+        }
+        double budgetedMs = measureMs(drawFrame);
+
+        const std::vector<CellDetail>& details = budget.assign(snapshot, 1.0f, canvasSize, config, scale);
+        canvas.setTo(cv::Scalar(255, 255, 255));
+        drawSnapshot(canvas, snapshot, 1.0f, config, scale, time, &details);
+        tiledCanvas.setTo(cv::Scalar(255, 255, 255));
+        tiled.render(tiledCanvas, snapshot, 1.0f, config, scale, time, &details);
+        int mismatched = 0;
+        for (int y = 0; y < canvasSize.height; ++y) {
+            if (std::memcmp(canvas.ptr(y), tiledCanvas.ptr(y), canvasSize.width * 3) != 0) ++mismatched;
+        }
+        if (mismatched > 0) status = 1;
+
+        std::cout << std::setw(8) << count << "个细胞" << std::fixed << std::setprecision(3)
+                  << std::setw(12) << fullMs << " ms -> " << budgetedMs << " ms ("
+                  << std::setprecision(1) << fullMs / budgetedMs << "x), 完整/简化/圆点 "
+                  << budget.countOf(CellDetail::Full) << "/" << budget.countOf(CellDetail::Simplified) << "/"
+                  << budget.countOf(CellDetail::Dot) << ", 分块绘制"
+                  << (mismatched == 0 ? std::string("与串行一致") : std::to_string(mismatched) + "行不一致") << std::endl;
+    }
+    return status;
+}
+
+// 导出：每帧绘制后在游戏循环里直接写PNG vs 交给后台编码线程（丢帧和等待两种策略）
+int benchExport() {
+    const cv::Size canvasSize(800, 600);
+    const float scale = 0.4f;
+    const int frames = 60;
+    const std::map<std::string, float> config = makeCellConfig();
+    std::mt19937 gen(41);
+    auto entities = makePopulation(300, canvasSize, gen);
+    RenderSnapshot snapshot;
+    snapshot.capture(entities, ParticleSystem::instance());
+    TiledRenderer renderer;
+    FrameBuffers frameBuffers;
+    int status = 0;
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "cell_export_bench";
+    std::filesystem::create_directories(directory);
+    const std::string pattern = (directory / "frame_%06d.png").string();
+
+    auto drawFrame = [&](int frame) -> const cv::Mat& {
+        cv::Mat& canvas = frameBuffers.acquire(canvasSize);
+        renderer.render(canvas, snapshot, 1.0f, config, scale, frame / 60.0f);
+        return frameBuffers.present();
+    };
+
+    std::cout << "帧导出基准 (画布" << canvasSize.width << "x" << canvasSize.height << ", "
+              << snapshot.cells.size() << "个细胞, " << frames << "帧PNG)" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "inline_%06d.png", frame);
+        cv::imwrite((directory / name).string(), drawFrame(frame));
+    }
+    double inlineMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    for (FrameExporter::FullPolicy policy : {FrameExporter::FullPolicy::Drop, FrameExporter::FullPolicy::Wait}) {
+        FrameExporter exporter(pattern, 60.0, 8, policy);
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            exporter.submit(drawFrame(frame));
+        }
+        double queuedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        exporter.close();
+
+        FrameExporter::Stats stats = exporter.getStats();
+        bool complete = stats.written + stats.dropped == static_cast<size_t>(frames)
+                        && (policy == FrameExporter::FullPolicy::Drop || stats.dropped == 0);
+        if (!complete) status = 1;
+
+        std::cout << std::setw(10) << (policy == FrameExporter::FullPolicy::Drop ? "丢帧" : "等待")
+                  << std::fixed << std::setprecision(3) << std::setw(12) << inlineMs << " ms -> " << queuedMs << " ms ("
+                  << std::setprecision(1) << inlineMs / queuedMs << "x), 写出/丢弃 " << stats.written << "/"
+                  << stats.dropped << ", 最大队列深度 " << stats.maxQueueDepth << "/" << exporter.getCapacity()
+                  << (complete ? "" : ", 帧数不符") << std::endl;
+    }
+
+    std::filesystem::remove_all(directory);
+    return status;
+}
+
+// HUD文字：每帧构造字符串并putText vs 缓存的文字层（盾牌剩余时间每6帧跨一个0.1秒档）
+int benchHud() {
+    const cv::Size canvasSize(800, 600);
+    const int frames = 600;
+    const std::string gene = "ACGTTGCAACGTTGCA";
+    const size_t entityCount = 240;
+    cv::Mat canvas(canvasSize, CV_8UC3);
+    cv::Mat cachedCanvas(canvasSize, CV_8UC3);
+
+    // 第frame帧两个玩家的盾牌剩余时间（秒）
+    auto shieldRemaining = [](int frame, int player) { return 3.0f - ((frame + player * 40) % 180) / 60.0f; };
+
+    auto drawLegacy = [&](cv::Mat& target, int frame) {
+        cv::putText(target, "Player 1 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression",
+                    cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        for (int i = 0; i < 2; i++) {
+            std::string shieldStatus = "Shield: " + std::to_string(int(shieldRemaining(frame, i) * 10) / 10.0) + "s";
+            cv::putText(target, shieldStatus, cv::Point(10, 70 + i * 20), cv::FONT_HERSHEY_SIMPLEX, 0.4,
+                        cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        }
+        cv::putText(target, std::string("Server - client connected"), cv::Point(10, 90), cv::FONT_HERSHEY_SIMPLEX,
+                    0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        for (int i = 0; i < 2; i++) {
+            std::string geneInfo = "Player " + std::to_string(i + 1) + " Gene: " + gene + " Faction: " + std::to_string(i);
+            cv::putText(target, geneInfo, cv::Point(10, 130 + i * 20), cv::FONT_HERSHEY_SIMPLEX, 0.4,
+                        cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        }
+        cv::putText(target, "Entities: " + std::to_string(entityCount), cv::Point(10, 170), cv::FONT_HERSHEY_SIMPLEX,
+                    0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+    };
+
+    HudLayer hud;
+    auto drawCached = [&](cv::Mat& target, int frame) {
+        hud.beginFrame();
+        hud.setLine(0, 0, cv::Point(10, 30), TextStyle(0.5), [] {
+            return std::string("Player 1 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression");
+        });
+        for (int i = 0; i < 2; i++) {
+            int tenths = int(shieldRemaining(frame, i) * 10);
+            hud.setLine(2 + i, HudLayer::mixKey(1, tenths), cv::Point(10, 70 + i * 20), TextStyle(0.4), [&] {
+                return "Shield: " + std::to_string(tenths / 10.0) + "s";
+            });
+        }
+        hud.setLine(4, 0, cv::Point(10, 90), TextStyle(0.4), [] { return std::string("Server - client connected"); });
+        for (int i = 0; i < 2; i++) {
+            hud.setLine(5 + i, i, cv::Point(10, 130 + i * 20), TextStyle(0.4), [&] {
+                return "Player " + std::to_string(i + 1) + " Gene: " + gene + " Faction: " + std::to_string(i);
+            });
+        }
+        hud.setLine(7, entityCount, cv::Point(10, 170), TextStyle(0.4), [&] {
+            return "Entities: " + std::to_string(entityCount);
+        });
+        hud.composite(target);
+    };
+
+    // 与直接putText的差别只在抗锯齿边缘的取整
+    int maxDiff = 0;
+    for (int frame : {0, 7, 95}) {
+        canvas.setTo(cv::Scalar(255, 255, 255));
+        drawLegacy(canvas, frame);
+        cachedCanvas.setTo(cv::Scalar(255, 255, 255));
+        drawCached(cachedCanvas, frame);
+        for (int y = 0; y < canvasSize.height; ++y) {
+            const uchar* a = canvas.ptr(y);
+            const uchar* b = cachedCanvas.ptr(y);
+            for (int x = 0; x < canvasSize.width * 3; ++x) {
+                maxDiff = std::max(maxDiff, std::abs(a[x] - b[x]));
+            }
+        }
+    }
+
+    double legacyMs = measureMs([&]() {
+        for (int frame = 0; frame < frames; ++frame) {
+            drawLegacy(canvas, frame);
+        }
+    }) / frames;
+    size_t rasterizedBefore = hud.getRasterizeCount();
+    int measuredFrames = 0;
+    double cachedMs = measureMs([&]() {
+        for (int frame = 0; frame < frames; ++frame) {
+            drawCached(cachedCanvas, frame);
+        }
+        measuredFrames += frames;
+    }) / frames;
+    double linesPerFrame = static_cast<double>(hud.getRasterizeCount() - rasterizedBefore) / measuredFrames;
+
+    std::cout << "HUD文字基准 (8行, 每轮" << frames << "帧)" << std::endl;
+    std::cout << std::setw(10) << "HUD" << std::fixed << std::setprecision(4) << std::setw(12) << legacyMs
+              << " ms -> " << cachedMs << " ms (" << std::setprecision(1) << legacyMs / cachedMs
+              << "x), 每帧重新光栅化 " << std::setprecision(2) << linesPerFrame << "行, 与putText最大差 "
+              << maxDiff << std::endl;
+    return maxDiff <= 2 ? 0 : 1;
+}
+
+// 消息分帧：TCP把消息合并或拆开后，旧的"一次recv即一条消息"能还原多少条 vs 帧头加环形缓冲
+int benchFraming() {
+    const int messageCount = 5000;
+    std::mt19937 gen(43);
+    std::uniform_int_distribution<int> kindDist(0, 9);
+    std::uniform_int_distribution<int> snapshotSizeDist(500, 6000);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+
+    // 以玩家状态和输入为主，夹杂超过1KB的世界快照
+    std::vector<NetworkMessage> messages(messageCount);
+    for (NetworkMessage& msg : messages) {
+        int kind = kindDist(gen);
+        msg.type = kind < 5 ? MessageType::PLAYER_STATE : (kind < 9 ? MessageType::PLAYER_INPUT : MessageType::GAME_STATE);
+        size_t size = msg.type == MessageType::PLAYER_STATE ? 32 : (msg.type == MessageType::PLAYER_INPUT ? 8 : snapshotSizeDist(gen));
+        msg.data.resize(size);
+        for (uint8_t& byte : msg.data) {
+            byte = static_cast<uint8_t>(byteDist(gen));
+        }
+    }
+
+    std::vector<uint8_t> legacyStream, framedStream;
+    for (const NetworkMessage& msg : messages) {
+        legacyStream.push_back(static_cast<uint8_t>(msg.type));
+        legacyStream.insert(legacyStream.end(), msg.data.begin(), msg.data.end());
+        framing::appendFrame(framedStream, msg);
+    }
+
+    // 每次recv拿到的字节数：从几个字节到数个报文段不等
+    std::uniform_int_distribution<size_t> chunkDist(1, 6000);
+    std::vector<size_t> chunks;
+    for (size_t total = 0; total < framedStream.size(); ) {
+        chunks.push_back(chunkDist(gen));
+        total += chunks.back();
+    }
+
+    // 旧解析：每次recv最多1023字节，首字节当作类型，其余当作一条消息的负载
+    int legacyRecovered = 0;
+    {
+        size_t offset = 0, next = 0;
+        for (size_t chunk : chunks) {
+            size_t remaining = std::min(chunk, legacyStream.size() - offset);
+            while (remaining > 0) {
+                size_t bytes = std::min<size_t>(remaining, 1023);
+                if (next < messages.size() && bytes == messages[next].data.size() + 1
+                    && legacyStream[offset] == static_cast<uint8_t>(messages[next].type)
+                    && std::memcmp(&legacyStream[offset + 1], messages[next].data.data(), bytes - 1) == 0) {
+                    ++legacyRecovered;
+                    ++next;
+                }
+                offset += bytes;
+                remaining -= bytes;
+            }
+            if (offset >= legacyStream.size()) break;
+        }
+    }
+
+    // 新解析：把每次recv的数据写进FrameReader，取出所有完整消息
+    int framedRecovered = 0;
+    size_t maxCapacity = 0;
+    auto runFramed = [&]() {
+        FrameReader reader;
+        NetworkMessage msg;
+        size_t offset = 0, next = 0;
+        framedRecovered = 0;
+        for (size_t chunk : chunks) {
+            size_t remaining = std::min(chunk, framedStream.size() - offset);
+            while (remaining > 0) {
+                size_t space = 0;
+                uint8_t* buffer = reader.writeSpace(space);
+                size_t bytes = std::min(remaining, space);
+                std::memcpy(buffer, &framedStream[offset], bytes);
+                reader.commit(bytes);
+                offset += bytes;
+                remaining -= bytes;
+                while (reader.nextMessage(msg)) {
+                    if (next < messages.size() && msg.type == messages[next].type && msg.data == messages[next].data) {
+                        ++framedRecovered;
+                    }
+                    ++next;
+                }
+            }
+        }
+        maxCapacity = reader.capacity();
+    };
+    double framedMs = measureMs(runFramed);
+
+    std::cout << "消息分帧基准 (" << messageCount << "条消息, " << framedStream.size() / 1024 << " KB, "
+              << chunks.size() << "次recv)" << std::endl;
+    std::cout << std::setw(10) << "还原" << std::setw(12) << legacyRecovered << "条 -> " << framedRecovered
+              << "条, 解析 " << std::fixed << std::setprecision(1) << framedStream.size() / 1048576.0 / (framedMs / 1000.0)
+              << " MB/s, 缓冲容量 " << maxCapacity << " 字节" << std::endl;
+    return framedRecovered == messageCount ? 0 : 1;
+}
+
+// UDP通道：模拟的有损链路（单程40ms加0-40ms抖动、5%丢包）上双方各以30Hz发送玩家状态，
+// 接收端每1ms采样一次已应用的最新状态的年龄（采样时刻减该状态的发送时刻）
+// TCP按序交付：丢失的段在3个后续段之后快速重传，重传再丢失则按至少200ms、逐次翻倍的RTO重传，之后的状态都要等它
+// vs DatagramChannel：丢失的包不再等待，因抖动迟到的旧包被丢弃，确认捎带在反向的包头里
+int benchDatagram() {
+    const double interval = 1000.0 / 30.0;
+    const double duration = 60000.0;
+    const double oneWay = 40.0;
+    const double minRto = 200.0;
+    const int count = static_cast<int>(duration / interval);
+    std::mt19937 gen(53);
+    std::uniform_real_distribution<double> jitterDist(0.0, 40.0);
+    std::bernoulli_distribution lossDist(0.05);
+
+    // 接收端依次应用的状态：(应用时刻, 发送时刻)，应用时刻非递减
+    typedef std::vector<std::pair<double, double>> Applied;
+    auto sampleAges = [&](const Applied& applied, std::vector<double>& ages) {
+        size_t next = 0;
+        double latestSend = -1.0;
+        for (double t = 1000.0; t < duration; t += 1.0) {
+            while (next < applied.size() && applied[next].first <= t) {
+                latestSend = std::max(latestSend, applied[next].second);
+                ++next;
+            }
+            if (latestSend >= 0.0) ages.push_back(t - latestSend);
+        }
+    };
+
+    // TCP：每个状态送达应用的时刻不早于它之前的所有状态
+    Applied tcpApplied;
+    double previousDelivery = 0.0;
+    const double fastRetransmit = 3.0 * interval + 2.0 * oneWay;
+    for (int i = 0; i < count; ++i) {
+        double send = i * interval;
+        double resend = send;
+        if (lossDist(gen)) {
+            resend += fastRetransmit;
+            for (double rto = minRto; lossDist(gen); rto *= 2.0) {
+                resend += rto;
+            }
+        }
+        double delivery = std::max(resend + oneWay + jitterDist(gen), previousDelivery);
+        tcpApplied.emplace_back(delivery, send);
+        previousDelivery = delivery;
+    }
+
+    // UDP：两个方向各一个通道，按时间顺序处理发送和到达事件
+    struct Event {
+        double time;
+        int kind;      // 0: A发送, 1: B发送, 2: 包到达B, 3: 包到达A
+        int index;
+        std::vector<uint8_t> packet;
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    for (int i = 0; i < count; ++i) {
+        events.push({i * interval, 0, i, {}});
+        events.push({i * interval + interval * 0.5, 1, i, {}});
+    }
+    DatagramChannel sender(1, 0x5eed), receiver(1, 0x5eed);
+    Applied udpApplied;
+    bool ordered = true;
+    std::vector<uint8_t> frame;
+    uint8_t packet[datagram::maxPacketSize];
+    NetworkMessage msg;
+    while (!events.empty()) {
+        Event event = events.top();
+        events.pop();
+        if (event.kind <= 1) {
+            PlayerStateMessage state{};
+            state.position = cv::Point2f(static_cast<float>(event.index), 0.0f);
+            std::vector<uint8_t> payload = NetworkSerializer::serializePlayerState(state);
+            frame.clear();
+            framing::appendFrame(frame, MessageType::PLAYER_STATE, payload.data(), payload.size());
+            DatagramChannel& channel = event.kind == 0 ? sender : receiver;
+            size_t size = channel.buildPacket(packet, frame.data(), frame.size());
+            if (!lossDist(gen)) {
+                events.push({event.time + oneWay + jitterDist(gen), event.kind + 2, event.index,
+                             std::vector<uint8_t>(packet, packet + size)});
+            }
+            continue;
+        }
+
+        datagram::Header header;
+        if (!datagram::readHeader(event.packet.data(), event.packet.size(), header)) return 1;
+        DatagramChannel& channel = event.kind == 2 ? receiver : sender;
+        if (!channel.acceptPacket(header) || event.kind == 3) continue;
+        const uint8_t* frames = event.packet.data() + datagram::headerSize;
+        size_t remaining = event.packet.size() - datagram::headerSize;
+        while (datagram::nextFrame(frames, remaining, msg)) {
+            int index = static_cast<int>(NetworkSerializer::deserializePlayerState(msg.data).position.x);
+            ordered = ordered && (udpApplied.empty() || index * interval > udpApplied.back().second);
+            udpApplied.emplace_back(event.time, index * interval);
+        }
+    }
+
+    std::vector<double> tcpAges, udpAges;
+    sampleAges(tcpApplied, tcpAges);
+    sampleAges(udpApplied, udpAges);
+    auto percentile = [](std::vector<double> values, int p) {
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, values.size() * p / 100)];
+    };
+    auto staleRatio = [](const std::vector<double>& ages) {
+        size_t stale = std::count_if(ages.begin(), ages.end(), [](double age) { return age > 200.0; });
+        return 100.0 * stale / std::max<size_t>(ages.size(), 1);
+    };
+
+    DatagramChannel::Stats sent = sender.getStats(), received = receiver.getStats();
+    std::cout << "UDP通道基准 (模拟链路: 单程40ms+0-40ms抖动, 丢包5%, 30Hz状态, " << count << "个包)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(16) << "状态年龄p50" << std::setw(10) << percentile(tcpAges, 50) << " ms -> "
+              << percentile(udpAges, 50) << " ms" << std::endl
+              << std::setw(16) << "状态年龄p99" << std::setw(10) << percentile(tcpAges, 99) << " ms -> "
+              << percentile(udpAges, 99) << " ms (" << percentile(tcpAges, 99) / percentile(udpAges, 99) << "x)" << std::endl
+              << std::setw(16) << "最大年龄" << std::setw(10) << percentile(tcpAges, 100) << " ms -> "
+              << percentile(udpAges, 100) << " ms" << std::endl
+              << std::setw(16) << "超过200ms" << std::setw(10) << staleRatio(tcpAges) << " % -> "
+              << staleRatio(udpAges) << " %" << std::endl;
+    std::cout << "  接收端: 应用" << received.received << ", 迟到丢弃" << received.stale
+              << "; 发送端: 发出" << sent.sent << ", 对端确认" << sent.acked << ", 计为丢失" << sent.lost << std::endl;
+
+    // 应用的状态必须严格按发送顺序，确认和丢失不能超过发出的包数
+    bool consistent = ordered && received.received == udpApplied.size() && sent.acked + sent.lost <= sent.sent
+                      && sent.acked >= received.received;
+    return consistent ? 0 : 1;
+}
+
+// 世界快照：AI细胞以60Hz模拟，每2步给一个客户端发一个快照，快照和确认各在链路上延迟2个快照间隔、丢包5%
+// 每隔半秒一个细胞死亡、一个新细胞出生；每个实体每次发一条PLAYER_STATE的全量同步 vs 相对已确认快照的增量快照
+// 误差为客户端解码出的世界与服务器当前状态的平均位置差；最后在无丢包的链路上静止收敛，两边必须完全一致
+int benchWorldState() {
+    const cv::Size canvasSize(800, 600);
+    const float deltaTime = 1.0f / 60.0f;
+    const int ticks = 1200;
+    const int ticksPerSnapshot = 2;
+    const size_t linkDelay = 2;
+
+    GameConfig config{};
+    config.maxSpeed = 6.0f;
+    config.drag = 0.94f;
+    config.attackDuration = 0.5f;
+    config.randomMoveProbability = 0.08f;
+    config.randomMoveStrength = 0.4f;
+    config.aggressionChangeProbability = 0.01f;
+    config.aggressionChangeAmount = 0.1f;
+    config.maxAggression = 1.0f;
+    config.minAggression = 0.0f;
+
+    PlayerStateMessage sample{};
+    const size_t fullEntityBytes = NetworkSerializer::serializePlayerState(sample).size() + framing::headerSize;
+
+    std::cout << "世界快照基准 (30Hz快照, 链路单程" << linkDelay << "个快照间隔, 丢包5%, 每快照预算 "
+              << worldstate::defaultBudget << " B)" << std::endl;
+    std::cout << std::setw(8) << "实体" << std::setw(16) << "全量(B/快照)" << std::setw(16) << "增量(B/快照)"
+              << std::setw(14) << "平均误差(px)" << std::setw(12) << "缺失实体" << std::setw(14) << "编码(us)" << std::endl;
+
+    std::mt19937 gen(29);
+    std::bernoulli_distribution lossDist(0.05);
+    bool consistent = true;
+
+    for (int count : {25, 50, 100, 200, 400, 800}) {
+        auto entities = makePopulation(count, canvasSize, gen);
+        CellStore& store = CellStore::instance();
+
+        WorldStateEncoder encoder;
+        WorldStateDecoder decoder;
+        std::vector<worldstate::EntityState> world;
+        auto captureWorld = [&]() {
+            world.clear();
+            for (const auto& cell : entities) {
+                world.push_back(worldstate::capture(*cell));
+            }
+        };
+
+        // 链路上的快照和确认，下标为到达的快照间隔
+        std::vector<std::vector<std::vector<uint8_t>>> snapshotsInFlight(ticks / ticksPerSnapshot + linkDelay + 1);
+        std::vector<std::vector<uint32_t>> acksInFlight(snapshotsInFlight.size());
+        std::vector<uint8_t> payload;
+        double encodeSeconds = 0.0;
+        double errorSum = 0.0;
+        size_t errorSamples = 0, missing = 0, present = 0;
+
+        for (int tick = 0; tick < ticks; ++tick) {
+            for (auto& cell : entities) {
+                cell->updateBehavior(deltaTime, config);
+            }
+            store.step(deltaTime, config, canvasSize);
+            if (tick % 30 == 29) {
+                entities.erase(entities.begin() + gen() % entities.size());
+                auto born = makePopulation(1, canvasSize, gen);
+                entities.push_back(born.front());
+            }
+            if (tick % ticksPerSnapshot != 0) continue;
+
+            const size_t slot = tick / ticksPerSnapshot;
+            for (uint32_t ack : acksInFlight[slot]) {
+                encoder.acknowledge(ack);
+            }
+
+            captureWorld();
+            auto start = std::chrono::high_resolution_clock::now();
+            encoder.encode(world, payload);
+            encodeSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            if (!lossDist(gen)) {
+                snapshotsInFlight[slot + linkDelay].push_back(payload);
+            }
+
+            for (const auto& snapshot : snapshotsInFlight[slot]) {
+                if (decoder.decode(snapshot) && !lossDist(gen)) {
+                    acksInFlight[slot + linkDelay].push_back(decoder.getSequence());
+                }
+            }
+
+            // 客户端当前看到的世界与服务器此刻的状态比较
+            const auto& seen = decoder.world();
+            size_t s = 0;
+            for (const auto& state : world) {
+                while (s < seen.size() && seen[s].id < state.id) ++s;
+                if (s < seen.size() && seen[s].id == state.id) {
+                    errorSum += std::hypot(seen[s].x - state.x, seen[s].y - state.y) / 8.0;
+                    ++errorSamples;
+                    ++present;
+                } else {
+                    ++missing;
+                }
+            }
+        }
+
+        const WorldStateEncoder::Stats& stats = encoder.getStats();
+        std::cout << std::setw(8) << count
+                  << std::setw(16) << count * fullEntityBytes
+                  << std::setw(16) << std::fixed << std::setprecision(0) << double(stats.bytes) / stats.snapshots
+                  << std::setw(14) << std::setprecision(2) << errorSum / std::max<size_t>(errorSamples, 1)
+                  << std::setw(11) << std::setprecision(1) << 100.0 * missing / std::max<size_t>(present + missing, 1) << "%"
+                  << std::setw(14) << std::setprecision(1) << encodeSeconds * 1e6 / stats.snapshots << std::endl;
+
+        // 世界静止后在无丢包的链路上继续发送，直到没有待发送的变化；客户端必须与服务器完全一致
+        captureWorld();
+        for (int i = 0; i < 64; ++i) {
+            encoder.encode(world, payload);
+            if (decoder.decode(payload)) {
+                encoder.acknowledge(decoder.getSequence());
+            }
+        }
+        const auto& seen = decoder.world();
+        bool same = seen.size() == world.size();
+        for (size_t i = 0; same && i < world.size(); ++i) {
+            same = seen[i].id == world[i].id && seen[i].diff(world[i]) == 0 && seen[i].phase == world[i].phase
+                   && std::equal(world[i].gene, world[i].gene + Gene::LENGTH, seen[i].gene);
+        }
+        if (!same) {
+            std::cout << "  静止后客户端与服务器的世界不一致!" << std::endl;
+            consistent = false;
+        }
+    }
+    return consistent ? 0 : 1;
+}
+
+#ifndef _WIN32
+
+// 回环上建立一对已连接的TCP套接字，接收端为非阻塞；失败时返回false
+bool makeLoopbackPair(int& sender, int& receiver) {
+    int listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t length = sizeof(addr);
+    bool ok = listener >= 0 && bind(listener, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(listener, 1) == 0
+              && getsockname(listener, (sockaddr*)&addr, &length) == 0;
+    sender = ok ? socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : -1;
+    ok = ok && sender >= 0 && connect(sender, (sockaddr*)&addr, sizeof(addr)) == 0;
+    receiver = ok ? accept(listener, nullptr, nullptr) : -1;
+    if (listener >= 0) close(listener);
+    if (receiver < 0) {
+        if (sender >= 0) close(sender);
+        return false;
+    }
+    int noDelay = 1;
+    setsockopt(sender, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(receiver, F_SETFL, fcntl(receiver, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+// 回环上的输入延迟：发送端按不规则间隔发出带时间戳的输入消息，记录接收端分发每条消息时的延迟
+// 旧接收线程每次recv之后sleep 10ms vs Reactor在可读时立即唤醒
+int benchLatency() {
+    const int messageCount = 300;
+    std::mt19937 gen(47);
+    std::uniform_int_distribution<int> gapDist(300, 3000);
+
+    struct Result { double p50, p99, max; size_t received; };
+    auto measure = [&](bool useReactor) -> Result {
+        int sender = -1, receiver = -1;
+        if (!makeLoopbackPair(sender, receiver)) return {0.0, 0.0, 0.0, 0};
+
+        std::vector<double> latencies;
+        latencies.reserve(messageCount);
+        std::mutex latencyMutex;
+        FrameReader reader;
+        // 读出已到达的数据并记录每条完整消息的延迟
+        auto drain = [&]() {
+            NetworkMessage msg;
+            while (true) {
+                size_t space = 0;
+                uint8_t* buffer = reader.writeSpace(space);
+                ssize_t bytes = recv(receiver, buffer, space, 0);
+                if (bytes <= 0) return;
+                reader.commit(static_cast<size_t>(bytes));
+                while (reader.nextMessage(msg)) {
+                    int64_t sent = 0;
+                    std::memcpy(&sent, msg.data.data(), sizeof(sent));
+                    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+                    std::lock_guard<std::mutex> lock(latencyMutex);
+                    latencies.push_back((now - sent) / 1e6);
+                }
+            }
+        };
+
+        std::atomic<bool> polling(true);
+        std::thread pollThread;
+        Reactor reactor;
+        if (useReactor) {
+            reactor.start();
+            reactor.add(receiver, drain);
+        } else {
+            // 与原来的接收线程相同：每次recv之后都暂停10ms
+            pollThread = std::thread([&]() {
+                while (polling) {
+                    drain();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            });
+        }
+
+        std::vector<uint8_t> frame;
+        std::vector<uint8_t> payload(8);
+        for (int i = 0; i < messageCount; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(gapDist(gen)));
+            int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            std::memcpy(payload.data(), &now, sizeof(now));
+            frame.clear();
+            framing::appendFrame(frame, MessageType::PLAYER_INPUT, payload.data(), payload.size());
+            ssize_t sent = send(sender, frame.data(), frame.size(), 0);
+            (void)sent;
+        }
+
+        // 等最后的消息到达
+        for (int wait = 0; wait < 100; ++wait) {
+            {
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                if (latencies.size() >= static_cast<size_t>(messageCount)) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (useReactor) {
+            reactor.stop();
+        } else {
+            polling = false;
+            pollThread.join();
+        }
+        close(sender);
+        close(receiver);
+
+        Result result{0.0, 0.0, 0.0, latencies.size()};
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            result.p50 = latencies[latencies.size() / 2];
+            result.p99 = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+            result.max = latencies.back();
+        }
+        return result;
+    };
+
+    Result polled = measure(false);
+    Result reactive = measure(true);
+    std::cout << "输入延迟基准 (回环TCP, " << messageCount << "条消息, 间隔0.3-3ms)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(10) << "p50" << std::setw(12) << polled.p50 << " ms -> " << reactive.p50 << " ms ("
+              << std::setprecision(1) << polled.p50 / std::max(reactive.p50, 1e-6) << "x)" << std::endl
+              << std::setprecision(3)
+              << std::setw(10) << "p99" << std::setw(12) << polled.p99 << " ms -> " << reactive.p99 << " ms ("
+              << std::setprecision(1) << polled.p99 / std::max(reactive.p99, 1e-6) << "x), 最大 "
+              << std::setprecision(3) << reactive.max << " ms, 收到 " << polled.received << "/" << reactive.received
+              << std::endl;
+    return (polled.received == static_cast<size_t>(messageCount) && reactive.received == static_cast<size_t>(messageCount)) ? 0 : 1;
+}
+
+// 多客户端广播：32个回环客户端中有1个从不读取（接收缓冲设得很小），每次广播32条玩家状态
+// 旧的发送方式对每个客户端依次阻塞发送（发送缓冲满时每1ms重试，这里每次最多等10ms后放弃，原实现会一直等下去）
+// vs 会话表的非阻塞发送：写不下的进该会话的积压，由I/O线程在可写时续发，积压超限的慢客户端被断开
+int benchSessions() {
+    const int clientCount = 32;
+    const int broadcastCount = 300;
+    const int batchSize = 32;
+    const size_t backlogLimit = 64 * 1024;
+    const int stalledIndex = clientCount - 1;
+
+    std::vector<NetworkMessage> batch;
+    for (int i = 0; i < batchSize; ++i) {
+        PlayerStateMessage state;
+        state.position = cv::Point2f(10.0f * i, 5.0f * i);
+        state.velocity = cv::Point2f(1.0f, -1.0f);
+        state.facingRight = i % 2 == 0;
+        state.health = 100.0f;
+        state.isAttacking = false;
+        state.attackTime = 0.0f;
+        state.isShielding = false;
+        state.aggressionLevel = 0.5f;
+        state.playerNumber = i + 1;
+        batch.emplace_back(MessageType::PLAYER_STATE, NetworkSerializer::serializePlayerState(state));
+    }
+    std::vector<uint8_t> encoded;
+    for (const NetworkMessage& msg : batch) {
+        framing::appendFrame(encoded, msg);
+    }
+
+    // 客户端一侧：一个线程poll所有正常客户端并按帧计数，慢客户端从不读取
+    struct Clients {
+        std::vector<int> sockets;
+        std::vector<size_t> received;
+    };
+    auto readClients = [&](Clients& clients, std::atomic<bool>& reading) {
+        std::vector<FrameReader> readers(clients.sockets.size());
+        std::vector<pollfd> fds;
+        for (int i = 0; i < stalledIndex; ++i) {
+            fds.push_back({clients.sockets[i], POLLIN, 0});
+        }
+        NetworkMessage msg;
+        while (reading) {
+            if (poll(fds.data(), fds.size(), 5) <= 0) continue;
+            for (size_t i = 0; i < fds.size(); ++i) {
+                if (!(fds[i].revents & POLLIN)) continue;
+                while (true) {
+                    size_t space = 0;
+                    uint8_t* buffer = readers[i].writeSpace(space);
+                    ssize_t bytes = recv(fds[i].fd, buffer, space, 0);
+                    if (bytes <= 0) break;
+                    readers[i].commit(static_cast<size_t>(bytes));
+                    while (readers[i].nextMessage(msg)) {
+                        ++clients.received[i];
+                    }
+                }
+            }
+        }
+    };
+    auto waitForDelivery = [&](Clients& clients) {
+        const size_t expected = static_cast<size_t>(broadcastCount) * batchSize;
+        for (int wait = 0; wait < 400; ++wait) {
+            bool done = true;
+            for (int i = 0; i < stalledIndex; ++i) {
+                done = done && clients.received[i] >= expected;
+            }
+            if (done) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    };
+    auto countDelivered = [&](const Clients& clients) {
+        size_t complete = 0;
+        for (int i = 0; i < stalledIndex; ++i) {
+            if (clients.received[i] == static_cast<size_t>(broadcastCount) * batchSize) ++complete;
+        }
+        return complete;
+    };
+    auto percentile = [](std::vector<double> values, int p) {
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, values.size() * p / 100)];
+    };
+    auto shrinkReceiveBuffer = [](int socket) {
+        int size = 2048;
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    };
+
+    // 旧方式：每个客户端一条连接，服务器端依次阻塞发送
+    std::vector<double> legacyTicks;
+    size_t legacyStalls = 0, legacyDelivered = 0;
+    {
+        Clients clients;
+        std::vector<int> serverSide;
+        for (int i = 0; i < clientCount; ++i) {
+            int sender = -1, receiver = -1;
+            if (!makeLoopbackPair(sender, receiver)) return 1;
+            // 与会话套接字相同的内核发送缓冲，只比较发送方式
+            int sendBufferBytes = 64 * 1024;
+            setsockopt(sender, SOL_SOCKET, SO_SNDBUF, &sendBufferBytes, sizeof(sendBufferBytes));
+            fcntl(sender, F_SETFL, fcntl(sender, F_GETFL, 0) | O_NONBLOCK);
+            if (i == stalledIndex) shrinkReceiveBuffer(receiver);
+            serverSide.push_back(sender);
+            clients.sockets.push_back(receiver);
+        }
+        clients.received.assign(clientCount, 0);
+        std::atomic<bool> reading(true);
+        std::thread reader(readClients, std::ref(clients), std::ref(reading));
+
+        for (int tick = 0; tick < broadcastCount; ++tick) {
+            auto start = std::chrono::steady_clock::now();
+            for (int socket : serverSide) {
+                const uint8_t* data = encoded.data();
+                size_t size = encoded.size();
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+                while (size > 0) {
+                    ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+                    if (sent > 0) {
+                        data += sent;
+                        size -= static_cast<size_t>(sent);
+                    } else if (std::chrono::steady_clock::now() < deadline) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    } else {
+                        ++legacyStalls;
+                        break;
+                    }
+                }
+            }
+            legacyTicks.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        waitForDelivery(clients);
+        reading = false;
+        reader.join();
+        legacyDelivered = countDelivered(clients);
+        for (int socket : serverSide) close(socket);
+        for (int socket : clients.sockets) close(socket);
+    }
+
+    // 会话表：所有客户端连到同一个NetworkServer
+    std::vector<double> sessionTicks;
+    size_t sessionDelivered = 0, slowDisconnects = 0, sessionsLeft = 0;
+    {
+        NetworkServer server(0, clientCount, backlogLimit);
+        if (!server.initialize()) return 1;
+        server.startListening();
+
+        Clients clients;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(server.getPort()));
+        for (int i = 0; i < clientCount; ++i) {
+            int socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (i == stalledIndex) shrinkReceiveBuffer(socket);
+            if (connect(socket, (sockaddr*)&addr, sizeof(addr)) != 0) return 1;
+            fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+            clients.sockets.push_back(socket);
+        }
+        clients.received.assign(clientCount, 0);
+        for (int wait = 0; wait < 400 && server.sessionCount() < static_cast<size_t>(clientCount); ++wait) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        std::atomic<bool> reading(true);
+        std::thread reader(readClients, std::ref(clients), std::ref(reading));
+
+        for (int tick = 0; tick < broadcastCount; ++tick) {
+            auto start = std::chrono::steady_clock::now();
+            server.broadcast(batch);
+            sessionTicks.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        waitForDelivery(clients);
+        reading = false;
+        reader.join();
+        sessionDelivered = countDelivered(clients);
+        slowDisconnects = server.getSlowDisconnects();
+        sessionsLeft = server.sessionCount();
+        server.shutdown();
+        for (int socket : clients.sockets) close(socket);
+    }
+
+    double legacyP99 = percentile(legacyTicks, 99), sessionP99 = percentile(sessionTicks, 99);
+    double legacyTotal = 0.0, sessionTotal = 0.0;
+    for (double t : legacyTicks) legacyTotal += t;
+    for (double t : sessionTicks) sessionTotal += t;
+    std::cout << "会话广播基准 (" << clientCount << "个客户端，其中1个不读取，" << broadcastCount << "次广播 x "
+              << batchSize << "条玩家状态)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(14) << "广播p99" << std::setw(12) << legacyP99 << " ms -> " << sessionP99 << " ms ("
+              << std::setprecision(1) << legacyP99 / std::max(sessionP99, 1e-6) << "x)" << std::endl
+              << std::setprecision(1)
+              << std::setw(14) << "广播总耗时" << std::setw(12) << legacyTotal << " ms -> " << sessionTotal << " ms ("
+              << legacyTotal / std::max(sessionTotal, 1e-6) << "x)" << std::endl;
+    std::cout << "  旧方式阻塞超时" << legacyStalls << "次；会话表断开慢客户端" << slowDisconnects << "个，剩余会话"
+              << sessionsLeft << "；正常客户端完整收到 " << legacyDelivered << "/" << sessionDelivered << " (共"
+              << stalledIndex << ")" << std::endl;
+    return (sessionDelivered == static_cast<size_t>(stalledIndex) && slowDisconnects == 1) ? 0 : 1;
+}
+
+#else
+
+int benchLatency() {
+    std::cout << "输入延迟基准只在POSIX平台上运行" << std::endl;
+    return 0;
+}
+
+int benchSessions() {
+    std::cout << "会话广播基准只在POSIX平台上运行" << std::endl;
+    return 0;
+}
+
+#endif
+
+const std::map<std::string, std::function<int()>>& benchmarkRegistry() {
+    static const std::map<std::string, std::function<int()>> registry = {
+        {"blend", benchBlend},
+        {"cells", benchCellSprites},
+        {"cellstore", benchCellStore},
+        {"combat", benchCombat},
+        {"detail", benchDetail},
+        {"export", benchExport},
+        {"framing", benchFraming},
+        {"framebuffer", benchFrameBuffers},
+        {"genes", benchGenes},
+        {"geometry", benchGeometry},
+        {"hud", benchHud},
+        {"latency", benchLatency},
+        {"pairs", benchPairs},
+        {"particles", benchParticles},
+        {"rng", benchRng},
+        {"sessions", benchSessions},
+        {"shields", benchShields},
+        {"snapshot", benchSnapshot},
+        {"threads", benchThreads},
+        {"tiles", benchTiles},
+        {"udp", benchDatagram},
+        {"worldstate", benchWorldState},
+    };
+    return registry;
+}
+
+} // namespace
+
+int runBenchmark(const std::string& name) {
+    const auto& registry = benchmarkRegistry();
+    auto it = registry.find(name);
+    if (it == registry.end()) {
+        std::cerr << "未知的基准测试: " << name << std::endl;
+        listBenchmarks();
+        return 1;
+    }
+    return it->second();
+}
+
+void listBenchmarks() {
+    std::cout << "可用的基准测试:";
+    for (const auto& entry : benchmarkRegistry()) {
+        std::cout << " " << entry.first;
+    }
+    std::cout << std::endl;
+}
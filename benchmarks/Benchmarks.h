@@ -0,0 +1,13 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+
+// 性能基准测试入口，通过命令行 --bench <名称> 调用
+// 返回进程退出码，名称未知时返回非零
+int runBenchmark(const std::string& name);
+
+// 列出所有可用的基准测试名称
+void listBenchmarks();
+
+#endif // BENCHMARKS_H
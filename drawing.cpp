@@ -1,6 +1,12 @@
 #include <opencv2/opencv.hpp>
 #include "entities/BaseCell.h"
 #include "entities/AICell.h"
+#include "simulation/ParticleSystem.h"
+#include "rendering/Compositor.h"
+#include "rendering/ShieldSprites.h"
+#include "rendering/CellSprites.h"
+#include "rendering/CellGeometry.h"
+#include "rendering/TextSprites.h"
 #include <string>
 #include <cmath>
 
@@ -14,6 +20,8 @@ static Mat shieldImage;
 void loadShieldImage() {
     char image_dir[] = "../assets/shield.png";
     shieldImage = imread(image_dir, IMREAD_UNCHANGED);
+    // Sprites scaled from a previous image are stale now
+    ShieldSprites::instance().clear();
     if(shieldImage.empty())
         throw runtime_error("\n Could not load shield image: " + string(image_dir));
     // if (shieldImage.empty()) {
@@ -29,6 +37,28 @@ Mat& getShieldImage() {
     return shieldImage;
 }
 
+// Blend a sprite onto the canvas, writing only inside clip (the whole canvas when clip is empty).
+// Blending is per pixel, so the clipped pixels come out exactly as with an unclipped stamp
+static void stampSprite(Mat& canvas, const Mat& sprite, const Point& topLeft, const Rect& clip,
+                        const SpriteTint* tint = nullptr) {
+    Rect region = clip.area() > 0 ? (clip & Rect(0, 0, canvas.cols, canvas.rows)) : Rect(0, 0, canvas.cols, canvas.rows);
+    if (region.area() <= 0) return;
+    Mat target = canvas(region);
+    if (tint) {
+        blendPremultiplied(target, sprite, topLeft - region.tl(), *tint);
+    } else {
+        blendPremultiplied(target, sprite, topLeft - region.tl());
+    }
+}
+
+// Whether a shape spanning a..b, widened by pad pixels of thickness and anti-aliasing, can touch clip.
+// Skipping one that cannot is exact, it would leave every pixel inside clip unchanged
+static bool reachesClip(const Rect& clip, const Point& a, const Point& b, int pad) {
+    if (clip.area() <= 0) return true;
+    Rect span(Point(min(a.x, b.x) - pad, min(a.y, b.y) - pad), Point(max(a.x, b.x) + pad + 1, max(a.y, b.y) + pad + 1));
+    return (span & clip).area() > 0;
+}
+
 // Function to compute Bezier curve points
 Point2f bezierPoint(const vector<Point2f>& controlPoints, float t) {
     int n = controlPoints.size() - 1;
@@ -73,23 +103,29 @@ void drawTeardropShape(Mat& canvas, const Point2f& position, float size, float r
     fillConvexPoly(canvas, trianglePoints, 3, color, LINE_AA);
 }
 
-// Function to draw blood drops
-void drawBloodDrops(Mat& canvas, const vector<BloodDrop>& bloodDrops) {
-    for (const auto& drop : bloodDrops) {
-        // Calculate alpha based on remaining lifetime
-        float alpha = drop.lifetime / drop.maxLifetime;
+// Conservative pixel bounds of a teardrop, anti-aliased edge included
+Rect teardropBounds(const Point2f& position, float size) {
+    // The tail tip is the farthest point from the center
+    float reach = size * 1.5f + 4.0f;
+    return Rect(Point(cvFloor(position.x - reach), cvFloor(position.y - reach)),
+                Point(cvCeil(position.x + reach) + 1, cvCeil(position.y + reach) + 1));
+}
 
-        // Blood color - pure red
-        Scalar bloodColor(0, 0, 255);
+// Function to draw blood drops
+void drawBloodDrops(Mat& canvas, const ParticleSystem& particles) {
+    // Blood color - pure red
+    Scalar bloodColor(0, 0, 255);
 
+    for (size_t i = 0; i < particles.size(); ++i) {
         // Draw a teardrop shape instead of a circle
-        drawTeardropShape(canvas, drop.position, drop.size, drop.rotation, bloodColor);
+        drawTeardropShape(canvas, Point2f(particles.posX[i], particles.posY[i]),
+                          particles.sizes[i], particles.rotation[i], bloodColor);
     }
 }
 
 // Function to draw a spear with attack animation
 void drawSpear(Mat& canvas, const Point2f& cellPosition, bool faceRight, float scale,
-               float cellWidth, float cellHeight, bool isAttacking, float attackTime) {
+               float cellWidth, float cellHeight, bool isAttacking, float attackTime, const Rect& clip) {
     // Scale factor for left/right direction
     float directionFactor = faceRight ? 1.0f : -1.0f;
 
@@ -124,6 +160,11 @@ void drawSpear(Mat& canvas, const Point2f& cellPosition, bool faceRight, float s
         spearStart.y - spearLength * 0.3f  // Angled downward
     );
 
+    // Nothing to draw when the whole spear misses the clip region (the spearhead stays within 15px of the tip)
+    Point shaftStart(static_cast<int>(spearStart.x), static_cast<int>(spearStart.y));
+    Point shaftEnd(static_cast<int>(spearEnd.x), static_cast<int>(spearEnd.y));
+    if (!reachesClip(clip, shaftStart, shaftEnd, static_cast<int>(spearheadHeight + spearThickness) + 3)) return;
+
     // Draw the spear shaft
     line(canvas,
          Point(static_cast<int>(spearStart.x), static_cast<int>(spearStart.y)),
@@ -144,9 +185,15 @@ void drawSpear(Mat& canvas, const Point2f& cellPosition, bool faceRight, float s
     fillConvexPoly(canvas, spearheadPoints, 3, Scalar(0, 0, 0), LINE_AA);
 }
 
+// Pixel size of the shield sprite at the given scale
+static Size shieldSpriteSize(float scale) {
+    return Size(static_cast<int>(100.0f * scale), static_cast<int>(140.0f * scale));
+}
+
 // Function to draw shield
 void drawShield(cv::Mat& canvas, const Point2f& cellPosition, bool faceRight, float scale,
-               float cellWidth, float cellHeight, bool isShielding, float shieldTime, bool hasParried) {
+               float cellWidth, float cellHeight, bool isShielding, float shieldTime, bool hasParried,
+               const Rect& clip) {
     if (!isShielding && !hasParried) return;
 
     // Scale factor for left/right direction
@@ -177,88 +224,58 @@ void drawShield(cv::Mat& canvas, const Point2f& cellPosition, bool faceRight, fl
             Size(static_cast<int>(shieldWidth/2), static_cast<int>(shieldHeight/2)),
             0, 0, 360, Scalar(50, 50, 50), 2, LINE_AA);
     } else {
-        // Prepare the shield image with appropriate scaling and rotation
-        Mat shieldImg = getShieldImage().clone();
-
-        // Resize the shield image to the appropriate size
-        Mat resizedShield;
-        resize(shieldImg, resizedShield, Size(static_cast<int>(shieldWidth), static_cast<int>(shieldHeight)));
-
-        // Create a region of interest in the canvas
-        Rect roi(
-            static_cast<int>(shieldPos.x - shieldWidth/2),
-            static_cast<int>(shieldPos.y - shieldHeight/2),
-            static_cast<int>(shieldWidth),
-            static_cast<int>(shieldHeight)
-        );
-
-        // Ensure the ROI is within the canvas bounds
-        roi = roi & Rect(0, 0, canvas.cols, canvas.rows);
-
-        if (roi.width > 0 && roi.height > 0) {
-            // If we have a 4-channel image with alpha, handle transparency
-            if (resizedShield.channels() == 4) {
-                // Apply alpha blending
-                for (int y = 0; y < roi.height; ++y) {
-                    for (int x = 0; x < roi.width; ++x) {
-                        int srcX = x + roi.x - (static_cast<int>(shieldPos.x - shieldWidth/2));
-                        int srcY = y + roi.y - (static_cast<int>(shieldPos.y - shieldHeight/2));
-
-                        if (srcX >= 0 && srcX < resizedShield.cols && srcY >= 0 && srcY < resizedShield.rows) {
-                            Vec4b& shieldPixel = resizedShield.at<Vec4b>(srcY, srcX);
-                            Vec3b& canvasPixel = canvas.at<Vec3b>(y + roi.y, x + roi.x);
-
-                            // Apply alpha blending and a parry glow effect if needed
-                            float alpha = shieldPixel[3] / 255.0f;
-                            if (hasParried) {
-                                // Add a yellow glow for parry effect
-                                canvasPixel[0] = saturate_cast<uchar>((1 - alpha) * canvasPixel[0] + alpha * min(255.0f, shieldPixel[0] * 1.5f));
-                                canvasPixel[1] = saturate_cast<uchar>((1 - alpha) * canvasPixel[1] + alpha * min(255.0f, shieldPixel[1] * 1.5f));
-                                canvasPixel[2] = saturate_cast<uchar>((1 - alpha) * canvasPixel[2] + alpha * 255); // Strong red component
-                            } else {
-                                canvasPixel[0] = saturate_cast<uchar>((1 - alpha) * canvasPixel[0] + alpha * shieldPixel[0]);
-                                canvasPixel[1] = saturate_cast<uchar>((1 - alpha) * canvasPixel[1] + alpha * shieldPixel[1]);
-                                canvasPixel[2] = saturate_cast<uchar>((1 - alpha) * canvasPixel[2] + alpha * shieldPixel[2]);
-                            }
-                        }
-                    }
-                }
+        // Blend the cached pre-scaled, premultiplied sprite for this size
+        Size spriteSize = shieldSpriteSize(scale);
+        if (spriteSize.width > 0 && spriteSize.height > 0) {
+            const Mat& sprite = ShieldSprites::instance().get(getShieldImage(), spriteSize);
+            Point topLeft(static_cast<int>(shieldPos.x - shieldWidth/2), static_cast<int>(shieldPos.y - shieldHeight/2));
+            if (hasParried) {
+                // Yellow glow for parry: boost blue/green, saturate red
+                static const SpriteTint parryGlow{Vec3f(1.5f, 1.5f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f)};
+                stampSprite(canvas, sprite, topLeft, clip, &parryGlow);
             } else {
-                // If no alpha channel, just copy the shield image
-                Mat shieldRoi = resizedShield(Rect(0, 0, roi.width, roi.height));
-                shieldRoi.copyTo(canvas(roi));
+                stampSprite(canvas, sprite, topLeft, clip);
             }
         }
     }
 
     // Add visual feedback for parry timing - flash a ring around the shield
+    Point ringCenter(static_cast<int>(shieldPos.x), static_cast<int>(shieldPos.y));
     if (hasParried) {
         int pulseRadius = static_cast<int>(shieldWidth * (1.0f + 0.3f * sin(shieldTime * 10.0f)));
-        circle(canvas,
-               Point(static_cast<int>(shieldPos.x), static_cast<int>(shieldPos.y)),
-               pulseRadius,
-               Scalar(0, 255, 255), // Yellow
-               3, LINE_AA);
+        Point reach(pulseRadius, pulseRadius);
+        if (reachesClip(clip, ringCenter - reach, ringCenter + reach, 4)) {
+            circle(canvas, ringCenter, pulseRadius,
+                   Scalar(0, 255, 255), // Yellow
+                   3, LINE_AA);
+        }
     }
     
     // Add visual feedback for perfect parry window (first 50ms)
     if (isShielding && shieldTime < 0.05f) {
-        circle(canvas,
-               Point(static_cast<int>(shieldPos.x), static_cast<int>(shieldPos.y)),
-               static_cast<int>(shieldWidth * 0.7f),
-               Scalar(0, 255, 255), // Yellow for perfect parry window
-               2, LINE_AA);
+        int windowRadius = static_cast<int>(shieldWidth * 0.7f);
+        Point reach(windowRadius, windowRadius);
+        if (reachesClip(clip, ringCenter - reach, ringCenter + reach, 4)) {
+            circle(canvas, ringCenter, windowRadius,
+                   Scalar(0, 255, 255), // Yellow for perfect parry window
+                   2, LINE_AA);
+        }
     }
 }
 
 // Function to draw health bar
-void drawHealthBar(Mat& canvas, const Point2f& position, float cellWidth, float health, float maxHealth) {
+void drawHealthBar(Mat& canvas, const Point2f& position, float cellWidth, float health, float maxHealth,
+                   const Rect& clip) {
     float healthBarWidth = cellWidth * 1.2f;
     float healthBarHeight = 5.0f;
     Point2f healthBarPos(
         position.x - healthBarWidth / 2,
         position.y - 50.0f // Position above the cell
     );
+    if (!reachesClip(clip, Point(static_cast<int>(healthBarPos.x), static_cast<int>(healthBarPos.y)),
+                     Point(static_cast<int>(healthBarPos.x + healthBarWidth), static_cast<int>(healthBarPos.y + healthBarHeight)), 3)) {
+        return;
+    }
 
     // Draw health bar background (empty bar - red)
     rectangle(canvas,
@@ -282,47 +299,17 @@ void drawHealthBar(Mat& canvas, const Point2f& position, float cellWidth, float
         Scalar(0, 0, 0), 1, LINE_AA);
 }
 
-// Function to draw the cell directly on the canvas
-void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& config, float scale,
-              float time) {
-    // 获取基本参数值
-    float baseWidth = config.at("cell_width");
-    float baseHeight = config.at("cell_height");
-    
-    // 减弱基因对大小的影响 - 使差异更微妙
-    float sizeEffect = 1.0f + (cell.getSizeMultiplier() - 1.0f) * 0.3f;
-    
-    // 减小离心率范围 - 使用更窄的范围
-    float eccentricity = 0.05f + (cell.sharpnessMultiplier - 1.0f) * 0.15f;
-    
-    // 计算实际宽高，降低基因影响
-    float cellWidth = baseWidth * scale * sizeEffect;
-    float cellHeight = baseHeight * scale * sizeEffect;
-    
-    // 根据离心率调整形状 - 更温和的形变
-    if (cell.sharpnessMultiplier > 1.0f) {
-        // 高尖锐度 = 更狭长，但效果更温和
-        cellWidth *= (1.0f + eccentricity * 0.3f);
-        cellHeight *= (1.0f - eccentricity * 0.1f);
-    } else {
-        // 低尖锐度 = 更圆润，但效果更温和
-        cellWidth *= (1.0f - eccentricity * 0.1f);
-        cellHeight *= (1.0f + eccentricity * 0.1f);
-    }
-
-    Point2f cellPos(cell.getPosition().x, cell.getPosition().y);
-    bool faceRight = cell.isFacingRight();
-    Vec3b cellColor = cell.getColor();
-    float tailPhaseOffset = cell.getTailPhaseOffset();
-    float aggressionLevel = cell.getAggressionLevel();
-
+// Body, eye and mouth. Also used to render the cached body sprites onto a transparent BGRA image,
+// which is why the black features carry an opaque alpha
+void drawCellBody(Mat& canvas, const Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                  const Scalar& bodyColor, float aggressionLevel, const map<string, float>& config, float scale) {
     // Scale factor for left/right flipped features
     float directionFactor = faceRight ? 1.0f : -1.0f;
 
     // 1) Cell Body (Ellipse)
     ellipse(canvas, Point(static_cast<int>(cellPos.x), static_cast<int>(cellPos.y)),
             Size(static_cast<int>(cellWidth), static_cast<int>(cellHeight)),
-            0, 0, 360, Scalar(cellColor[0], cellColor[1], cellColor[2]), FILLED, LINE_AA);
+            0, 0, 360, bodyColor, FILLED, LINE_AA);
 
     // 2) Eye - simplified anger expression
     float eyeSize = config.at("eye_size") * scale;
@@ -341,7 +328,7 @@ void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& confi
     // Draw the full eye
     ellipse(canvas, Point(static_cast<int>(eyeCenter.x), static_cast<int>(eyeCenter.y)),
             Size(static_cast<int>(ea), static_cast<int>(eb)),
-            eyeAngle, 0, 360, Scalar(0, 0, 0), FILLED, LINE_AA);
+            eyeAngle, 0, 360, Scalar(0, 0, 0, 255), FILLED, LINE_AA);
 
     // Draw a rectangle to cover the top part of the eye based on aggression level
     if (aggressionLevel > 0.0f) {
@@ -365,12 +352,12 @@ void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& confi
             points[i] = Point(static_cast<int>(vertices[i].x), static_cast<int>(vertices[i].y));
         }
 
-        fillConvexPoly(canvas, points, 4, Scalar(cellColor[0], cellColor[1], cellColor[2]), LINE_AA);
+        fillConvexPoly(canvas, points, 4, bodyColor, LINE_AA);
     }
 
     // 3) Mouth (Bezier Curve) - modified to show aggression by curving downward
     // The control points adjust based on aggression level
-    vector<Point2f> mouthControlPoints = {
+    Point2f mouthControlPoints[3] = {
         Point2f(cellPos.x + config.at("mouth_x0") * cellWidth * directionFactor,
                 cellPos.y + config.at("mouth_y0") * cellHeight),
         Point2f(cellPos.x + config.at("mouth_x1") * cellWidth * directionFactor,
@@ -379,10 +366,9 @@ void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& confi
                 cellPos.y + config.at("mouth_y2") * cellHeight)
     };
 
+    // Sampled with the precomputed Bernstein weights, same points as bezierPoint
     vector<Point2f> mouthCurve;
-    for (float t = 0; t <= 1; t += 0.04f) {
-        mouthCurve.push_back(bezierPoint(mouthControlPoints, t));
-    }
+    evaluateMouthCurve(mouthControlPoints, mouthCurve);
 
     // Draw mouth with thickness based on aggression (angrier = thicker mouth line)
     int mouthThickness = max(1, int(1 + aggressionLevel * 2 * scale));
@@ -390,82 +376,196 @@ void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& confi
         line(canvas,
             Point(static_cast<int>(mouthCurve[i-1].x), static_cast<int>(mouthCurve[i-1].y)),
             Point(static_cast<int>(mouthCurve[i].x), static_cast<int>(mouthCurve[i].y)),
-            Scalar(0, 0, 0), mouthThickness, LINE_AA);
+            Scalar(0, 0, 0, 255), mouthThickness, LINE_AA);
     }
+}
 
-    // 4) Animated Tail with wave effect
-    // Base tail points (similar to the original)
-    float tailLength = 2.5f * cellWidth;
-    float tailWaveAmplitude = 0.25f * cellHeight;
-    float tailWaveFrequency = 3.0f;  // Number of waves along tail
-    float tailWaveSpeed = 5.0f;      // Speed of wave movement
+// Body half-extents of a cell; its genes stretch the configured size a little
+Size2f cellBodySize(const CellView& cell, const map<string, float>& config, float scale) {
+    // 获取基本参数值
+    float baseWidth = config.at("cell_width");
+    float baseHeight = config.at("cell_height");
+    
+    // 减弱基因对大小的影响 - 使差异更微妙
+    float sizeEffect = 1.0f + (cell.sizeMultiplier - 1.0f) * 0.3f;
+    
+    // 减小离心率范围 - 使用更窄的范围
+    float eccentricity = 0.05f + (cell.sharpnessMultiplier - 1.0f) * 0.15f;
+    
+    // 计算实际宽高，降低基因影响
+    float cellWidth = baseWidth * scale * sizeEffect;
+    float cellHeight = baseHeight * scale * sizeEffect;
+    
+    // 根据离心率调整形状 - 更温和的形变
+    if (cell.sharpnessMultiplier > 1.0f) {
+        // 高尖锐度 = 更狭长，但效果更温和
+        cellWidth *= (1.0f + eccentricity * 0.3f);
+        cellHeight *= (1.0f - eccentricity * 0.1f);
+    } else {
+        // 低尖锐度 = 更圆润，但效果更温和
+        cellWidth *= (1.0f - eccentricity * 0.1f);
+        cellHeight *= (1.0f + eccentricity * 0.1f);
+    }
 
-    // Create a more detailed tail curve with wave effect
-    vector<Point2f> tailCurve;
-    int numTailPoints = 30; // More points for smoother tail
+    return Size2f(cellWidth, cellHeight);
+}
+
+// Conservative pixel bounds of everything drawCell draws for this cell, anti-aliasing included
+Rect cellBounds(const CellView& cell, const Point2f& renderPosition, const map<string, float>& config, float scale) {
+    Size2f bodySize = cellBodySize(cell, config, scale);
+    float cellWidth = bodySize.width;
+    float cellHeight = bodySize.height;
+    float directionFactor = cell.faceRight ? 1.0f : -1.0f;
+    const Point2f& cellPos = renderPosition;
+
+    // Body, and the tail trailing up to three body widths behind it
+    float tailEnd = cellPos.x - directionFactor * cellWidth * 3.0f;
+    float left = min(cellPos.x - cellWidth, tailEnd);
+    float right = max(cellPos.x + cellWidth, tailEnd);
+    float top = cellPos.y - cellHeight;
+    float bottom = cellPos.y + cellHeight;
+
+    // Health bar
+    left = min(left, cellPos.x - cellWidth * 0.6f);
+    right = max(right, cellPos.x + cellWidth * 0.6f);
+    top = min(top, cellPos.y - 50.0f);
+
+    // Player label ("player N" at font scale 0.5 stays well under 120 pixels wide)
+    if (cell.playerNumber > 0) {
+        left = min(left, cellPos.x - 25.0f);
+        right = max(right, cellPos.x + 95.0f);
+        top = min(top, cellPos.y - cellHeight - 50.0f);
+    }
 
-    // Calculate starting point and direction vector for the tail
-    Point2f tailStart(cellPos.x - directionFactor * cellWidth * 0.5f, cellPos.y);
-    Point2f tailDirection(-directionFactor, 0); // Tail extends left/right depending on direction
+    // Shield, including the pulsing parry ring
+    if (cell.isShielding || cell.hasParried) {
+        Point2f shieldPos(cellPos.x + directionFactor * cellWidth * 0.6f, cellPos.y + cellHeight * 0.4f);
+        float reach = (cell.hasParried ? 130.0f : 70.0f) * scale + 3.0f;
+        left = min(left, shieldPos.x - reach);
+        right = max(right, shieldPos.x + reach);
+        top = min(top, shieldPos.y - reach);
+        bottom = max(bottom, shieldPos.y + reach);
+    }
+
+    // Spear at full attack extension
+    if (cell.isAttacking && !cell.isShielding) {
+        float spearScale = (cell.playerNumber > 0) ? scale : scale * 0.8f;
+        float spearTip = cellPos.x + directionFactor * 200.0f * spearScale;
+        left = min(left, min(cellPos.x, spearTip));
+        right = max(right, max(cellPos.x, spearTip));
+        top = min(top, cellPos.y + cellHeight - 35.0f * spearScale);
+        bottom = max(bottom, cellPos.y + cellHeight);
+    }
 
-    for (int i = 0; i <= numTailPoints; i++) {
-        float t = static_cast<float>(i) / numTailPoints;
+    // Anti-aliasing, line thickness and truncation of the coordinates
+    float pad = 6.0f + 2.0f * scale;
+    return Rect(Point(cvFloor(left - pad), cvFloor(top - pad)),
+                Point(cvCeil(right + pad) + 1, cvCeil(bottom + pad) + 1));
+}
 
-        // Calculate position along the tail (decreasing exponential to make it taper)
-        float x = tailStart.x + tailDirection.x * t * tailLength;
-        float y = tailStart.y + tailDirection.y * t * tailLength;
+// Build the cached sprites this cell needs, so drawing it afterwards only reads the caches
+// Cached "player N" label; rasterized once per player number instead of putText every frame
+static const TextSprite& playerLabel(int playerNum) {
+    return TextSprites::instance().get("player " + to_string(playerNum), TextStyle(0.5));
+}
 
-        // Calculate wave effect perpendicular to tail direction
-        float wavePhase = time * tailWaveSpeed + tailPhaseOffset + t * tailWaveFrequency * 2 * CV_PI;
+void prepareCellSprites(const CellView& cell, const map<string, float>& config, float scale) {
+    Size2f bodySize = cellBodySize(cell, config, scale);
+    CellSprites::instance().get(config, scale, bodySize.width, bodySize.height, cell.faceRight, cell.aggressionLevel);
 
-        float perpX = -tailDirection.y; // Perpendicular to tail direction
-        float perpY = tailDirection.x;
+    Size shieldSize = shieldSpriteSize(scale);
+    if ((cell.isShielding || cell.hasParried) && !getShieldImage().empty() &&
+        shieldSize.width > 0 && shieldSize.height > 0) {
+        ShieldSprites::instance().get(getShieldImage(), shieldSize);
+    }
 
-        // Amplitude decreases toward the end of the tail
-        float localAmplitude = tailWaveAmplitude * (t);
-        float waveOffset = sin(wavePhase) * localAmplitude;
+    if (cell.playerNumber > 0) {
+        playerLabel(cell.playerNumber);
+    }
+}
 
-        Point2f pointWithWave(x + perpX * waveOffset, y + perpY * waveOffset);
-        tailCurve.push_back(pointWithWave);
+// Draw a cell from its copied state at the given (interpolated) position
+void drawCell(Mat& canvas, const CellView& cell, const Point2f& renderPosition, const map<string, float>& config,
+              float scale, float time, const Rect& clip, CellDetail detail, const Point2f* tailPoints) {
+    Size2f bodySize = cellBodySize(cell, config, scale);
+    float cellWidth = bodySize.width;
+    float cellHeight = bodySize.height;
+
+    // Dot tier: a plain filled dot in the body color, nothing else
+    if (detail == CellDetail::Dot) {
+        circle(canvas, Point(static_cast<int>(renderPosition.x), static_cast<int>(renderPosition.y)),
+               max(1, static_cast<int>(cellHeight * 0.6f)), Scalar(cell.color[0], cell.color[1], cell.color[2]),
+               FILLED, LINE_8);
+        return;
+    }
+
+    Point2f cellPos = renderPosition;
+    bool faceRight = cell.faceRight;
+    Vec3b cellColor = cell.color;
+    float tailPhaseOffset = cell.tailPhaseOffset;
+    float aggressionLevel = cell.aggressionLevel;
+
+    // 1)-3) Body, eye and mouth only depend on size, facing and aggression: stamp the cached
+    // white sprite tinted with the cell color instead of rasterizing them again
+    const CellSprite& bodySprite = CellSprites::instance().get(config, scale, cellWidth, cellHeight,
+                                                               faceRight, aggressionLevel);
+    SpriteTint bodyTint;
+    bodyTint.gain = Vec3f(cellColor[0] / 255.0f, cellColor[1] / 255.0f, cellColor[2] / 255.0f);
+    stampSprite(canvas, bodySprite.image,
+                Point(static_cast<int>(cellPos.x), static_cast<int>(cellPos.y)) - bodySprite.origin, clip, &bodyTint);
+
+    // 4) Animated Tail with wave effect
+    // The simplified tier samples a shorter tail more coarsely; batched callers pass the polyline in
+    const TailShape& shape = tailShape(detail);
+    Point2f tailCurve[maxTailPoints];
+    if (!tailPoints) {
+        computeTailCurve(cellPos, cellWidth, cellHeight, faceRight, tailPhaseOffset, time, detail, tailCurve);
+        tailPoints = tailCurve;
     }
 
     // Draw the tail curve with fixed thickness
-    for (size_t i = 6; i < tailCurve.size(); ++i) {
+    for (int i = shape.firstSegment; i <= shape.segments; ++i) {
         // Always use a safe fixed thickness for tail segments
         int tailThickness = 1; // Minimum thickness of 1
 
-        line(canvas,
-            Point(static_cast<int>(tailCurve[i-1].x), static_cast<int>(tailCurve[i-1].y)),
-            Point(static_cast<int>(tailCurve[i].x), static_cast<int>(tailCurve[i].y)),
-            Scalar(0, 0, 0), tailThickness, LINE_AA);
+        Point segmentStart(static_cast<int>(tailPoints[i-1].x), static_cast<int>(tailPoints[i-1].y));
+        Point segmentEnd(static_cast<int>(tailPoints[i].x), static_cast<int>(tailPoints[i].y));
+        if (!reachesClip(clip, segmentStart, segmentEnd, 2)) continue;
+        line(canvas, segmentStart, segmentEnd, Scalar(0, 0, 0), tailThickness, LINE_AA);
     }
 
-    // Draw blood drops for this cell
-    drawBloodDrops(canvas, cell.getBloodDrops());
-
     // Draw the shield if the cell is shielding
-    if (cell.isShielding() || cell.hasParried()) {
+    if (cell.isShielding || cell.hasParried) {
         drawShield(canvas, cellPos, faceRight, scale, cellWidth, cellHeight,
-                 cell.isShielding(), cell.getParryTime(), cell.hasParried());
+                 cell.isShielding, cell.parryTime, cell.hasParried, clip);
     }
 
     // Draw the spear for all cells when attacking - 所有细胞都用矛
-    if (cell.isAttacking() && !cell.isShielding()) {
+    if (cell.isAttacking && !cell.isShielding) {
         // AI细胞矛稍小一点
-        float spearScale = (cell.getPlayerNumber() > 0) ? scale : scale * 0.8f;
+        float spearScale = (cell.playerNumber > 0) ? scale : scale * 0.8f;
         drawSpear(canvas, cellPos, faceRight, spearScale, cellWidth, cellHeight,
-                 true, cell.getAttackTime());
+                 true, cell.attackTime, clip);
     }
 
+    // Health bar and label only at full detail
+    if (detail != CellDetail::Full) return;
+
     // Draw health bar
-    drawHealthBar(canvas, cellPos, cellWidth, cell.getHealth(), cell.getMaxHealth());
+    drawHealthBar(canvas, cellPos, cellWidth, cell.health, cell.maxHealth, clip);
 
     // Add player identification text
-    int playerNum = cell.getPlayerNumber();
+    int playerNum = cell.playerNumber;
     if (playerNum > 0) {
-        string playerText = "player " + to_string(playerNum);
-        Point textPos(static_cast<int>(cell.getPosition().x - 25),
-                      static_cast<int>(cell.getPosition().y - cellHeight - 30));
-        putText(canvas, playerText, textPos, FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0, 0, 0), 1, LINE_AA);
+        Point textPos(static_cast<int>(cellPos.x - 25),
+                      static_cast<int>(cellPos.y - cellHeight - 30));
+        const TextSprite& label = playerLabel(playerNum);
+        stampSprite(canvas, label.image, textPos - label.origin, clip);
     }
 }
+
+// Function to draw the cell directly on the canvas
+void drawCell(Mat& canvas, const BaseCell& cell, const map<string, float>& config, float scale,
+              float time) {
+    drawCell(canvas, cell.makeView(), cell.getRenderPosition(), config, scale, time, Rect(), CellDetail::Full, nullptr);
+}
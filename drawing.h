@@ -8,6 +8,7 @@
 
 // 前向声明
 class BaseCell;
+class ParticleSystem;
 
 // Function to compute Bezier curve points
 cv::Point2f bezierPoint(const std::vector<cv::Point2f>& controlPoints, float t);
@@ -16,25 +17,56 @@ cv::Point2f bezierPoint(const std::vector<cv::Point2f>& controlPoints, float t);
 void drawTeardropShape(cv::Mat& canvas, const cv::Point2f& position,
                       float size, float rotation, const cv::Scalar& color);
 
+// Conservative pixel bounds of a teardrop drawn by drawTeardropShape
+cv::Rect teardropBounds(const cv::Point2f& position, float size);
+
 // Function to draw blood drops
-void drawBloodDrops(cv::Mat& canvas, const std::vector<BloodDrop>& bloodDrops);
+void drawBloodDrops(cv::Mat& canvas, const ParticleSystem& particles);
 
-// Function to draw a spear with attack animation
+// Function to draw a spear with attack animation; skipped when it cannot reach clip
 void drawSpear(cv::Mat& canvas, const cv::Point2f& cellPosition, bool faceRight, float scale,
-               float cellWidth, float cellHeight, bool isAttacking, float attackTime);
+               float cellWidth, float cellHeight, bool isAttacking, float attackTime,
+               const cv::Rect& clip = cv::Rect());
 
-// Function to draw shield
+// Function to draw shield; with a clip rect the sprite is only blended inside it
 void drawShield(cv::Mat& canvas, const cv::Point2f& cellPosition, bool faceRight, float scale,
-               float cellWidth, float cellHeight, bool isShielding, float shieldTime, bool hasParried);
+               float cellWidth, float cellHeight, bool isShielding, float shieldTime, bool hasParried,
+               const cv::Rect& clip = cv::Rect());
 
-// Function to draw health bar
+// Function to draw health bar; skipped when it cannot reach clip
 void drawHealthBar(cv::Mat& canvas, const cv::Point2f& position,
-                  float cellWidth, float health, float maxHealth);
+                  float cellWidth, float health, float maxHealth, const cv::Rect& clip = cv::Rect());
+
+// Function to draw the cell body, eye and mouth (everything but the animated tail and equipment)
+void drawCellBody(cv::Mat& canvas, const cv::Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                  const cv::Scalar& bodyColor, float aggressionLevel, const std::map<std::string, float>& config,
+                  float scale);
 
 // Function to draw the cell directly on the canvas
 void drawCell(cv::Mat& canvas, const BaseCell& cell, const std::map<std::string, float>& config,
              float scale, float time);
 
+// Function to draw a cell from its copied state at the given (interpolated) position, at the given detail tier.
+// With a clip rect only the pixels inside it are guaranteed to be right: sprites are blended just there and
+// shapes that cannot reach it are skipped, the rest are rasterized whole so OpenCV clips them exactly as it
+// would on an unclipped canvas. tailPoints is the tail polyline from a TailBatch, computed here when null
+void drawCell(cv::Mat& canvas, const CellView& cell, const cv::Point2f& renderPosition,
+             const std::map<std::string, float>& config, float scale, float time,
+             const cv::Rect& clip = cv::Rect(), CellDetail detail = CellDetail::Full,
+             const cv::Point2f* tailPoints = nullptr);
+
+// Body half-extents of the cell on screen, as drawCell computes them
+cv::Size2f cellBodySize(const CellView& cell, const std::map<std::string, float>& config, float scale);
+
+// Conservative pixel bounds of everything drawCell draws for the cell at renderPosition
+cv::Rect cellBounds(const CellView& cell, const cv::Point2f& renderPosition,
+                    const std::map<std::string, float>& config, float scale);
+
+// Build the cached sprites the cell needs: body (CellSprites), shield (ShieldSprites) and player
+// label (TextSprites). None of these caches is thread-safe; call this for every cell on one thread
+// before drawing them from several threads, so the parallel draws only look up existing sprites
+void prepareCellSprites(const CellView& cell, const std::map<std::string, float>& config, float scale);
+
 // Load shield image
 void loadShieldImage();
 
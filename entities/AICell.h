@@ -2,25 +2,23 @@
 #define AI_CELL_H
 
 #include "BaseCell.h"
-#include <random>
+#include "../simulation/Random.h"
 
 // AI控制的细胞类，处理自主行为
 class AICell : public BaseCell {
 public:
     AICell(const cv::Point2f& pos, int id, const cv::Vec3b& baseColor,
-           float phaseOffset, float aggression = 0.0f, const std::string& cellGene = "");
+           float phaseOffset, float aggression = 0.0f, const Gene& cellGene = Gene());
     
-    // 重写更新方法以实现AI行为
-    void update(float deltaTime, const GameConfig& config, const cv::Size& canvasSize) override;
+    // 重写行为决策以实现AI行为，物理和状态推进由基类和CellStore完成
+    void updateBehavior(float deltaTime, const GameConfig& config) override;
     
 private:
     // AI行为控制
     void updateAIBehavior(float deltaTime, const GameConfig& config);
     
-    // 随机数生成器
-    std::mt19937 gen;
-    std::uniform_real_distribution<float> moveDist;
-    std::uniform_real_distribution<float> probDist;
+    // 本细胞独占的随机流，从世界种子派生，并行更新时互不干扰
+    Pcg32 rng;
 };
 
 #endif // AI_CELL_H
\ No newline at end of file
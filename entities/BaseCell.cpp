@@ -8,80 +8,50 @@
 // 添加AICell的头文件引用
 #include "AICell.h"
 
-// 添加随机数生成引擎
-std::mt19937& BaseCell::getRandomEngine() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    return gen;
-}
-
-// 生成杂乱的随机基因
-std::string BaseCell::generateRandomGene(int length) {
-    static const char charset[] = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "0123456789!@#$%^&*()-_=+";
-    
-    const size_t max_index = sizeof(charset) - 1;
-    std::string gene;
-    gene.reserve(length);
-    
-    auto& gen = getRandomEngine();
-    std::uniform_int_distribution<size_t> dist(0, max_index);
-    
-    for (int i = 0; i < length; i++) {
-        gene += charset[dist(gen)];
-    }
-    
-    return gene;
+// 基因生成、繁殖等都在串行阶段执行，共用世界随机流
+Pcg32& BaseCell::getRandomEngine() {
+    return Random::world();
 }
 
+namespace {
+
+// 细胞只在串行阶段创建，编号计数不需要同步
+uint32_t nextNetworkId = 1;
+
+} // namespace
+
 BaseCell::BaseCell(const cv::Point2f& pos, int playerNum, const cv::Vec3b& baseColor,
-                float phaseOffset, float aggression, const std::string& cellGene)
-    : position(pos),
-      velocity(0, 0),
-      acceleration(0, 0),
-      faceRight(true),
+                float phaseOffset, float aggression, const Gene& cellGene)
+    : slot(CellStore::instance().allocate(this, pos)),  // 热数据的默认值由CellStore写入
       playerNumber(playerNum),
       color(baseColor),
       tailPhaseOffset(phaseOffset),
       aggressionLevel(aggression),
-      health(100.0f),
-      maxHealth(100.0f),
-      isAttackingFlag(false),
-      attackTimeValue(0.0f),
-      isShieldingFlag(false),
-      shieldTimeValue(0.0f),
-      hasParriedFlag(false),
-      parryTimeValue(0.0f),
-      shieldDurationValue(2.0f),
-      shieldCooldownTimeValue(0.0f),
-      damageReductionValue(0.75f),
-      gene(cellGene.empty() ? generateRandomGene() : cellGene),
+      gene(cellGene.empty() ? Gene::random(getRandomEngine()) : cellGene),
       faction(0),  // 默认阵营
-      sizeMultiplier(1.0f),
-      sharpnessMultiplier(1.0f),
-      speedMultiplier(1.0f),
-      attackMultiplier(1.0f),
-      defenseMultiplier(1.0f) {
+      networkId(nextNetworkId++) {
     
     // 解析基因并设置细胞属性
     parseGene();
 }
 
+BaseCell::~BaseCell() {
+    CellStore::instance().release(slot);
+}
+
 // 从杂乱的基因中提取特定属性值
-float BaseCell::extractGeneAttribute(const std::string& geneStr, int startIndex, int length) const {
+float BaseCell::extractGeneAttribute(const Gene& geneStr, int startIndex, int length) const {
     if (geneStr.empty()) return 1.0f;
     
     // 使用一个简单的哈希函数从基因子串中提取属性值
     float value = 0.0f;
-    int actualLength = std::min((int)geneStr.length() - startIndex, length);
+    int actualLength = std::min((int)geneStr.size() - startIndex, length);
     
     if (actualLength <= 0) return 1.0f;
     
     // 计算这段基因的特征值
     for (int i = 0; i < actualLength; i++) {
-        char c = geneStr[(startIndex + i) % geneStr.length()];
+        char c = geneStr[(startIndex + i) % geneStr.size()];
         value += (float)(c) / 255.0f;
     }
     
@@ -96,6 +66,9 @@ void BaseCell::parseGene() {
     
     if (gene.empty()) return;
     
+    // 先在局部变量中计算，最后写回CellStore
+    float sizeMultiplier, sharpnessMultiplier, attackMultiplier, defenseMultiplier, speedMultiplier;
+    
     // 使用基因不同部分计算不同属性 - 缩小范围使差异更细微
     sizeMultiplier = 0.9f + extractGeneAttribute(gene, 0, 3) * 0.2f; // 前3个字符影响大小 (0.9-1.1)
     sharpnessMultiplier = 0.9f + extractGeneAttribute(gene, 3, 3) * 0.2f; // 接下来3个字符影响尖锐度 (0.9-1.1)
@@ -112,9 +85,10 @@ void BaseCell::parseGene() {
     // 弱化属性之间的关系
     
     // 大小会影响血量和防御，但降低速度 - 效果更温和
-    maxHealth = 100.0f * (1.0f + (sizeMultiplier - 1.0f) * 0.5f); // 线性增长，更温和
-    health = maxHealth;
-    damageReductionValue = std::min(0.9f, 0.75f * defenseMultiplier);
+    CellStore& store = CellStore::instance();
+    store.maxHealth[slot] = 100.0f * (1.0f + (sizeMultiplier - 1.0f) * 0.5f); // 线性增长，更温和
+    store.health[slot] = store.maxHealth[slot];
+    store.damageReduction[slot] = std::min(0.9f, 0.75f * defenseMultiplier);
     
     // 尖锐度会提高攻击力和速度但降低防御 - 效果更温和
     attackMultiplier *= (1.0f + (sharpnessMultiplier - 1.0f) * 0.2f);
@@ -129,9 +103,15 @@ void BaseCell::parseGene() {
     attackMultiplier = std::max(0.8f, std::min(1.3f, attackMultiplier));
     defenseMultiplier = std::max(0.8f, std::min(1.2f, defenseMultiplier));
     
-    // 根据玩家编号设置阵营 (1为0阵营，2为1阵营)
+    store.sizeMultiplier[slot] = sizeMultiplier;
+    store.sharpnessMultiplier[slot] = sharpnessMultiplier;
+    store.speedMultiplier[slot] = speedMultiplier;
+    store.attackMultiplier[slot] = attackMultiplier;
+    store.defenseMultiplier[slot] = defenseMultiplier;
+    
+    // 根据玩家编号设置阵营 (奇数编号为0阵营，偶数编号为1阵营；双人对战即1为0阵营，2为1阵营)
     if (playerNumber > 0) {
-        faction = (playerNumber == 2) ? 1 : 0;
+        faction = (playerNumber % 2 == 0) ? 1 : 0;
     } else {
         // 对于非玩家细胞，根据基因哈希值决定阵营
         faction = hash % 2;
@@ -142,26 +122,11 @@ void BaseCell::parseGene() {
 }
 
 void BaseCell::update(float deltaTime, const GameConfig& config, const cv::Size& canvasSize) {
-    // 基于调整后的速度更新物理状态
-    float adjustedMaxSpeed = config.maxSpeed * speedMultiplier;
-    updatePhysics(deltaTime, adjustedMaxSpeed, config.drag, canvasSize);
+    // 行为决策（AI等由子类实现）
+    updateBehavior(deltaTime, config);
     
-    // 更新攻击动画
-    if (isAttackingFlag) {
-        attackTimeValue += deltaTime / config.attackDuration;
-        
-        // 检查攻击动画是否完成
-        if (attackTimeValue >= 1.0f) {
-            isAttackingFlag = false;
-            attackTimeValue = 0.0f;
-        }
-    }
-    
-    // 更新盾牌状态
-    updateShieldState(deltaTime);
-    
-    // 更新血液粒子效果
-    updateBloodDrops(bloodDrops, deltaTime);
+    // 物理、攻击动画和盾牌状态与批量更新共用CellStore的内核
+    CellStore::instance().integrate(slot, slot + 1, deltaTime, config, canvasSize);
 }
 
 void BaseCell::render(cv::Mat& canvas, const std::map<std::string, float>& config, float scale, float time) {
@@ -170,38 +135,82 @@ void BaseCell::render(cv::Mat& canvas, const std::map<std::string, float>& confi
 }
 
 bool BaseCell::isAlive() const {
-    return health > 0;
+    return CellStore::instance().health[slot] > 0;
 }
 
 cv::Point2f BaseCell::getPosition() const {
-    return position;
+    const CellStore& store = CellStore::instance();
+    return cv::Point2f(store.posX[slot], store.posY[slot]);
+}
+
+cv::Point2f BaseCell::getRenderPosition() const {
+    return CellStore::instance().interpolatedPosition(slot);
+}
+
+CellView BaseCell::makeView() const {
+    const CellStore& store = CellStore::instance();
+    CellView view;
+    view.position = cv::Point2f(store.posX[slot], store.posY[slot]);
+    view.prevPosition = cv::Point2f(store.prevX[slot], store.prevY[slot]);
+    view.color = color;
+    view.tailPhaseOffset = tailPhaseOffset;
+    view.aggressionLevel = aggressionLevel;
+    view.sizeMultiplier = store.sizeMultiplier[slot];
+    view.sharpnessMultiplier = store.sharpnessMultiplier[slot];
+    view.health = store.health[slot];
+    view.maxHealth = store.maxHealth[slot];
+    view.attackTime = store.attackTime[slot];
+    view.parryTime = store.parryTime[slot];
+    view.playerNumber = playerNumber;
+    view.faceRight = isFacingRight();
+    view.isAttacking = isAttacking();
+    view.isShielding = isShielding();
+    view.hasParried = hasParried();
+    return view;
+}
+
+void BaseCell::setPosition(const cv::Point2f& newPosition) {
+    CellStore& store = CellStore::instance();
+    store.posX[slot] = store.prevX[slot] = newPosition.x;
+    store.posY[slot] = store.prevY[slot] = newPosition.y;
+}
+
+void BaseCell::setVelocity(const cv::Point2f& newVelocity) {
+    CellStore& store = CellStore::instance();
+    store.velX[slot] = newVelocity.x;
+    store.velY[slot] = newVelocity.y;
 }
 
 void BaseCell::applyAcceleration(const cv::Point2f& acc) {
-    acceleration += acc;
+    CellStore& store = CellStore::instance();
+    store.accX[slot] += acc.x;
+    store.accY[slot] += acc.y;
 }
 
 void BaseCell::applyKnockback(const cv::Point2f& force) {
-    velocity += force;
+    CellStore& store = CellStore::instance();
+    store.velX[slot] += force.x;
+    store.velY[slot] += force.y;
 }
 
 bool BaseCell::isAttacking() const {
-    return isAttackingFlag;
+    return CellStore::instance().hasFlag(slot, CellStore::ATTACKING);
 }
 
 void BaseCell::setAttacking(bool attacking) {
-    isAttackingFlag = attacking;
+    CellStore::instance().setFlag(slot, CellStore::ATTACKING, attacking);
 }
 
 float BaseCell::getAttackTime() const {
-    return attackTimeValue;
+    return CellStore::instance().attackTime[slot];
 }
 
 void BaseCell::setAttackTime(float time) {
-    attackTimeValue = time;
+    CellStore::instance().attackTime[slot] = time;
 }
 
 void BaseCell::takeDamage(float damage) {
+    float& health = CellStore::instance().health[slot];
     health -= damage;
     if (health < 0) {
         health = 0;
@@ -209,77 +218,71 @@ void BaseCell::takeDamage(float damage) {
 }
 
 bool BaseCell::isShielding() const {
-    return isShieldingFlag;
+    return CellStore::instance().hasFlag(slot, CellStore::SHIELDING);
 }
 
 void BaseCell::setShielding(bool shielding) {
-    isShieldingFlag = shielding;
+    CellStore::instance().setFlag(slot, CellStore::SHIELDING, shielding);
 }
 
 float BaseCell::getShieldTime() const {
-    return shieldTimeValue;
+    return CellStore::instance().shieldTime[slot];
 }
 
 void BaseCell::setShieldTime(float time) {
-    shieldTimeValue = time;
+    CellStore::instance().shieldTime[slot] = time;
 }
 
 bool BaseCell::hasParried() const {
-    return hasParriedFlag;
+    return CellStore::instance().hasFlag(slot, CellStore::PARRIED);
 }
 
 void BaseCell::setParried(bool parried) {
-    hasParriedFlag = parried;
+    CellStore::instance().setFlag(slot, CellStore::PARRIED, parried);
 }
 
 float BaseCell::getParryTime() const {
-    return parryTimeValue;
+    return CellStore::instance().parryTime[slot];
 }
 
 void BaseCell::setParryTime(float time) {
-    parryTimeValue = time;
+    CellStore::instance().parryTime[slot] = time;
 }
 
 float BaseCell::getShieldDuration() const {
-    return shieldDurationValue;
+    return CellStore::instance().shieldDuration[slot];
 }
 
 void BaseCell::setShieldDuration(float duration) {
-    shieldDurationValue = duration;
+    CellStore::instance().shieldDuration[slot] = duration;
 }
 
 float BaseCell::getShieldCooldownTime() const {
-    return shieldCooldownTimeValue;
+    return CellStore::instance().shieldCooldown[slot];
 }
 
 void BaseCell::setShieldCooldownTime(float time) {
-    shieldCooldownTimeValue = time;
+    CellStore::instance().shieldCooldown[slot] = time;
 }
 
 float BaseCell::getDamageReduction() const {
-    return damageReductionValue;
+    return CellStore::instance().damageReduction[slot];
 }
 
 void BaseCell::setDamageReduction(float reduction) {
-    damageReductionValue = reduction;
-}
-
-void BaseCell::updateShieldCooldown(float deltaTime) {
-    if (shieldCooldownTimeValue > 0) {
-        shieldCooldownTimeValue = std::max(0.0f, shieldCooldownTimeValue - deltaTime);
-    }
+    CellStore::instance().damageReduction[slot] = reduction;
 }
 
 bool BaseCell::canToggleShield() const {
-    return shieldCooldownTimeValue <= 0;
+    return CellStore::instance().shieldCooldown[slot] <= 0;
 }
 
 bool BaseCell::isFacingRight() const {
-    return faceRight;
+    return CellStore::instance().hasFlag(slot, CellStore::FACE_RIGHT);
 }
 
 void BaseCell::setFacingRight(bool facing) {
-    faceRight = facing;
+    CellStore::instance().setFlag(slot, CellStore::FACE_RIGHT, facing);
 }
 
 float BaseCell::getAggressionLevel() const {
@@ -290,88 +293,8 @@ void BaseCell::setAggressionLevel(float level) {
     aggressionLevel = level;
 }
 
-const std::vector<BloodDrop>& BaseCell::getBloodDrops() const {
-    return bloodDrops;
-}
-
-// 新添加的方法实现
-void BaseCell::addBloodDrop(const cv::Point2f& position, const cv::Point2f& velocity, float size, float lifetime, float rotation) {
-    bloodDrops.emplace_back(position, velocity, size, lifetime, rotation);
-}
-
-void BaseCell::updatePhysics(float deltaTime, float maxSpeed, float drag, const cv::Size& canvasSize) {
-    // 基于加速度更新速度
-    velocity += acceleration;
-    
-    // 限制速度不超过最大速度
-    velocity.x = std::clamp(velocity.x, -maxSpeed, maxSpeed);
-    velocity.y = std::clamp(velocity.y, -maxSpeed, maxSpeed);
-    
-    // 基于速度更新位置
-    position += velocity;
-    
-    // 应用阻力
-    velocity *= drag;
-    
-    // 重置加速度
-    acceleration = cv::Point2f(0, 0);
-    
-    // 边界检查，保持细胞在画布内
-    if (position.x < 0) {
-        position.x = 0;
-        velocity.x *= -0.5f; // 反弹
-    }
-    if (position.x > canvasSize.width) {
-        position.x = canvasSize.width;
-        velocity.x *= -0.5f; // 反弹
-    }
-    if (position.y < 0) {
-        position.y = 0;
-        velocity.y *= -0.5f; // 反弹
-    }
-    if (position.y > canvasSize.height) {
-        position.y = canvasSize.height;
-        velocity.y *= -0.5f; // 反弹
-    }
-    
-    // 根据速度更新方向，添加更大的阈值和缓冲以避免频繁切换
-    // 只有本地玩家或者速度超过较大阈值时才更新朝向
-    if (velocity.x > 1.0f) {
-        faceRight = true;
-    } else if (velocity.x < -1.0f) {
-        faceRight = false;
-    }
-    // 速度很小的情况下保持当前朝向
-}
-
-void BaseCell::updateShieldState(float deltaTime) {
-    // 更新盾牌时间
-    if (isShieldingFlag) {
-        shieldTimeValue += deltaTime;
-        
-        // 盾牌持续时间超过限制后自动降下
-        if (shieldTimeValue >= shieldDurationValue) {
-            isShieldingFlag = false;
-            shieldTimeValue = 0.0f;
-            shieldCooldownTimeValue = 0.3f; // 盾牌自动降下后应用冷却时间
-        }
-    } else {
-        shieldTimeValue = 0.0f;
-    }
-    
-    // 更新格挡效果时间
-    if (hasParriedFlag) {
-        parryTimeValue += deltaTime;
-        // 格挡效果持续0.5秒
-        if (parryTimeValue >= 0.5f) {
-            hasParriedFlag = false;
-            parryTimeValue = 0.0f;
-        }
-    }
-}
-
 // 获取基因
-const std::string& BaseCell::getGene() const {
+const Gene& BaseCell::getGene() const {
     return gene;
 }
 
@@ -389,31 +312,12 @@ void BaseCell::setFaction(int newFaction) {
 
 // 获取细胞尺寸倍数
 float BaseCell::getSizeMultiplier() const {
-    return sizeMultiplier;
+    return CellStore::instance().sizeMultiplier[slot];
 }
 
-// 计算两个细胞的基因相似度 (0-1)
+// 计算两个细胞的基因相似度 (0-1)，每次命中都会调用，由定长基因一次比较完成
 float BaseCell::getGeneticSimilarity(const BaseCell& other) const {
-    if (gene.empty() || other.getGene().empty()) {
-        return 0.0f;
-    }
-    
-    // 使用Levenshtein距离计算两个基因的相似度
-    const std::string& s1 = gene;
-    const std::string& s2 = other.getGene();
-    const size_t len1 = s1.size();
-    const size_t len2 = s2.size();
-    
-    // 计算字符级别的匹配度
-    int matches = 0;
-    size_t minLength = std::min(len1, len2);
-    for (size_t i = 0; i < minLength; i++) {
-        if (s1[i] == s2[i]) {
-            matches++;
-        }
-    }
-    
-    return static_cast<float>(matches) / minLength;
+    return gene.similarity(other.gene);
 }
 
 // 计算基因特异性伤害系数
@@ -435,17 +339,16 @@ BaseCell* BaseCell::createOffspring(const BaseCell& parent1,
                                   const BaseCell& parent2, 
                                   const cv::Size& canvasSize) {
     // 混合父母基因生成新基因
-    std::string newGene = mutateGene(parent1.getGene(), parent2.getGene());
+    auto& gen = getRandomEngine();
+    Gene newGene = Gene::mix(parent1.getGene(), parent2.getGene(), gen);
     
     // 混合父母的颜色
     cv::Vec3b newColor = (parent1.getColor() + parent2.getColor()) / 2;
     
     // 随机变异颜色
-    std::uniform_int_distribution<int> colorDist(-20, 20);
-    auto& gen = getRandomEngine();
-    newColor[0] = cv::saturate_cast<uchar>(newColor[0] + colorDist(gen));
-    newColor[1] = cv::saturate_cast<uchar>(newColor[1] + colorDist(gen));
-    newColor[2] = cv::saturate_cast<uchar>(newColor[2] + colorDist(gen));
+    newColor[0] = cv::saturate_cast<uchar>(newColor[0] + gen.uniformInt(-20, 20));
+    newColor[1] = cv::saturate_cast<uchar>(newColor[1] + gen.uniformInt(-20, 20));
+    newColor[2] = cv::saturate_cast<uchar>(newColor[2] + gen.uniformInt(-20, 20));
     
     // 确定位置 (两个父母之间的位置加随机偏移)
     cv::Point2f parentPos1 = parent1.getPosition();
@@ -453,17 +356,15 @@ BaseCell* BaseCell::createOffspring(const BaseCell& parent1,
     cv::Point2f midPoint = (parentPos1 + parentPos2) * 0.5f;
     
     // 添加随机偏移
-    std::uniform_real_distribution<float> posDist(-50.0f, 50.0f);
-    midPoint.x += posDist(gen);
-    midPoint.y += posDist(gen);
+    midPoint.x += gen.uniform(-50.0f, 50.0f);
+    midPoint.y += gen.uniform(-50.0f, 50.0f);
     
     // 限制在画布范围内
     midPoint.x = std::clamp(midPoint.x, 0.0f, static_cast<float>(canvasSize.width));
     midPoint.y = std::clamp(midPoint.y, 0.0f, static_cast<float>(canvasSize.height));
     
     // 随机相位偏移
-    std::uniform_real_distribution<float> phaseDist(0, 2 * CV_PI);
-    float phaseOffset = phaseDist(gen);
+    float phaseOffset = gen.uniform(0.0f, 2 * CV_PI);
     
     // 创建新细胞 - 使用AICell而不是BaseCell，因为我们需要一个具体类
     AICell* offspring = new AICell(
@@ -471,72 +372,16 @@ BaseCell* BaseCell::createOffspring(const BaseCell& parent1,
     );
     
     // 随机确定阵营继承 (80%概率继承父母的阵营)
-    std::uniform_real_distribution<float> factionDist(0.0f, 1.0f);
-    if (parent1.getFaction() == parent2.getFaction() || factionDist(gen) < 0.8f) {
-        offspring->setFaction(factionDist(gen) < 0.5f ? parent1.getFaction() : parent2.getFaction());
+    if (parent1.getFaction() == parent2.getFaction() || gen.chance(0.8f)) {
+        offspring->setFaction(gen.chance(0.5f) ? parent1.getFaction() : parent2.getFaction());
     } else {
         // 小概率产生阵营变异
-        offspring->setFaction(factionDist(gen) < 0.5f ? 0 : 1);
+        offspring->setFaction(gen.chance(0.5f) ? 0 : 1);
     }
     
     return offspring;
 }
 
-// 基因突变 - 生成更杂乱的基因
-std::string BaseCell::mutateGene(const std::string& parentGene1, const std::string& parentGene2) {
-    std::string newGene;
-    auto& gen = getRandomEngine();
-    
-    // 确保生成的基因长度一致
-    size_t targetLength = std::max(parentGene1.length(), parentGene2.length());
-    if (targetLength < 16) targetLength = 16; // 确保至少16个字符
-    
-    newGene.reserve(targetLength);
-    
-    // 均匀分布随机选择父母基因
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-    
-    for (size_t i = 0; i < targetLength; i++) {
-        char geneChar;
-        
-        // 60%概率从父母继承，40%概率变异
-        if (dist(gen) < 0.6f) {
-            // 从两个父母中随机选择一个基因位点
-            if (i < parentGene1.length() && i < parentGene2.length()) {
-                geneChar = (dist(gen) < 0.5f) ? parentGene1[i] : parentGene2[i];
-            } else if (i < parentGene1.length()) {
-                geneChar = parentGene1[i];
-            } else if (i < parentGene2.length()) {
-                geneChar = parentGene2[i];
-            } else {
-                // 如果超出两个父母的长度，生成随机字符
-                geneChar = generateRandomGene(1)[0];
-            }
-        } else {
-            // 生成随机变异字符
-            geneChar = generateRandomGene(1)[0];
-        }
-        
-        newGene += geneChar;
-    }
-    
-    return newGene;
-}
-
-// 单个基因位点突变 - 现在使用更广泛的字符集
-char BaseCell::mutateGeneChar(char c) {
-    static const char charset[] = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "0123456789!@#$%^&*()-_=+";
-    
-    const size_t max_index = sizeof(charset) - 1;
-    auto& gen = getRandomEngine();
-    std::uniform_int_distribution<size_t> charDist(0, max_index);
-    
-    return charset[charDist(gen)];
-}
-
 // 设置细胞颜色
 void BaseCell::setColor(const cv::Vec3b& newColor) {
     color = newColor;
@@ -545,17 +390,21 @@ void BaseCell::setColor(const cv::Vec3b& newColor) {
 // 根据阵营更新颜色
 void BaseCell::updateColorByFaction() {
     // 生成一个基于基因的随机颜色变化
-    auto& gen = getRandomEngine();
-    std::uniform_int_distribution<int> colorVariation(-15, 15);
-    
     // 计算一个特定于这个基因的颜色种子
     unsigned int colorSeed = 0;
-    for (size_t i = 0; i < gene.length(); i++) {
+    for (size_t i = 0; i < gene.size(); i++) {
         colorSeed = colorSeed * 31 + gene[i];
     }
     
     // 使用这个种子为这个特定的基因设置一个固定的颜色变化
-    std::mt19937 colorGen(colorSeed);
+    Pcg32 colorGen(colorSeed);
+    
+    // 读取基因决定的属性倍率
+    const CellStore& store = CellStore::instance();
+    float sharpnessMultiplier = store.sharpnessMultiplier[slot];
+    float attackMultiplier = store.attackMultiplier[slot];
+    float speedMultiplier = store.speedMultiplier[slot];
+    float sizeMultiplier = store.sizeMultiplier[slot];
     
     // 保存原色调
     cv::Vec3b originalColor = color;
@@ -563,13 +412,13 @@ void BaseCell::updateColorByFaction() {
     
     // 根据阵营调整颜色，但添加更多基于基因的变化
     if (faction == 0) { // 蓝色阵营
-        color[0] = cv::saturate_cast<uchar>(colorSum * (0.5f + sharpnessMultiplier * 0.1f) + colorVariation(colorGen));
-        color[1] = cv::saturate_cast<uchar>(colorSum * (0.6f + attackMultiplier * 0.1f) + colorVariation(colorGen));
-        color[2] = cv::saturate_cast<uchar>(colorSum * (1.4f + speedMultiplier * 0.1f) + colorVariation(colorGen));
+        color[0] = cv::saturate_cast<uchar>(colorSum * (0.5f + sharpnessMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
+        color[1] = cv::saturate_cast<uchar>(colorSum * (0.6f + attackMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
+        color[2] = cv::saturate_cast<uchar>(colorSum * (1.4f + speedMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
     } else { // 绿色阵营
-        color[0] = cv::saturate_cast<uchar>(colorSum * (0.5f + sharpnessMultiplier * 0.1f) + colorVariation(colorGen));
-        color[1] = cv::saturate_cast<uchar>(colorSum * (1.4f + attackMultiplier * 0.1f) + colorVariation(colorGen));
-        color[2] = cv::saturate_cast<uchar>(colorSum * (0.6f + speedMultiplier * 0.1f) + colorVariation(colorGen));
+        color[0] = cv::saturate_cast<uchar>(colorSum * (0.5f + sharpnessMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
+        color[1] = cv::saturate_cast<uchar>(colorSum * (1.4f + attackMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
+        color[2] = cv::saturate_cast<uchar>(colorSum * (0.6f + speedMultiplier * 0.1f) + colorGen.uniformInt(-15, 15));
     }
     
     // 根据尺寸调整饱和度 - 更大的细胞颜色更饱和
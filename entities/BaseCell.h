@@ -5,32 +5,47 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
-#include <random>
 #include "../structs.h"
+#include "../simulation/CellStore.h"
+#include "../simulation/Random.h"
+#include "Gene.h"
 
 // 前向声明AI细胞类用于后代生成
 class AICell;
 
 // 基础细胞类，实现所有细胞共有的功能
+// 位置、速度、血量、计时器等热数据存放在CellStore中，细胞对象只持有槽位下标
 class BaseCell : public Entity {
 public:
     BaseCell(const cv::Point2f& pos, int playerNum, const cv::Vec3b& baseColor,
-            float phaseOffset, float aggression = 0.0f, const std::string& cellGene = "");
-    virtual ~BaseCell() {}
+            float phaseOffset, float aggression = 0.0f, const Gene& cellGene = Gene());
+    virtual ~BaseCell();
+    
+    // 槽位归属唯一，不允许拷贝
+    BaseCell(const BaseCell&) = delete;
+    BaseCell& operator=(const BaseCell&) = delete;
     
     // 实现Entity接口
+    // 依次执行行为决策、本细胞槽位的物理与状态推进
     void update(float deltaTime, const GameConfig& config, const cv::Size& canvasSize) override;
     void render(cv::Mat& canvas, const std::map<std::string, float>& config, float scale, float time) override;
     bool isAlive() const override;
     cv::Point2f getPosition() const override;
+    // 渲染用位置，在上一模拟步与当前模拟步之间插值
+    cv::Point2f getRenderPosition() const;
+    // 复制绘制所需的状态，用于交给渲染线程
+    CellView makeView() const;
+    
+    // 批量更新时由引擎分阶段调用：先对每个细胞做行为决策，再由CellStore::step统一推进物理和状态
+    virtual void updateBehavior(float /*deltaTime*/, const GameConfig& /*config*/) {}
     
     // 物理和运动
     virtual void applyAcceleration(const cv::Point2f& acc);
     void applyKnockback(const cv::Point2f& force);
     
-    // 添加直接设置位置和速度的方法
-    void setPosition(const cv::Point2f& newPosition) { position = newPosition; }
-    void setVelocity(const cv::Point2f& newVelocity) { velocity = newVelocity; }
+    // 添加直接设置位置和速度的方法（直接设置位置视为瞬移，不做渲染插值）
+    void setPosition(const cv::Point2f& newPosition);
+    void setVelocity(const cv::Point2f& newVelocity);
     
     // 战斗系统
     bool isAttacking() const;
@@ -54,7 +69,6 @@ public:
     void setShieldCooldownTime(float time);
     float getDamageReduction() const;
     void setDamageReduction(float reduction);
-    void updateShieldCooldown(float deltaTime);
     bool canToggleShield() const;
     
     // 视觉和状态
@@ -62,22 +76,20 @@ public:
     void setFacingRight(bool facing);
     float getAggressionLevel() const;
     void setAggressionLevel(float level);
-    const std::vector<BloodDrop>& getBloodDrops() const;
-    
-    // 新增方法：添加血液滴
-    void addBloodDrop(const cv::Point2f& position, const cv::Point2f& velocity, float size, float lifetime, float rotation);
-    
     // 新增公共访问方法
     const cv::Vec3b& getColor() const { return color; }
     // 添加设置颜色的方法
     void setColor(const cv::Vec3b& newColor);
     float getTailPhaseOffset() const { return tailPhaseOffset; }
     int getPlayerNumber() const { return playerNumber; }
-    float getHealth() const { return health; }
-    float getMaxHealth() const { return maxHealth; }
+    // 进程内唯一、按创建顺序递增的编号，服务器在世界快照中用它标识实体
+    uint32_t getNetworkId() const { return networkId; }
+    float getHealth() const { return CellStore::instance().health[slot]; }
+    float getMaxHealth() const { return CellStore::instance().maxHealth[slot]; }
+    int getSlot() const { return slot; }
     
     // 修改基因相关方法
-    const std::string& getGene() const;
+    const Gene& getGene() const;
     int getFaction() const;
     void setFaction(int newFaction);
     float getGeneticSimilarity(const BaseCell& other) const;
@@ -95,63 +107,41 @@ public:
     float getSizeMultiplier() const;
     
     // 新增获取攻击和防御倍率的方法
-    float getAttackMultiplier() const { return attackMultiplier; }
-    float getDefenseMultiplier() const { return defenseMultiplier; }
+    float getAttackMultiplier() const { return CellStore::instance().attackMultiplier[slot]; }
+    float getDefenseMultiplier() const { return CellStore::instance().defenseMultiplier[slot]; }
+    float getSpeedMultiplier() const { return CellStore::instance().speedMultiplier[slot]; }
+    float getSharpnessMultiplier() const { return CellStore::instance().sharpnessMultiplier[slot]; }
     
     // 为了允许drawing.cpp访问
     friend void drawCell(cv::Mat& canvas, const BaseCell& cell, const std::map<std::string, float>& config, float scale, float time);
     // 为了允许physics.cpp中的函数访问
-    friend void createBloodEffect(BaseCell& cell, const cv::Point2f& hitPosition, bool faceRight, const cv::Point2f& spearTipPosition);
     friend void handleCellCollision(BaseCell& cell1, BaseCell& cell2, GameConfig& config);
+    // 槽位搬移时由CellStore更新slot
+    friend class CellStore;
     
 protected:
-    cv::Point2f position;
-    cv::Point2f velocity;
-    cv::Point2f acceleration;
-    bool faceRight;
+    // 在CellStore中的槽位，热数据都按此下标存取
+    int slot;
+    
     int playerNumber;
     cv::Vec3b color;
     float tailPhaseOffset;
     float aggressionLevel;
     
-    float health;
-    float maxHealth;
-    bool isAttackingFlag;
-    float attackTimeValue;
-    
-    bool isShieldingFlag;
-    float shieldTimeValue;
-    bool hasParriedFlag;
-    float parryTimeValue;
-    float shieldDurationValue;
-    float shieldCooldownTimeValue;
-    float damageReductionValue;
-    
-    std::vector<BloodDrop> bloodDrops;
-    
     // 基因和阵营属性
-    const std::string gene;
+    const Gene gene;
     int faction;
-    float sizeMultiplier;
-    float sharpnessMultiplier;
-    float speedMultiplier;
-    float attackMultiplier;
-    float defenseMultiplier;
+    
+    uint32_t networkId;
     
     // 内部辅助方法
-    void updatePhysics(float deltaTime, float maxSpeed, float drag, const cv::Size& canvasSize);
-    void updateShieldState(float deltaTime);
     void parseGene();
     void updateColorByFaction();
     
-    // 修改基因突变辅助函数生成更杂乱的字符串
-    static std::string mutateGene(const std::string& parentGene1, const std::string& parentGene2);
-    static char mutateGeneChar(char c);
-    static std::string generateRandomGene(int length = 16);
-    static std::mt19937& getRandomEngine();
+    static Pcg32& getRandomEngine();
     
     // 从杂乱基因中提取属性的辅助方法
-    float extractGeneAttribute(const std::string& geneStr, int startIndex, int length) const;
+    float extractGeneAttribute(const Gene& geneStr, int startIndex, int length) const;
 };
 
 #endif // BASE_CELL_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "Gene.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+// x86-64默认具备SSE2，相似度比较据此选择向量化路径
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GENE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 基因字符集
+const char charset[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789!@#$%^&*()-_=+";
+
+const int charsetSize = sizeof(charset) - 1;
+
+char randomChar(Pcg32& gen) {
+    return charset[gen.uniformInt(0, charsetSize - 1)];
+}
+
+} // namespace
+
+Gene::Gene() {
+    std::memset(chars, 0, LENGTH);
+}
+
+Gene::Gene(const std::string& text) {
+    if (text.empty()) {
+        std::memset(chars, 0, LENGTH);
+        return;
+    }
+    for (size_t i = 0; i < LENGTH; ++i) {
+        chars[i] = text[i % text.size()];
+    }
+}
+
+Gene Gene::random(Pcg32& gen) {
+    Gene gene;
+    for (size_t i = 0; i < LENGTH; ++i) {
+        gene.chars[i] = randomChar(gen);
+    }
+    return gene;
+}
+
+Gene Gene::mix(const Gene& parent1, const Gene& parent2, Pcg32& gen) {
+    Gene gene;
+    for (size_t i = 0; i < LENGTH; ++i) {
+        // 60%概率从父母继承，40%概率变异
+        if (gen.chance(0.6f)) {
+            gene.chars[i] = gen.chance(0.5f) ? parent1.chars[i] : parent2.chars[i];
+        } else {
+            gene.chars[i] = randomChar(gen);
+        }
+    }
+    return gene;
+}
+
+float Gene::similarity(const Gene& other) const {
+    if (empty() || other.empty()) {
+        return 0.0f;
+    }
+
+#ifdef GENE_SSE2
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(chars));
+    __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.chars));
+    unsigned int equalMask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    int matches = std::popcount(equalMask);
+#else
+    // 按8字节一组异或，相同的字节为0，再统计为0的字节数
+    int matches = 0;
+    for (size_t offset = 0; offset < LENGTH; offset += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, chars + offset, 8);
+        std::memcpy(&y, other.chars + offset, 8);
+        uint64_t diff = x ^ y;
+        // 每个字节非0时置最高位
+        uint64_t nonZero = ((diff & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | diff;
+        matches += 8 - std::popcount(nonZero & 0x8080808080808080ULL);
+    }
+#endif
+    return static_cast<float>(matches) / LENGTH;
+}
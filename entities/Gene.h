@@ -0,0 +1,37 @@
+#ifndef GENE_H
+#define GENE_H
+
+#include <cstddef>
+#include <string>
+#include "../simulation/Random.h"
+
+// 定长基因：16个字符内联存放在细胞对象里，不再单独分配字符串
+// 相似度用一次16字节比较加popcount算出；繁殖时直接在定长数组上混合和变异
+class Gene {
+public:
+    static constexpr size_t LENGTH = 16;
+
+    // 默认构造得到空基因（全0），细胞构造时遇到空基因会随机生成
+    Gene();
+    // 从字符串构造，超出部分截断，不足部分按原字符串循环补齐
+    explicit Gene(const std::string& text);
+
+    static Gene random(Pcg32& gen);
+    // 逐位点60%概率从父母中随机继承一个，否则随机变异
+    static Gene mix(const Gene& parent1, const Gene& parent2, Pcg32& gen);
+
+    // 相同位点字符相同的比例 (0-1)，任一方为空时返回0
+    float similarity(const Gene& other) const;
+
+    bool empty() const { return chars[0] == '\0'; }
+    size_t size() const { return LENGTH; }
+    char operator[](size_t i) const { return chars[i]; }
+    const char* begin() const { return chars; }
+    const char* end() const { return chars + LENGTH; }
+    std::string toString() const { return std::string(chars, LENGTH); }
+
+private:
+    alignas(16) char chars[LENGTH];
+};
+
+#endif // GENE_H
@@ -2,7 +2,7 @@
 #include <algorithm>
 
 PlayerCell::PlayerCell(const cv::Point2f& pos, int playerNum, const cv::Vec3b& baseColor,
-                      float phaseOffset, float aggression, const std::string& cellGene)
+                      float phaseOffset, float aggression, const Gene& cellGene)
     : BaseCell(pos, playerNum, baseColor, phaseOffset, aggression, cellGene) {
 }
 
@@ -19,23 +19,23 @@ PlayerCell::PlayerCell(const cv::Point2f& pos, int playerNum)
 
 void PlayerCell::moveUp(float accelerationStep) {
     // 应用基因对移动速度的影响 - 使用平方关系增强效果
-    applyAcceleration(cv::Point2f(0, -accelerationStep * std::pow(speedMultiplier, 1.5f)));
+    applyAcceleration(cv::Point2f(0, -accelerationStep * std::pow(getSpeedMultiplier(), 1.5f)));
 }
 
 void PlayerCell::moveDown(float accelerationStep) {
     // 应用基因对移动速度的影响 - 使用平方关系增强效果
-    applyAcceleration(cv::Point2f(0, accelerationStep * std::pow(speedMultiplier, 1.5f)));
+    applyAcceleration(cv::Point2f(0, accelerationStep * std::pow(getSpeedMultiplier(), 1.5f)));
 }
 
 void PlayerCell::moveLeft(float accelerationStep) {
     // 应用基因对移动速度的影响 - 使用平方关系增强效果
-    applyAcceleration(cv::Point2f(-accelerationStep * std::pow(speedMultiplier, 1.5f), 0));
+    applyAcceleration(cv::Point2f(-accelerationStep * std::pow(getSpeedMultiplier(), 1.5f), 0));
     setFacingRight(false);
 }
 
 void PlayerCell::moveRight(float accelerationStep) {
     // 应用基因对移动速度的影响 - 使用平方关系增强效果
-    applyAcceleration(cv::Point2f(accelerationStep * std::pow(speedMultiplier, 1.5f), 0));
+    applyAcceleration(cv::Point2f(accelerationStep * std::pow(getSpeedMultiplier(), 1.5f), 0));
     setFacingRight(true);
 }
 
@@ -57,7 +57,7 @@ void PlayerCell::toggleShield(float cooldown) {
         setShieldTime(0.0f);
     } else {
         // 放下盾牌时应用冷却时间，考虑防御基因
-        setShieldCooldownTime(cooldown / defenseMultiplier);
+        setShieldCooldownTime(cooldown / getDefenseMultiplier());
         
         // 如果正在攻击，取消攻击
         if (isAttacking()) {
@@ -69,10 +69,10 @@ void PlayerCell::toggleShield(float cooldown) {
 
 void PlayerCell::increaseAggression(float amount) {
     // 应用攻击基因对攻击性增长的影响
-    setAggressionLevel(std::min(1.0f, getAggressionLevel() + amount * attackMultiplier));
+    setAggressionLevel(std::min(1.0f, getAggressionLevel() + amount * getAttackMultiplier()));
 }
 
 void PlayerCell::decreaseAggression(float amount) {
     // 应用防御基因对攻击性降低的影响
-    setAggressionLevel(std::max(0.0f, getAggressionLevel() - amount * defenseMultiplier));
+    setAggressionLevel(std::max(0.0f, getAggressionLevel() - amount * getDefenseMultiplier()));
 }
\ No newline at end of file
@@ -8,7 +8,7 @@ class PlayerCell : public BaseCell {
 public:
     // 原始构造函数
     PlayerCell(const cv::Point2f& pos, int playerNum, const cv::Vec3b& baseColor,
-              float phaseOffset, float aggression = 0.0f, const std::string& cellGene = "");
+              float phaseOffset, float aggression = 0.0f, const Gene& cellGene = Gene());
     
     // 添加新的简化构造函数，只需要位置和玩家编号
     PlayerCell(const cv::Point2f& pos, int playerNum);
@@ -3,12 +3,16 @@
 #include "../physics.h"
 #include "../entities/PlayerCell.h"
 #include "../entities/AICell.h"
+#include "../simulation/ParticleSystem.h"
+#include "../simulation/Random.h"
 #include <chrono>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <random>
 
-MultiPlayerGame::MultiPlayerGame()
-    : running(true), canvasSize(800, 600), scale(0.4f),
+MultiPlayerGame::MultiPlayerGame(uint64_t worldSeed)
+    : running(true), canvasSize(800, 600), scale(0.4f), simTick(0),
       startTime(std::chrono::high_resolution_clock::now()),
       lastUpdateTime(startTime),
       lastNetworkUpdateTime(startTime),
@@ -19,8 +23,18 @@ MultiPlayerGame::MultiPlayerGame()
       remotePlayer(nullptr),
       windowTitle("多细胞网络对战") {
     
-    // 初始化游戏配置
+    // 初始化游戏配置，外部指定的种子优先
     initializeConfig();
+    if (worldSeed != 0) {
+        gameConfig.worldSeed = worldSeed;
+    }
+    
+    // 模拟以固定步长推进，deltaTime即每步的时长
+    simClock.setTickRate(gameConfig.tickRate);
+    deltaTime = simClock.getTickDelta();
+    
+    // 逐实体更新阶段的线程池
+    threadPool = std::make_unique<ThreadPool>(gameConfig.workerThreads);
     
     // 加载资源
     loadShieldImage();
@@ -47,22 +61,15 @@ bool MultiPlayerGame::initialize(NetGameMode mode, const std::string& serverIP,
         windowTitle = "多细胞网络对战 - 客户端模式";
     }
     
-    // 创建玩家
-    createPlayers();
-    
-    // 创建AI细胞（只在服务器或单机模式下创建）
-    if (gameMode == NetGameMode::SERVER || gameMode == NetGameMode::STANDALONE) {
-        createAICells();
-    }
+    // 创建玩家和AI细胞
+    createWorld();
     
     // 如果是网络模式，初始化网络
     if (mode != NetGameMode::STANDALONE) {
         networkInitialized = networkManager->initialize();
         
-        // 设置消息回调
-        networkManager->setMessageCallback([this](const NetworkMessage& msg) {
-            this->onNetworkMessage(msg);
-        });
+        // 收到的消息只在游戏线程上从接收队列取出处理（processNetworkMessages），不注册在I/O线程上执行的回调，
+        // 否则每条消息会被处理两次，且与模拟并发修改玩家
         
         // 如果是服务器，开始监听
         if (mode == NetGameMode::SERVER && networkInitialized) {
@@ -90,30 +97,111 @@ bool MultiPlayerGame::initialize(NetGameMode mode, const std::string& serverIP,
     return true;
 }
 
+void MultiPlayerGame::createWorld() {
+    // 固定世界种子后再创建实体，相同种子得到相同的初始世界和AI行为
+    gameConfig.worldSeed = Random::beginWorld(gameConfig.worldSeed);
+    
+    // 创建玩家
+    createPlayers();
+    
+    // 创建AI细胞（只在服务器或单机模式下创建）
+    if (gameMode == NetGameMode::SERVER || gameMode == NetGameMode::STANDALONE) {
+        createAICells();
+    }
+}
+
+void MultiPlayerGame::startRecording(const std::string& path) {
+    recording = std::make_unique<ReplayLog>();
+    recording->game = "multi";
+    recording->mode = static_cast<int>(gameMode);
+    recording->seed = gameConfig.worldSeed;
+    recording->tickRate = simClock.getTickRate();
+    recordPath = path;
+}
+
+bool MultiPlayerGame::runReplay(const ReplayLog& log) {
+    // 以录制时的模式离线重建世界，不建立网络连接，收到的网络消息按录像重放
+    gameMode = static_cast<NetGameMode>(log.mode);
+    createWorld();
+    
+    time = 0.0f;
+    deltaTime = 1.0f / log.tickRate;
+    ReplayCursor cursor(log);
+    
+    auto wallStart = std::chrono::high_resolution_clock::now();
+    
+    bool diverged = false;
+    while (simTick < log.tickCount && running) {
+        while (const ReplayLog::Event* event = cursor.takeEvent(simTick)) {
+            switch (event->type) {
+                case ReplayLog::EventType::KEY:
+                    applyKey(event->key);
+                    break;
+                case ReplayLog::EventType::NET_INPUT:
+                    handlePlayerInputMessage(NetworkSerializer::deserializePlayerInput(event->payload));
+                    break;
+                case ReplayLog::EventType::NET_STATE:
+                    handlePlayerStateMessage(NetworkSerializer::deserializePlayerState(event->payload));
+                    break;
+                case ReplayLog::EventType::NET_JOIN:
+                    handlePlayerJoin(event->key);
+                    break;
+                case ReplayLog::EventType::NET_LEAVE:
+                    handlePlayerLeave(event->key);
+                    break;
+                case ReplayLog::EventType::NET_WORLD:
+                    handleWorldState(event->payload);
+                    break;
+            }
+        }
+        
+        time += deltaTime;
+        stepWorld();
+        
+        uint64_t expected = 0, actual = 0;
+        if (!cursor.verifyTick(simTick, expected, actual)) {
+            std::cerr << "回放在第" << simTick << "步出现分歧: 录制哈希 " << std::hex << expected
+                      << ", 当前哈希 " << actual << std::dec << std::endl;
+            diverged = true;
+            break;
+        }
+    }
+    
+    double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wallStart).count();
+    double ticksPerSecond = wallSeconds > 0.0 ? simTick / wallSeconds : 0.0;
+    
+    std::cout << "回放" << (diverged ? "中止" : "完成") << ": " << simTick << "/" << log.tickCount << " ticks, 墙钟时间 "
+              << wallSeconds << " s, " << ticksPerSecond << " ticks/s, 剩余实体 " << entities.size() << std::endl;
+    return !diverged;
+}
+
 void MultiPlayerGame::run() {
     while (running) {
         try {
-            // 计算帧时间
-            updateFrameTime();
+            // 计算帧时间，换算成本帧要执行的模拟步数
+            int ticks = updateFrameTime();
             
-            // 创建画布
-            cv::Mat canvas = cv::Mat(canvasSize, CV_8UC3, cv::Scalar(255, 255, 255));
+            // 取一块预分配的画布并清成白色背景
+            cv::Mat& canvas = frameBuffers.acquire(canvasSize);
             
             // 处理网络消息
             if (networkInitialized) {
                 processNetworkMessages();
             }
             
-            // 更新所有实体
-            updateEntities();
+            // 以固定步长推进世界状态，可能为0步或多步；负载高时少渲染而不拖慢模拟
+            for (int i = 0; i < ticks; ++i) {
+                stepWorld();
+            }
             
-            // 处理玩家攻击和碰撞检测
-            handleCombat();
+            // 渲染时在最近两个模拟步之间插值
+            CellStore::instance().setRenderAlpha(simClock.getAlpha());
             
             // 发送本地玩家状态（如果是网络模式）
             if (networkInitialized && localPlayer && 
                 std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - lastNetworkUpdateTime).count() >= networkUpdateInterval) {
                 sendPlayerState();
+                sendWorldState();
                 lastNetworkUpdateTime = std::chrono::high_resolution_clock::now();
             }
             
@@ -123,35 +211,8 @@ void MultiPlayerGame::run() {
             // 显示控制提示和网络状态
             displayControls(canvas);
             
-            // 显示游戏模式
-            std::string modeText;
-            if (gameMode == NetGameMode::SERVER) {
-                modeText = "服务器模式";
-                NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
-                if (server && server->hasClient()) {
-                    modeText += " - 客户端已连接";
-                } else {
-                    modeText += " - 等待客户端连接";
-                }
-            }
-            else if (gameMode == NetGameMode::CLIENT) {
-                modeText = "客户端模式";
-                NetworkClient* client = dynamic_cast<NetworkClient*>(networkManager.get());
-                if (client && client->isConnected()) {
-                    modeText += " - 已连接";
-                } else {
-                    modeText += " - 未连接";
-                }
-            }
-            else {
-                modeText = "单机模式";
-            }
-            
-            cv::putText(canvas, modeText,
-                       cv::Point(10, 90), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
-            
             // 显示画布
-            cv::imshow(windowTitle, canvas);
+            cv::imshow(windowTitle, frameBuffers.present());
             
             // 处理用户输入
             handleInput();
@@ -167,6 +228,13 @@ void MultiPlayerGame::run() {
     }
     
     cv::destroyAllWindows();
+    
+    if (recording) {
+        if (recording->save(recordPath)) {
+            std::cout << "录像已保存: " << recordPath << " (" << recording->tickCount << " ticks, 种子 "
+                      << recording->seed << ")" << std::endl;
+        }
+    }
 }
 
 void MultiPlayerGame::initializeConfig() {
@@ -174,6 +242,9 @@ void MultiPlayerGame::initializeConfig() {
     gameConfig.maxSpeed = 6.0f;
     gameConfig.accelerationStep = 0.7f;
     gameConfig.drag = 0.94f;
+    gameConfig.tickRate = 60.0f;
+    gameConfig.workerThreads = 0;
+    gameConfig.worldSeed = 0;
     gameConfig.numCells = 20;
     gameConfig.scale = 0.4f;
 
@@ -236,8 +307,7 @@ void MultiPlayerGame::createPlayers() {
 
 void MultiPlayerGame::createAICells() {
     // 创建AI细胞
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    Pcg32& gen = Random::world();
     std::uniform_real_distribution<float> xDist(50.0f, canvasSize.width - 50.0f);
     std::uniform_real_distribution<float> yDist(50.0f, canvasSize.height - 50.0f);
     std::uniform_real_distribution<float> phaseDist(0.0f, 2.0f * 3.14159f);
@@ -254,25 +324,60 @@ void MultiPlayerGame::createAICells() {
     }
 }
 
-void MultiPlayerGame::updateFrameTime() {
+int MultiPlayerGame::updateFrameTime() {
     auto currentTime = std::chrono::high_resolution_clock::now();
-    deltaTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
+    float frameTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
     lastUpdateTime = currentTime;
     time = std::chrono::duration<float>(currentTime - startTime).count();
     
-    // 限制deltaTime，防止过大的时间步长
-    deltaTime = std::min(deltaTime, 0.1f);
+    // 真实帧时间只用于累加，模拟始终以固定的deltaTime推进；单帧追赶步数由调度器限制
+    return simClock.advance(frameTime);
 }
 
-void MultiPlayerGame::updateEntities() {
+void MultiPlayerGame::stepWorld() {
+    // 保存上一步的位置，供渲染插值
+    CellStore::instance().savePreviousPositions();
+    
     // 更新所有实体
+    updateEntities();
+    
+    // 处理玩家攻击和碰撞检测
+    handleCombat();
+    
+    ++simTick;
+    if (recording) {
+        recording->recordTick(simTick);
+    }
+}
+
+void MultiPlayerGame::updateEntities() {
+    // 逐实体阶段只读写实体自身的状态，分块并行执行，每个parallelFor返回即为一道屏障
+    const size_t grainSize = 256;
+    threadPool->parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            entities[i]->updateBehavior(deltaTime, gameConfig);
+        }
+    });
+    
+    // 物理、攻击动画和盾牌状态由CellStore按槽位区间并行推进
+    CellStore::instance().step(deltaTime, gameConfig, canvasSize, *threadPool);
+    
+    // 血滴粒子由世界级粒子池统一推进，与细胞是否存活无关
+    ParticleSystem::instance().update(deltaTime);
+    
+    // 移除死亡实体会改变entities，在屏障之后串行处理
     for (auto it = entities.begin(); it != entities.end();) {
-        (*it)->update(deltaTime, gameConfig, canvasSize);
-        
         // 如果实体不存活，移除它
         if (!(*it)->isAlive()) {
             // 检查是否是玩家，如果是则不移除
             if (std::find(playerCells.begin(), playerCells.end(), it->get()) == playerCells.end()) {
+                // 客户端上由快照创建的细胞同时移出映射，之后的快照写到它时会重新创建
+                for (auto cell = worldCells.begin(); cell != worldCells.end(); ++cell) {
+                    if (cell->second == it->get()) {
+                        worldCells.erase(cell);
+                        break;
+                    }
+                }
                 it = entities.erase(it);
             } else {
                 // 如果是玩家，则重置它的位置和状态
@@ -288,6 +393,9 @@ void MultiPlayerGame::updateEntities() {
         }
     }
     
+    // 位置已更新完毕，重建本帧共用的空间索引
+    rebuildSpatialIndex();
+    
     // 检查细胞繁殖
     checkCellReproduction();
 }
@@ -299,59 +407,82 @@ void MultiPlayerGame::checkCellReproduction() {
     }
     
     // 简单的繁殖逻辑：当两个AI细胞靠近时可能会繁殖
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> chanceDist(0.0f, 1.0f);
+    Pcg32& gen = Random::world();
     
-    for (size_t i = 0; i < entities.size(); ++i) {
+    // 繁殖距离上限取决于最大的细胞尺寸，先求出查询半径
+    float maxSizeMultiplier = 0.0f;
+    for (const auto& entity : entities) {
+        AICell* cell = dynamic_cast<AICell*>(entity.get());
+        if (cell && cell->getPlayerNumber() == 0) {
+            maxSizeMultiplier = std::max(maxSizeMultiplier, cell->getSizeMultiplier());
+        }
+    }
+    if (maxSizeMultiplier <= 0.0f) return;
+    
+    // 只检查空间索引给出的足够近的细胞对，本帧新生的后代下一帧才参与繁殖
+    spatialIndex.findPairsWithin(maxSizeMultiplier * 2.0f * 30.0f, neighborPairs);
+    
+    int bredIndex = -1;
+    for (const auto& pair : neighborPairs) {
         if (entities.size() >= 50) break; // 限制最大实体数量
+        if (pair.first == bredIndex) continue; // 每个细胞每次检查只繁殖一次
         
         // 只有AI细胞可以繁殖
-        AICell* cell1 = dynamic_cast<AICell*>(entities[i].get());
+        AICell* cell1 = dynamic_cast<AICell*>(entities[pair.first].get());
         if (!cell1 || cell1->getPlayerNumber() > 0) continue;
+        AICell* cell2 = dynamic_cast<AICell*>(entities[pair.second].get());
+        if (!cell2 || cell2->getPlayerNumber() > 0) continue;
         
-        for (size_t j = i + 1; j < entities.size(); ++j) {
-            AICell* cell2 = dynamic_cast<AICell*>(entities[j].get());
-            if (!cell2 || cell2->getPlayerNumber() > 0) continue;
-            
-            // 检查距离
-            float distance = cv::norm(cell1->getPosition() - cell2->getPosition());
-            float combinedSize = (cell1->getSizeMultiplier() + cell2->getSizeMultiplier()) * 30.0f;
-            
-            if (distance < combinedSize) {
-                // 繁殖几率
-                float breedChance = 0.001f;  // 每帧0.1%的繁殖几率
-                if (chanceDist(gen) < breedChance) {
-                    // 创建后代
-                    BaseCell* offspring = BaseCell::createOffspring(*cell1, *cell2, canvasSize);
-                    if (offspring) {
-                        auto newCell = std::shared_ptr<BaseCell>(offspring);
-                        entities.push_back(newCell);
-                        break; // 每个细胞每次检查只繁殖一次
-                    }
+        // 检查距离
+        float distance = cv::norm(cell1->getPosition() - cell2->getPosition());
+        float combinedSize = (cell1->getSizeMultiplier() + cell2->getSizeMultiplier()) * 30.0f;
+        
+        if (distance < combinedSize) {
+            // 繁殖几率
+            float breedChance = 0.001f;  // 每帧0.1%的繁殖几率
+            if (gen.chance(breedChance)) {
+                // 创建后代
+                BaseCell* offspring = BaseCell::createOffspring(*cell1, *cell2, canvasSize);
+                if (offspring) {
+                    entities.push_back(std::shared_ptr<BaseCell>(offspring));
+                    bredIndex = pair.first;
                 }
             }
         }
     }
 }
 
+void MultiPlayerGame::rebuildSpatialIndex() {
+    // 以细胞宽度为格子尺寸
+    spatialIndex.build(entities, cellConfig.at("cell_width") * gameConfig.scale);
+}
+
 void MultiPlayerGame::handleCombat() {
+    // 空间索引已在updateEntities中重建，每个攻击者只检查矛尖附近的实体
+    float cellWidth = cellConfig.at("cell_width");
+    float hitRadius = spearHitRadius(gameConfig.scale, cellWidth);
+    
+    // 攻击者直接从CellStore的标志和攻击进度数组中筛选（前刺阶段），按槽位顺序处理
+    CellStore::instance().collectAttackers(combatAttackers);
+    
     // 检查攻击碰撞
-    for (auto& attacker : entities) {
-        // 只有正在攻击的细胞才能造成伤害
-        if (attacker->isAttacking()) {
-            for (auto& target : entities) {
-                // 不能攻击自己
-                if (attacker.get() == target.get()) continue;
-                
-                // 检查是否命中
-                cv::Point2f hitPosition;
-                cv::Point2f spearTipPosition;
-                if (checkSpearCollision(*attacker, *target, gameConfig.scale, 
-                                      cellConfig.at("cell_width"), hitPosition, spearTipPosition)) {
-                    // 处理命中效果
-                    handleHit(attacker.get(), target.get(), hitPosition, spearTipPosition);
-                }
+    for (BaseCell* attacker : combatAttackers) {
+        cv::Point2f spearTip = computeSpearTip(*attacker, gameConfig.scale);
+        spatialIndex.queryRadius(spearTip, hitRadius, neighborCandidates);
+        
+        for (int index : neighborCandidates) {
+            auto& target = entities[index];
+            
+            // 不能攻击自己
+            if (attacker == target.get()) continue;
+            
+            // 检查是否命中
+            cv::Point2f hitPosition;
+            cv::Point2f spearTipPosition;
+            if (checkSpearCollision(*attacker, *target, gameConfig.scale, 
+                                  cellWidth, hitPosition, spearTipPosition)) {
+                // 处理命中效果
+                handleHit(attacker, target.get(), hitPosition, spearTipPosition);
             }
         }
     }
@@ -360,6 +491,12 @@ void MultiPlayerGame::handleCombat() {
 void MultiPlayerGame::handleHit(BaseCell* attacker, BaseCell* target, 
                             const cv::Point2f& hitPosition, 
                             const cv::Point2f& spearTipPosition) {
+    // 客户端上的非玩家细胞由服务器快照驱动，本地只播放血滴，伤害、击退和格挡以服务器为准
+    if (gameMode == NetGameMode::CLIENT && target->getPlayerNumber() == 0) {
+        createBloodEffect(hitPosition, attacker->isFacingRight(), spearTipPosition);
+        return;
+    }
+    
     bool perfectParry = false;
     
     // 计算阵营倍率 - 同一阵营伤害降低，不同阵营伤害提高
@@ -398,7 +535,7 @@ void MultiPlayerGame::handleHit(BaseCell* attacker, BaseCell* target,
             
             // 创建小规模的血液效果
             cv::Point2f reducedHitPos = target->getPosition();
-            createBloodEffect(*target, reducedHitPos, attacker->isFacingRight(), spearTipPosition);
+            createBloodEffect(reducedHitPos, attacker->isFacingRight(), spearTipPosition);
         }
     } else {
         // 直接命中，没有格挡
@@ -412,7 +549,7 @@ void MultiPlayerGame::handleHit(BaseCell* attacker, BaseCell* target,
         target->takeDamage(damage);
         
         // 创建血液效果
-        createBloodEffect(*target, hitPosition, attacker->isFacingRight(), spearTipPosition);
+        createBloodEffect(hitPosition, attacker->isFacingRight(), spearTipPosition);
         
         // 添加击退效果
         float knockbackStrength = 5.0f * attacker->getSizeMultiplier();
@@ -427,62 +564,101 @@ void MultiPlayerGame::renderEntities(cv::Mat& canvas) {
     for (auto& entity : entities) {
         entity->render(canvas, cellConfig, scale, time);
     }
+    
+    // 血滴由粒子池统一绘制，已被移除的细胞留下的血滴也会播放完
+    drawBloodDrops(canvas, ParticleSystem::instance());
 }
 
 void MultiPlayerGame::displayControls(cv::Mat& canvas) {
+    // 文字缓存在HUD层里，只有键变化的行才重新构造字符串和光栅化
+    hud.beginFrame();
+    
     // Display control instructions with unified control scheme
     if (gameMode == NetGameMode::SERVER || gameMode == NetGameMode::STANDALONE) {
-        cv::putText(canvas,
-                   "Player 1 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression",
-                   cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(0, 0, cv::Point(10, 30), TextStyle(0.5), [] {
+            return std::string("Player 1 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression");
+        });
     }
     
     if (gameMode == NetGameMode::CLIENT) {
-        cv::putText(canvas,
-                   "Player 2 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression",
-                   cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(0, 1, cv::Point(10, 30), TextStyle(0.5), [] {
+            return std::string("Player 2 (Local): WASD to move, J to attack, K to defend, Q/E to adjust aggression");
+        });
     }
-    
-    // 显示盾牌状态
+
+    // 显示盾牌状态，剩余时间按0.1秒分档
     for (int i = 0; i < playerCells.size() && i < 2; i++) {
-        std::string shieldStatus;
         auto player = playerCells[i];
+        float remainingTime = player->getShieldDuration() - player->getShieldTime();
+        bool inParryWindow = player->getShieldTime() < gameConfig.parryWindowDuration;
+        int state = player->isShielding() ? 1 : (player->getShieldCooldownTime() > 0 ? 2 : 0);
+        int tenths = state == 1 ? int(remainingTime * 10) : (state == 2 ? int(player->getShieldCooldownTime() * 10) : 0);
+        uint64_t key = HudLayer::mixKey(HudLayer::mixKey(state, tenths), state == 1 && inParryWindow);
         
-        if (player->isShielding()) {
-            float remainingTime = player->getShieldDuration() - player->getShieldTime();
-            shieldStatus = "Shield: " + std::to_string(int(remainingTime * 10) / 10.0) + "s";
-            if (player->getShieldTime() < gameConfig.parryWindowDuration) {
-                shieldStatus += " (PERFECT PARRY)";
+        hud.setLine(2 + i, key, cv::Point(10, 70 + i*20), TextStyle(0.4), [&] {
+            std::string shieldStatus;
+            if (state == 1) {
+                shieldStatus = "Shield: " + std::to_string(tenths / 10.0) + "s";
+                if (inParryWindow) {
+                    shieldStatus += " (PERFECT PARRY)";
+                }
+            } else if (state == 2) {
+                shieldStatus = "Shield CD: " + std::to_string(tenths / 10.0) + "s";
+            } else {
+                shieldStatus = "Shield Ready";
             }
-        } else if (player->getShieldCooldownTime() > 0) {
-            shieldStatus = "Shield CD: " + std::to_string(int(player->getShieldCooldownTime() * 10) / 10.0) + "s";
-        } else {
-            shieldStatus = "Shield Ready";
-        }
-        
-        cv::putText(canvas, shieldStatus, 
-                  cv::Point(10, 70 + i*20), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            return shieldStatus;
+        });
     }
     
-    // 显示基因和阵营信息
+    // 显示游戏模式和连接状态
+    bool connected = false;
+    size_t clients = 0;
+    if (gameMode == NetGameMode::SERVER) {
+        NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
+        clients = server ? server->sessionCount() : 0;
+        connected = clients > 0;
+    }
+    else if (gameMode == NetGameMode::CLIENT) {
+        NetworkClient* client = dynamic_cast<NetworkClient*>(networkManager.get());
+        connected = client && client->isConnected();
+    }
+    uint64_t modeKey = HudLayer::mixKey(HudLayer::mixKey(static_cast<int>(gameMode), connected), clients);
+    hud.setLine(4, modeKey, cv::Point(10, 90), TextStyle(0.4), [&] {
+        std::string modeText;
+        if (gameMode == NetGameMode::SERVER) {
+            modeText = "服务器模式";
+            modeText += connected ? " - " + std::to_string(clients) + "个客户端已连接" : " - 等待客户端连接";
+        }
+        else if (gameMode == NetGameMode::CLIENT) {
+            modeText = "客户端模式";
+            modeText += connected ? " - 已连接" : " - 未连接";
+        }
+        else {
+            modeText = "单机模式";
+        }
+        return modeText;
+    });
+    
+    // 显示基因和阵营信息，键取基因字符和阵营
     for (int i = 0; i < playerCells.size() && i < 2; i++) {
         auto player = playerCells[i];
+        uint64_t key = static_cast<uint64_t>(player->getFaction());
+        for (char c : player->getGene()) {
+            key = HudLayer::mixKey(key, static_cast<unsigned char>(c));
+        }
         
-        // 显示基因信息
-        std::string geneInfo = "玩家 " + std::to_string(i+1) + 
-                               " 基因: " + player->getGene() + 
-                               " 阵营: " + std::to_string(player->getFaction());
-        
-        cv::putText(canvas, geneInfo, 
-                   cv::Point(10, 130 + i*20), cv::FONT_HERSHEY_SIMPLEX, 
-                   0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+        hud.setLine(5 + i, key, cv::Point(10, 130 + i*20), TextStyle(0.4), [&] {
+            return "玩家 " + std::to_string(i+1) + " 基因: " + player->getGene().toString() + " 阵营: " + std::to_string(player->getFaction());
+        });
     }
     
     // 显示实体数量
-    std::string entitiesInfo = "实体数量: " + std::to_string(entities.size());
-    cv::putText(canvas, entitiesInfo, 
-               cv::Point(10, 170), cv::FONT_HERSHEY_SIMPLEX, 
-               0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+    hud.setLine(7, entities.size(), cv::Point(10, 170), TextStyle(0.4), [&] {
+        return "实体数量: " + std::to_string(entities.size());
+    });
+    
+    hud.composite(canvas);
 }
 
 void MultiPlayerGame::handleInput() {
@@ -492,9 +668,21 @@ void MultiPlayerGame::handleInput() {
         running = false;
         return;
     }
+    if (key < 0) return;
     
+    // 录制时记下按键和施加时已完成的模拟步数
+    if (recording) {
+        recording->recordKey(simTick, key);
+    }
+    applyKey(key);
+}
+
+void MultiPlayerGame::applyKey(int key) {
     // 记录输入状态
     PlayerInputMessage inputMsg;
+    if (localPlayer) {
+        inputMsg.playerNumber = localPlayer->getPlayerNumber();
+    }
     
     // 根据游戏模式处理输入
     if (gameMode == NetGameMode::SERVER || gameMode == NetGameMode::CLIENT) {
@@ -612,19 +800,109 @@ void MultiPlayerGame::processNetworkMessages() {
 void MultiPlayerGame::onNetworkMessage(const NetworkMessage& msg) {
     if (!networkInitialized) return;
     
+    NetworkServer* server = gameMode == NetGameMode::SERVER ? dynamic_cast<NetworkServer*>(networkManager.get()) : nullptr;
+    // 服务器上按发送方会话找到它的玩家，未分配玩家的会话发来的消息直接丢弃
+    int sessionPlayer = 0;
+    if (server) {
+        auto it = sessionPlayers.find(msg.sessionId);
+        sessionPlayer = it != sessionPlayers.end() ? it->second : 0;
+    }
+    
     switch (msg.type) {
+        case MessageType::CONNECT_REQUEST: {
+            // 服务器上的新会话：分配玩家编号并告诉该客户端
+            if (!server || sessionPlayer != 0) break;
+            int playerNumber = allocatePlayerNumber();
+            sessionPlayers[msg.sessionId] = playerNumber;
+            std::vector<uint8_t> data = {static_cast<uint8_t>(playerNumber & 0xFF), static_cast<uint8_t>((playerNumber >> 8) & 0xFF)};
+            server->sendTo(msg.sessionId, NetworkMessage(MessageType::CONNECT_ACCEPT, data));
+            worldEncoders.emplace(msg.sessionId, WorldStateEncoder());
+            if (recording) {
+                recording->recordPlayer(simTick, ReplayLog::EventType::NET_JOIN, playerNumber);
+            }
+            handlePlayerJoin(playerNumber);
+            std::cout << "会话" << msg.sessionId << "加入，分配为玩家" << playerNumber << std::endl;
+            break;
+        }
+        case MessageType::CONNECT_ACCEPT: {
+            // 客户端得知自己的玩家编号
+            if (gameMode != NetGameMode::CLIENT || msg.data.size() < 2) break;
+            int playerNumber = msg.data[0] | (msg.data[1] << 8);
+            if (recording) {
+                recording->recordPlayer(simTick, ReplayLog::EventType::NET_JOIN, playerNumber);
+            }
+            handlePlayerJoin(playerNumber);
+            break;
+        }
+        case MessageType::DISCONNECT: {
+            int playerNumber = 0;
+            if (server) {
+                // 会话断开：释放它的玩家编号，并通知其他客户端移除该玩家
+                if (sessionPlayer == 0) break;
+                playerNumber = sessionPlayer;
+                sessionPlayers.erase(msg.sessionId);
+                worldEncoders.erase(msg.sessionId);
+                std::vector<uint8_t> data = {static_cast<uint8_t>(playerNumber & 0xFF), static_cast<uint8_t>((playerNumber >> 8) & 0xFF)};
+                server->sendMessage(NetworkMessage(MessageType::DISCONNECT, data));
+                std::cout << "会话" << msg.sessionId << "离开，玩家" << playerNumber << "退出" << std::endl;
+            }
+            else if (msg.data.size() >= 2) {
+                playerNumber = msg.data[0] | (msg.data[1] << 8);
+            }
+            if (playerNumber == 0) break;
+            if (recording) {
+                recording->recordPlayer(simTick, ReplayLog::EventType::NET_LEAVE, playerNumber);
+            }
+            handlePlayerLeave(playerNumber);
+            break;
+        }
         case MessageType::PLAYER_INPUT: {
-            // 解析玩家输入
+            // 解析玩家输入；服务器以会话的玩家编号为准，录下的是改写编号后的数据
             PlayerInputMessage inputMsg = NetworkSerializer::deserializePlayerInput(msg.data);
+            if (server) {
+                if (sessionPlayer == 0) break;
+                inputMsg.playerNumber = sessionPlayer;
+            }
+            if (recording) {
+                recording->recordMessage(simTick, ReplayLog::EventType::NET_INPUT,
+                                         server ? NetworkSerializer::serializePlayerInput(inputMsg) : msg.data);
+            }
             handlePlayerInputMessage(inputMsg);
             break;
         }
         case MessageType::PLAYER_STATE: {
-            // 解析玩家状态
+            // 解析玩家状态，编号的处理同上
             PlayerStateMessage stateMsg = NetworkSerializer::deserializePlayerState(msg.data);
+            if (server) {
+                if (sessionPlayer == 0) break;
+                stateMsg.playerNumber = sessionPlayer;
+            }
+            if (recording) {
+                recording->recordMessage(simTick, ReplayLog::EventType::NET_STATE,
+                                         server ? NetworkSerializer::serializePlayerState(stateMsg) : msg.data);
+            }
             handlePlayerStateMessage(stateMsg);
             break;
         }
+        case MessageType::GAME_STATE: {
+            if (server) {
+                // 客户端对快照的确认
+                uint32_t sequence = 0;
+                auto it = worldEncoders.find(msg.sessionId);
+                if (it != worldEncoders.end() && worldstate::decodeAck(msg.data, sequence)) {
+                    it->second.acknowledge(sequence);
+                }
+                break;
+            }
+            // 快照会创建和更新细胞，录下原始数据，回放时按同样的顺序解码
+            if (recording) {
+                recording->recordMessage(simTick, ReplayLog::EventType::NET_WORLD, msg.data);
+            }
+            if (handleWorldState(msg.data)) {
+                networkManager->sendMessage(NetworkMessage(MessageType::GAME_STATE, worldstate::encodeAck(worldDecoder.getSequence())));
+            }
+            break;
+        }
         // 处理其他类型的消息...
         default:
             break;
@@ -632,68 +910,61 @@ void MultiPlayerGame::onNetworkMessage(const NetworkMessage& msg) {
 }
 
 void MultiPlayerGame::handlePlayerInputMessage(const PlayerInputMessage& inputMsg) {
-    // 根据游戏模式应用输入
-    if (gameMode == NetGameMode::SERVER && remotePlayer) {
-        // 服务器接收到客户端输入，应用到玩家2
-        if (inputMsg.moveUp) {
-            remotePlayer->moveUp(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveDown) {
-            remotePlayer->moveDown(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveLeft) {
-            remotePlayer->moveLeft(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveRight) {
-            remotePlayer->moveRight(gameConfig.accelerationStep);
-        }
-        if (inputMsg.decreaseAggression) {
-            remotePlayer->decreaseAggression(0.1f);
-        }
-        if (inputMsg.increaseAggression) {
-            remotePlayer->increaseAggression(0.1f);
-        }
-        if (inputMsg.attack && !remotePlayer->isShielding()) {
-            remotePlayer->attack();
-        }
-        if (inputMsg.shield && remotePlayer->canToggleShield()) {
-            remotePlayer->toggleShield(gameConfig.shieldCooldown);
-        }
+    if (gameMode == NetGameMode::STANDALONE) return;
+    
+    // 带编号的输入作用于对应玩家，不带编号的作用于远程玩家（服务器上为玩家2，客户端上为玩家1）
+    PlayerCell* target = inputMsg.playerNumber > 0 ? findPlayer(inputMsg.playerNumber) : remotePlayer;
+    if (target && target != localPlayer) {
+        applyPlayerInput(*target, inputMsg);
     }
-    else if (gameMode == NetGameMode::CLIENT && remotePlayer) {
-        // 客户端接收到服务器输入，应用到玩家1
-        if (inputMsg.moveUp) {
-            remotePlayer->moveUp(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveDown) {
-            remotePlayer->moveDown(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveLeft) {
-            remotePlayer->moveLeft(gameConfig.accelerationStep);
-        }
-        if (inputMsg.moveRight) {
-            remotePlayer->moveRight(gameConfig.accelerationStep);
-        }
-        if (inputMsg.decreaseAggression) {
-            remotePlayer->decreaseAggression(0.1f);
-        }
-        if (inputMsg.increaseAggression) {
-            remotePlayer->increaseAggression(0.1f);
-        }
-        if (inputMsg.attack && !remotePlayer->isShielding()) {
-            remotePlayer->attack();
-        }
-        if (inputMsg.shield && remotePlayer->canToggleShield()) {
-            remotePlayer->toggleShield(gameConfig.shieldCooldown);
-        }
+}
+
+void MultiPlayerGame::applyPlayerInput(PlayerCell& player, const PlayerInputMessage& inputMsg) {
+    if (inputMsg.moveUp) {
+        player.moveUp(gameConfig.accelerationStep);
+    }
+    if (inputMsg.moveDown) {
+        player.moveDown(gameConfig.accelerationStep);
+    }
+    if (inputMsg.moveLeft) {
+        player.moveLeft(gameConfig.accelerationStep);
+    }
+    if (inputMsg.moveRight) {
+        player.moveRight(gameConfig.accelerationStep);
+    }
+    if (inputMsg.decreaseAggression) {
+        player.decreaseAggression(0.1f);
+    }
+    if (inputMsg.increaseAggression) {
+        player.increaseAggression(0.1f);
+    }
+    if (inputMsg.attack && !player.isShielding()) {
+        player.attack();
+    }
+    if (inputMsg.shield && player.canToggleShield()) {
+        player.toggleShield(gameConfig.shieldCooldown);
     }
 }
 
 void MultiPlayerGame::sendPlayerState() {
     if (!networkInitialized || !localPlayer) return;
     
+    NetworkServer* server = gameMode == NetGameMode::SERVER ? dynamic_cast<NetworkServer*>(networkManager.get()) : nullptr;
+    if (server) {
+        // 服务器把所有玩家的状态作为一批广播给每个客户端，客户端跳过自己的那条
+        stateBatch.clear();
+        for (PlayerCell* player : playerCells) {
+            PlayerStateMessage stateMsg = NetworkSerializer::getPlayerStateFromCell(*player);
+            stateMsg.playerNumber = player->getPlayerNumber();
+            stateBatch.emplace_back(MessageType::PLAYER_STATE, NetworkSerializer::serializePlayerState(stateMsg));
+        }
+        server->broadcast(stateBatch);
+        return;
+    }
+    
     // 获取本地玩家的状态
     PlayerStateMessage stateMsg = NetworkSerializer::getPlayerStateFromCell(*localPlayer);
+    stateMsg.playerNumber = localPlayer->getPlayerNumber();
     
     // 序列化状态消息
     std::vector<uint8_t> stateData = NetworkSerializer::serializePlayerState(stateMsg);
@@ -704,8 +975,129 @@ void MultiPlayerGame::sendPlayerState() {
 }
 
 void MultiPlayerGame::handlePlayerStateMessage(const PlayerStateMessage& stateMsg) {
-    if (!remotePlayer) return;
+    // 带编号的状态更新对应玩家，客户端第一次收到某个编号时创建该玩家；不带编号的更新远程玩家
+    PlayerCell* target = stateMsg.playerNumber > 0 ? findPlayer(stateMsg.playerNumber) : remotePlayer;
+    if (!target && gameMode == NetGameMode::CLIENT && stateMsg.playerNumber > 0) {
+        target = spawnPlayer(stateMsg.playerNumber);
+    }
+    if (!target || target == localPlayer) return;
+    
+    NetworkSerializer::applyPlayerStateToCell(*target, stateMsg);
+}
+
+void MultiPlayerGame::handlePlayerJoin(int playerNumber) {
+    if (gameMode == NetGameMode::CLIENT) {
+        // 服务器分配的编号与本机预设的玩家2不同时，改由该编号的玩家作为本地玩家，原来的玩家2留给对应的远程客户端
+        if (localPlayer && localPlayer->getPlayerNumber() == playerNumber) return;
+        PlayerCell* player = findPlayer(playerNumber);
+        localPlayer = player ? player : spawnPlayer(playerNumber);
+        std::cout << "服务器分配本机为玩家" << playerNumber << std::endl;
+        return;
+    }
+    
+    // 服务器上玩家1是本地玩家，玩家2在开局时就已创建，其余编号在加入时创建
+    if (!findPlayer(playerNumber)) {
+        spawnPlayer(playerNumber);
+    }
+}
+
+void MultiPlayerGame::handlePlayerLeave(int playerNumber) {
+    // 开局就有的两个玩家和本地玩家保留在世界中，与双人对战时客户端断开的表现一致
+    if (playerNumber <= 2 || (localPlayer && localPlayer->getPlayerNumber() == playerNumber)) return;
+    removePlayer(playerNumber);
+}
+
+int MultiPlayerGame::allocatePlayerNumber() const {
+    int playerNumber = 2;
+    while (true) {
+        bool used = false;
+        for (const auto& entry : sessionPlayers) {
+            if (entry.second == playerNumber) {
+                used = true;
+                break;
+            }
+        }
+        if (!used) return playerNumber;
+        ++playerNumber;
+    }
+}
+
+PlayerCell* MultiPlayerGame::findPlayer(int playerNumber) const {
+    for (PlayerCell* player : playerCells) {
+        if (player->getPlayerNumber() == playerNumber) return player;
+    }
+    return nullptr;
+}
+
+PlayerCell* MultiPlayerGame::spawnPlayer(int playerNumber) {
+    // 按黄金角把编号相邻的玩家分散在画布中心周围
+    float angle = playerNumber * 2.39996f;
+    float radius = 0.35f * std::min(canvasSize.width, canvasSize.height);
+    cv::Point2f position(canvasSize.width * 0.5f + radius * std::cos(angle),
+                         canvasSize.height * 0.5f + radius * std::sin(angle));
+    
+    auto player = std::make_shared<PlayerCell>(position, playerNumber);
+    entities.push_back(player);
+    playerCells.push_back(player.get());
+    return player.get();
+}
+
+void MultiPlayerGame::removePlayer(int playerNumber) {
+    PlayerCell* player = findPlayer(playerNumber);
+    if (!player) return;
+    
+    playerCells.erase(std::find(playerCells.begin(), playerCells.end(), player));
+    entities.erase(std::find_if(entities.begin(), entities.end(),
+                                [player](const std::shared_ptr<BaseCell>& entity) { return entity.get() == player; }));
+    if (remotePlayer == player) {
+        remotePlayer = nullptr;
+    }
+}
+
+void MultiPlayerGame::sendWorldState() {
+    if (gameMode != NetGameMode::SERVER || worldEncoders.empty()) return;
+    NetworkServer* server = dynamic_cast<NetworkServer*>(networkManager.get());
+    if (!server) return;
     
-    // 客户端收到服务器的状态更新，或服务器收到客户端的状态更新
-    NetworkSerializer::applyPlayerStateToCell(*remotePlayer, stateMsg);
+    // 非玩家细胞按创建顺序排列，编号已是升序；刚死亡、下一步才移除的细胞不再发送
+    worldCapture.clear();
+    for (const auto& entity : entities) {
+        if (entity->getPlayerNumber() > 0 || !entity->isAlive()) continue;
+        worldCapture.push_back(worldstate::capture(*entity));
+    }
+    
+    // 每个会话的基线不同，分别编码
+    for (auto& entry : worldEncoders) {
+        entry.second.encode(worldCapture, worldPayload);
+        server->sendTo(entry.first, NetworkMessage(MessageType::GAME_STATE, worldPayload));
+    }
+}
+
+bool MultiPlayerGame::handleWorldState(const std::vector<uint8_t>& data) {
+    if (gameMode != NetGameMode::CLIENT || !worldDecoder.decode(data)) return false;
+    
+    // 只改动本快照写到的实体；没写到的细胞保持本地外推的状态，而不是退回基线
+    for (const WorldStateDecoder::Change& change : worldDecoder.changes()) {
+        auto it = worldCells.find(change.id);
+        if (change.removed) {
+            if (it == worldCells.end()) continue;
+            BaseCell* cell = it->second;
+            entities.erase(std::find_if(entities.begin(), entities.end(),
+                                        [cell](const std::shared_ptr<BaseCell>& entity) { return entity.get() == cell; }));
+            worldCells.erase(it);
+            continue;
+        }
+        
+        const worldstate::EntityState* state = worldDecoder.find(change.id);
+        if (!state) continue;
+        if (it == worldCells.end()) {
+            // 解码出的世界总有完整的状态，即使本快照只写了部分字段也能创建
+            std::shared_ptr<BaseCell> cell = worldstate::createCell(*state);
+            worldCells[change.id] = cell.get();
+            entities.push_back(cell);
+        } else {
+            worldstate::applyFields(*it->second, *state, change.fields);
+        }
+    }
+    return true;
 }
@@ -2,12 +2,20 @@
 #define MULTI_PLAYER_GAME_H
 
 #include <opencv2/opencv.hpp>
+#include <map>
 #include <memory>
 #include <string>
 #include "../GameConfig.h"
+#include "../simulation/SpatialGrid.h"
+#include "../simulation/FixedTimestep.h"
+#include "../simulation/ThreadPool.h"
+#include "../rendering/FrameBuffers.h"
+#include "../rendering/HudLayer.h"
+#include "../simulation/ReplayLog.h"
 #include "../network/NetworkManager.h"
 #include "../network/NetworkServer.h"
 #include "../network/NetworkClient.h"
+#include "../network/WorldState.h"
 
 // 网络游戏模式
 enum class NetGameMode {
@@ -19,7 +27,8 @@ enum class NetGameMode {
 // 多人游戏类
 class MultiPlayerGame {
 public:
-    MultiPlayerGame();
+    // worldSeed为0时使用随机种子
+    explicit MultiPlayerGame(uint64_t worldSeed = 0);
     ~MultiPlayerGame();
     
     // 初始化网络游戏
@@ -28,16 +37,24 @@ public:
     // 运行游戏循环
     void run();
     
+    // 录制本地按键和收到的玩家输入/状态消息，run()结束时写入path；须在initialize之后调用
+    void startRecording(const std::string& path);
+    // 无头重放录像（代替initialize和run），游戏须以录像中的种子构造；状态哈希出现分歧时返回false
+    bool runReplay(const ReplayLog& log);
+    
 private:
     // 初始化方法
     void initializeConfig();
     void initializeNetworkManager();
     void createPlayers();
     void createAICells();
+    void createWorld();
     
     // 游戏循环方法
-    void updateFrameTime();
+    int updateFrameTime();
+    void stepWorld();
     void updateEntities();
+    void rebuildSpatialIndex();
     void handleCombat();
     void handleHit(BaseCell* attacker, BaseCell* target, 
                   const cv::Point2f& hitPosition, 
@@ -45,6 +62,7 @@ private:
     void renderEntities(cv::Mat& canvas);
     void displayControls(cv::Mat& canvas);
     void handleInput();
+    void applyKey(int key);
     
     // 网络相关方法
     void processNetworkMessages();
@@ -52,6 +70,23 @@ private:
     void sendPlayerState();
     void handlePlayerStateMessage(const PlayerStateMessage& stateMsg);
     void onNetworkMessage(const NetworkMessage& msg);
+    void applyPlayerInput(PlayerCell& player, const PlayerInputMessage& inputMsg);
+    
+    // 多客户端：服务器为每个会话分配一个玩家编号（从2起），客户端从CONNECT_ACCEPT得知自己的编号
+    // 加入和离开在实时游戏和回放中走同一路径，保证回放时实体的创建和移除与录制时一致
+    void handlePlayerJoin(int playerNumber);
+    void handlePlayerLeave(int playerNumber);
+    // 服务器上尚未分配给任何会话的最小玩家编号
+    int allocatePlayerNumber() const;
+    PlayerCell* findPlayer(int playerNumber) const;
+    // 在按编号确定的位置创建玩家
+    PlayerCell* spawnPlayer(int playerNumber);
+    void removePlayer(int playerNumber);
+    
+    // 世界快照：服务器按会话编码增量快照发出，客户端按快照创建、更新和移除非玩家细胞
+    void sendWorldState();
+    // 解码并应用一个快照，成功时返回true，调用方回送确认
+    bool handleWorldState(const std::vector<uint8_t>& data);
     
     // 检查和处理细胞繁殖
     void checkCellReproduction();
@@ -62,6 +97,7 @@ private:
     float scale;
     float time;
     float deltaTime;
+    uint64_t simTick;  // 已完成的模拟步数
     NetGameMode gameMode;
     
     // 配置
@@ -71,8 +107,44 @@ private:
     // 实体管理
     std::vector<std::shared_ptr<BaseCell>> entities;
     std::vector<PlayerCell*> playerCells; // 不拥有这些指针，只是便于访问
+    
+    // 空间索引，每帧实体更新后重建一次，战斗和繁殖等跨实体阶段共用
+    SpatialGrid spatialIndex;
+    std::vector<int> neighborCandidates;
+    std::vector<BaseCell*> combatAttackers;
+    std::vector<std::pair<int, int>> neighborPairs;
+    
     PlayerCell* localPlayer;   // 本地玩家
-    PlayerCell* remotePlayer;  // 远程玩家
+    PlayerCell* remotePlayer;  // 远程玩家，未带玩家编号的消息作用于它
+    
+    // 服务器上会话编号到玩家编号的映射
+    std::map<uint32_t, int> sessionPlayers;
+    // 服务器每次广播的玩家状态批，逐次复用
+    std::vector<NetworkMessage> stateBatch;
+    
+    // 服务器上每个会话的快照编码器，以及每次发送前量化一次、各会话共用的世界状态
+    std::map<uint32_t, WorldStateEncoder> worldEncoders;
+    std::vector<worldstate::EntityState> worldCapture;
+    std::vector<uint8_t> worldPayload;
+    // 客户端的快照解码器，以及服务器实体编号到本地细胞的映射
+    WorldStateDecoder worldDecoder;
+    std::map<uint32_t, BaseCell*> worldCells;
+    
+    // 固定步长调度，按gameConfig.tickRate换算每帧的模拟步数
+    FixedTimestep simClock;
+    
+    // 逐实体更新阶段使用的线程池，线程数取自gameConfig.workerThreads
+    std::unique_ptr<ThreadPool> threadPool;
+    
+    // 预分配的画布，逐帧轮换
+    FrameBuffers frameBuffers;
+    
+    // 控制提示、盾牌状态、连接状态等的缓存文字层
+    HudLayer hud;
+    
+    // 输入录像，未开启录制时为空
+    std::unique_ptr<ReplayLog> recording;
+    std::string recordPath;
     
     // 计时
     std::chrono::high_resolution_clock::time_point startTime;
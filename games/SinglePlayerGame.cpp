@@ -3,19 +3,35 @@
 #include "../physics.h"
 #include "../entities/PlayerCell.h"
 #include "../entities/AICell.h"
+#include "../simulation/ParticleSystem.h"
 #include <chrono>
 #include <algorithm>
+#include <iostream>
+#include <thread>
 
-SinglePlayerGame::SinglePlayerGame() 
-    : running(true), canvasSize(800, 600), scale(0.4f),
+SinglePlayerGame::SinglePlayerGame(uint64_t worldSeed) 
+    : running(true), canvasSize(800, 600), scale(0.4f), simTick(0),
       startTime(std::chrono::high_resolution_clock::now()),
       lastUpdateTime(startTime) {
     
-    // 初始化游戏配置
+    // 初始化游戏配置，外部指定的种子优先
     initializeConfig();
+    if (worldSeed != 0) {
+        gameConfig.worldSeed = worldSeed;
+    }
     
-    // 加载资源
-    loadShieldImage();
+    // 模拟以固定步长推进，deltaTime即每步的时长
+    simClock.setTickRate(gameConfig.tickRate);
+    deltaTime = simClock.getTickDelta();
+    
+    // 逐实体更新阶段的线程池
+    threadPool = std::make_unique<ThreadPool>(gameConfig.workerThreads);
+    
+    // 分块并行绘制，和模拟线程各用一个线程池
+    renderer = std::make_unique<TiledRenderer>(gameConfig.workerThreads);
+    
+    // 固定世界种子后再创建实体，相同种子得到相同的初始世界和AI行为
+    gameConfig.worldSeed = Random::beginWorld(gameConfig.worldSeed);
     
     // 初始化随机数生成器
     initializeRandomGenerators();
@@ -26,28 +42,49 @@ SinglePlayerGame::SinglePlayerGame()
 }
 
 void SinglePlayerGame::run() {
+    // 加载资源（仅窗口模式需要，无头模式不加载）
+    loadShieldImage();
+    
+    // 模拟在独立线程上以固定步长推进并发布快照；本线程只绘制最新快照、显示和读取输入，
+    // 模拟吞吐不受绘制开销影响，帧节奏也不受模拟开销影响（OpenCV窗口须留在主线程）
+    lastUpdateTime = std::chrono::high_resolution_clock::now();
+    publishSnapshot();
+    std::thread simulation(&SinglePlayerGame::simulationLoop, this);
+    
+    // 导出的帧按约60FPS的显示节奏播放；编码跟不上时丢帧，不拖慢游戏循环
+    if (!exportPath.empty()) {
+        exporter = std::make_unique<FrameExporter>(exportPath, 60.0);
+    }
+    
     while (running) {
         try {
-            // 计算帧时间
-            updateFrameTime();
+            snapshots.update();
+            const RenderSnapshot& snapshot = snapshots.readBuffer();
             
-            // 创建画布
-            cv::Mat canvas = cv::Mat(canvasSize, CV_8UC3, cv::Scalar(255, 255, 255));
+            // 插值系数取快照发布后经过的时间占一个模拟步的比例
+            auto now = std::chrono::steady_clock::now();
+            float sincePublish = std::chrono::duration<float>(now - snapshot.publishTime).count();
+            float alpha = std::min(1.0f, sincePublish / deltaTime);
+            float frameTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
             
-            // 更新所有实体
-            updateEntities();
+            // 取一块预分配的画布并清成白色背景
+            cv::Mat& canvas = frameBuffers.acquire(canvasSize);
             
-            // 处理玩家攻击和碰撞检测
-            handleCombat();
-            
-            // 绘制所有实体
-            renderEntities(canvas);
+            // 按细节预算选择各细胞的绘制档位，分块并行绘制快照中的实体和血滴
+            const std::vector<CellDetail>& details = detailBudget.assign(snapshot, alpha, canvasSize, cellConfig, scale);
+            auto drawStart = std::chrono::steady_clock::now();
+            renderer->render(canvas, snapshot, alpha, cellConfig, scale, frameTime, &details);
+            detailBudget.report(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - drawStart).count());
             
             // 显示控制提示
-            displayControls(canvas);
+            displayControls(canvas, snapshot);
             
-            // 显示画布
-            cv::imshow("多细胞单人游戏", canvas);
+            // 显示画布，开启导出时把同一帧拷给编码线程
+            const cv::Mat& frame = frameBuffers.present();
+            cv::imshow("多细胞单人游戏", frame);
+            if (exporter) {
+                exporter->submit(frame);
+            }
             
             // 处理用户输入
             handleInput();
@@ -62,7 +99,188 @@ void SinglePlayerGame::run() {
         }
     }
     
+    simulation.join();
     cv::destroyAllWindows();
+    
+    if (exporter) {
+        exporter->close();
+    }
+    
+    if (recording) {
+        if (recording->save(recordPath)) {
+            std::cout << "录像已保存: " << recordPath << " (" << recording->tickCount << " ticks, 种子 "
+                      << recording->seed << ")" << std::endl;
+        }
+    }
+}
+
+void SinglePlayerGame::simulationLoop() {
+    while (running) {
+        try {
+            // 输入在模拟步之间施加，录像据此在相同的tick重放
+            applyPendingInput();
+            
+            // 计算经过的时间，换算成要执行的模拟步数
+            int ticks = updateFrameTime();
+            for (int i = 0; i < ticks; ++i) {
+                stepWorld();
+            }
+            if (ticks > 0) {
+                publishSnapshot();
+            }
+            
+            // 睡到下一个模拟步到期
+            float untilNextTick = deltaTime * (1.0f - simClock.getAlpha());
+            std::this_thread::sleep_for(std::chrono::duration<float>(untilNextTick));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "模拟错误: " << e.what() << std::endl;
+        }
+    }
+}
+
+void SinglePlayerGame::applyPendingInput() {
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        keyBatch.swap(pendingKeys);
+    }
+    for (int key : keyBatch) {
+        // 录制时记下按键和施加时已完成的模拟步数
+        if (recording) {
+            recording->recordKey(simTick, key);
+        }
+        applyKey(key);
+    }
+    keyBatch.clear();
+}
+
+void SinglePlayerGame::publishSnapshot() {
+    RenderSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.tick = simTick;
+    snapshot.capture(entities, ParticleSystem::instance());
+    
+    snapshot.players.clear();
+    for (size_t i = 0; i < playerCells.size() && i < 2; i++) {
+        PlayerCell* player = playerCells[i].get();
+        snapshot.players.push_back({player->isShielding(),
+                                    player->getShieldDuration() - player->getShieldTime(),
+                                    player->getShieldTime() < gameConfig.parryWindowDuration,
+                                    player->getShieldCooldownTime()});
+    }
+    snapshots.publish();
+}
+
+void SinglePlayerGame::startRecording(const std::string& path) {
+    recording = std::make_unique<ReplayLog>();
+    recording->game = "single";
+    recording->seed = gameConfig.worldSeed;
+    recording->tickRate = simClock.getTickRate();
+    recordPath = path;
+}
+
+void SinglePlayerGame::startExport(const std::string& path) {
+    // 在开始游戏前检查路径，格式错误时直接报错，而不是等到第一帧
+    FrameExporter::validatePath(path);
+    exportPath = path;
+}
+
+void SinglePlayerGame::runHeadless(int ticks, float fixedDeltaTime) {
+    // 无头模式：不创建画布、不调用imshow/waitKey，以固定步长尽可能快地推进世界
+    time = 0.0f;
+    deltaTime = fixedDeltaTime;
+    
+    // 导出时每个模拟步绘制一帧，视频按模拟频率播放；没有帧率要求，队列满时等待编码而不丢帧
+    if (!exportPath.empty()) {
+        loadShieldImage();
+        exporter = std::make_unique<FrameExporter>(exportPath, 1.0 / fixedDeltaTime, 8, FrameExporter::FullPolicy::Wait);
+    }
+    
+    auto wallStart = std::chrono::high_resolution_clock::now();
+    
+    int tick = 0;
+    for (; tick < ticks && running; ++tick) {
+        time += fixedDeltaTime;
+        stepWorld();
+        if (exporter) {
+            exportHeadlessFrame();
+        }
+    }
+    
+    if (exporter) {
+        exporter->close();
+    }
+    
+    double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wallStart).count();
+    double ticksPerSecond = wallSeconds > 0.0 ? tick / wallSeconds : 0.0;
+    
+    std::cout << "无头模式完成: " << tick << " ticks, 墙钟时间 " << wallSeconds << " s, "
+              << ticksPerSecond << " ticks/s, 模拟时间 " << tick * fixedDeltaTime << " s, "
+              << "剩余实体 " << entities.size() << ", 种子 " << gameConfig.worldSeed << std::endl;
+}
+
+void SinglePlayerGame::exportHeadlessFrame() {
+    // 单线程下借用三缓冲：发布后立即取回，快照与窗口模式绘制的内容相同
+    publishSnapshot();
+    snapshots.update();
+    const RenderSnapshot& snapshot = snapshots.readBuffer();
+    
+    // 导出用于分析，所有细胞都完整绘制
+    cv::Mat& canvas = frameBuffers.acquire(canvasSize);
+    renderer->render(canvas, snapshot, 1.0f, cellConfig, scale, time);
+    displayControls(canvas, snapshot);
+    exporter->submit(frameBuffers.present());
+}
+
+bool SinglePlayerGame::runReplay(const ReplayLog& log) {
+    // 按录制时的步长推进，在与录制时相同的tick施加输入
+    time = 0.0f;
+    deltaTime = 1.0f / log.tickRate;
+    ReplayCursor cursor(log);
+    
+    auto wallStart = std::chrono::high_resolution_clock::now();
+    
+    bool diverged = false;
+    while (simTick < log.tickCount && running) {
+        while (const ReplayLog::Event* event = cursor.takeEvent(simTick)) {
+            if (event->type == ReplayLog::EventType::KEY) {
+                applyKey(event->key);
+            }
+        }
+        
+        time += deltaTime;
+        stepWorld();
+        
+        uint64_t expected = 0, actual = 0;
+        if (!cursor.verifyTick(simTick, expected, actual)) {
+            std::cerr << "回放在第" << simTick << "步出现分歧: 录制哈希 " << std::hex << expected
+                      << ", 当前哈希 " << actual << std::dec << std::endl;
+            diverged = true;
+            break;
+        }
+    }
+    
+    double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wallStart).count();
+    double ticksPerSecond = wallSeconds > 0.0 ? simTick / wallSeconds : 0.0;
+    
+    std::cout << "回放" << (diverged ? "中止" : "完成") << ": " << simTick << "/" << log.tickCount << " ticks, 墙钟时间 "
+              << wallSeconds << " s, " << ticksPerSecond << " ticks/s, 剩余实体 " << entities.size() << std::endl;
+    return !diverged;
+}
+
+void SinglePlayerGame::stepWorld() {
+    // 保存上一步的位置，供渲染插值
+    CellStore::instance().savePreviousPositions();
+    
+    // 更新所有实体
+    updateEntities();
+    
+    // 处理玩家攻击和碰撞检测
+    handleCombat();
+    
+    ++simTick;
+    if (recording) {
+        recording->recordTick(simTick);
+    }
 }
 
 void SinglePlayerGame::initializeConfig() {
@@ -70,6 +288,9 @@ void SinglePlayerGame::initializeConfig() {
     gameConfig.maxSpeed = 6.0f;
     gameConfig.accelerationStep = 0.7f;
     gameConfig.drag = 0.94f;
+    gameConfig.tickRate = 60.0f;
+    gameConfig.workerThreads = 0;
+    gameConfig.worldSeed = 0;
     gameConfig.numCells = 20;
     gameConfig.scale = 0.4f;
 
@@ -103,7 +324,7 @@ void SinglePlayerGame::initializeConfig() {
 }
 
 void SinglePlayerGame::initializeRandomGenerators() {
-    gen = std::mt19937(rd());
+    gen = Random::makeStream();
     xDist = std::uniform_real_distribution<float>(50.0f, canvasSize.width - 50.0f);
     yDist = std::uniform_real_distribution<float>(50.0f, canvasSize.height - 50.0f);
     moveDist = std::uniform_real_distribution<float>(-1.0f, 1.0f);
@@ -132,8 +353,8 @@ void SinglePlayerGame::createPlayers() {
     entities.push_back(player2);
     
     // 保存玩家指针，便于后续访问
-    playerCells.push_back(player1.get());
-    playerCells.push_back(player2.get());
+    playerCells.push_back(player1);
+    playerCells.push_back(player2);
 }
 
 void SinglePlayerGame::createAICells() {
@@ -149,21 +370,33 @@ void SinglePlayerGame::createAICells() {
     }
 }
 
-void SinglePlayerGame::updateFrameTime() {
+int SinglePlayerGame::updateFrameTime() {
     auto currentTime = std::chrono::high_resolution_clock::now();
-    deltaTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
+    float frameTime = std::chrono::duration<float>(currentTime - lastUpdateTime).count();
     lastUpdateTime = currentTime;
     time = std::chrono::duration<float>(currentTime - startTime).count();
     
-    // 限制deltaTime，防止过大的时间步长
-    deltaTime = std::min(deltaTime, 0.1f);
+    // 真实帧时间只用于累加，模拟始终以固定的deltaTime推进；单帧追赶步数由调度器限制
+    return simClock.advance(frameTime);
 }
 
 void SinglePlayerGame::updateEntities() {
-    // 更新所有实体
+    // 逐实体阶段只读写实体自身的状态，分块并行执行，每个parallelFor返回即为一道屏障
+    const size_t grainSize = 256;
+    threadPool->parallelFor(entities.size(), grainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            entities[i]->updateBehavior(deltaTime, gameConfig);
+        }
+    });
+    
+    // 物理、攻击动画和盾牌状态由CellStore按槽位区间并行推进
+    CellStore::instance().step(deltaTime, gameConfig, canvasSize, *threadPool);
+    
+    // 血滴粒子由世界级粒子池统一推进，与细胞是否存活无关
+    ParticleSystem::instance().update(deltaTime);
+    
+    // 移除死亡实体会改变entities，在屏障之后串行处理
     for (auto it = entities.begin(); it != entities.end();) {
-        (*it)->update(deltaTime, gameConfig, canvasSize);
-        
         // 如果实体不再存活，移除它
         if (!(*it)->isAlive()) {
             it = entities.erase(it);
@@ -171,25 +404,42 @@ void SinglePlayerGame::updateEntities() {
             ++it;
         }
     }
+    
+    // 位置已更新完毕，重建本帧共用的空间索引
+    rebuildSpatialIndex();
+}
+
+void SinglePlayerGame::rebuildSpatialIndex() {
+    // 以细胞宽度为格子尺寸
+    spatialIndex.build(entities, cellConfig.at("cell_width") * gameConfig.scale);
 }
 
 void SinglePlayerGame::handleCombat() {
+    // 空间索引已在updateEntities中重建，每个攻击者只检查矛尖附近的实体
+    float cellWidth = cellConfig.at("cell_width");
+    float hitRadius = spearHitRadius(gameConfig.scale, cellWidth);
+    
+    // 攻击者直接从CellStore的标志和攻击进度数组中筛选（前刺阶段），按槽位顺序处理
+    CellStore::instance().collectAttackers(combatAttackers);
+    
     // 检查攻击碰撞
-    for (auto& attacker : entities) {
-        // 只有正在攻击的细胞才能造成伤害
-        if (attacker->isAttacking()) {
-            for (auto& target : entities) {
-                // 不能攻击自己
-                if (attacker.get() == target.get()) continue;
-                
-                // 检查是否命中
-                cv::Point2f hitPosition;
-                cv::Point2f spearTipPosition;
-                if (checkSpearCollision(*attacker, *target, gameConfig.scale, 
-                                      cellConfig.at("cell_width"), hitPosition, spearTipPosition)) {
-                    // 处理命中效果
-                    handleHit(attacker.get(), target.get(), hitPosition, spearTipPosition);
-                }
+    for (BaseCell* attacker : combatAttackers) {
+        cv::Point2f spearTip = computeSpearTip(*attacker, gameConfig.scale);
+        spatialIndex.queryRadius(spearTip, hitRadius, neighborCandidates);
+        
+        for (int index : neighborCandidates) {
+            auto& target = entities[index];
+            
+            // 不能攻击自己
+            if (attacker == target.get()) continue;
+            
+            // 检查是否命中
+            cv::Point2f hitPosition;
+            cv::Point2f spearTipPosition;
+            if (checkSpearCollision(*attacker, *target, gameConfig.scale, 
+                                  cellWidth, hitPosition, spearTipPosition)) {
+                // 处理命中效果
+                handleHit(attacker, target.get(), hitPosition, spearTipPosition);
             }
         }
     }
@@ -218,7 +468,7 @@ void SinglePlayerGame::handleHit(BaseCell* attacker, BaseCell* target,
             
             // 创建小规模的血液效果
             cv::Point2f reducedHitPos = target->getPosition();
-            createBloodEffect(*target, reducedHitPos, attacker->isFacingRight(), spearTipPosition);
+            createBloodEffect(reducedHitPos, attacker->isFacingRight(), spearTipPosition);
         }
     } else {
         // 直接命中，没有格挡
@@ -226,7 +476,7 @@ void SinglePlayerGame::handleHit(BaseCell* attacker, BaseCell* target,
         target->takeDamage(damage);
         
         // 创建血液效果
-        createBloodEffect(*target, hitPosition, attacker->isFacingRight(), spearTipPosition);
+        createBloodEffect(hitPosition, attacker->isFacingRight(), spearTipPosition);
         
         // 添加击退效果
         float knockbackStrength = 5.0f;
@@ -236,42 +486,40 @@ void SinglePlayerGame::handleHit(BaseCell* attacker, BaseCell* target,
     }
 }
 
-void SinglePlayerGame::renderEntities(cv::Mat& canvas) {
-    // 绘制所有实体
-    for (auto& entity : entities) {
-        entity->render(canvas, cellConfig, scale, time);
-    }
-}
-
-void SinglePlayerGame::displayControls(cv::Mat& canvas) {
-    cv::putText(canvas,
-               "Player 1: WASD to move, F to attack, G to defend, Q/E to adjust aggression",
-               cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
-    
-    cv::putText(canvas,
-               "Player 2: Arrow keys to move, F to attack, G to defend, Q/E to adjust aggression",
-               cv::Point(10, 50), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
-    
-    // 显示屏蔽状态
-    for (int i = 0; i < playerCells.size() && i < 2; i++) {
-        std::string shieldStatus;
-        auto player = playerCells[i];
+void SinglePlayerGame::displayControls(cv::Mat& canvas, const RenderSnapshot& snapshot) {
+    // 文字缓存在HUD层里，只有键变化的行才重新构造字符串和光栅化
+    hud.beginFrame();
+    hud.setLine(0, 0, cv::Point(10, 30), TextStyle(0.5), [] {
+        return std::string("Player 1: WASD to move, F to attack, G to defend, Q/E to adjust aggression");
+    });
+    hud.setLine(1, 0, cv::Point(10, 50), TextStyle(0.5), [] {
+        return std::string("Player 2: Arrow keys to move, F to attack, G to defend, Q/E to adjust aggression");
+    });
+    
+    // 显示屏蔽状态，剩余时间按0.1秒分档
+    for (size_t i = 0; i < snapshot.players.size(); i++) {
+        const RenderSnapshot::PlayerStatus& player = snapshot.players[i];
+        int state = player.shielding ? 1 : (player.cooldown > 0 ? 2 : 0);
+        int tenths = state == 1 ? int(player.shieldRemaining * 10) : (state == 2 ? int(player.cooldown * 10) : 0);
+        uint64_t key = HudLayer::mixKey(HudLayer::mixKey(state, tenths), state == 1 && player.inParryWindow);
         
-        if (player->isShielding()) {
-            float remainingTime = player->getShieldDuration() - player->getShieldTime();
-            shieldStatus = "Shield: " + std::to_string(int(remainingTime * 10) / 10.0) + "s";
-            if (player->getShieldTime() < gameConfig.parryWindowDuration) {
-                shieldStatus += " (PERFECT PARRY)";
+        hud.setLine(2 + i, key, cv::Point(10, 70 + static_cast<int>(i) * 20), TextStyle(0.4), [&] {
+            std::string shieldStatus;
+            if (state == 1) {
+                shieldStatus = "Shield: " + std::to_string(tenths / 10.0) + "s";
+                if (player.inParryWindow) {
+                    shieldStatus += " (PERFECT PARRY)";
+                }
+            } else if (state == 2) {
+                shieldStatus = "Shield CD: " + std::to_string(tenths / 10.0) + "s";
+            } else {
+                shieldStatus = "Shield Ready";
             }
-        } else if (player->getShieldCooldownTime() > 0) {
-            shieldStatus = "Shield CD: " + std::to_string(int(player->getShieldCooldownTime() * 10) / 10.0) + "s";
-        } else {
-            shieldStatus = "Shield Ready";
-        }
-        
-        cv::putText(canvas, shieldStatus, 
-                  cv::Point(10, 70 + i*20), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            return shieldStatus;
+        });
     }
+    
+    hud.composite(canvas);
 }
 
 void SinglePlayerGame::handleInput() {
@@ -281,7 +529,14 @@ void SinglePlayerGame::handleInput() {
         running = false;
         return;
     }
+    if (key < 0) return;
     
+    // 交给模拟线程在下一个模拟步之前施加
+    std::lock_guard<std::mutex> lock(inputMutex);
+    pendingKeys.push_back(key);
+}
+
+void SinglePlayerGame::applyKey(int key) {
     // 处理玩家1的输入 (WASD移动, F攻击, G防御, Q/E调整攻击性)
     if (key == 'w' || key == 'W') {
         playerCells[0]->moveUp(gameConfig.accelerationStep);
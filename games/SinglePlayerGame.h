@@ -2,20 +2,47 @@
 #define SINGLE_PLAYER_GAME_H
 
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <random>
 #include <map>
 #include <chrono>
 #include "../GameConfig.h"
+#include "../simulation/SpatialGrid.h"
+#include "../simulation/FixedTimestep.h"
+#include "../simulation/ThreadPool.h"
+#include "../rendering/FrameBuffers.h"
+#include "../simulation/Random.h"
+#include "../simulation/ReplayLog.h"
+#include "../simulation/TripleBuffer.h"
+#include "../rendering/RenderSnapshot.h"
+#include "../rendering/TiledRenderer.h"
+#include "../rendering/DetailBudget.h"
+#include "../rendering/FrameExporter.h"
+#include "../rendering/HudLayer.h"
 
 class BaseCell;
 class PlayerCell;
 
 class SinglePlayerGame {
 public:
-    SinglePlayerGame();
+    // worldSeed为0时使用随机种子
+    explicit SinglePlayerGame(uint64_t worldSeed = 0);
     void run();
+    
+    // 无头模式：以固定步长运行ticks帧，不渲染（开启导出时除外），结束后输出ticks/s和墙钟时间
+    // 移动和计时都按fixedDeltaTime换算，步长不同时每秒的移动距离不变
+    void runHeadless(int ticks, float fixedDeltaTime = 1.0f / 60.0f);
+    
+    // 录制本局的键盘输入，run()结束时写入path
+    void startRecording(const std::string& path);
+    // 把渲染的帧导出为视频或PNG序列（见FrameExporter），由后台线程编码；
+    // 窗口模式下编码跟不上时丢帧，无头模式下每个模拟步导出一帧且不丢帧；帧号格式不合法时抛出std::invalid_argument
+    void startExport(const std::string& path);
+    // 无头重放录像，游戏须以录像中的种子构造；状态哈希出现分歧时返回false
+    bool runReplay(const ReplayLog& log);
 
 private:
     // 初始化方法
@@ -25,22 +52,33 @@ private:
     void createAICells();
     
     // 游戏循环方法
-    void updateFrameTime();
+    int updateFrameTime();
+    void stepWorld();
     void updateEntities();
+    void rebuildSpatialIndex();
     void handleCombat();
     void handleHit(BaseCell* attacker, BaseCell* target, 
                   const cv::Point2f& hitPosition, 
                   const cv::Point2f& spearTipPosition);
-    void renderEntities(cv::Mat& canvas);
-    void displayControls(cv::Mat& canvas);
+    void displayControls(cv::Mat& canvas, const RenderSnapshot& snapshot);
     void handleInput();
+    void applyKey(int key);
+    
+    // 窗口模式下模拟线程的主循环：施加输入、按固定步长推进世界、发布快照
+    void simulationLoop();
+    void applyPendingInput();
+    void publishSnapshot();
+    // 无头导出：绘制当前世界并交给导出线程
+    void exportHeadlessFrame();
     
     // 游戏状态
-    bool running;
+    // 渲染线程和模拟线程共用的退出标志
+    std::atomic<bool> running;
     cv::Size canvasSize;
     float scale;
     float time;
     float deltaTime;
+    uint64_t simTick;  // 已完成的模拟步数
     
     // 配置
     GameConfig gameConfig;
@@ -48,15 +86,54 @@ private:
     
     // 实体管理
     std::vector<std::shared_ptr<BaseCell>> entities;
-    std::vector<PlayerCell*> playerCells; // 不拥有这些指针，只是便于访问
+    // 与entities共同持有玩家：玩家死亡后照常移出entities，控制提示和按键处理仍可安全访问它
+    std::vector<std::shared_ptr<PlayerCell>> playerCells;
+    
+    // 空间索引，每帧实体更新后重建一次，战斗和繁殖等跨实体阶段共用
+    SpatialGrid spatialIndex;
+    std::vector<int> neighborCandidates;
+    std::vector<BaseCell*> combatAttackers;
+    
+    // 固定步长调度，按gameConfig.tickRate换算每帧的模拟步数
+    FixedTimestep simClock;
+    
+    // 逐实体更新阶段使用的线程池，线程数取自gameConfig.workerThreads
+    std::unique_ptr<ThreadPool> threadPool;
+    
+    // 预分配的画布，逐帧轮换
+    FrameBuffers frameBuffers;
+    
+    // 渲染线程上的分块并行绘制
+    std::unique_ptr<TiledRenderer> renderer;
+    
+    // 按绘制耗时选择细胞的细节档位
+    DetailBudget detailBudget;
+    
+    // 控制提示和盾牌状态的缓存文字层
+    HudLayer hud;
+    
+    // 模拟线程发布、渲染线程读取的世界快照
+    TripleBuffer<RenderSnapshot> snapshots;
+    
+    // 渲染线程读到的按键，由模拟线程在下一个模拟步之前取走施加
+    std::mutex inputMutex;
+    std::vector<int> pendingKeys;
+    std::vector<int> keyBatch;
+    
+    // 输入录像，未开启录制时为空
+    std::unique_ptr<ReplayLog> recording;
+    std::string recordPath;
+    
+    // 帧导出，未开启导出时为空；run/runHeadless开始时按模式创建
+    std::string exportPath;
+    std::unique_ptr<FrameExporter> exporter;
     
     // 计时
     std::chrono::high_resolution_clock::time_point startTime;
     std::chrono::high_resolution_clock::time_point lastUpdateTime;
     
-    // 随机数生成
-    std::random_device rd;
-    std::mt19937 gen;
+    // 随机数生成，gen从世界种子派生
+    Pcg32 gen;
     std::uniform_real_distribution<float> xDist;
     std::uniform_real_distribution<float> yDist;
     std::uniform_real_distribution<float> moveDist;
@@ -1,8 +1,10 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "games/SinglePlayerGame.h"
 #include "games/MultiPlayerGame.h"
+#include "benchmarks/Benchmarks.h"
 
 // 游戏类型
 enum class GameType {
@@ -28,9 +30,20 @@ SelectorState g_state = {
     8888
 };
 
+// 可与各模式组合使用的选项
+struct RunOptions {
+    uint64_t worldSeed;      // 0表示随机种子
+    std::string recordPath;  // 非空时录制输入
+    std::string exportPath;  // 非空时导出渲染的帧
+};
+
+RunOptions g_options = { 0, "", "" };
+
 // 函数声明
 void showHelp();
 void runSinglePlayerGame();
+void runHeadlessGame(int ticks);
+int runReplay(const std::string& path);
 void runMultiPlayerGame(const SelectorState& state);
 GameType showGameSelector();
 void mouseCallback(int event, int x, int y, int flags, void* userdata);
@@ -38,9 +51,23 @@ void networkModeMouseCallback(int event, int x, int y, int flags, void* userdata
 
 int main(int argc, char* argv[]) {
     try {
-        // 如果有命令行参数，按照原来的方式处理
-        if (argc > 1) {
-            std::string arg = argv[1];
+        // 先取出--seed、--record和--export选项，其余参数按原来的方式处理
+        std::vector<std::string> args;
+        for (int i = 0; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc) {
+                g_options.worldSeed = std::stoull(argv[++i]);
+            } else if (arg == "--record" && i + 1 < argc) {
+                g_options.recordPath = argv[++i];
+            } else if (arg == "--export" && i + 1 < argc) {
+                g_options.exportPath = argv[++i];
+            } else {
+                args.push_back(arg);
+            }
+        }
+        
+        if (args.size() > 1) {
+            std::string arg = args[1];
             if (arg == "--help" || arg == "-h") {
                 showHelp();
                 return 0;
@@ -49,14 +76,39 @@ int main(int argc, char* argv[]) {
                 runSinglePlayerGame();
                 return 0;
             }
+            else if (arg == "--headless") {
+                int ticks = 1000;
+                
+                // 检查是否有帧数参数
+                if (args.size() > 2 && isdigit(args[2][0])) {
+                    ticks = std::stoi(args[2]);
+                }
+                
+                runHeadlessGame(ticks);
+                return 0;
+            }
+            else if (arg == "--replay") {
+                if (args.size() < 3) {
+                    std::cerr << "请指定录像文件" << std::endl;
+                    return 1;
+                }
+                return runReplay(args[2]);
+            }
+            else if (arg == "--bench") {
+                if (args.size() < 3) {
+                    listBenchmarks();
+                    return 1;
+                }
+                return runBenchmark(args[2]);
+            }
             else if (arg == "--server") {
                 SelectorState state;
                 state.networkMode = NetGameMode::SERVER;
                 state.port = 8888;
                 
                 // 检查是否有端口参数
-                if (argc > 2 && isdigit(argv[2][0])) {
-                    state.port = std::stoi(argv[2]);
+                if (args.size() > 2 && isdigit(args[2][0])) {
+                    state.port = std::stoi(args[2]);
                 }
                 
                 runMultiPlayerGame(state);
@@ -69,11 +121,11 @@ int main(int argc, char* argv[]) {
                 state.port = 8888;
                 
                 // 检查是否有IP参数
-                if (argc > 2 && argv[2][0] != '-') {
-                    state.serverIP = argv[2];
+                if (args.size() > 2 && args[2][0] != '-') {
+                    state.serverIP = args[2];
                     // 检查是否有端口参数
-                    if (argc > 3 && isdigit(argv[3][0])) {
-                        state.port = std::stoi(argv[3]);
+                    if (args.size() > 3 && isdigit(args[3][0])) {
+                        state.port = std::stoi(args[3]);
                     }
                 }
                 
@@ -178,25 +230,68 @@ void showHelp() {
     std::cout << "使用方法: cell [参数]\n"
               << "参数:\n"
               << "  --standalone    单机模式\n"
+              << "  --headless [N]  无头模式，以固定步长模拟N帧（默认1000）并输出ticks/s\n"
+              << "  --replay <文件> 无头重放录像，逐检查点比对状态哈希并输出ticks/s\n"
+              << "  --bench <名称>  运行性能基准测试\n"
               << "  --server [端口] 服务器模式，可选指定端口号，默认8888\n"
               << "  --client [IP] [端口] 客户端模式，可选指定服务器IP和端口，默认127.0.0.1:8888\n"
               << "  --help         显示此帮助\n"
+              << "选项:\n"
+              << "  --seed <N>      固定世界随机种子，相同种子得到相同的模拟\n"
+              << "  --record <文件> 录制本局输入，退出时写入文件（单人和多人游戏）\n"
+              << "  --export <路径> 导出渲染的帧（单机和无头模式）：.avi/.mp4/.mkv/.mov写视频，\n"
+              << "                  其他路径写PNG序列，帧号从0开始（可含一个%d或%06d这样的帧号格式，%%表示%）；无头模式每步导出一帧\n"
               << std::endl;
 }
 
 // 运行单人游戏
 void runSinglePlayerGame() {
     std::cout << "启动单人游戏模式..." << std::endl;
-    SinglePlayerGame game;
+    SinglePlayerGame game(g_options.worldSeed);
+    if (!g_options.recordPath.empty()) {
+        game.startRecording(g_options.recordPath);
+    }
+    if (!g_options.exportPath.empty()) {
+        game.startExport(g_options.exportPath);
+    }
     game.run();
 }
 
+// 运行无头模拟
+void runHeadlessGame(int ticks) {
+    std::cout << "启动无头模拟模式，帧数: " << ticks << std::endl;
+    SinglePlayerGame game(g_options.worldSeed);
+    if (!g_options.exportPath.empty()) {
+        game.startExport(g_options.exportPath);
+    }
+    game.runHeadless(ticks);
+}
+
+// 无头重放录像，出现分歧时返回非0
+int runReplay(const std::string& path) {
+    ReplayLog log;
+    if (!log.load(path)) {
+        return 1;
+    }
+    
+    std::cout << "重放录像: " << path << " (" << log.tickCount << " ticks, 种子 " << log.seed << ")" << std::endl;
+    bool consistent;
+    if (log.game == "multi") {
+        MultiPlayerGame engine(log.seed);
+        consistent = engine.runReplay(log);
+    } else {
+        SinglePlayerGame game(log.seed);
+        consistent = game.runReplay(log);
+    }
+    return consistent ? 0 : 2;
+}
+
 // 运行多人游戏
 void runMultiPlayerGame(const SelectorState& state) {
     std::cout << "启动多人游戏模式..." << std::endl;
     
     // 初始化并运行多人游戏
-    MultiPlayerGame engine;
+    MultiPlayerGame engine(g_options.worldSeed);
     
     // 根据选择的模式进行初始化
     if (state.networkMode == NetGameMode::SERVER) {
@@ -214,6 +309,9 @@ void runMultiPlayerGame(const SelectorState& state) {
         }
     }
     
+    if (!g_options.recordPath.empty()) {
+        engine.startRecording(g_options.recordPath);
+    }
     engine.run();
 }
 
@@ -0,0 +1,174 @@
+#include "DatagramChannel.h"
+#include "MessageFraming.h"
+#include "WireFormat.h"
+#include <cstring>
+
+namespace {
+
+// 确认位图覆盖的包数
+const uint32_t ackWindow = 32;
+
+} // namespace
+
+namespace datagram {
+
+bool readHeader(const uint8_t* data, size_t size, Header& header) {
+    if (size < headerSize || wire::readU16(data) != magic) return false;
+    header.sessionId = wire::readU32(data + 2);
+    header.token = wire::readU32(data + 6);
+    header.sequence = wire::readU32(data + 10);
+    header.ack = wire::readU32(data + 14);
+    header.ackBits = wire::readU32(data + 18);
+    return true;
+}
+
+bool nextFrame(const uint8_t*& data, size_t& size, NetworkMessage& msg) {
+    if (size < framing::headerSize) return false;
+    const uint32_t length = wire::readU32(data);
+    if (length > size - framing::headerSize) return false;
+
+    msg.type = static_cast<MessageType>(data[4]);
+    msg.data.assign(data + framing::headerSize, data + framing::headerSize + length);
+    data += framing::headerSize + length;
+    size -= framing::headerSize + length;
+    return true;
+}
+
+} // namespace datagram
+
+DatagramChannel::DatagramChannel(uint32_t sessionId, uint32_t token) {
+    reset(sessionId, token);
+}
+
+void DatagramChannel::reset(uint32_t newSessionId, uint32_t newToken) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sessionId = newSessionId;
+    token = newToken;
+    nextSequence = 1;
+    remoteSequence = 0;
+    receivedBits = 0;
+    settledUpTo = 0;
+    confirmed = false;
+    sentPackets.fill(SentPacket());
+    stats = Stats();
+}
+
+uint32_t DatagramChannel::getSessionId() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessionId;
+}
+
+uint32_t DatagramChannel::getToken() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return token;
+}
+
+size_t DatagramChannel::buildPacket(uint8_t* out, const uint8_t* frames, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t sequence = nextSequence++;
+
+    wire::writeU16(out, datagram::magic);
+    wire::writeU32(out + 2, sessionId);
+    wire::writeU32(out + 6, token);
+    wire::writeU32(out + 10, sequence);
+    wire::writeU32(out + 14, remoteSequence);
+    wire::writeU32(out + 18, receivedBits);
+    if (size > 0) {
+        std::memcpy(out + datagram::headerSize, frames, size);
+    }
+
+    // 环中的旧记录到此仍未确认，计为丢失
+    SentPacket& slot = sentPackets[sequence % sentWindow];
+    if (slot.pending) {
+        ++stats.lost;
+    }
+    slot.sequence = sequence;
+    slot.sentAt = std::chrono::steady_clock::now();
+    slot.pending = true;
+    ++stats.sent;
+    return datagram::headerSize + size;
+}
+
+bool DatagramChannel::acceptPacket(const datagram::Header& header) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // 先处理确认：包本身即使过期，其中的确认信息仍然有效
+    if (header.ack != 0) {
+        auto now = std::chrono::steady_clock::now();
+        markAcked(header.ack, now);
+        for (uint32_t n = 0; n < ackWindow && n + 1 < header.ack; ++n) {
+            if (header.ackBits & (1u << n)) {
+                markAcked(header.ack - (n + 1), now);
+            }
+        }
+        settleLosses(header.ack);
+    }
+
+    const uint32_t sequence = header.sequence;
+    if (sequence == 0) return false;
+
+    if (remoteSequence == 0 || wire::sequenceNewer(sequence, remoteSequence)) {
+        // 位图随最新序号前移，原来的最新包落到第advance-1位
+        const uint32_t advance = sequence - remoteSequence;
+        if (remoteSequence == 0 || advance > ackWindow) {
+            receivedBits = 0;
+        } else if (advance == ackWindow) {
+            receivedBits = 1u << (ackWindow - 1);
+        } else {
+            receivedBits = (receivedBits << advance) | (1u << (advance - 1));
+        }
+        remoteSequence = sequence;
+        ++stats.received;
+        return true;
+    }
+
+    // 迟到的包仍在确认位图范围内时记为已收到，对端不会把它计为丢失
+    const uint32_t behind = remoteSequence - sequence;
+    if (behind > 0 && behind <= ackWindow) {
+        receivedBits |= 1u << (behind - 1);
+    }
+    ++stats.stale;
+    return false;
+}
+
+void DatagramChannel::markAcked(uint32_t sequence, std::chrono::steady_clock::time_point now) {
+    SentPacket& slot = sentPackets[sequence % sentWindow];
+    if (!slot.pending || slot.sequence != sequence) return;
+    slot.pending = false;
+    ++stats.acked;
+    confirmed = true;
+
+    // 与TCP相同的平滑往返时间
+    double sample = std::chrono::duration<double, std::milli>(now - slot.sentAt).count();
+    stats.rttMs = stats.rttMs == 0.0 ? sample : stats.rttMs * 0.875 + sample * 0.125;
+}
+
+void DatagramChannel::settleLosses(uint32_t ack) {
+    if (ack <= ackWindow + 1) return;
+    const uint32_t limit = ack - (ackWindow + 1);
+    if (!wire::sequenceNewer(limit, settledUpTo)) return;
+
+    // 结算范围只需覆盖仍在环中的记录
+    uint32_t first = settledUpTo + 1;
+    if (limit - first >= sentWindow) {
+        first = limit - static_cast<uint32_t>(sentWindow) + 1;
+    }
+    for (uint32_t sequence = first; sequence != limit + 1; ++sequence) {
+        SentPacket& slot = sentPackets[sequence % sentWindow];
+        if (slot.pending && slot.sequence == sequence) {
+            slot.pending = false;
+            ++stats.lost;
+        }
+    }
+    settledUpTo = limit;
+}
+
+bool DatagramChannel::peerConfirmed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return confirmed;
+}
+
+DatagramChannel::Stats DatagramChannel::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,104 @@
+#ifndef DATAGRAM_CHANNEL_H
+#define DATAGRAM_CHANNEL_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "NetworkManager.h"
+
+// UDP上的不可靠通道：高频的状态类消息走UDP，丢一个包不会像TCP那样让之后的所有更新排队等重传
+// 每个数据包是一个包头加若干条与TCP相同格式的帧（framing::appendFrame），包头带会话编号和令牌、
+// 本端的包序号，以及对端最新包序号和它之前32个包的接收位图，用于确认
+// 接收端只接受比已收到的最新包更新的包，迟到和重复的包直接丢弃：状态总是后到的更新，旧包没有价值
+// 不重传；确认用于判断UDP路径是否可用，并统计往返时间和丢包
+namespace datagram {
+
+const uint16_t magic = 0x4344;
+// magic(2) + 会话编号(4) + 令牌(4) + 序号(4) + 确认序号(4) + 确认位图(4)
+const size_t headerSize = 22;
+// 不超过常见路径MTU，避免IP分片；放不进一个包的消息仍走TCP
+const size_t maxPacketSize = 1200;
+const size_t maxFramesSize = maxPacketSize - headerSize;
+
+// 走UDP的消息类型；连接、断开、输入等其余消息仍走TCP
+inline bool prefersDatagram(MessageType type) {
+    return type == MessageType::PLAYER_STATE || type == MessageType::GAME_STATE;
+}
+
+struct Header {
+    uint32_t sessionId;
+    uint32_t token;
+    uint32_t sequence;
+    uint32_t ack;      // 对端已收到的本端最新包序号，0表示还没有收到
+    uint32_t ackBits;  // 第n位表示ack-(n+1)号包已收到
+};
+
+// 解析包头，magic不符或长度不足时返回false
+bool readHeader(const uint8_t* data, size_t size, Header& header);
+
+// 从包内平铺的帧数据中取出下一条完整消息，数据不足或格式错误时返回false
+bool nextFrame(const uint8_t*& data, size_t& size, NetworkMessage& msg);
+
+} // namespace datagram
+
+// 一个UDP对端的序号和确认状态，发送（游戏线程）和接收（I/O线程）可以并发调用
+class DatagramChannel {
+public:
+    struct Stats {
+        size_t sent = 0;      // 发出的包数
+        size_t received = 0;  // 接受的包数
+        size_t stale = 0;     // 迟到或重复而丢弃的包数
+        size_t acked = 0;     // 对端确认收到的包数
+        size_t lost = 0;      // 移出确认窗口仍未确认的包数
+        double rttMs = 0.0;   // 平滑往返时间，尚无样本时为0
+    };
+
+    explicit DatagramChannel(uint32_t sessionId = 0, uint32_t token = 0);
+
+    // 换成新的会话并清空序号和统计
+    void reset(uint32_t sessionId, uint32_t token);
+    uint32_t getSessionId() const;
+    uint32_t getToken() const;
+
+    // 在out中编码一个带下一个序号的包，out至少有datagram::maxPacketSize字节，
+    // frames长度不超过datagram::maxFramesSize；返回包的总长度
+    size_t buildPacket(uint8_t* out, const uint8_t* frames, size_t size);
+
+    // 处理收到的包头：记录确认信息；包比已收到的最新包旧或重复时返回false，调用方应丢弃包内的消息
+    bool acceptPacket(const datagram::Header& header);
+
+    // 对端确认过本端发出的包，即UDP路径双向可用
+    bool peerConfirmed() const;
+
+    Stats getStats() const;
+
+private:
+    // 本端发出的包，按序号在环中取模存放
+    struct SentPacket {
+        uint32_t sequence = 0;
+        std::chrono::steady_clock::time_point sentAt;
+        bool pending = false;  // 已发出、尚未确认也未计为丢失
+    };
+    static const size_t sentWindow = 256;
+
+    void markAcked(uint32_t sequence, std::chrono::steady_clock::time_point now);
+    // 确认推进到ack后，把已移出确认位图范围仍未确认的包计为丢失
+    void settleLosses(uint32_t ack);
+
+    mutable std::mutex mutex;
+    uint32_t sessionId;
+    uint32_t token;
+
+    uint32_t nextSequence;    // 下一个发出包的序号，从1开始
+    uint32_t remoteSequence;  // 已收到的对端最新包序号，0表示还没有收到
+    uint32_t receivedBits;    // 第n位表示remoteSequence-(n+1)号包已收到
+    uint32_t settledUpTo;     // 不大于它的序号都已确认或计为丢失
+    bool confirmed;
+
+    std::array<SentPacket, sentWindow> sentPackets;
+    Stats stats;
+};
+
+#endif // DATAGRAM_CHANNEL_H
@@ -0,0 +1,110 @@
+#include "MessageFraming.h"
+#include <algorithm>
+#include <cstring>
+
+namespace framing {
+
+void appendFrame(std::vector<uint8_t>& out, MessageType type, const uint8_t* data, size_t size) {
+    const uint32_t length = static_cast<uint32_t>(size);
+    const size_t start = out.size();
+    out.resize(start + headerSize + size);
+    uint8_t* frame = out.data() + start;
+    frame[0] = static_cast<uint8_t>(length);
+    frame[1] = static_cast<uint8_t>(length >> 8);
+    frame[2] = static_cast<uint8_t>(length >> 16);
+    frame[3] = static_cast<uint8_t>(length >> 24);
+    frame[4] = static_cast<uint8_t>(type);
+    if (size > 0) {
+        std::memcpy(frame + headerSize, data, size);
+    }
+}
+
+void appendFrame(std::vector<uint8_t>& out, const NetworkMessage& msg) {
+    appendFrame(out, msg.type, msg.data.data(), msg.data.size());
+}
+
+} // namespace framing
+
+namespace {
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+FrameReader::FrameReader(size_t initialCapacity)
+    : ring(roundUpPowerOfTwo(std::max(initialCapacity, framing::headerSize))), head(0), count(0), error(false) {
+}
+
+uint8_t* FrameReader::writeSpace(size_t& available) {
+    if (count == ring.size()) {
+        grow(ring.size() * 2);
+    }
+    const size_t mask = ring.size() - 1;
+    const size_t tail = (head + count) & mask;
+    // 写位置在读位置之后时可以一直写到缓冲末尾，否则只能写到读位置
+    available = (tail >= head) ? ring.size() - tail : head - tail;
+    return ring.data() + tail;
+}
+
+void FrameReader::commit(size_t bytes) {
+    count += bytes;
+}
+
+bool FrameReader::nextMessage(NetworkMessage& msg) {
+    if (error || count < framing::headerSize) return false;
+
+    uint8_t header[framing::headerSize];
+    peek(0, header, framing::headerSize);
+    const uint32_t length = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8)
+                          | (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    if (length > framing::maxPayload) {
+        error = true;
+        return false;
+    }
+
+    const size_t frameSize = framing::headerSize + length;
+    if (count < frameSize) {
+        if (ring.size() < frameSize) {
+            grow(frameSize);
+        }
+        return false;
+    }
+
+    msg.type = static_cast<MessageType>(header[4]);
+    msg.data.resize(length);
+    peek(framing::headerSize, msg.data.data(), length);
+
+    count -= frameSize;
+    // 缓冲读空时回到开头，下一次recv可以用上整块连续空间
+    head = count == 0 ? 0 : (head + frameSize) & (ring.size() - 1);
+    return true;
+}
+
+void FrameReader::reset() {
+    head = 0;
+    count = 0;
+    error = false;
+}
+
+void FrameReader::peek(size_t offset, uint8_t* out, size_t size) const {
+    if (size == 0) return;
+    const size_t start = (head + offset) & (ring.size() - 1);
+    const size_t first = std::min(size, ring.size() - start);
+    std::memcpy(out, ring.data() + start, first);
+    if (first < size) {
+        std::memcpy(out + first, ring.data(), size - first);
+    }
+}
+
+void FrameReader::grow(size_t minCapacity) {
+    std::vector<uint8_t> larger(roundUpPowerOfTwo(minCapacity));
+    peek(0, larger.data(), count);
+    ring.swap(larger);
+    head = 0;
+}
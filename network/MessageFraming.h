@@ -0,0 +1,59 @@
+#ifndef MESSAGE_FRAMING_H
+#define MESSAGE_FRAMING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "NetworkManager.h"
+
+// TCP字节流上的消息分帧：每条消息前加5字节帧头，4字节小端负载长度加1字节消息类型
+// 发送端用appendFrame编码；接收端把每次recv的数据写进FrameReader，再取出其中所有完整的消息，
+// 不完整的消息留在缓冲中等待后续数据，TCP把消息合并或拆开都不影响解析
+namespace framing {
+
+const size_t headerSize = 5;
+// 单条消息负载的上限，超过即视为协议错误
+const uint32_t maxPayload = 16u << 20;
+
+// 把一条消息编码后追加到out末尾
+void appendFrame(std::vector<uint8_t>& out, MessageType type, const uint8_t* data, size_t size);
+void appendFrame(std::vector<uint8_t>& out, const NetworkMessage& msg);
+
+} // namespace framing
+
+// 每个连接一个的接收缓冲：可扩容的环形缓冲，容量总是2的幂
+// recv直接写进writeSpace()给出的连续空间，commit()后用nextMessage()逐条取出完整消息
+// 只由该连接的接收线程使用，不是线程安全的
+class FrameReader {
+public:
+    explicit FrameReader(size_t initialCapacity = 4096);
+
+    // 可供recv直接写入的连续空间；缓冲已满时先扩容，available至少为1
+    uint8_t* writeSpace(size_t& available);
+    // 确认recv写入了bytes字节
+    void commit(size_t bytes);
+
+    // 取出一条完整消息，数据不足或出现协议错误时返回false
+    // 消息比当前容量大时在这里扩容，之后的recv可以把它收完整
+    bool nextMessage(NetworkMessage& msg);
+
+    // 收到了超过maxPayload的帧头，连接应当断开
+    bool hasError() const { return error; }
+    size_t buffered() const { return count; }
+    size_t capacity() const { return ring.size(); }
+    // 丢弃缓冲中的数据和错误状态，用于重新连接
+    void reset();
+
+private:
+    // 从读位置之后offset字节处拷出size字节，可跨越环形缓冲的末尾
+    void peek(size_t offset, uint8_t* out, size_t size) const;
+    // 扩容到不小于minCapacity的2的幂，同时把数据整理到缓冲开头
+    void grow(size_t minCapacity);
+
+    std::vector<uint8_t> ring;
+    size_t head;   // 第一个未读字节的位置
+    size_t count;  // 未读字节数
+    bool error;
+};
+
+#endif // MESSAGE_FRAMING_H
@@ -1,5 +1,6 @@
 #include "NetworkClient.h"
 #include <iostream>
+#include <cerrno>
 #include <cstring>
 
 #ifdef _WIN32
@@ -28,7 +29,7 @@ typedef int socklen_t;
 
 NetworkClient::NetworkClient(const std::string& ip, int port)
     : serverIP(ip), serverPort(port), clientSocket(INVALID_SOCKET),
-      running(false), connected(false) {
+      running(false), connected(false), datagramSocket(INVALID_SOCKET), datagramKnown(false) {
 }
 
 NetworkClient::~NetworkClient() {
@@ -91,10 +92,34 @@ bool NetworkClient::connectToServer() {
     fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
     #endif
     
-    connected = true;
+    // UDP套接字连接到服务器的同一端口，只收服务器发来的包；失败时所有消息都走TCP
+    datagramKnown = false;
+    datagramSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (datagramSocket != INVALID_SOCKET &&
+        connect(datagramSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+        CLOSE_SOCKET(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+    if (datagramSocket != INVALID_SOCKET) {
+        #ifdef _WIN32
+        ioctlsocket(datagramSocket, FIONBIO, &mode);
+        #else
+        flags = fcntl(datagramSocket, F_GETFL, 0);
+        fcntl(datagramSocket, F_SETFL, flags | O_NONBLOCK);
+        #endif
+    }
     
-    // 启动接收线程
-    receiveThread = std::thread(&NetworkClient::receiveThreadFunc, this);
+    // 套接字可读时由I/O线程接收，新连接从空的接收缓冲开始
+    reader.reset();
+    connected = true;
+    if (!reactor.start() || !reactor.add(clientSocket, [this] { receiveAvailable(); })) {
+        std::cerr << "无法启动网络I/O线程" << std::endl;
+        connected = false;
+        return false;
+    }
+    if (datagramSocket != INVALID_SOCKET) {
+        reactor.add(datagramSocket, [this] { receiveDatagrams(); });
+    }
     
     std::cout << "已连接到服务器: " << serverIP << ":" << serverPort << std::endl;
     return true;
@@ -103,91 +128,179 @@ bool NetworkClient::connectToServer() {
 void NetworkClient::disconnect() {
     connected = false;
     
-    if (receiveThread.joinable()) {
-        receiveThread.join();
-    }
+    // 等待I/O线程退出，之后不会再有回调
+    reactor.stop();
     
+    std::lock_guard<std::mutex> lock(sendMutex);
     if (clientSocket != INVALID_SOCKET) {
         CLOSE_SOCKET(clientSocket);
         clientSocket = INVALID_SOCKET;
     }
+    if (datagramSocket != INVALID_SOCKET) {
+        CLOSE_SOCKET(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+    DatagramChannel::Stats stats = channel.getStats();
+    if (datagramKnown && stats.sent + stats.received > 0) {
+        std::cout << "UDP通道: 发出" << stats.sent << "个包, 收到" << stats.received << "个, 迟到丢弃" << stats.stale
+                  << "个, 丢失" << stats.lost << "个, 往返 " << static_cast<int>(stats.rttMs + 0.5) << " ms" << std::endl;
+    }
+    datagramKnown = false;
 }
 
-void NetworkClient::receiveThreadFunc() {
-    const int bufSize = 1024;
-    char buffer[bufSize];
+void NetworkClient::receiveAvailable() {
+    NetworkMessage msg;
     
-    while (running && connected) {
-        // 清空缓冲区
-        memset(buffer, 0, bufSize);
-        
-        // 接收数据
-        int bytesReceived = recv(clientSocket, buffer, bufSize - 1, 0);
+    // 读出已到达的全部数据，每次recv之后取出其中所有完整的消息，不完整的留到下次
+    while (connected) {
+        // 接收数据，直接写进环形缓冲的空闲部分
+        size_t space = 0;
+        uint8_t* buffer = reader.writeSpace(space);
+        int bytesReceived = recv(clientSocket, reinterpret_cast<char*>(buffer), static_cast<int>(space), 0);
         
         if (bytesReceived > 0) {
-            // 处理接收到的数据
+            reader.commit(static_cast<size_t>(bytesReceived));
             try {
-                // 简单处理：假设每条消息的第一个字节是消息类型
-                MessageType type = static_cast<MessageType>(buffer[0]);
-                
-                // 剩余字节是数据
-                std::vector<uint8_t> data(buffer + 1, buffer + bytesReceived);
-                
-                NetworkMessage msg(type, data);
-                
-                // 处理消息
-                handleMessage(msg);
+                while (reader.nextMessage(msg)) {
+                    if (msg.type == MessageType::DATAGRAM_HELLO) {
+                        // 记下UDP通道的会话编号和令牌，下一次发送状态时开始探测
+                        if (msg.data.size() >= 8 && datagramSocket != INVALID_SOCKET) {
+                            uint32_t sessionId = 0, token = 0;
+                            for (int i = 0; i < 4; ++i) {
+                                sessionId |= static_cast<uint32_t>(msg.data[i]) << (8 * i);
+                                token |= static_cast<uint32_t>(msg.data[4 + i]) << (8 * i);
+                            }
+                            channel.reset(sessionId, token);
+                            datagramKnown = true;
+                        }
+                        continue;
+                    }
+                    handleMessage(msg);
+                }
             }
             catch (const std::exception& e) {
                 std::cerr << "接收消息处理错误: " << e.what() << std::endl;
             }
+            
+            if (reader.hasError()) {
+                std::cerr << "消息长度超出上限，断开连接" << std::endl;
+                dropConnection();
+                return;
+            }
         }
         else if (bytesReceived == 0) {
             // 服务器关闭连接
             std::cout << "服务器断开连接" << std::endl;
-            connected = false;
-            break;
+            dropConnection();
+            return;
         }
         else {
-            // 检查是否是合法的错误（非阻塞模式下没有数据可读）
+            // 非阻塞模式下没有更多数据可读，等待下一次可读事件
             #ifdef _WIN32
             int error = WSAGetLastError();
-            if (error != WSAEWOULDBLOCK) {
-                std::cerr << "接收数据错误: " << error << std::endl;
-                connected = false;
-                break;
-            }
+            if (error == WSAEWOULDBLOCK) return;
             #else
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                std::cerr << "接收数据错误: " << errno << std::endl;
-                connected = false;
-                break;
-            }
+            int error = errno;
+            if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR) return;
             #endif
+            std::cerr << "接收数据错误: " << error << std::endl;
+            dropConnection();
+            return;
         }
+    }
+}
+
+void NetworkClient::receiveDatagrams() {
+    uint8_t packet[datagram::maxPacketSize];
+    NetworkMessage msg;
+    
+    while (connected) {
+        int bytes = recv(datagramSocket, reinterpret_cast<char*>(packet), static_cast<int>(sizeof(packet)), 0);
+        // 没有更多包（或出错，如服务器UDP端口不可达）时等待下一次可读事件
+        if (bytes < 0) return;
+        
+        datagram::Header header;
+        if (!datagramKnown || !datagram::readHeader(packet, static_cast<size_t>(bytes), header)) continue;
+        if (header.sessionId != channel.getSessionId() || header.token != channel.getToken()) continue;
         
-        // 暂停一下，避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // 过期和重复的包只取其中的确认信息
+        if (!channel.acceptPacket(header)) continue;
+        
+        const uint8_t* frames = packet + datagram::headerSize;
+        size_t remaining = static_cast<size_t>(bytes) - datagram::headerSize;
+        while (datagram::nextFrame(frames, remaining, msg)) {
+            if (datagram::prefersDatagram(msg.type)) {
+                handleMessage(msg);
+            }
+        }
+    }
+}
+
+void NetworkClient::dropConnection() {
+    // 在I/O线程上调用，不能停止I/O线程本身，只取消注册；套接字留给disconnect关闭
+    connected = false;
+    reactor.remove(clientSocket);
+    if (datagramSocket != INVALID_SOCKET) {
+        reactor.remove(datagramSocket);
     }
 }
 
 bool NetworkClient::sendMessage(const NetworkMessage& msg) {
     if (!connected) return false;
     
-    // 锁定，防止多线程同时发送数据
+    // 锁定，防止多线程同时发送数据；I/O线程断开连接时也要先拿到这把锁
     std::lock_guard<std::mutex> lock(sendMutex);
+    if (clientSocket == INVALID_SOCKET) return false;
     
-    // 构建要发送的数据，第一个字节是消息类型
-    std::vector<uint8_t> buffer;
-    buffer.push_back(static_cast<uint8_t>(msg.type));
-    buffer.insert(buffer.end(), msg.data.begin(), msg.data.end());
+    // 构建要发送的数据：帧头（负载长度和消息类型）加负载，复用发送缓冲
+    sendBuffer.clear();
+    framing::appendFrame(sendBuffer, msg);
     
-    // 发送数据
-    int bytesSent = send(clientSocket, reinterpret_cast<const char*>(buffer.data()), buffer.size(), 0);
+    // 状态类消息在服务器确认过UDP包后改走UDP；确认之前照常走TCP，并定期发空的探测包
+    if (datagramKnown && datagram::prefersDatagram(msg.type) && sendBuffer.size() <= datagram::maxFramesSize) {
+        if (channel.peerConfirmed()) {
+            sendDatagram(sendBuffer.data(), sendBuffer.size());
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastProbe >= std::chrono::milliseconds(100)) {
+            lastProbe = now;
+            sendDatagram(nullptr, 0);
+        }
+    }
     
-    if (bytesSent == SOCKET_ERROR) {
-        std::cerr << "发送数据错误: " << SOCKET_ERROR_CODE << std::endl;
-        return false;
+    // 发送数据
+    return sendAll(sendBuffer.data(), sendBuffer.size());
+}
+
+void NetworkClient::sendDatagram(const uint8_t* frames, size_t size) {
+    // 发送缓冲满或出错时直接丢弃，由后续的状态补上
+    uint8_t packet[datagram::maxPacketSize];
+    size_t packetSize = channel.buildPacket(packet, frames, size);
+    send(datagramSocket, reinterpret_cast<const char*>(packet), static_cast<int>(packetSize), 0);
+}
+
+bool NetworkClient::sendAll(const uint8_t* data, size_t size) {
+    // 非阻塞套接字一次可能只发出一部分，发送缓冲满时稍等再继续，保证帧在字节流中完整连续
+    while (size > 0) {
+        int bytesSent = send(clientSocket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0);
+        
+        if (bytesSent == SOCKET_ERROR) {
+            #ifdef _WIN32
+            bool wouldBlock = WSAGetLastError() == WSAEWOULDBLOCK;
+            #else
+            bool wouldBlock = errno == EAGAIN || errno == EWOULDBLOCK;
+            #endif
+            if (wouldBlock && connected) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            std::cerr << "发送数据错误: " << SOCKET_ERROR_CODE << std::endl;
+            return false;
+        }
+        
+        data += bytesSent;
+        size -= static_cast<size_t>(bytesSent);
     }
     
     return true;
@@ -2,6 +2,10 @@
 #define NETWORK_CLIENT_H
 
 #include "NetworkManager.h"
+#include "MessageFraming.h"
+#include "DatagramChannel.h"
+#include "Reactor.h"
+#include <chrono>
 #include <string>
 #include <thread>
 #include <atomic>
@@ -10,6 +14,8 @@
 #include <memory>
 
 // 网络客户端实现
+// 收到服务器的DATAGRAM_HELLO后向服务器的同一端口发UDP探测包，服务器确认后状态类消息改走UDP，
+// 在此之前以及UDP不通时仍走TCP
 class NetworkClient : public NetworkManager {
 public:
     NetworkClient(const std::string& serverIP = "127.0.0.1", int serverPort = 8888);
@@ -43,9 +49,21 @@ private:
     std::atomic<bool> running;
     std::atomic<bool> connected;
     
-    std::thread receiveThread;
+    // 套接字的可读事件由它的I/O线程处理
+    Reactor reactor;
+    // 接收缓冲，只在I/O线程上访问
+    FrameReader reader;
+    
+    // 已连接到服务器地址的UDP套接字和通道；收到DATAGRAM_HELLO后datagramKnown为true
+    int datagramSocket;
+    DatagramChannel channel;
+    std::atomic<bool> datagramKnown;
+    // 上一次发UDP探测包的时间，由sendMutex保护
+    std::chrono::steady_clock::time_point lastProbe;
     
     std::mutex sendMutex;
+    // 编码待发送帧的缓冲，由sendMutex保护
+    std::vector<uint8_t> sendBuffer;
     std::mutex receiveMutex;
     std::queue<NetworkMessage> receiveQueue;
     
@@ -55,8 +73,20 @@ private:
     bool isThrottled;             // 连接是否被限制
     int throttleDelayMs;          // 限制连接时的延迟毫秒数
     
-    // 接收线程函数
-    void receiveThreadFunc();
+    // 套接字可读时读出已到达的数据，按帧头拆分并分发其中所有完整的消息
+    void receiveAvailable();
+    
+    // 在I/O线程上发现连接断开时调用
+    void dropConnection();
+    
+    // UDP套接字可读时读出所有到达的包
+    void receiveDatagrams();
+    
+    // 经UDP发送一段已编码的帧，调用时须持有sendMutex
+    void sendDatagram(const uint8_t* frames, size_t size);
+    
+    // 发送全部数据，非阻塞套接字发送缓冲满时等待
+    bool sendAll(const uint8_t* data, size_t size);
     
     // 初始化socket
     bool initializeSocket();
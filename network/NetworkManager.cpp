@@ -120,6 +120,9 @@ std::vector<uint8_t> NetworkSerializer::serializePlayerInput(const PlayerInputMe
     if (input.decreaseAggression) flags |= 0x80;
     
     data[0] = flags;
+    // 玩家编号写在原来未用的字节里，旧数据中为0
+    data[1] = static_cast<uint8_t>(input.playerNumber & 0xFF);
+    data[2] = static_cast<uint8_t>((input.playerNumber >> 8) & 0xFF);
     return data;
 }
 
@@ -137,6 +140,9 @@ PlayerInputMessage NetworkSerializer::deserializePlayerInput(const std::vector<u
     input.shield = (flags & 0x20) != 0;
     input.increaseAggression = (flags & 0x40) != 0;
     input.decreaseAggression = (flags & 0x80) != 0;
+    if (data.size() >= 3) {
+        input.playerNumber = data[1] | (data[2] << 8);
+    }
     
     return input;
 }
@@ -159,6 +165,9 @@ std::vector<uint8_t> NetworkSerializer::serializePlayerState(const PlayerStateMe
     if (state.facingRight) *flagsPtr |= 0x01;
     if (state.isAttacking) *flagsPtr |= 0x02;
     if (state.isShielding) *flagsPtr |= 0x04;
+    // 玩家编号写在标志之后原来未用的字节里，旧数据中为0
+    flagsPtr[1] = static_cast<uint8_t>(state.playerNumber & 0xFF);
+    flagsPtr[2] = static_cast<uint8_t>((state.playerNumber >> 8) & 0xFF);
     
     return data;
 }
@@ -182,6 +191,7 @@ PlayerStateMessage NetworkSerializer::deserializePlayerState(const std::vector<u
     state.facingRight = (*flagsPtr & 0x01) != 0;
     state.isAttacking = (*flagsPtr & 0x02) != 0;
     state.isShielding = (*flagsPtr & 0x04) != 0;
+    state.playerNumber = flagsPtr[1] | (flagsPtr[2] << 8);
     
     return state;
 }
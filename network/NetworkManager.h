@@ -22,18 +22,20 @@ enum class MessageType {
     PLAYER_INPUT,       // 玩家输入
     GAME_STATE,         // 游戏状态
     PING,               // 心跳检测
-    PONG                // 心跳响应
+    PONG,               // 心跳响应
+    DATAGRAM_HELLO      // 服务器经TCP告知客户端UDP通道的会话编号和令牌，由网络层处理，不交给游戏
 };
 
 // 网络消息结构
 struct NetworkMessage {
     MessageType type;   // 消息类型
     std::vector<uint8_t> data; // 消息数据
+    uint32_t sessionId; // 服务器收到的消息由接收方填写发送方的会话编号，不在网络上传输；0表示未知
     
-    NetworkMessage() : type(MessageType::PING) {}
+    NetworkMessage() : type(MessageType::PING), sessionId(0) {}
     
     NetworkMessage(MessageType t, const std::vector<uint8_t>& d) 
-        : type(t), data(d) {}
+        : type(t), data(d), sessionId(0) {}
 };
 
 // 玩家输入消息
@@ -46,10 +48,12 @@ struct PlayerInputMessage {
     bool shield;
     bool increaseAggression;
     bool decreaseAggression;
+    int playerNumber;   // 输入所属的玩家，0表示对方的唯一玩家（双人对战）
     
     PlayerInputMessage() 
         : moveUp(false), moveDown(false), moveLeft(false), moveRight(false),
-          attack(false), shield(false), increaseAggression(false), decreaseAggression(false) {}
+          attack(false), shield(false), increaseAggression(false), decreaseAggression(false),
+          playerNumber(0) {}
 };
 
 // 玩家状态消息
@@ -62,6 +66,7 @@ struct PlayerStateMessage {
     float attackTime;
     bool isShielding;
     float aggressionLevel;
+    int playerNumber = 0; // 状态所属的玩家，0表示对方的唯一玩家（双人对战）
 };
 
 // 用于序列化和反序列化网络消息
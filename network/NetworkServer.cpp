@@ -1,5 +1,7 @@
 #include "NetworkServer.h"
+#include <algorithm>
 #include <iostream>
+#include <cerrno>
 #include <cstring>
 
 #ifdef _WIN32
@@ -19,16 +21,42 @@
 typedef int socklen_t;
 #define CLOSE_SOCKET(s) closesocket(s)
 #define SOCKET_ERROR_CODE WSAGetLastError()
+#define SHUTDOWN_BOTH SD_BOTH
 #else
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
 #define CLOSE_SOCKET(s) close(s)
 #define SOCKET_ERROR_CODE errno
+#define SHUTDOWN_BOTH SHUT_RDWR
 #endif
 
-NetworkServer::NetworkServer(int port)
-    : serverPort(port), serverSocket(INVALID_SOCKET), clientSocket(INVALID_SOCKET),
-      running(false), connected(false) {
+// 对端已关闭时send返回错误而不是触发SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+namespace {
+
+// 会话套接字的内核发送缓冲上限。系统默认会随流量自动增长到数MB，慢客户端的积压会在内核里堆积数十秒的旧状态才被发现；
+// 限制之后主要积压留在会话自己的缓冲里，由maxBacklogBytes决定何时断开
+const int sessionSendBufferBytes = 64 * 1024;
+
+bool lastErrorWouldBlock() {
+    #ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+    #else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+    #endif
+}
+
+} // namespace
+
+NetworkServer::NetworkServer(int port, size_t maxSessions, size_t maxBacklogBytes)
+    : serverPort(port), serverSocket(INVALID_SOCKET), datagramSocket(INVALID_SOCKET), maxSessions(maxSessions),
+      maxBacklogBytes(maxBacklogBytes), running(false), slowDisconnects(0), nextSessionId(1),
+      tokenGenerator(std::random_device{}()) {
 }
 
 NetworkServer::~NetworkServer() {
@@ -71,8 +99,14 @@ bool NetworkServer::initializeSocket() {
         return false;
     }
     
-    // 监听连接请求
-    if (listen(serverSocket, 5) == SOCKET_ERROR) {
+    // 端口为0时取系统分配的端口
+    socklen_t addrLen = sizeof(serverAddr);
+    if (getsockname(serverSocket, (struct sockaddr*)&serverAddr, &addrLen) == 0) {
+        serverPort = ntohs(serverAddr.sin_port);
+    }
+    
+    // 监听连接请求，积压队列按会话上限放宽
+    if (listen(serverSocket, static_cast<int>(std::max<size_t>(maxSessions, 5))) == SOCKET_ERROR) {
         std::cerr << "Listen failed: " << SOCKET_ERROR_CODE << std::endl;
         CLOSE_SOCKET(serverSocket);
         return false;
@@ -87,6 +121,25 @@ bool NetworkServer::initializeSocket() {
     fcntl(serverSocket, F_SETFL, flags | O_NONBLOCK);
     #endif
     
+    // 同一端口号上的UDP套接字，失败时所有消息都走TCP
+    datagramSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(serverPort);
+    if (datagramSocket != INVALID_SOCKET &&
+        bind(datagramSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+        std::cerr << "UDP端口绑定失败，状态消息改走TCP: " << SOCKET_ERROR_CODE << std::endl;
+        CLOSE_SOCKET(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+    if (datagramSocket != INVALID_SOCKET) {
+        #ifdef _WIN32
+        ioctlsocket(datagramSocket, FIONBIO, &mode);
+        #else
+        flags = fcntl(datagramSocket, F_GETFL, 0);
+        fcntl(datagramSocket, F_SETFL, flags | O_NONBLOCK);
+        #endif
+    }
+    
     running = true;
     return true;
 }
@@ -97,136 +150,395 @@ void NetworkServer::startListening() {
     // 显示服务器IP地址
     displayServerIp(serverPort);
     
-    // 启动监听线程
-    listenThread = std::thread(&NetworkServer::listenThreadFunc, this);
+    // 监听套接字可读即有连接待接受，由I/O线程处理
+    if (!reactor.start() || !reactor.add(serverSocket, [this] { acceptClients(); })) {
+        std::cerr << "无法启动网络I/O线程" << std::endl;
+        return;
+    }
+    if (datagramSocket != INVALID_SOCKET) {
+        reactor.add(datagramSocket, [this] { receiveDatagrams(); });
+    }
+    std::cout << "服务器开始监听连接，最多" << maxSessions << "个客户端..." << std::endl;
 }
 
 void NetworkServer::stopListening() {
     running = false;
     
-    if (listenThread.joinable()) {
-        listenThread.join();
-    }
-    
-    if (receiveThread.joinable()) {
-        receiveThread.join();
-    }
+    // 等待I/O线程退出，之后不会再有回调
+    reactor.stop();
 }
 
-void NetworkServer::listenThreadFunc() {
-    std::cout << "服务器开始监听连接..." << std::endl;
-    
+void NetworkServer::acceptClients() {
+    // 非阻塞接受所有排队的连接
     while (running) {
-        if (!connected) {
-            struct sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            
-            // 非阻塞接受连接
-            clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-            
-            if (clientSocket != INVALID_SOCKET) {
-                connected = true;
-                std::cout << "客户端已连接: " << inet_ntoa(clientAddr.sin_addr) << std::endl;
-                
-                // 设置客户端套接字为非阻塞模式
-                #ifdef _WIN32
-                u_long mode = 1;
-                ioctlsocket(clientSocket, FIONBIO, &mode);
-                #else
-                int flags = fcntl(clientSocket, F_GETFL, 0);
-                fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-                #endif
-                
-                // 启动接收线程
-                receiveThread = std::thread(&NetworkServer::receiveThreadFunc, this);
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        int socket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
+        if (socket == INVALID_SOCKET) break;
+        
+        // 设置客户端套接字为非阻塞模式，加入会话表后游戏线程随时可能向它发送
+        #ifdef _WIN32
+        u_long mode = 1;
+        ioctlsocket(socket, FIONBIO, &mode);
+        #else
+        int flags = fcntl(socket, F_GETFL, 0);
+        fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+        #endif
+        int sendBufferBytes = sessionSendBufferBytes;
+        setsockopt(socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBufferBytes), sizeof(sendBufferBytes));
+        
+        auto session = std::make_shared<Session>();
+        session->socket = socket;
+        session->address = inet_ntoa(clientAddr.sin_addr);
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            if (sessions.size() >= maxSessions) {
+                std::cout << "客户端已满(" << maxSessions << ")，拒绝: " << session->address << std::endl;
+                CLOSE_SOCKET(socket);
+                continue;
             }
+            session->id = nextSessionId++;
+            sessions[session->id] = session;
         }
+        session->token = static_cast<uint32_t>(tokenGenerator());
+        session->channel.reset(session->id, session->token);
         
-        // 暂停一下，避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // 先报告接入再注册可读事件，保证游戏线程总是先看到会话的CONNECT_REQUEST
+        NetworkMessage joined(MessageType::CONNECT_REQUEST, {});
+        joined.sessionId = session->id;
+        handleMessage(joined);
+        
+        reactor.add(socket, [this, session] { receiveAvailable(session); },
+                    [this, session] { flushBacklog(session); });
+        // 注册前游戏线程可能已经向它发送，写不下的积压在此接上可写事件
+        flushBacklog(session);
+        
+        // 告诉客户端UDP通道的会话编号和令牌
+        if (datagramSocket != INVALID_SOCKET) {
+            std::vector<uint8_t> hello(8);
+            for (int i = 0; i < 4; ++i) {
+                hello[i] = static_cast<uint8_t>(session->id >> (8 * i));
+                hello[4 + i] = static_cast<uint8_t>(session->token >> (8 * i));
+            }
+            std::vector<uint8_t> frame;
+            framing::appendFrame(frame, MessageType::DATAGRAM_HELLO, hello.data(), hello.size());
+            queueBytes(*session, frame.data(), frame.size());
+        }
+        std::cout << "客户端已连接: " << session->address << " (会话" << session->id << ")" << std::endl;
     }
 }
 
-void NetworkServer::receiveThreadFunc() {
-    const int bufSize = 1024;
-    char buffer[bufSize];
+void NetworkServer::receiveAvailable(const std::shared_ptr<Session>& session) {
+    NetworkMessage msg;
     
-    while (running && connected) {
-        // 清空缓冲区
-        memset(buffer, 0, bufSize);
-        
-        // 接收数据
-        int bytesReceived = recv(clientSocket, buffer, bufSize - 1, 0);
+    // 读出已到达的全部数据，每次recv之后取出其中所有完整的消息，不完整的留到下次
+    while (true) {
+        // 接收数据，直接写进环形缓冲的空闲部分
+        size_t space = 0;
+        uint8_t* buffer = session->reader.writeSpace(space);
+        int bytesReceived = recv(session->socket, reinterpret_cast<char*>(buffer), static_cast<int>(space), 0);
         
         if (bytesReceived > 0) {
-            // 处理接收到的数据
+            session->reader.commit(static_cast<size_t>(bytesReceived));
+            bool goodbye = false;
             try {
-                // 简单处理：假设每条消息的第一个字节是消息类型
-                MessageType type = static_cast<MessageType>(buffer[0]);
-                
-                // 剩余字节是数据
-                std::vector<uint8_t> data(buffer + 1, buffer + bytesReceived);
-                
-                NetworkMessage msg(type, data);
-                
-                // 处理消息
-                handleMessage(msg);
+                while (session->reader.nextMessage(msg)) {
+                    // 会话的接入和断开由服务器自己报告，客户端发来的断开请求直接关闭会话
+                    if (msg.type == MessageType::CONNECT_REQUEST) continue;
+                    if (msg.type == MessageType::DISCONNECT) {
+                        goodbye = true;
+                        break;
+                    }
+                    msg.sessionId = session->id;
+                    handleMessage(msg);
+                }
             }
             catch (const std::exception& e) {
                 std::cerr << "接收消息处理错误: " << e.what() << std::endl;
             }
+            
+            if (session->reader.hasError()) {
+                std::cerr << "消息长度超出上限，断开会话" << session->id << std::endl;
+                closeSessionOnIoThread(session);
+                return;
+            }
+            if (goodbye) {
+                std::cout << "客户端断开连接 (会话" << session->id << ")" << std::endl;
+                closeSessionOnIoThread(session);
+                return;
+            }
         }
         else if (bytesReceived == 0) {
-            // 客户端关闭连接
-            std::cout << "客户端断开连接" << std::endl;
-            connected = false;
-            CLOSE_SOCKET(clientSocket);
-            break;
+            // 客户端关闭连接，或本端因发送失败关闭了连接
+            std::cout << "客户端断开连接 (会话" << session->id << ")" << std::endl;
+            closeSessionOnIoThread(session);
+            return;
         }
         else {
-            // 检查是否是合法的错误（非阻塞模式下没有数据可读）
+            // 非阻塞模式下没有更多数据可读，等待下一次可读事件
             #ifdef _WIN32
             int error = WSAGetLastError();
-            if (error != WSAEWOULDBLOCK) {
-                std::cerr << "接收数据错误: " << error << std::endl;
-                connected = false;
-                CLOSE_SOCKET(clientSocket);
-                break;
-            }
+            if (error == WSAEWOULDBLOCK) return;
             #else
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                std::cerr << "接收数据错误: " << errno << std::endl;
-                connected = false;
-                CLOSE_SOCKET(clientSocket);
-                break;
-            }
+            int error = errno;
+            if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR) return;
             #endif
+            std::cerr << "接收数据错误: " << error << " (会话" << session->id << ")" << std::endl;
+            closeSessionOnIoThread(session);
+            return;
         }
-        
-        // 暂停一下，避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
+void NetworkServer::flushBacklog(const std::shared_ptr<Session>& session) {
+    std::lock_guard<std::mutex> lock(session->sendMutex);
+    if (!session->open) return;
+    if (!drainBacklog(*session)) {
+        abortSession(*session);
+        return;
+    }
+    reactor.setWriteInterest(session->socket, session->backlogOffset != session->backlog.size());
+}
+
+void NetworkServer::closeSessionOnIoThread(const std::shared_ptr<Session>& session) {
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (sessions.erase(session->id) == 0) return;
+    }
+    reactor.remove(session->socket);
+    
+    // 等正在进行的发送放弃后再关闭套接字
+    {
+        std::lock_guard<std::mutex> lock(session->sendMutex);
+        session->open = false;
+        CLOSE_SOCKET(session->socket);
+        session->socket = INVALID_SOCKET;
+        session->backlog.clear();
+        session->backlogOffset = 0;
+    }
+    
+    NetworkMessage left(MessageType::DISCONNECT, {});
+    left.sessionId = session->id;
+    handleMessage(left);
+}
+
+void NetworkServer::abortSession(Session& session) {
+    if (!session.open) return;
+    session.open = false;
+    ::shutdown(session.socket, SHUTDOWN_BOTH);
+}
+
+std::shared_ptr<NetworkServer::Session> NetworkServer::findSession(uint32_t sessionId) const {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    auto it = sessions.find(sessionId);
+    return it != sessions.end() ? it->second : nullptr;
+}
+
+void NetworkServer::closeSession(uint32_t sessionId) {
+    std::shared_ptr<Session> session = findSession(sessionId);
+    if (!session) return;
+    std::lock_guard<std::mutex> lock(session->sendMutex);
+    abortSession(*session);
+}
+
 bool NetworkServer::sendMessage(const NetworkMessage& msg) {
-    if (!connected) return false;
+    // 编码一次，复用发送缓冲
+    std::lock_guard<std::mutex> lock(broadcastMutex);
+    encodeMessages(&msg, 1);
+    return sendEncoded(allSessions()) > 0;
+}
+
+size_t NetworkServer::broadcast(const std::vector<NetworkMessage>& messages) {
+    std::lock_guard<std::mutex> lock(broadcastMutex);
+    encodeMessages(messages.data(), messages.size());
+    return sendEncoded(allSessions());
+}
+
+bool NetworkServer::sendTo(uint32_t sessionId, const NetworkMessage& msg) {
+    std::shared_ptr<Session> session = findSession(sessionId);
+    if (!session) return false;
+    
+    std::lock_guard<std::mutex> lock(broadcastMutex);
+    encodeMessages(&msg, 1);
+    return sendEncoded({session}) == 1;
+}
+
+void NetworkServer::encodeMessages(const NetworkMessage* messages, size_t count) {
+    broadcastBuffer.clear();
+    datagramFrames.clear();
+    datagramChunkEnds.clear();
+    
+    // 状态类消息按包大小切分成若干段，一段一个UDP包；放不进一个包的消息走TCP
+    size_t chunkStart = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const NetworkMessage& msg = messages[i];
+        const size_t frameSize = framing::headerSize + msg.data.size();
+        if (datagramSocket == INVALID_SOCKET || !datagram::prefersDatagram(msg.type) || frameSize > datagram::maxFramesSize) {
+            framing::appendFrame(broadcastBuffer, msg);
+            continue;
+        }
+        if (datagramFrames.size() - chunkStart + frameSize > datagram::maxFramesSize) {
+            datagramChunkEnds.push_back(datagramFrames.size());
+            chunkStart = datagramFrames.size();
+        }
+        framing::appendFrame(datagramFrames, msg);
+    }
+    if (datagramFrames.size() > chunkStart) {
+        datagramChunkEnds.push_back(datagramFrames.size());
+    }
+}
+
+size_t NetworkServer::sendEncoded(const std::vector<std::shared_ptr<Session>>& targets) {
+    size_t delivered = 0;
+    for (const auto& session : targets) {
+        bool ok = true;
+        if (!broadcastBuffer.empty()) {
+            ok = queueBytes(*session, broadcastBuffer.data(), broadcastBuffer.size());
+        }
+        if (ok && !datagramFrames.empty()) {
+            ok = queueDatagrams(*session);
+        }
+        if (ok) ++delivered;
+    }
+    return delivered;
+}
+
+std::vector<std::shared_ptr<NetworkServer::Session>> NetworkServer::allSessions() const {
+    std::vector<std::shared_ptr<Session>> targets;
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    targets.reserve(sessions.size());
+    for (const auto& entry : sessions) {
+        targets.push_back(entry.second);
+    }
+    return targets;
+}
+
+bool NetworkServer::queueDatagrams(Session& session) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    bool ready = false;
+    {
+        std::lock_guard<std::mutex> lock(session.sendMutex);
+        if (!session.open) return false;
+        ready = session.datagramReady;
+        address.sin_addr.s_addr = session.datagramAddress;
+        address.sin_port = session.datagramPort;
+    }
+    if (!ready) {
+        return queueBytes(session, datagramFrames.data(), datagramFrames.size());
+    }
     
-    // 锁定，防止多线程同时发送数据
-    std::lock_guard<std::mutex> lock(sendMutex);
+    // 发送缓冲满或出错时直接丢弃，由后续的状态补上
+    uint8_t packet[datagram::maxPacketSize];
+    size_t chunkStart = 0;
+    for (size_t chunkEnd : datagramChunkEnds) {
+        size_t packetSize = session.channel.buildPacket(packet, datagramFrames.data() + chunkStart, chunkEnd - chunkStart);
+        sendto(datagramSocket, reinterpret_cast<const char*>(packet), static_cast<int>(packetSize), SEND_FLAGS,
+               (struct sockaddr*)&address, sizeof(address));
+        chunkStart = chunkEnd;
+    }
+    return true;
+}
+
+void NetworkServer::receiveDatagrams() {
+    uint8_t packet[datagram::maxPacketSize];
+    NetworkMessage msg;
     
-    // 构建要发送的数据，第一个字节是消息类型
-    std::vector<uint8_t> buffer;
-    buffer.push_back(static_cast<uint8_t>(msg.type));
-    buffer.insert(buffer.end(), msg.data.begin(), msg.data.end());
+    while (true) {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        int bytes = recvfrom(datagramSocket, reinterpret_cast<char*>(packet), static_cast<int>(sizeof(packet)), 0,
+                             (struct sockaddr*)&from, &fromLen);
+        // 没有更多包（或出错）时等待下一次可读事件
+        if (bytes < 0) return;
+        
+        datagram::Header header;
+        if (!datagram::readHeader(packet, static_cast<size_t>(bytes), header)) continue;
+        std::shared_ptr<Session> session = findSession(header.sessionId);
+        if (!session || header.token != session->token) continue;
+        
+        // 过期和重复的包只取其中的确认信息
+        if (!session->channel.acceptPacket(header)) continue;
+        {
+            // 最新的有效包决定客户端的UDP地址，NAT重新映射端口后随之更新
+            std::lock_guard<std::mutex> lock(session->sendMutex);
+            if (!session->open) continue;
+            session->datagramAddress = from.sin_addr.s_addr;
+            session->datagramPort = from.sin_port;
+            session->datagramReady = true;
+        }
+        
+        const uint8_t* frames = packet + datagram::headerSize;
+        size_t remaining = static_cast<size_t>(bytes) - datagram::headerSize;
+        while (datagram::nextFrame(frames, remaining, msg)) {
+            // UDP上只接受状态类消息，其余消息必须走TCP
+            if (!datagram::prefersDatagram(msg.type)) continue;
+            msg.sessionId = session->id;
+            handleMessage(msg);
+        }
+    }
+}
+
+bool NetworkServer::queueBytes(Session& session, const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(session.sendMutex);
+    if (!session.open) return false;
     
-    // 发送数据
-    int bytesSent = send(clientSocket, reinterpret_cast<const char*>(buffer.data()), buffer.size(), 0);
+    // 没有积压时直接发送，写不下的部分进积压；已有积压时只追加，保证帧在字节流中完整有序
+    if (session.backlogOffset == session.backlog.size()) {
+        session.backlog.clear();
+        session.backlogOffset = 0;
+        while (size > 0) {
+            int bytesSent = send(session.socket, reinterpret_cast<const char*>(data), static_cast<int>(size), SEND_FLAGS);
+            if (bytesSent == SOCKET_ERROR) {
+                if (lastErrorWouldBlock()) break;
+                std::cerr << "发送数据错误: " << SOCKET_ERROR_CODE << " (会话" << session.id << ")" << std::endl;
+                abortSession(session);
+                return false;
+            }
+            data += bytesSent;
+            size -= static_cast<size_t>(bytesSent);
+        }
+        if (size == 0) return true;
+    }
     
-    if (bytesSent == SOCKET_ERROR) {
-        std::cerr << "发送数据错误: " << SOCKET_ERROR_CODE << std::endl;
+    session.backlog.insert(session.backlog.end(), data, data + size);
+    size_t pending = session.backlog.size() - session.backlogOffset;
+    if (pending > maxBacklogBytes) {
+        std::cerr << "会话" << session.id << " (" << session.address << ") 发送积压 " << pending
+                  << " 字节超过上限，断开慢客户端" << std::endl;
+        ++slowDisconnects;
+        abortSession(session);
         return false;
     }
     
+    // 等套接字可写时由I/O线程继续发送
+    reactor.setWriteInterest(session.socket, true);
+    return true;
+}
+
+bool NetworkServer::drainBacklog(Session& session) {
+    while (session.backlogOffset < session.backlog.size()) {
+        const uint8_t* data = session.backlog.data() + session.backlogOffset;
+        size_t size = session.backlog.size() - session.backlogOffset;
+        int bytesSent = send(session.socket, reinterpret_cast<const char*>(data), static_cast<int>(size), SEND_FLAGS);
+        if (bytesSent == SOCKET_ERROR) {
+            if (lastErrorWouldBlock()) break;
+            std::cerr << "发送数据错误: " << SOCKET_ERROR_CODE << " (会话" << session.id << ")" << std::endl;
+            return false;
+        }
+        session.backlogOffset += static_cast<size_t>(bytesSent);
+    }
+    
+    // 发完时清空；已发出的部分超过一半时前移剩余数据，避免缓冲只增不减
+    if (session.backlogOffset == session.backlog.size()) {
+        session.backlog.clear();
+        session.backlogOffset = 0;
+    }
+    else if (session.backlogOffset > session.backlog.size() / 2) {
+        session.backlog.erase(session.backlog.begin(), session.backlog.begin() + session.backlogOffset);
+        session.backlogOffset = 0;
+    }
     return true;
 }
 
@@ -257,22 +569,38 @@ void NetworkServer::handleMessage(const NetworkMessage& msg) {
 
 void NetworkServer::shutdown() {
     running = false;
-    connected = false;
     
-    // 等待线程结束
+    // 等待I/O线程结束，之后可以在本线程关闭所有会话
     stopListening();
     
-    // 关闭套接字
-    if (clientSocket != INVALID_SOCKET) {
-        CLOSE_SOCKET(clientSocket);
-        clientSocket = INVALID_SOCKET;
+    std::map<uint32_t, std::shared_ptr<Session>> closing;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        closing.swap(sessions);
+    }
+    for (auto& entry : closing) {
+        Session& session = *entry.second;
+        reactor.remove(session.socket);
+        std::lock_guard<std::mutex> lock(session.sendMutex);
+        session.open = false;
+        if (session.socket != INVALID_SOCKET) {
+            CLOSE_SOCKET(session.socket);
+            session.socket = INVALID_SOCKET;
+        }
     }
     
     if (serverSocket != INVALID_SOCKET) {
+        reactor.remove(serverSocket);
         CLOSE_SOCKET(serverSocket);
         serverSocket = INVALID_SOCKET;
     }
     
+    if (datagramSocket != INVALID_SOCKET) {
+        reactor.remove(datagramSocket);
+        CLOSE_SOCKET(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+    
     #ifdef _WIN32
     // 清理Winsock
     WSACleanup();
@@ -280,7 +608,7 @@ void NetworkServer::shutdown() {
 }
 
 bool NetworkServer::isConnected() const {
-    return connected;
+    return hasClient();
 }
 
 void NetworkServer::setMessageCallback(MessageCallback callback) {
@@ -288,5 +616,10 @@ void NetworkServer::setMessageCallback(MessageCallback callback) {
 }
 
 bool NetworkServer::hasClient() const {
-    return connected;
-}
\ No newline at end of file
+    return sessionCount() > 0;
+}
+
+size_t NetworkServer::sessionCount() const {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    return sessions.size();
+}
@@ -2,21 +2,35 @@
 #define NETWORK_SERVER_H
 
 #include "NetworkManager.h"
+#include "MessageFraming.h"
+#include "DatagramChannel.h"
+#include "Reactor.h"
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <queue>
+#include <map>
 #include <memory>
+#include <random>
+#include <vector>
 
 // 网络服务器实现
+// 每个接入的客户端是一个会话，分配从1开始递增、不重复使用的会话编号；收到的消息带上会话编号放进接收队列
+// 会话接入和断开时服务器分别向接收队列放一条CONNECT_REQUEST和DISCONNECT（带会话编号），
+// 客户端自己发来的这两类消息不再转交，游戏线程据此为会话创建和移除玩家
+// 发送不会阻塞：每个会话有自己的发送积压，套接字写不下的部分留到可写时由I/O线程继续发送，
+// 积压超过上限的慢客户端被断开，不影响其他会话
+// 同一端口上另有UDP套接字：会话接入时经TCP发给客户端DATAGRAM_HELLO（会话编号和令牌），
+// 收到客户端带令牌的UDP包后，该会话的状态类消息（datagram::prefersDatagram）改走UDP，其余消息仍走TCP
 class NetworkServer : public NetworkManager {
 public:
-    NetworkServer(int port = 8888);
+    NetworkServer(int port = 8888, size_t maxSessions = 64, size_t maxBacklogBytes = 256 * 1024);
     virtual ~NetworkServer();
     
     // 实现NetworkManager接口
     bool initialize() override;
+    // 广播给所有会话
     bool sendMessage(const NetworkMessage& msg) override;
     bool receiveMessage(NetworkMessage& msg) override;
     void shutdown() override;
@@ -27,26 +41,101 @@ public:
     void startListening();
     void stopListening();
     bool hasClient() const;
+    size_t sessionCount() const;
+    // 实际监听的端口，以端口0初始化时由系统分配
+    int getPort() const { return serverPort; }
+    
+    // 发给指定会话，会话不存在或已断开时返回false
+    bool sendTo(uint32_t sessionId, const NetworkMessage& msg);
+    // 把一批消息编码一次后发给所有会话，每个会话只调用一次send；返回成功排队的会话数
+    size_t broadcast(const std::vector<NetworkMessage>& messages);
+    // 主动断开会话，之后接收队列中会出现它的DISCONNECT
+    void closeSession(uint32_t sessionId);
+    
+    // 因发送积压超限被断开的会话数
+    size_t getSlowDisconnects() const { return slowDisconnects; }
     
 private:
+    struct Session {
+        uint32_t id;
+        int socket;
+        std::string address;
+        uint32_t token;
+        // 接收缓冲，只在I/O线程上访问
+        FrameReader reader;
+        // UDP通道的序号和确认状态，有自己的锁
+        DatagramChannel channel;
+        
+        // 以下由sendMutex保护
+        std::mutex sendMutex;
+        std::vector<uint8_t> backlog;  // 尚未发出的字节，从backlogOffset开始有效
+        size_t backlogOffset = 0;
+        bool open = true;              // 断开后不再发送，套接字只由I/O线程关闭
+        bool datagramReady = false;    // 收到过客户端的有效UDP包
+        uint32_t datagramAddress = 0;  // 客户端UDP地址和端口，网络字节序
+        uint16_t datagramPort = 0;
+    };
+    
     int serverPort;
     int serverSocket;
-    int clientSocket;
+    int datagramSocket;
+    size_t maxSessions;
+    size_t maxBacklogBytes;
     std::atomic<bool> running;
-    std::atomic<bool> connected;
+    std::atomic<size_t> slowDisconnects;
+    
+    // 监听套接字和所有会话套接字的事件都由它的I/O线程处理
+    Reactor reactor;
     
-    std::thread listenThread;
-    std::thread receiveThread;
+    mutable std::mutex sessionsMutex;
+    std::map<uint32_t, std::shared_ptr<Session>> sessions;
+    uint32_t nextSessionId;
+    // 生成UDP令牌，只在I/O线程上使用
+    std::mt19937 tokenGenerator;
+    
+    // 编码待发送消息的缓冲，由broadcastMutex保护：走TCP的帧，以及走UDP的帧和按包大小切分的各段结尾
+    std::mutex broadcastMutex;
+    std::vector<uint8_t> broadcastBuffer;
+    std::vector<uint8_t> datagramFrames;
+    std::vector<size_t> datagramChunkEnds;
     
-    std::mutex sendMutex;
     std::mutex receiveMutex;
     std::queue<NetworkMessage> receiveQueue;
     
-    // 监听线程函数
-    void listenThreadFunc();
+    // 监听套接字可读时接受排队的连接
+    void acceptClients();
+    
+    // 会话套接字可读时读出已到达的数据，按帧头拆分并分发其中所有完整的消息
+    void receiveAvailable(const std::shared_ptr<Session>& session);
+    
+    // 会话套接字可写时继续发送积压
+    void flushBacklog(const std::shared_ptr<Session>& session);
+    
+    // 把消息按传输方式编码进发送缓冲；调用时须持有broadcastMutex
+    void encodeMessages(const NetworkMessage* messages, size_t count);
+    // 把编码好的消息发给各会话，返回成功发送或排队的会话数；调用时须持有broadcastMutex
+    size_t sendEncoded(const std::vector<std::shared_ptr<Session>>& targets);
+    std::vector<std::shared_ptr<Session>> allSessions() const;
+    
+    // 把编码好的UDP帧发给会话；UDP路径尚未建立时整体走TCP
+    bool queueDatagrams(Session& session);
+    
+    // UDP套接字可读时读出所有到达的包
+    void receiveDatagrams();
+    
+    // 发送或积压一段已编码的帧数据；积压超过上限时断开会话
+    bool queueBytes(Session& session, const uint8_t* data, size_t size);
+    
+    // 把积压尽量写进套接字，调用时须持有session.sendMutex；出错时返回false
+    bool drainBacklog(Session& session);
+    
+    // 在I/O线程上关闭会话并报告DISCONNECT
+    void closeSessionOnIoThread(const std::shared_ptr<Session>& session);
+    
+    // 让I/O线程尽快关闭会话：关闭发送后对端和本端的读取都会结束
+    void abortSession(Session& session);
     
-    // 接收线程函数
-    void receiveThreadFunc();
+    std::shared_ptr<Session> findSession(uint32_t sessionId) const;
     
     // 初始化socket
     bool initializeSocket();
@@ -55,4 +144,4 @@ private:
     void handleMessage(const NetworkMessage& msg);
 };
 
-#endif // NETWORK_SERVER_H
\ No newline at end of file
+#endif // NETWORK_SERVER_H
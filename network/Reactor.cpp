@@ -0,0 +1,236 @@
+#include "Reactor.h"
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#endif
+
+namespace {
+
+#ifndef __linux__
+// 没有唤醒fd的平台上，poll的超时决定注册变化和停止的生效延迟
+const int pollIntervalMs = 20;
+#endif
+
+// 单次等待最多取出的事件数
+const int maxEvents = 64;
+
+#ifdef __linux__
+// 已注册套接字关注的事件，可写事件只在有积压待发送时打开
+uint32_t epollEvents(bool wantWrite) {
+    return EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0u);
+}
+#endif
+
+} // namespace
+
+Reactor::Reactor() : running(false) {
+#ifdef __linux__
+    epollFd = -1;
+    wakeFd = -1;
+#endif
+}
+
+Reactor::~Reactor() {
+    stop();
+}
+
+bool Reactor::start() {
+    if (running) return true;
+
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::cerr << "创建epoll失败: " << errno << std::endl;
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+        epollFd = wakeFd = -1;
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    // 启动前已注册的套接字
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex);
+        for (const auto& entry : handlers) {
+            epoll_event socketEvent{};
+            socketEvent.events = epollEvents(entry.second->wantWrite);
+            socketEvent.data.fd = entry.first;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, entry.first, &socketEvent);
+        }
+    }
+#endif
+
+    running = true;
+    ioThread = std::thread(&Reactor::loop, this);
+    return true;
+}
+
+void Reactor::stop() {
+    if (!running.exchange(false)) return;
+    wake();
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+
+#ifdef __linux__
+    close(epollFd);
+    close(wakeFd);
+    epollFd = wakeFd = -1;
+#endif
+}
+
+bool Reactor::add(int socket, Handler onReadable, Handler onWritable) {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    auto entry = std::make_shared<Entry>();
+    entry->onReadable = std::move(onReadable);
+    entry->onWritable = std::move(onWritable);
+    handlers[socket] = entry;
+
+#ifdef __linux__
+    if (epollFd >= 0) {
+        epoll_event event{};
+        event.events = epollEvents(false);
+        event.data.fd = socket;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) != 0 &&
+            (errno != EEXIST || epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event) != 0)) {
+            std::cerr << "注册套接字失败: " << errno << std::endl;
+            handlers.erase(socket);
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+void Reactor::remove(int socket) {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    if (handlers.erase(socket) == 0) return;
+
+#ifdef __linux__
+    // 须在关闭套接字之前取消注册
+    if (epollFd >= 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+    }
+#endif
+}
+
+void Reactor::setWriteInterest(int socket, bool enabled) {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    auto it = handlers.find(socket);
+    if (it == handlers.end() || !it->second->onWritable || it->second->wantWrite == enabled) return;
+    it->second->wantWrite = enabled;
+
+#ifdef __linux__
+    if (epollFd >= 0) {
+        epoll_event event{};
+        event.events = epollEvents(enabled);
+        event.data.fd = socket;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event);
+    }
+#endif
+}
+
+void Reactor::wake() {
+#ifdef __linux__
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+}
+
+void Reactor::loop() {
+#ifdef __linux__
+    epoll_event events[maxEvents];
+    while (running) {
+        int count = epoll_wait(epollFd, events, maxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait错误: " << errno << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count && running; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                uint64_t value;
+                ssize_t bytes = read(wakeFd, &value, sizeof(value));
+                (void)bytes;
+                continue;
+            }
+
+            uint32_t flags = events[i].events;
+            dispatch(fd, (flags & ~static_cast<uint32_t>(EPOLLOUT)) != 0, (flags & EPOLLOUT) != 0);
+        }
+    }
+#else
+    #ifdef _WIN32
+    std::vector<WSAPOLLFD> fds;
+    #else
+    std::vector<pollfd> fds;
+    #endif
+    while (running) {
+        fds.clear();
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            for (const auto& entry : handlers) {
+                fds.push_back({});
+                fds.back().fd = entry.first;
+                fds.back().events = POLLIN | (entry.second->wantWrite ? POLLOUT : 0);
+            }
+        }
+
+        #ifdef _WIN32
+        int count = fds.empty() ? (Sleep(pollIntervalMs), 0)
+                                : WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), pollIntervalMs);
+        #else
+        int count = poll(fds.data(), fds.size(), pollIntervalMs);
+        #endif
+        if (count <= 0) continue;
+
+        for (size_t i = 0; i < fds.size() && running; ++i) {
+            if (fds[i].revents != 0) {
+                dispatch(static_cast<int>(fds[i].fd), (fds[i].revents & ~POLLOUT) != 0, (fds[i].revents & POLLOUT) != 0);
+            }
+        }
+    }
+#endif
+}
+
+void Reactor::dispatch(int socket, bool readable, bool writable) {
+    // 拷一份回调再调用，回调里可以注册或取消注册套接字；等待期间已取消注册的套接字不再调用
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex);
+        auto it = handlers.find(socket);
+        if (it != handlers.end()) entry = it->second;
+    }
+    if (!entry) return;
+    if (readable && entry->onReadable) {
+        entry->onReadable();
+    }
+    if (writable && entry->onWritable) {
+        // 可读回调可能已经断开了这个套接字
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            auto it = handlers.find(socket);
+            if (it == handlers.end() || it->second != entry) return;
+        }
+        entry->onWritable();
+    }
+}
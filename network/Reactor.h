@@ -0,0 +1,65 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 事件驱动的套接字I/O：一个I/O线程阻塞等待已注册套接字的可读事件，就绪时才唤醒并调用其回调
+// 取代"非阻塞recv失败后sleep再试"的轮询，消息到达后立即分发，空闲时没有唤醒
+// Linux上用epoll，停止时由eventfd唤醒；其他平台用poll/WSAPoll，注册变化和停止最迟在pollInterval后生效
+// 回调在I/O线程上执行，应读出套接字中已到达的全部数据（水平触发，未读完的数据会再次触发）
+// 发送缓冲满时可以临时打开套接字的可写事件，由I/O线程在对端读走数据后继续发送
+class Reactor {
+public:
+    typedef std::function<void()> Handler;
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // 启动I/O线程，已在运行时直接返回true
+    bool start();
+    // 停止并等待I/O线程退出，之后不会再调用任何回调；不能在回调里调用
+    void stop();
+    bool isRunning() const { return running; }
+
+    // 注册套接字的可读事件（含对端关闭和错误），可以在回调里调用
+    // onWritable为空时不会关注可写事件
+    bool add(int socket, Handler onReadable, Handler onWritable = Handler());
+    // 取消注册；在回调里调用时，正在执行的回调照常返回
+    void remove(int socket);
+    // 打开或关闭已注册套接字的可写事件（水平触发，写完积压后应关闭），可以在任意线程调用
+    void setWriteInterest(int socket, bool enabled);
+
+private:
+    void loop();
+    // 唤醒阻塞中的I/O线程
+    void wake();
+    // 调用套接字当前注册的回调
+    void dispatch(int socket, bool readable, bool writable);
+
+    struct Entry {
+        Handler onReadable;
+        Handler onWritable;
+        bool wantWrite = false;
+    };
+
+    std::atomic<bool> running;
+    std::thread ioThread;
+
+    std::mutex handlersMutex;
+    std::map<int, std::shared_ptr<Entry>> handlers;
+
+#ifdef __linux__
+    int epollFd;
+    int wakeFd;
+#endif
+};
+
+#endif // REACTOR_H
@@ -0,0 +1,45 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <cstdint>
+#include <vector>
+
+// UDP通道和世界快照共用的小端整数读写与回绕序号比较，只在network目录内部使用
+namespace wire {
+
+inline void writeU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void writeU32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// 追加到out末尾
+inline void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+    uint8_t bytes[4];
+    writeU32(bytes, value);
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+inline uint16_t readU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline uint32_t readU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8)
+         | (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// 序号回绕时仍能比较先后：a比b新时返回true
+inline bool sequenceNewer(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+} // namespace wire
+
+#endif // WIRE_FORMAT_H
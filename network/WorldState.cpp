@@ -0,0 +1,562 @@
+#include "WorldState.h"
+#include "DatagramChannel.h"
+#include "MessageFraming.h"
+#include "WireFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+// 各字段的位宽
+const int positionBits = 14;
+const int velocityBits = 11;
+const int healthBits = 10;
+const int flagBits = 4;
+const int attackBits = 6;
+const int aggressionBits = 7;
+const int fieldCount = 5;
+// 新建时才发送的相位、阵营、颜色和基因
+const int creationBits = 8 + 1 + 24 + 8 * static_cast<int>(Gene::LENGTH);
+
+const float positionScale = 8.0f;
+const float velocityScale = 64.0f;
+const float healthScale = 4.0f;
+const float twoPi = 6.28318531f;
+
+// 快照头：4字节序号加4字节基线序号，之后是位打包的记录
+const size_t snapshotHeaderSize = 8;
+
+int quantize(float value, float scale, int offset, int minValue, int bits) {
+    int q = static_cast<int>(std::lround(value * scale)) + offset;
+    return std::max(minValue, std::min(q, (1 << bits) - 1));
+}
+
+// 从低位起逐位追加到字节数组
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out), scratch(0), used(0) {}
+
+    void write(uint32_t value, int bits) {
+        scratch |= static_cast<uint64_t>(value & static_cast<uint32_t>((uint64_t(1) << bits) - 1)) << used;
+        used += bits;
+        while (used >= 8) {
+            out.push_back(static_cast<uint8_t>(scratch));
+            scratch >>= 8;
+            used -= 8;
+        }
+    }
+
+    // 0阶指数哥伦布码：value+1的有效位数减1个0、一个1，再写去掉最高位的value+1
+    void writeGamma(uint32_t value) {
+        uint64_t v = static_cast<uint64_t>(value) + 1;
+        int n = 0;
+        while ((v >> (n + 1)) != 0) ++n;
+        write(0, n);
+        write(1, 1);
+        write(static_cast<uint32_t>(v), n);
+    }
+
+    void flush() {
+        if (used > 0) {
+            out.push_back(static_cast<uint8_t>(scratch));
+            scratch = 0;
+            used = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t scratch;
+    int used;
+};
+
+// 读越界后failed()为true，之后读出的都是0
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size), position(0), overflow(false) {}
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i) {
+            if (position >= size * 8) {
+                overflow = true;
+                return 0;
+            }
+            value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7)) & 1) << i;
+            ++position;
+        }
+        return value;
+    }
+
+    uint32_t readGamma() {
+        int n = 0;
+        while (!overflow && read(1) == 0) {
+            if (++n > 32) overflow = true;
+        }
+        if (overflow) return 0;
+        uint64_t v = (uint64_t(1) << n) | read(n);
+        return static_cast<uint32_t>(v - 1);
+    }
+
+    bool failed() const { return overflow; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    bool overflow;
+};
+
+int gammaBits(uint32_t value) {
+    uint64_t v = static_cast<uint64_t>(value) + 1;
+    int n = 0;
+    while ((v >> (n + 1)) != 0) ++n;
+    return 2 * n + 1;
+}
+
+int fieldBits(uint8_t fields) {
+    int bits = 0;
+    if (fields & worldstate::POSITION) bits += 2 * positionBits;
+    if (fields & worldstate::VELOCITY) bits += 2 * velocityBits;
+    if (fields & worldstate::HEALTH) bits += healthBits;
+    if (fields & worldstate::COMBAT) bits += flagBits + attackBits;
+    if (fields & worldstate::AGGRESSION) bits += aggressionBits;
+    return bits;
+}
+
+// 一条记录除编号差以外的位数
+int recordBits(uint8_t fields, bool created, bool removed) {
+    if (removed) return 1;
+    if (created) return 2 + fieldBits(worldstate::ALL_FIELDS) + creationBits;
+    return 2 + fieldCount + fieldBits(fields);
+}
+
+void writeFields(BitWriter& writer, const worldstate::EntityState& state, uint8_t fields) {
+    if (fields & worldstate::POSITION) {
+        writer.write(state.x, positionBits);
+        writer.write(state.y, positionBits);
+    }
+    if (fields & worldstate::VELOCITY) {
+        writer.write(state.vx, velocityBits);
+        writer.write(state.vy, velocityBits);
+    }
+    if (fields & worldstate::HEALTH) {
+        writer.write(state.health, healthBits);
+    }
+    if (fields & worldstate::COMBAT) {
+        writer.write(state.flags, flagBits);
+        writer.write(state.attack, attackBits);
+    }
+    if (fields & worldstate::AGGRESSION) {
+        writer.write(state.aggression, aggressionBits);
+    }
+}
+
+void readFields(BitReader& reader, worldstate::EntityState& state, uint8_t fields) {
+    if (fields & worldstate::POSITION) {
+        state.x = static_cast<uint16_t>(reader.read(positionBits));
+        state.y = static_cast<uint16_t>(reader.read(positionBits));
+    }
+    if (fields & worldstate::VELOCITY) {
+        state.vx = static_cast<uint16_t>(reader.read(velocityBits));
+        state.vy = static_cast<uint16_t>(reader.read(velocityBits));
+    }
+    if (fields & worldstate::HEALTH) {
+        state.health = static_cast<uint16_t>(reader.read(healthBits));
+    }
+    if (fields & worldstate::COMBAT) {
+        state.flags = static_cast<uint8_t>(reader.read(flagBits));
+        state.attack = static_cast<uint8_t>(reader.read(attackBits));
+    }
+    if (fields & worldstate::AGGRESSION) {
+        state.aggression = static_cast<uint8_t>(reader.read(aggressionBits));
+    }
+}
+
+void writeCreation(BitWriter& writer, const worldstate::EntityState& state) {
+    writer.write(state.phase, 8);
+    writer.write(state.faction, 1);
+    for (uint8_t channel : state.color) {
+        writer.write(channel, 8);
+    }
+    for (char c : state.gene) {
+        writer.write(static_cast<uint8_t>(c), 8);
+    }
+}
+
+void readCreation(BitReader& reader, worldstate::EntityState& state) {
+    state.phase = static_cast<uint8_t>(reader.read(8));
+    state.faction = static_cast<uint8_t>(reader.read(1));
+    for (uint8_t& channel : state.color) {
+        channel = static_cast<uint8_t>(reader.read(8));
+    }
+    for (char& c : state.gene) {
+        c = static_cast<char>(reader.read(8));
+    }
+}
+
+const worldstate::EntityState* findById(const std::vector<worldstate::EntityState>& view, uint32_t id) {
+    auto it = std::lower_bound(view.begin(), view.end(), id,
+                               [](const worldstate::EntityState& state, uint32_t key) { return state.id < key; });
+    return it != view.end() && it->id == id ? &*it : nullptr;
+}
+
+const std::vector<worldstate::EntityState> emptyWorld;
+
+} // namespace
+
+namespace worldstate {
+
+const size_t defaultBudget = datagram::maxFramesSize - framing::headerSize;
+
+uint8_t EntityState::diff(const EntityState& other) const {
+    uint8_t fields = 0;
+    if (x != other.x || y != other.y) fields |= POSITION;
+    if (vx != other.vx || vy != other.vy) fields |= VELOCITY;
+    if (health != other.health) fields |= HEALTH;
+    if (flags != other.flags || attack != other.attack) fields |= COMBAT;
+    if (aggression != other.aggression) fields |= AGGRESSION;
+    return fields;
+}
+
+EntityState capture(const BaseCell& cell) {
+    const CellStore& store = CellStore::instance();
+    const int slot = cell.getSlot();
+
+    EntityState state;
+    state.id = cell.getNetworkId();
+    state.x = static_cast<uint16_t>(quantize(store.posX[slot], positionScale, 0, 0, positionBits));
+    state.y = static_cast<uint16_t>(quantize(store.posY[slot], positionScale, 0, 0, positionBits));
+    const int velocityOffset = 1 << (velocityBits - 1);
+    state.vx = static_cast<uint16_t>(quantize(store.velX[slot], velocityScale, velocityOffset, 0, velocityBits));
+    state.vy = static_cast<uint16_t>(quantize(store.velY[slot], velocityScale, velocityOffset, 0, velocityBits));
+    // 存活的细胞量化后不能变成0血，否则客户端会把它当作死亡移除
+    const float health = store.health[slot];
+    state.health = static_cast<uint16_t>(quantize(health, healthScale, 0, health > 0.0f ? 1 : 0, healthBits));
+    state.flags = store.flags[slot] & ((1 << flagBits) - 1);
+    state.attack = static_cast<uint8_t>(quantize(store.attackTime[slot], 63.0f, 0, 0, attackBits));
+    state.aggression = static_cast<uint8_t>(quantize(cell.getAggressionLevel(), 127.0f, 0, 0, aggressionBits));
+
+    state.phase = static_cast<uint8_t>(std::lround(cell.getTailPhaseOffset() / twoPi * 256.0f) & 0xFF);
+    state.faction = static_cast<uint8_t>(cell.getFaction() & 1);
+    const cv::Vec3b& color = cell.getColor();
+    for (int i = 0; i < 3; ++i) {
+        state.color[i] = color[i];
+    }
+    std::copy(cell.getGene().begin(), cell.getGene().end(), state.gene);
+    return state;
+}
+
+std::shared_ptr<BaseCell> createCell(const EntityState& state) {
+    // BaseCell本身不做行为决策，只按速度推进物理，在两个快照之间外推位置
+    cv::Vec3b color(state.color[0], state.color[1], state.color[2]);
+    auto cell = std::make_shared<BaseCell>(cv::Point2f(0.0f, 0.0f), 0, color, state.phase * twoPi / 256.0f,
+                                           0.0f, Gene(std::string(state.gene, Gene::LENGTH)));
+    // 阵营会按基因重新调色，之后再恢复服务器上的颜色
+    cell->setFaction(state.faction);
+    cell->setColor(color);
+    applyFields(*cell, state, ALL_FIELDS);
+    return cell;
+}
+
+void applyFields(BaseCell& cell, const EntityState& state, uint8_t fields) {
+    CellStore& store = CellStore::instance();
+    const int slot = cell.getSlot();
+    if (fields & POSITION) {
+        cell.setPosition(cv::Point2f(state.x / positionScale, state.y / positionScale));
+    }
+    if (fields & VELOCITY) {
+        const int velocityOffset = 1 << (velocityBits - 1);
+        cell.setVelocity(cv::Point2f((state.vx - velocityOffset) / velocityScale, (state.vy - velocityOffset) / velocityScale));
+    }
+    if (fields & HEALTH) {
+        store.health[slot] = state.health / healthScale;
+    }
+    if (fields & COMBAT) {
+        const uint8_t mask = (1 << flagBits) - 1;
+        store.flags[slot] = static_cast<uint8_t>((store.flags[slot] & ~mask) | state.flags);
+        store.attackTime[slot] = state.attack / 63.0f;
+    }
+    if (fields & AGGRESSION) {
+        cell.setAggressionLevel(state.aggression / 127.0f);
+    }
+}
+
+std::vector<uint8_t> encodeAck(uint32_t sequence) {
+    std::vector<uint8_t> data;
+    wire::appendU32(data, sequence);
+    return data;
+}
+
+bool decodeAck(const std::vector<uint8_t>& data, uint32_t& sequence) {
+    if (data.size() < 4) return false;
+    sequence = wire::readU32(data.data());
+    return true;
+}
+
+} // namespace worldstate
+
+using worldstate::EntityState;
+
+WorldStateEncoder::WorldStateEncoder(size_t budgetBytes)
+    : budgetBits(budgetBytes > snapshotHeaderSize ? (budgetBytes - snapshotHeaderSize) * 8 : 0),
+      nextSequence(1), ackedSequence(0) {
+}
+
+void WorldStateEncoder::encode(const std::vector<EntityState>& world, std::vector<uint8_t>& out) {
+    const uint32_t sequence = nextSequence++;
+
+    // 基线取最近确认的快照；还没有确认或它已移出历史时从空世界编码
+    const Frame& acked = history[ackedSequence % historySize];
+    const bool haveBaseline = ackedSequence != 0 && acked.sequence == ackedSequence;
+    const std::vector<EntityState>& baseline = haveBaseline ? acked.view : emptyWorld;
+    if (ackedSequence != 0 && !haveBaseline) {
+        ++stats.resyncs;
+    }
+
+    // 按编号合并当前世界和基线，找出新建、变化和移除的实体
+    struct Candidate {
+        uint32_t id;
+        size_t index;     // 在world中的下标，移除时不用
+        uint8_t fields;
+        bool created;
+        bool removed;
+        uint32_t waited;
+        int bits;
+    };
+    std::vector<Candidate> candidates;
+    size_t w = 0, b = 0;
+    while (w < world.size() || b < baseline.size()) {
+        Candidate candidate{0, 0, 0, false, false, 0, 0};
+        if (b == baseline.size() || (w < world.size() && world[w].id < baseline[b].id)) {
+            candidate.id = world[w].id;
+            candidate.index = w++;
+            candidate.fields = worldstate::ALL_FIELDS;
+            candidate.created = true;
+        } else if (w == world.size() || baseline[b].id < world[w].id) {
+            candidate.id = baseline[b++].id;
+            candidate.removed = true;
+        } else {
+            candidate.fields = world[w].diff(baseline[b]);
+            candidate.id = world[w].id;
+            candidate.index = w++;
+            ++b;
+            if (candidate.fields == 0) continue;
+        }
+        auto it = waiting.find(candidate.id);
+        candidate.waited = it != waiting.end() ? it->second : 0;
+        candidate.bits = recordBits(candidate.fields, candidate.created, candidate.removed);
+        candidates.push_back(candidate);
+    }
+
+    // 移除最便宜且能让客户端尽快对齐，排在最前；其余按等待的快照数，相同时编号小的优先
+    std::vector<Candidate> order = candidates;
+    std::sort(order.begin(), order.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.removed != b.removed) return a.removed;
+        if (a.waited != b.waited) return a.waited > b.waited;
+        return a.id < b.id;
+    });
+
+    // 编号差的位数取决于最终选中的集合，先按候选的平均间隔估计，编码前再按实际位数修正
+    uint32_t spread = candidates.empty() ? 0 : candidates.back().id - candidates.front().id;
+    int gapEstimate = gammaBits(spread / std::max<uint32_t>(1, static_cast<uint32_t>(candidates.size())));
+    std::vector<Candidate> selected;
+    size_t used = static_cast<size_t>(gammaBits(static_cast<uint32_t>(candidates.size())));
+    for (const Candidate& candidate : order) {
+        size_t cost = static_cast<size_t>(candidate.bits + gapEstimate);
+        if (used + cost > budgetBits) continue;
+        used += cost;
+        selected.push_back(candidate);
+    }
+    // 按编号串成双向链表算一次实际位数；去掉一个实体只改变它自己和前后两个编号差，逐个增减即可
+    const size_t none = selected.size();
+    std::vector<size_t> sortedOrder(selected.size());
+    for (size_t i = 0; i < sortedOrder.size(); ++i) {
+        sortedOrder[i] = i;
+    }
+    std::sort(sortedOrder.begin(), sortedOrder.end(),
+              [&selected](size_t a, size_t b) { return selected[a].id < selected[b].id; });
+    std::vector<size_t> prevById(selected.size(), none), nextById(selected.size(), none);
+    size_t recordTotal = 0;
+    for (size_t k = 0; k < sortedOrder.size(); ++k) {
+        const size_t i = sortedOrder[k];
+        const uint32_t previous = k > 0 ? selected[sortedOrder[k - 1]].id : 0;
+        if (k > 0) prevById[i] = sortedOrder[k - 1];
+        if (k + 1 < sortedOrder.size()) nextById[i] = sortedOrder[k + 1];
+        recordTotal += static_cast<size_t>(gammaBits(selected[i].id - previous - 1) + selected[i].bits);
+    }
+    // selected保持优先级顺序，超出时去掉优先级最低的
+    while (!selected.empty() &&
+           recordTotal + static_cast<size_t>(gammaBits(static_cast<uint32_t>(selected.size()))) > budgetBits) {
+        const size_t i = selected.size() - 1;
+        const uint32_t id = selected[i].id;
+        const uint32_t before = prevById[i] != none ? selected[prevById[i]].id : 0;
+        recordTotal -= static_cast<size_t>(gammaBits(id - before - 1) + selected[i].bits);
+        if (nextById[i] != none) {
+            const uint32_t after = selected[nextById[i]].id;
+            recordTotal -= static_cast<size_t>(gammaBits(after - id - 1));
+            recordTotal += static_cast<size_t>(gammaBits(after - before - 1));
+            prevById[nextById[i]] = prevById[i];
+        }
+        if (prevById[i] != none) nextById[prevById[i]] = nextById[i];
+        selected.pop_back();
+    }
+
+    // 没选中的变化留到之后的快照，等待数加一
+    std::map<uint32_t, uint32_t> stillWaiting;
+    {
+        std::vector<uint32_t> chosen;
+        chosen.reserve(selected.size());
+        for (const Candidate& candidate : selected) {
+            chosen.push_back(candidate.id);
+        }
+        std::sort(chosen.begin(), chosen.end());
+        for (const Candidate& candidate : candidates) {
+            if (!std::binary_search(chosen.begin(), chosen.end(), candidate.id)) {
+                stillWaiting[candidate.id] = candidate.waited + 1;
+            }
+        }
+    }
+    stats.deferred += stillWaiting.size();
+    waiting.swap(stillWaiting);
+
+    std::sort(selected.begin(), selected.end(), [](const Candidate& a, const Candidate& b) { return a.id < b.id; });
+
+    // 编码
+    out.clear();
+    wire::appendU32(out, sequence);
+    wire::appendU32(out, haveBaseline ? ackedSequence : 0);
+    BitWriter writer(out);
+    writer.writeGamma(static_cast<uint32_t>(selected.size()));
+    uint32_t previous = 0;
+    for (const Candidate& candidate : selected) {
+        writer.writeGamma(candidate.id - previous - 1);
+        previous = candidate.id;
+        writer.write(candidate.removed ? 1 : 0, 1);
+        if (candidate.removed) continue;
+        writer.write(candidate.created ? 1 : 0, 1);
+        const EntityState& state = world[candidate.index];
+        if (candidate.created) {
+            writeFields(writer, state, worldstate::ALL_FIELDS);
+            writeCreation(writer, state);
+        } else {
+            writer.write(candidate.fields, fieldCount);
+            writeFields(writer, state, candidate.fields);
+        }
+    }
+    writer.flush();
+
+    // 客户端解码后的世界：基线加上本快照的记录；选中的实体与服务器当前状态一致，其余保持基线
+    std::vector<EntityState> view;
+    view.reserve(baseline.size() + selected.size());
+    b = 0;
+    for (const Candidate& candidate : selected) {
+        while (b < baseline.size() && baseline[b].id < candidate.id) {
+            view.push_back(baseline[b++]);
+        }
+        if (b < baseline.size() && baseline[b].id == candidate.id) ++b;
+        if (!candidate.removed) view.push_back(world[candidate.index]);
+    }
+    view.insert(view.end(), baseline.begin() + b, baseline.end());
+
+    // 基线可能与新快照共用历史中的同一格，全部用完后才覆盖
+    Frame& frame = history[sequence % historySize];
+    frame.sequence = sequence;
+    frame.view.swap(view);
+
+    ++stats.snapshots;
+    stats.bytes += out.size();
+    stats.records += selected.size();
+}
+
+void WorldStateEncoder::acknowledge(uint32_t sequence) {
+    // 只接受更新且仍在历史中的确认；迟到的旧确认不会让基线倒退
+    if (sequence == 0 || !wire::sequenceNewer(nextSequence, sequence)) return;
+    if (ackedSequence != 0 && !wire::sequenceNewer(sequence, ackedSequence)) return;
+    if (history[sequence % historySize].sequence != sequence) return;
+    ackedSequence = sequence;
+}
+
+WorldStateDecoder::WorldStateDecoder() : latestSequence(0) {
+}
+
+bool WorldStateDecoder::decode(const std::vector<uint8_t>& data) {
+    if (data.size() < snapshotHeaderSize) return false;
+    const uint32_t sequence = wire::readU32(data.data());
+    const uint32_t baselineSequence = wire::readU32(data.data() + 4);
+    if (sequence == 0 || (latestSequence != 0 && !wire::sequenceNewer(sequence, latestSequence))) return false;
+
+    const std::vector<EntityState>* baseline = &emptyWorld;
+    if (baselineSequence != 0) {
+        const Frame& frame = history[baselineSequence % historySize];
+        if (frame.sequence != baselineSequence) return false;
+        baseline = &frame.view;
+    }
+
+    // 先完整解析记录，出错时不改动已有的世界
+    BitReader reader(data.data() + snapshotHeaderSize, data.size() - snapshotHeaderSize);
+    const uint32_t count = reader.readGamma();
+    if (reader.failed() || count > (data.size() - snapshotHeaderSize) * 8) return false;
+
+    std::vector<Change> changes;
+    std::vector<EntityState> states;
+    changes.reserve(count);
+    states.reserve(count);
+    uint64_t id = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        id += static_cast<uint64_t>(reader.readGamma()) + 1;
+        if (reader.failed() || id > 0xFFFFFFFFu) return false;
+
+        Change change{static_cast<uint32_t>(id), 0, false, false};
+        EntityState state;
+        state.id = change.id;
+        change.removed = reader.read(1) != 0;
+        if (!change.removed) {
+            change.created = reader.read(1) != 0;
+            if (change.created) {
+                change.fields = worldstate::ALL_FIELDS;
+                readFields(reader, state, worldstate::ALL_FIELDS);
+                readCreation(reader, state);
+            } else {
+                // 只写了变化字段的记录必须以基线中的同一实体为底
+                const EntityState* base = findById(*baseline, change.id);
+                if (!base) return false;
+                state = *base;
+                change.fields = static_cast<uint8_t>(reader.read(fieldCount));
+                readFields(reader, state, change.fields);
+            }
+        }
+        if (reader.failed()) return false;
+        changes.push_back(change);
+        states.push_back(state);
+    }
+
+    std::vector<EntityState> view;
+    view.reserve(baseline->size() + states.size());
+    size_t b = 0;
+    for (size_t i = 0; i < changes.size(); ++i) {
+        while (b < baseline->size() && (*baseline)[b].id < changes[i].id) {
+            view.push_back((*baseline)[b++]);
+        }
+        if (b < baseline->size() && (*baseline)[b].id == changes[i].id) ++b;
+        if (!changes[i].removed) view.push_back(states[i]);
+    }
+    view.insert(view.end(), baseline->begin() + b, baseline->end());
+
+    Frame& frame = history[sequence % historySize];
+    frame.sequence = sequence;
+    frame.view.swap(view);
+    latestSequence = sequence;
+    lastChanges.swap(changes);
+    return true;
+}
+
+const std::vector<EntityState>& WorldStateDecoder::world() const {
+    if (latestSequence == 0) return emptyWorld;
+    return history[latestSequence % historySize].view;
+}
+
+const EntityState* WorldStateDecoder::find(uint32_t id) const {
+    return findById(world(), id);
+}
@@ -0,0 +1,138 @@
+#ifndef WORLD_STATE_H
+#define WORLD_STATE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "../entities/BaseCell.h"
+
+// 服务器权威的世界快照：AI细胞、后代等非玩家细胞的状态经GAME_STATE发给客户端（玩家仍走PLAYER_STATE）
+// 每个客户端的快照相对它最近确认的快照做增量编码，只写基线之后变化了的字段：
+// 实体按编号升序排列，每条记录是编号差、移除位、新建位和按字段分组的变化位图，之后是量化后位打包的字段
+// 快照有字节预算，变化的实体超出预算时按等待的快照数排优先级，其余留到之后的快照，
+// 所以每个快照的大小不随实体数增长，始终放得进一个UDP包；没写进快照的实体在客户端保持基线的状态
+// 客户端收到快照后回一条只含快照序号的GAME_STATE作为确认，确认丢失时服务器继续以更早的快照为基线
+namespace worldstate {
+
+// 字段分组，变化位图中的位
+enum Field : uint8_t {
+    POSITION   = 1 << 0,
+    VELOCITY   = 1 << 1,
+    HEALTH     = 1 << 2,
+    COMBAT     = 1 << 3,  // 状态标志和攻击进度
+    AGGRESSION = 1 << 4,
+    ALL_FIELDS = (1 << 5) - 1
+};
+
+// 量化后的实体状态；比较和编码都在量化值上进行，浮点抖动不会产生变化
+struct EntityState {
+    uint32_t id = 0;
+    uint16_t x = 0, y = 0;       // 1/8像素
+    uint16_t vx = 0, vy = 0;     // 1/64像素每步，加偏移后为无符号数
+    uint16_t health = 0;         // 1/4点，存活的细胞至少为1
+    uint8_t flags = 0;           // CellStore::Flag的低4位
+    uint8_t attack = 0;          // 攻击进度，0-63
+    uint8_t aggression = 0;      // 攻击性，0-127
+    // 以下只在新建时发送
+    uint8_t phase = 0;           // 尾巴摆动相位，0-255对应0-2π
+    uint8_t faction = 0;
+    uint8_t color[3] = {0, 0, 0};
+    char gene[Gene::LENGTH] = {};
+
+    // 与other相比变化了的字段分组
+    uint8_t diff(const EntityState& other) const;
+};
+
+// 快照负载的默认预算：加上帧头后恰好放得进一个UDP包
+extern const size_t defaultBudget;
+
+// 量化细胞的当前状态
+EntityState capture(const BaseCell& cell);
+// 按快照创建一个不做自主行为的细胞，由之后的快照驱动
+std::shared_ptr<BaseCell> createCell(const EntityState& state);
+// 把fields中的字段写回细胞
+void applyFields(BaseCell& cell, const EntityState& state, uint8_t fields);
+
+// 客户端的确认消息：4字节小端快照序号
+std::vector<uint8_t> encodeAck(uint32_t sequence);
+bool decodeAck(const std::vector<uint8_t>& data, uint32_t& sequence);
+
+} // namespace worldstate
+
+// 服务器上每个客户端一个：保存最近发出的快照（客户端视角的世界），按确认选基线做增量编码
+class WorldStateEncoder {
+public:
+    struct Stats {
+        size_t snapshots = 0;  // 编码的快照数
+        size_t bytes = 0;      // 快照负载的总字节数
+        size_t records = 0;    // 写入的实体记录数
+        size_t deferred = 0;   // 因预算留到之后的变化实体数（按快照累计）
+        size_t resyncs = 0;    // 确认的基线已不在历史中、从空世界重新编码的快照数
+    };
+
+    explicit WorldStateEncoder(size_t budgetBytes = worldstate::defaultBudget);
+
+    // 编码一个快照到out（覆盖原内容）；world为服务器当前的实体状态，按编号升序
+    void encode(const std::vector<worldstate::EntityState>& world, std::vector<uint8_t>& out);
+    // 客户端确认收到了sequence号快照，之后以它为基线
+    void acknowledge(uint32_t sequence);
+
+    uint32_t getAckedSequence() const { return ackedSequence; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    // 确认过旧的快照不再保留，基线只能取最近historySize个快照之一
+    static const size_t historySize = 32;
+    struct Frame {
+        uint32_t sequence = 0;
+        std::vector<worldstate::EntityState> view;
+    };
+
+    size_t budgetBits;
+    uint32_t nextSequence;
+    uint32_t ackedSequence;
+    std::array<Frame, historySize> history;
+    // 有待发送变化的实体已等待的快照数，决定超出预算时的先后
+    std::map<uint32_t, uint32_t> waiting;
+    Stats stats;
+};
+
+// 客户端的解码器：按快照引用的基线还原世界，并给出本快照写到的实体，供游戏更新对应的细胞
+class WorldStateDecoder {
+public:
+    // 本快照写到的一个实体
+    struct Change {
+        uint32_t id;
+        uint8_t fields;  // 变化的字段分组，新建时为ALL_FIELDS
+        bool created;
+        bool removed;
+    };
+
+    WorldStateDecoder();
+
+    // 解码一个快照；格式错误、基线已不在、或不比上一个快照新时返回false，世界保持不变
+    bool decode(const std::vector<uint8_t>& data);
+
+    // 最近解码的快照序号，0表示还没有
+    uint32_t getSequence() const { return latestSequence; }
+    const std::vector<worldstate::EntityState>& world() const;
+    const std::vector<Change>& changes() const { return lastChanges; }
+    // 当前世界中编号为id的实体，不存在时返回nullptr
+    const worldstate::EntityState* find(uint32_t id) const;
+
+private:
+    static const size_t historySize = 32;
+    struct Frame {
+        uint32_t sequence = 0;
+        std::vector<worldstate::EntityState> view;
+    };
+
+    uint32_t latestSequence;
+    std::array<Frame, historySize> history;
+    std::vector<Change> lastChanges;
+};
+
+#endif // WORLD_STATE_H
@@ -1,60 +1,25 @@
 #include "physics.h"
-#include <random>
 #include <algorithm> // for std::clamp
 #include "entities/BaseCell.h"
+#include "simulation/ParticleSystem.h"
+#include "simulation/Random.h"
 
 using namespace cv;
 using namespace std;
 
-// Function to update blood drops physics
-void updateBloodDrops(vector<BloodDrop>& bloodDrops, float deltaTime) {
-    // Gravity constant
-    const float gravity = 9.8f;
-
-    for (auto it = bloodDrops.begin(); it != bloodDrops.end();) {
-        // Update lifetime
-        it->lifetime -= deltaTime;
-
-        if (it->lifetime <= 0) {
-            // Remove dead blood drops
-            it = bloodDrops.erase(it);
-        } else {
-            // Update position based on velocity
-            it->position += it->velocity * deltaTime;
-
-            // Apply gravity
-            it->velocity.y += gravity * deltaTime;
-
-            // Note: We keep rotation fixed as assigned at creation
-
-            ++it;
-        }
-    }
-}
-
 // Function to create blood splash effect at a specific position
-void createBloodEffect(BaseCell& cell, const Point2f& hitPosition, bool faceRight, const Point2f& spearTipPosition) {
+void createBloodEffect(const Point2f& hitPosition, bool faceRight, const Point2f& spearTipPosition) {
     // Direction factor based on facing direction
     float directionFactor = faceRight ? 1.0f : -1.0f;
 
-    // Random number generators
-    random_device rd;
-    mt19937 gen(rd());
-
-    // Distributions for a splatter effect
-    uniform_real_distribution<float> velXDist(-2.0f, 2.0f);
-    uniform_real_distribution<float> velYDist(-3.0f, 0.5f); // Upward bias
-    uniform_real_distribution<float> offsetXDist(-20.0f, 20.0f); // Position X offset
-    uniform_real_distribution<float> offsetYDist(-20.0f, 20.0f); // Position Y offset
-    uniform_real_distribution<float> forwardOffsetDist(15.0f, 25.0f); // Forward offset (in front of spear)
-    uniform_real_distribution<float> sizeDist(4.0f, 7.0f); // Even larger blood drop since we only have one
-    uniform_real_distribution<float> lifeDist(0.6f, 1.3f); // Longer lifetime
+    // 战斗阶段串行执行，直接使用世界随机流
+    Pcg32& gen = Random::world();
 
     // Just one blood drop now
     // Add forward offset in the facing direction plus some randomness
-    float forwardOffset = forwardOffsetDist(gen); // 15-25 pixels forward
-    float offsetX = offsetXDist(gen);
-    float offsetY = offsetYDist(gen);
+    float forwardOffset = gen.uniform(15.0f, 25.0f); // 15-25 pixels forward
+    float offsetX = gen.uniform(-20.0f, 20.0f);
+    float offsetY = gen.uniform(-20.0f, 20.0f);
 
     // Calculate the base position with forward offset in the direction the spear is facing
     Point2f basePosition = hitPosition + Point2f(directionFactor * forwardOffset, 0);
@@ -63,12 +28,12 @@ void createBloodEffect(BaseCell& cell, const Point2f& hitPosition, bool faceRigh
     Point2f dropPosition(basePosition.x + offsetX, basePosition.y + offsetY);
 
     // Random velocity with directional bias
-    float vx = velXDist(gen) + directionFactor * 1.5f;
-    float vy = velYDist(gen); // Mostly upward for splash effect
+    float vx = gen.uniform(-2.0f, 2.0f) + directionFactor * 1.5f;
+    float vy = gen.uniform(-3.0f, 0.5f); // Mostly upward for splash effect
 
     // Random size and lifetime
-    float size = sizeDist(gen);
-    float lifetime = lifeDist(gen);
+    float size = gen.uniform(4.0f, 7.0f); // Even larger blood drop since we only have one
+    float lifetime = gen.uniform(0.6f, 1.3f); // Longer lifetime
 
     // Calculate the direction from the spear tip to the blood drop position
     Point2f directionVector = dropPosition - spearTipPosition;
@@ -76,17 +41,12 @@ void createBloodEffect(BaseCell& cell, const Point2f& hitPosition, bool faceRigh
     // Calculate the rotation angle so that the pointed end of the blood drop points AWAY from the spear
     float rotation = atan2(directionVector.y, directionVector.x) - CV_PI/2;
 
-    // 使用新添加的方法添加血滴效果
-    cell.addBloodDrop(dropPosition, Point2f(vx, vy), size, lifetime, rotation);
+    // 血滴交给世界级的粒子池，细胞死亡后仍会播放完
+    ParticleSystem::instance().spawn(dropPosition, Point2f(vx, vy), size, lifetime, rotation);
 }
 
-// Function to check if a spear attack hits another cell
-bool checkSpearCollision(const BaseCell& attacker, const BaseCell& target, float scale, float cellWidth,
-                         Point2f& hitPosition, Point2f& spearTipPosition) {
-    if (!attacker.isAttacking() || attacker.getAttackTime() >= 0.5f) {
-        return false; // Only check during forward thrust
-    }
-
+// Function to compute the spear tip position of an attacking cell
+Point2f computeSpearTip(const BaseCell& attacker, float scale) {
     // Direction facing
     float directionFactor = attacker.isFacingRight() ? 1.0f : -1.0f;
 
@@ -95,7 +55,22 @@ bool checkSpearCollision(const BaseCell& attacker, const BaseCell& target, float
     float spearLength = 100.0f * scale;
     float spearTipX = attacker.getPosition().x + directionFactor * (spearLength * 1.5f + attackExtension);
     float spearTipY = attacker.getPosition().y + 60.0f * scale - spearLength * 0.3f;
-    Point2f spearTip(spearTipX, spearTipY);
+    return Point2f(spearTipX, spearTipY);
+}
+
+// Function to get the distance within which a spear tip hits a cell center
+float spearHitRadius(float scale, float cellWidth) {
+    return cellWidth * scale * 0.8f;
+}
+
+// Function to check if a spear attack hits another cell
+bool checkSpearCollision(const BaseCell& attacker, const BaseCell& target, float scale, float cellWidth,
+                         Point2f& hitPosition, Point2f& spearTipPosition) {
+    if (!attacker.isAttacking() || attacker.getAttackTime() >= 0.5f) {
+        return false; // Only check during forward thrust
+    }
+
+    Point2f spearTip = computeSpearTip(attacker, scale);
 
     // Calculate distance from spear tip to target center
     float distance = norm(spearTip - target.getPosition());
@@ -105,7 +80,7 @@ bool checkSpearCollision(const BaseCell& attacker, const BaseCell& target, float
     spearTipPosition = spearTip;
 
     // Hit if distance is less than target cell width
-    return distance < cellWidth * scale * 0.8f;
+    return distance < spearHitRadius(scale, cellWidth);
 }
 
 // Function to check if a shield blocks an attack
@@ -123,16 +98,11 @@ bool checkShieldBlock(const BaseCell& defender, const BaseCell& attacker, float
         return false;
     }
 
-    // Direction factors
-    float attackerDirFactor = attacker.isFacingRight() ? 1.0f : -1.0f;
+    // Direction factor of the defender
     float defenderDirFactor = defender.isFacingRight() ? 1.0f : -1.0f;
 
     // Calculate spear tip position with attack extension
-    float attackExtension = attacker.getAttackTime() * 2.0f * 50.0f * scale;
-    float spearLength = 100.0f * scale;
-    float spearTipX = attacker.getPosition().x + attackerDirFactor * (spearLength * 1.5f + attackExtension);
-    float spearTipY = attacker.getPosition().y + 60.0f * scale - spearLength * 0.3f;
-    Point2f spearTip(spearTipX, spearTipY);
+    Point2f spearTip = computeSpearTip(attacker, scale);
 
     // Calculate shield position
     Point2f shieldPos = defender.getPosition();
@@ -178,7 +148,7 @@ void createParryEffect(BaseCell& attacker, BaseCell& defender) {
     // Create blood effect on the attacker (they're damaged by parry)
     Point2f hitPosition = attacker.getPosition();
     Point2f spearTipPosition = attacker.getPosition() + Point2f(directionFactor * 30.0f, 0);
-    createBloodEffect(attacker, hitPosition, !attacker.isFacingRight(), spearTipPosition);
+    createBloodEffect(hitPosition, !attacker.isFacingRight(), spearTipPosition);
 }
 
 // 处理碰撞检测和伤害计算的函数
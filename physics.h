@@ -5,11 +5,14 @@
 #include "structs.h"
 #include "entities/BaseCell.h"
 
-// Function to update blood drops physics
-void updateBloodDrops(std::vector<BloodDrop>& bloodDrops, float deltaTime);
-
 // Function to create blood splash effect at a specific position
-void createBloodEffect(BaseCell& cell, const cv::Point2f& hitPosition, bool faceRight, const cv::Point2f& spearTipPosition);
+void createBloodEffect(const cv::Point2f& hitPosition, bool faceRight, const cv::Point2f& spearTipPosition);
+
+// Function to compute the spear tip position of an attacking cell
+cv::Point2f computeSpearTip(const BaseCell& attacker, float scale);
+
+// Function to get the distance within which a spear tip hits a cell center
+float spearHitRadius(float scale, float cellWidth);
 
 // Function to check if a spear attack hits another cell
 bool checkSpearCollision(const BaseCell& attacker, const BaseCell& target, float scale, float cellWidth,
@@ -0,0 +1,185 @@
+#include "CellGeometry.h"
+#include "../drawing.h"
+#include <cmath>
+
+// 与Compositor相同的SSE2检测
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CELL_GEOMETRY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const float tailWaveFrequency = 3.0f;  // 整条尾巴上的波数
+const float tailWaveSpeed = 5.0f;      // 波沿尾巴移动的速度
+
+// 一个档位的采样位置t和相邻采样点之间的相位增量
+struct TailTable {
+    float t[maxTailPoints];
+    float cosStep;
+    float sinStep;
+};
+
+TailTable makeTailTable(const TailShape& shape) {
+    TailTable table{};
+    for (int i = 0; i <= shape.segments; ++i) {
+        table.t[i] = static_cast<float>(i) / shape.segments;
+    }
+    const double step = tailWaveFrequency * 2.0 * CV_PI / shape.segments;
+    table.cosStep = static_cast<float>(std::cos(step));
+    table.sinStep = static_cast<float>(std::sin(step));
+    return table;
+}
+
+const TailTable& tailTable(CellDetail detail) {
+    static const TailTable full = makeTailTable(tailShape(CellDetail::Full));
+    static const TailTable simplified = makeTailTable(tailShape(CellDetail::Simplified));
+    return detail == CellDetail::Full ? full : simplified;
+}
+
+// 一个细胞的尾巴：x = baseX + spanX * t，y = baseY + swingY * t * sin(相位)
+struct TailParams {
+    float baseX, spanX, baseY, swingY;
+    float sin0, cos0;  // 尾巴起点的相位
+};
+
+TailParams tailParams(const cv::Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                      float tailPhaseOffset, float time, const TailShape& shape) {
+    const float directionFactor = faceRight ? 1.0f : -1.0f;
+    const float phase = time * tailWaveSpeed + tailPhaseOffset;
+    TailParams params;
+    params.baseX = cellPos.x - directionFactor * cellWidth * 0.5f;
+    params.spanX = -directionFactor * shape.lengthFactor * cellWidth;
+    params.baseY = cellPos.y;
+    params.swingY = -directionFactor * 0.25f * cellHeight;
+    params.sin0 = std::sin(phase);
+    params.cos0 = std::cos(phase);
+    return params;
+}
+
+// 标量递推，SSE2路径按相同的运算顺序逐通道计算
+void tailScalar(const TailParams& params, const TailTable& table, int segments, cv::Point2f* out) {
+    float s = params.sin0;
+    float c = params.cos0;
+    for (int i = 0; i <= segments; ++i) {
+        const float t = table.t[i];
+        out[i] = cv::Point2f(params.baseX + params.spanX * t, params.baseY + params.swingY * t * s);
+        const float nextSin = s * table.cosStep + c * table.sinStep;
+        c = c * table.cosStep - s * table.sinStep;
+        s = nextSin;
+    }
+}
+
+#ifdef CELL_GEOMETRY_SSE2
+
+// 4个细胞的尾巴同时递推，每个通道一个细胞
+void tailQuad(const TailParams* params, const TailTable& table, int segments, cv::Point2f* const out[4]) {
+    const __m128 baseX = _mm_setr_ps(params[0].baseX, params[1].baseX, params[2].baseX, params[3].baseX);
+    const __m128 spanX = _mm_setr_ps(params[0].spanX, params[1].spanX, params[2].spanX, params[3].spanX);
+    const __m128 baseY = _mm_setr_ps(params[0].baseY, params[1].baseY, params[2].baseY, params[3].baseY);
+    const __m128 swingY = _mm_setr_ps(params[0].swingY, params[1].swingY, params[2].swingY, params[3].swingY);
+    const __m128 cosStep = _mm_set1_ps(table.cosStep);
+    const __m128 sinStep = _mm_set1_ps(table.sinStep);
+    __m128 s = _mm_setr_ps(params[0].sin0, params[1].sin0, params[2].sin0, params[3].sin0);
+    __m128 c = _mm_setr_ps(params[0].cos0, params[1].cos0, params[2].cos0, params[3].cos0);
+
+    alignas(16) float xs[4];
+    alignas(16) float ys[4];
+    for (int i = 0; i <= segments; ++i) {
+        const __m128 t = _mm_set1_ps(table.t[i]);
+        _mm_store_ps(xs, _mm_add_ps(baseX, _mm_mul_ps(spanX, t)));
+        _mm_store_ps(ys, _mm_add_ps(baseY, _mm_mul_ps(_mm_mul_ps(swingY, t), s)));
+        for (int lane = 0; lane < 4; ++lane) {
+            out[lane][i] = cv::Point2f(xs[lane], ys[lane]);
+        }
+        const __m128 nextSin = _mm_add_ps(_mm_mul_ps(s, cosStep), _mm_mul_ps(c, sinStep));
+        c = _mm_sub_ps(_mm_mul_ps(c, cosStep), _mm_mul_ps(s, sinStep));
+        s = nextSin;
+    }
+}
+
+#endif // CELL_GEOMETRY_SSE2
+
+} // namespace
+
+const TailShape& tailShape(CellDetail detail) {
+    static const TailShape full{30, 2.5f, 6};
+    static const TailShape simplified{10, 1.5f, 4};
+    return detail == CellDetail::Full ? full : simplified;
+}
+
+void computeTailCurve(const cv::Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                      float tailPhaseOffset, float time, CellDetail detail, cv::Point2f* out) {
+    const TailShape& shape = tailShape(detail);
+    tailScalar(tailParams(cellPos, cellWidth, cellHeight, faceRight, tailPhaseOffset, time, shape),
+               tailTable(detail), shape.segments, out);
+}
+
+void TailBatch::compute(const std::vector<CellView>& cells, const std::vector<cv::Point2f>& positions,
+                        const std::vector<CellDetail>* details, const std::map<std::string, float>& config,
+                        float scale, float time) {
+    points.resize(cells.size() * maxTailPoints);
+
+    for (CellDetail detail : {CellDetail::Full, CellDetail::Simplified}) {
+        group.clear();
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if ((details ? (*details)[i] : CellDetail::Full) == detail) {
+                group.push_back(static_cast<int>(i));
+            }
+        }
+        const TailShape& shape = tailShape(detail);
+        const TailTable& table = tailTable(detail);
+
+        auto paramsOf = [&](int i) {
+            const cv::Size2f bodySize = cellBodySize(cells[i], config, scale);
+            return tailParams(positions[i], bodySize.width, bodySize.height, cells[i].faceRight,
+                              cells[i].tailPhaseOffset, time, shape);
+        };
+
+        size_t k = 0;
+#ifdef CELL_GEOMETRY_SSE2
+        for (; k + 4 <= group.size(); k += 4) {
+            TailParams params[4];
+            cv::Point2f* out[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                params[lane] = paramsOf(group[k + lane]);
+                out[lane] = &points[group[k + lane] * maxTailPoints];
+            }
+            tailQuad(params, table, shape.segments, out);
+        }
+#endif
+        for (; k < group.size(); ++k) {
+            tailScalar(paramsOf(group[k]), table, shape.segments, &points[group[k] * maxTailPoints]);
+        }
+    }
+}
+
+const std::vector<cv::Vec3f>& mouthBezierWeights() {
+    // 按bezierPoint的算式逐项计算，曲线点与逐次调用bezierPoint逐位相同
+    static const std::vector<cv::Vec3f> weights = [] {
+        std::vector<cv::Vec3f> table;
+        const int n = 2;
+        for (float t = 0; t <= 1; t += 0.04f) {
+            cv::Vec3f weight;
+            for (int i = 0; i <= n; ++i) {
+                float binomial = std::tgamma(n + 1) / (std::tgamma(i + 1) * std::tgamma(n - i + 1));
+                weight[i] = binomial * std::pow(1 - t, n - i) * std::pow(t, i);
+            }
+            table.push_back(weight);
+        }
+        return table;
+    }();
+    return weights;
+}
+
+void evaluateMouthCurve(const cv::Point2f controlPoints[3], std::vector<cv::Point2f>& out) {
+    const std::vector<cv::Vec3f>& weights = mouthBezierWeights();
+    out.resize(weights.size());
+    for (size_t k = 0; k < weights.size(); ++k) {
+        cv::Point2f point(0, 0);
+        for (int i = 0; i < 3; ++i) {
+            point += weights[k][i] * controlPoints[i];
+        }
+        out[k] = point;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CELL_GEOMETRY_H
+#define CELL_GEOMETRY_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "../structs.h"
+
+// 细胞绘制用到的折线几何：尾巴波形和嘴的二次Bezier曲线
+// 两者的采样数固定，预先算好不随帧变化的部分，逐帧只做乘加
+
+// 尾巴的采样方式，按细节档位区分
+struct TailShape {
+    int segments;        // 折线段数，采样点比它多一个
+    float lengthFactor;  // 尾巴长度相对身体半宽的倍数
+    int firstSegment;    // 前面几段落在身体里，从这一段开始绘制
+};
+
+// 完整档30段、长2.5倍半宽；简化档10段、长1.5倍半宽
+const TailShape& tailShape(CellDetail detail);
+
+// 尾巴最多的采样点数
+const int maxTailPoints = 31;
+
+// 计算一个细胞的尾巴折线，out至少容纳maxTailPoints个点
+// 沿尾巴的波相位等距递增，用角度叠加的递推代替逐点sin：只在起点算一次sin/cos
+void computeTailCurve(const cv::Point2f& cellPos, float cellWidth, float cellHeight, bool faceRight,
+                      float tailPhaseOffset, float time, CellDetail detail, cv::Point2f* out);
+
+// 一帧中所有细胞的尾巴折线，按档位分组后每4个细胞一组用SSE2并行递推，结果与computeTailCurve逐位相同
+class TailBatch {
+public:
+    // positions为各细胞的绘制位置，details为空时全部按完整档；圆点档不计算
+    void compute(const std::vector<CellView>& cells, const std::vector<cv::Point2f>& positions,
+                 const std::vector<CellDetail>* details, const std::map<std::string, float>& config,
+                 float scale, float time);
+
+    const cv::Point2f* curve(size_t cell) const { return &points[cell * maxTailPoints]; }
+
+private:
+    std::vector<cv::Point2f> points;
+    // 逐帧复用：同一档位的细胞下标
+    std::vector<int> group;
+};
+
+// 嘴的Bezier曲线在t = 0, 0.04, ...处采样，返回各采样点的Bernstein权重，与bezierPoint逐位一致
+const std::vector<cv::Vec3f>& mouthBezierWeights();
+
+// 用预先算好的权重对三个控制点求曲线上的点
+void evaluateMouthCurve(const cv::Point2f controlPoints[3], std::vector<cv::Point2f>& out);
+
+#endif // CELL_GEOMETRY_H
@@ -0,0 +1,53 @@
+#include "CellSprites.h"
+#include "../drawing.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 抗锯齿边缘外留出的透明边
+const int spriteMargin = 3;
+
+} // namespace
+
+CellSprites& CellSprites::instance() {
+    static CellSprites atlas;
+    return atlas;
+}
+
+void CellSprites::checkConfig(const std::map<std::string, float>& config, float scale) {
+    if (&config == lastConfig && scale == builtScale) return;
+    if (scale != builtScale || config != builtConfig) {
+        sprites.clear();
+        builtConfig = config;
+        builtScale = scale;
+    }
+    lastConfig = &config;
+}
+
+const CellSprite& CellSprites::get(const std::map<std::string, float>& config, float scale,
+                                   float cellWidth, float cellHeight, bool faceRight, float aggressionLevel) {
+    checkConfig(config, scale);
+
+    // 身体椭圆本来就按整数半轴绘制，尺寸取整不改变外形
+    const int width = std::max(1, static_cast<int>(cellWidth));
+    const int height = std::max(1, static_cast<int>(cellHeight));
+    const int level = static_cast<int>(std::lround(std::clamp(aggressionLevel, 0.0f, 1.0f) * (aggressionLevels - 1)));
+
+    auto key = std::make_tuple(width, height, faceRight, level);
+    auto it = sprites.find(key);
+    if (it != sprites.end()) return it->second;
+
+    if (sprites.size() >= maxSprites) {
+        sprites.clear();
+    }
+
+    // 画在全透明的BGRA图上，得到的就是预乘alpha（见Compositor.h）
+    CellSprite sprite;
+    sprite.origin = cv::Point(width + spriteMargin, height + spriteMargin);
+    sprite.image = cv::Mat::zeros(2 * sprite.origin.y + 1, 2 * sprite.origin.x + 1, CV_8UC4);
+    drawCellBody(sprite.image, cv::Point2f(static_cast<float>(sprite.origin.x), static_cast<float>(sprite.origin.y)),
+                 static_cast<float>(width), static_cast<float>(height), faceRight,
+                 cv::Scalar(255, 255, 255, 255), static_cast<float>(level) / (aggressionLevels - 1), config, scale);
+    return sprites.emplace(key, std::move(sprite)).first->second;
+}
@@ -0,0 +1,50 @@
+#ifndef CELL_SPRITES_H
+#define CELL_SPRITES_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <tuple>
+
+// 缓存的细胞身体精灵：预乘alpha的BGRA图，origin为身体中心在图中的位置
+struct CellSprite {
+    cv::Mat image;
+    cv::Point origin;
+};
+
+// 细胞身体（椭圆身体、眼睛、眼睑和嘴）的精灵图集，进程内共用一个实例
+// 这些部件只取决于身体尺寸、朝向和攻击性，与颜色无关：身体和眼睑按白色绘制一次，
+// 混合时用SpriteTint乘上细胞颜色，眼睛和嘴是黑色不受影响；尾巴每帧都在动，仍逐帧绘制
+// 尺寸取整到像素、攻击性量化为aggressionLevels档，不同外观的数量很有限
+// 外观参数（cellConfig和scale）变化时整个图集失效；多线程使用的约定见prepareCellSprites（drawing.h）
+class CellSprites {
+public:
+    static const int aggressionLevels = 16;
+    // 超过这个数量时清空重建，防止尺寸异常多时无限增长
+    static const size_t maxSprites = 4096;
+
+    static CellSprites& instance();
+
+    // 取给定外观的精灵，第一次请求时绘制
+    const CellSprite& get(const std::map<std::string, float>& config, float scale,
+                          float cellWidth, float cellHeight, bool faceRight, float aggressionLevel);
+
+    void clear() { sprites.clear(); }
+    size_t size() const { return sprites.size(); }
+
+private:
+    CellSprites() : lastConfig(nullptr), builtScale(0.0f) {}
+    CellSprites(const CellSprites&) = delete;
+    CellSprites& operator=(const CellSprites&) = delete;
+
+    // 外观参数变化时清空图集
+    void checkConfig(const std::map<std::string, float>& config, float scale);
+
+    // 键为(宽, 高, 朝右, 攻击性档位)
+    std::map<std::tuple<int, int, bool, int>, CellSprite> sprites;
+    const std::map<std::string, float>* lastConfig;
+    std::map<std::string, float> builtConfig;
+    float builtScale;
+};
+
+#endif // CELL_SPRITES_H
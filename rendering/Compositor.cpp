@@ -0,0 +1,160 @@
+#include "Compositor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// x86-64默认具备SSE2，行混合据此选择向量化路径
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COMPOSITOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 精确的x / 255（四舍五入），x不超过255 * 255
+inline uint8_t div255(unsigned int x) {
+    x += 128;
+    return static_cast<uint8_t>((x + (x >> 8)) >> 8);
+}
+
+// 定点化后的着色参数，1.0对应128
+struct FixedTint {
+    uint16_t gain[3];
+    uint16_t fill[3];
+};
+
+FixedTint toFixed(const SpriteTint& tint) {
+    FixedTint fixed;
+    for (int c = 0; c < 3; ++c) {
+        fixed.gain[c] = static_cast<uint16_t>(std::lround(std::clamp(tint.gain[c], 0.0f, 2.0f) * 128.0f));
+        fixed.fill[c] = static_cast<uint16_t>(std::lround(std::clamp(tint.fill[c], 0.0f, 1.0f) * 128.0f));
+    }
+    return fixed;
+}
+
+// 单个像素的标量混合，也用于SSE2路径处理行尾
+template <bool Tinted>
+inline void blendPixel(uint8_t* dst, const uint8_t* src, const FixedTint& tint) {
+    const unsigned int alpha = src[3];
+    if (alpha == 0) return;
+    const unsigned int inverse = 255 - alpha;
+    for (int c = 0; c < 3; ++c) {
+        unsigned int color = src[c];
+        if (Tinted) {
+            color = std::min(alpha, ((color * tint.gain[c]) >> 7) + ((alpha * tint.fill[c]) >> 7));
+        }
+        dst[c] = static_cast<uint8_t>(color + div255(dst[c] * inverse));
+    }
+}
+
+#ifdef COMPOSITOR_SSE2
+
+// 两个像素的BGRA各占4个16位通道：着色后与画布按alpha混合，与blendPixel逐位一致
+template <bool Tinted>
+inline __m128i blendPair(__m128i src, __m128i dst, __m128i gain, __m128i fill) {
+    const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    if (Tinted) {
+        __m128i scaled = _mm_srli_epi16(_mm_mullo_epi16(src, gain), 7);
+        __m128i filled = _mm_srli_epi16(_mm_mullo_epi16(alpha, fill), 7);
+        src = _mm_min_epi16(alpha, _mm_add_epi16(scaled, filled));
+    }
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(dst, inverse), _mm_set1_epi16(128));
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    return _mm_add_epi16(src, t);
+}
+
+// 画布是3通道，4个像素恰好12字节，整组读写且不越过本行的混合区域（分块并行绘制时相邻区域可能属于其他线程）
+template <bool Tinted>
+void blendRow(uint8_t* dst, const uint8_t* src, int width, const FixedTint& tint) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaBytes = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i gain = _mm_setr_epi16(tint.gain[0], tint.gain[1], tint.gain[2], 0,
+                                        tint.gain[0], tint.gain[1], tint.gain[2], 0);
+    const __m128i fill = _mm_setr_epi16(tint.fill[0], tint.fill[1], tint.fill[2], 128,
+                                        tint.fill[0], tint.fill[1], tint.fill[2], 128);
+    int x = 0;
+    for (; x + 4 <= width; x += 4, src += 16, dst += 12) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        // 4个像素全透明时跳过，盾牌等精灵的边角大多如此
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(s, alphaBytes), zero)) == 0xFFFF) continue;
+
+        // 12字节的BGR展开成4个BGRx
+        uint64_t head;
+        uint32_t tail;
+        std::memcpy(&head, dst, 8);
+        std::memcpy(&tail, dst + 8, 4);
+        const __m128i d = _mm_setr_epi32(static_cast<int>(head & 0xFFFFFF),
+                                         static_cast<int>((head >> 24) & 0xFFFFFF),
+                                         static_cast<int>((head >> 48) | ((tail & 0xFF) << 16)),
+                                         static_cast<int>(tail >> 8));
+
+        const __m128i lo = blendPair<Tinted>(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), gain, fill);
+        const __m128i hi = blendPair<Tinted>(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), gain, fill);
+        alignas(16) uint32_t pixels[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels), _mm_packus_epi16(lo, hi));
+        head = (pixels[0] & 0xFFFFFF) | (static_cast<uint64_t>(pixels[1] & 0xFFFFFF) << 24)
+             | (static_cast<uint64_t>(pixels[2]) << 48);
+        tail = ((pixels[2] >> 16) & 0xFF) | (pixels[3] << 8);
+        std::memcpy(dst, &head, 8);
+        std::memcpy(dst + 8, &tail, 4);
+    }
+    for (; x < width; ++x, src += 4, dst += 3) {
+        blendPixel<Tinted>(dst, src, tint);
+    }
+}
+
+#else
+
+template <bool Tinted>
+void blendRow(uint8_t* dst, const uint8_t* src, int width, const FixedTint& tint) {
+    for (int x = 0; x < width; ++x, src += 4, dst += 3) {
+        blendPixel<Tinted>(dst, src, tint);
+    }
+}
+
+#endif // COMPOSITOR_SSE2
+
+template <bool Tinted>
+void blendClipped(cv::Mat& canvas, const cv::Mat& sprite, const cv::Point& topLeft, const FixedTint& tint) {
+    CV_Assert(canvas.type() == CV_8UC3 && sprite.type() == CV_8UC4);
+
+    // 裁剪到画布范围内
+    cv::Rect target = cv::Rect(topLeft, sprite.size()) & cv::Rect(0, 0, canvas.cols, canvas.rows);
+    if (target.width <= 0 || target.height <= 0) return;
+    const int srcX = target.x - topLeft.x;
+    const int srcY = target.y - topLeft.y;
+
+    for (int y = 0; y < target.height; ++y) {
+        blendRow<Tinted>(canvas.ptr<uint8_t>(target.y + y) + target.x * 3,
+                         sprite.ptr<uint8_t>(srcY + y) + srcX * 4, target.width, tint);
+    }
+}
+
+} // namespace
+
+cv::Mat premultiplyAlpha(const cv::Mat& bgra) {
+    CV_Assert(bgra.type() == CV_8UC4);
+    cv::Mat result(bgra.size(), CV_8UC4);
+    for (int y = 0; y < bgra.rows; ++y) {
+        const uint8_t* src = bgra.ptr<uint8_t>(y);
+        uint8_t* dst = result.ptr<uint8_t>(y);
+        for (int x = 0; x < bgra.cols; ++x, src += 4, dst += 4) {
+            const unsigned int alpha = src[3];
+            dst[0] = div255(src[0] * alpha);
+            dst[1] = div255(src[1] * alpha);
+            dst[2] = div255(src[2] * alpha);
+            dst[3] = static_cast<uint8_t>(alpha);
+        }
+    }
+    return result;
+}
+
+void blendPremultiplied(cv::Mat& canvas, const cv::Mat& sprite, const cv::Point& topLeft) {
+    blendClipped<false>(canvas, sprite, topLeft, FixedTint{});
+}
+
+void blendPremultiplied(cv::Mat& canvas, const cv::Mat& sprite, const cv::Point& topLeft, const SpriteTint& tint) {
+    blendClipped<true>(canvas, sprite, topLeft, toFixed(tint));
+}
@@ -0,0 +1,26 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <opencv2/opencv.hpp>
+
+// 混合时对精灵颜色做的着色，按BGR通道分别设置，作用在预乘后的颜色上：
+// color = min(alpha, color * gain + alpha * fill)
+// 例如格挡高光：蓝绿通道gain为1.5，红通道gain为0、fill为1（红色拉满）
+// gain取值[0, 2]，fill取值[0, 1]，内部按1/128定点化
+struct SpriteTint {
+    cv::Vec3f gain{1.0f, 1.0f, 1.0f};
+    cv::Vec3f fill{0.0f, 0.0f, 0.0f};
+};
+
+// 把普通BGRA图像转换为预乘alpha（颜色通道已乘以alpha/255）
+// 预乘后的精灵混合时每个通道只需一次乘加：dst = src + dst * (255 - alpha) / 255
+// 直接在全透明(0,0,0,0)的BGRA图上绘制的精灵不需要转换：抗锯齿逐通道按覆盖率混合，画出的正好是预乘alpha
+cv::Mat premultiplyAlpha(const cv::Mat& bgra);
+
+// 把预乘alpha的BGRA精灵混合到BGR画布上，topLeft为精灵左上角在画布中的位置，超出画布的部分被裁掉
+// 按整行处理，x86上走SSE2路径一次混合4个像素，其他平台走标量路径，两者结果逐位相同
+// 之后新增的精灵绘制都应通过这里合成
+void blendPremultiplied(cv::Mat& canvas, const cv::Mat& sprite, const cv::Point& topLeft);
+void blendPremultiplied(cv::Mat& canvas, const cv::Mat& sprite, const cv::Point& topLeft, const SpriteTint& tint);
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,89 @@
+#include "DetailBudget.h"
+#include "RenderSnapshot.h"
+#include "../drawing.h"
+#include <algorithm>
+#include <limits>
+
+DetailBudget::DetailBudget(double drawBudgetMs, size_t initialQuota)
+    : budgetMs(drawBudgetMs), quota(std::max(minQuota, initialQuota)), lastCellCount(0), counts{0, 0, 0} {
+}
+
+const std::vector<CellDetail>& DetailBudget::assign(const RenderSnapshot& snapshot, float alpha,
+                                                    const cv::Size& canvasSize,
+                                                    const std::map<std::string, float>& config, float scale) {
+    const size_t count = snapshot.cells.size();
+    lastCellCount = count;
+    details.assign(count, CellDetail::Dot);
+
+    // 玩家细胞是视线焦点，没有玩家时以画布中心为焦点
+    focusPoints.clear();
+    for (const CellView& cell : snapshot.cells) {
+        if (cell.playerNumber > 0) focusPoints.push_back(cell.interpolate(alpha));
+    }
+    if (focusPoints.empty()) {
+        focusPoints.emplace_back(canvasSize.width * 0.5f, canvasSize.height * 0.5f);
+    }
+
+    // 优先级为离最近焦点的距离平方，玩家细胞为-1排在最前
+    priorities.resize(count);
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const CellView& cell = snapshot.cells[i];
+        order[i] = static_cast<int>(i);
+        if (cell.playerNumber > 0) {
+            priorities[i] = -1.0f;
+            continue;
+        }
+        const cv::Point2f position = cell.interpolate(alpha);
+        float nearest = std::numeric_limits<float>::max();
+        for (const cv::Point2f& focus : focusPoints) {
+            const cv::Point2f d = position - focus;
+            nearest = std::min(nearest, d.x * d.x + d.y * d.y);
+        }
+        priorities[i] = nearest;
+    }
+
+    // 只需要把前quota个和之后的简化名额分出来，不必完整排序
+    auto byPriority = [this](int a, int b) { return priorities[a] < priorities[b]; };
+    const size_t fullEnd = std::min(count, quota);
+    const size_t simplifiedEnd = std::min(count, quota * (1 + simplifiedRatio));
+    if (fullEnd < count) {
+        std::nth_element(order.begin(), order.begin() + fullEnd, order.end(), byPriority);
+    }
+    if (simplifiedEnd < count) {
+        std::nth_element(order.begin() + fullEnd, order.begin() + simplifiedEnd, order.end(), byPriority);
+    }
+
+    counts[0] = counts[1] = counts[2] = 0;
+    for (size_t rank = 0; rank < count; ++rank) {
+        const int i = order[rank];
+        const CellView& cell = snapshot.cells[i];
+        CellDetail detail = rank < fullEnd ? CellDetail::Full
+                          : rank < simplifiedEnd ? CellDetail::Simplified : CellDetail::Dot;
+        if (cell.playerNumber > 0) {
+            detail = CellDetail::Full;
+        } else {
+            // 屏幕上过小的细胞看不出细节
+            const float bodyPixels = cellBodySize(cell, config, scale).height;
+            if (bodyPixels < dotBodyPixels) {
+                detail = CellDetail::Dot;
+            } else if (bodyPixels < simplifiedBodyPixels && detail == CellDetail::Full) {
+                detail = CellDetail::Simplified;
+            }
+        }
+        details[i] = detail;
+        ++counts[static_cast<int>(detail)];
+    }
+    return details;
+}
+
+void DetailBudget::report(double drawMs) {
+    if (drawMs > budgetMs) {
+        // 超出预算：按超出比例收缩，单帧最多减半，避免一次卡顿把细节全部降掉
+        const double factor = std::max(0.5, budgetMs / drawMs);
+        quota = std::max(minQuota, static_cast<size_t>(quota * factor));
+    } else if (drawMs < budgetMs * 0.75 && quota < lastCellCount) {
+        // 余量充足时每帧放宽约10%，名额不超过细胞数，否则细胞增多时要先收缩很久
+        quota = std::min(lastCellCount, quota + std::max<size_t>(1, quota / 10));
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef DETAIL_BUDGET_H
+#define DETAIL_BUDGET_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "../structs.h"
+
+struct RenderSnapshot;
+
+// 每帧为快照中的细胞选择绘制档位（完整、简化、圆点），让细胞数量随繁殖增长时帧率保持平稳
+// 名额quota决定档位：按优先级（玩家细胞最先，其余按离最近玩家的距离）排序，前quota个完整绘制，
+// 之后的simplifiedRatio * quota个简化绘制，其余画成圆点；屏幕上过小的细胞直接降档，玩家细胞总是完整绘制
+// 每帧用report报告细胞绘制耗时：超出预算时按比例收缩名额，明显低于预算时缓慢放宽
+class DetailBudget {
+public:
+    // 屏幕上身体半高低于这些像素数时降档
+    static constexpr float dotBodyPixels = 3.0f;
+    static constexpr float simplifiedBodyPixels = 8.0f;
+    static const size_t simplifiedRatio = 4;
+    static const size_t minQuota = 16;
+
+    // drawBudgetMs为每帧细胞绘制的目标耗时
+    explicit DetailBudget(double drawBudgetMs = 8.0, size_t initialQuota = 256);
+
+    // 返回与snapshot.cells一一对应的档位，引用在下次调用前有效
+    const std::vector<CellDetail>& assign(const RenderSnapshot& snapshot, float alpha, const cv::Size& canvasSize,
+                                          const std::map<std::string, float>& config, float scale);
+
+    // 报告本帧细胞绘制耗时（毫秒），调整下一帧的名额
+    void report(double drawMs);
+
+    size_t getQuota() const { return quota; }
+    double getBudgetMs() const { return budgetMs; }
+    // 上一次assign各档位的细胞数
+    size_t countOf(CellDetail detail) const { return counts[static_cast<int>(detail)]; }
+
+private:
+    double budgetMs;
+    size_t quota;
+    // 上一次assign的细胞数，放宽名额时不超过它
+    size_t lastCellCount;
+    size_t counts[3];
+
+    // 逐帧复用的缓冲
+    std::vector<CellDetail> details;
+    std::vector<float> priorities;
+    std::vector<int> order;
+    std::vector<cv::Point2f> focusPoints;
+};
+
+#endif // DETAIL_BUDGET_H
@@ -0,0 +1,61 @@
+#include "FrameBuffers.h"
+#include <algorithm>
+#include <cstring>
+
+FrameBuffers::FrameBuffers(int count, const cv::Scalar& background)
+    : buffers(std::max(count, 2)), backIndex(-1), frontIndex(-1), backgroundColor(background) {
+}
+
+cv::Mat& FrameBuffers::acquire(const cv::Size& size) {
+    if (buffers[0].size() != size) {
+        for (cv::Mat& buffer : buffers) {
+            buffer.create(size, CV_8UC3);
+        }
+        frontIndex = -1;
+    }
+
+    // 跳过刚提交的一帧
+    backIndex = (backIndex + 1) % static_cast<int>(buffers.size());
+    if (backIndex == frontIndex) {
+        backIndex = (backIndex + 1) % static_cast<int>(buffers.size());
+    }
+    cv::Mat& buffer = buffers[backIndex];
+    clear(buffer);
+    return buffer;
+}
+
+const cv::Mat& FrameBuffers::present() {
+    CV_Assert(backIndex >= 0);
+    frontIndex = backIndex;
+    return buffers[frontIndex];
+}
+
+const cv::Mat& FrameBuffers::front() const {
+    static const cv::Mat none;
+    return frontIndex >= 0 ? buffers[frontIndex] : none;
+}
+
+void FrameBuffers::setBackground(const cv::Scalar& color) {
+    backgroundColor = color;
+    backgroundImage.release();
+}
+
+void FrameBuffers::setBackground(const cv::Mat& image) {
+    CV_Assert(image.empty() || image.type() == CV_8UC3);
+    backgroundImage = image;
+}
+
+void FrameBuffers::clear(cv::Mat& buffer) const {
+    if (!backgroundImage.empty() && backgroundImage.size() == buffer.size()) {
+        backgroundImage.copyTo(buffer);
+        return;
+    }
+
+    // 三个通道相同（白、黑、灰）时整块memset，否则交给setTo
+    const double value = backgroundColor[0];
+    if (buffer.isContinuous() && backgroundColor[1] == value && backgroundColor[2] == value) {
+        std::memset(buffer.ptr(), cv::saturate_cast<uchar>(value), buffer.total() * buffer.elemSize());
+    } else {
+        buffer.setTo(backgroundColor);
+    }
+}
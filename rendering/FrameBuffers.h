@@ -0,0 +1,39 @@
+#ifndef FRAME_BUFFERS_H
+#define FRAME_BUFFERS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 预分配的画布轮换池，取代每帧新建cv::Mat
+// 每帧acquire()取下一块缓冲并清成背景（纯色填充或拷贝缓存的背景图），绘制完成后present()交给显示/导出；
+// 刚提交的一帧在下一次acquire()时不会被覆盖，显示或导出阶段可以在绘制下一帧的同时持有它
+// 只在渲染线程使用，不是线程安全的
+class FrameBuffers {
+public:
+    explicit FrameBuffers(int count = 2, const cv::Scalar& background = cv::Scalar(255, 255, 255));
+
+    // 取下一块后备缓冲并清成背景，尺寸变化时重新分配全部缓冲
+    cv::Mat& acquire(const cv::Size& size);
+    // 把最近一次acquire()的缓冲标记为已完成的一帧并返回它
+    const cv::Mat& present();
+    // 最近完成的一帧，还没有完成的帧时为空
+    const cv::Mat& front() const;
+
+    // 纯色背景
+    void setBackground(const cv::Scalar& color);
+    // 缓存的背景图，每帧整块拷贝；尺寸须与画布一致，传入空图恢复纯色背景
+    void setBackground(const cv::Mat& image);
+
+    size_t count() const { return buffers.size(); }
+
+private:
+    void clear(cv::Mat& buffer) const;
+
+    std::vector<cv::Mat> buffers;
+    int backIndex;
+    int frontIndex;
+    cv::Scalar backgroundColor;
+    cv::Mat backgroundImage;
+};
+
+#endif // FRAME_BUFFERS_H
@@ -0,0 +1,248 @@
+#include "FrameExporter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// 小写的扩展名（不含点），没有扩展名时为空
+std::string extensionOf(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return "";
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+// 丢帧警告的最短间隔
+const std::chrono::seconds dropReportInterval(2);
+
+} // namespace
+
+FrameExporter::FrameExporter(const std::string& path, double fps, size_t queueCapacity, FullPolicy policy)
+    : path(path), fps(fps > 0.0 ? fps : 60.0), policy(policy), videoOutput(isVideoPath(path)),
+      sequence(videoOutput ? SequencePattern() : parseSequencePattern(path)),
+      slots(std::max<size_t>(queueCapacity, 1)), closing(false), reportedDrops(0),
+      lastReport(std::chrono::steady_clock::now()), frameIndex(0) {
+    freeSlots.reserve(slots.size());
+    for (size_t i = slots.size(); i > 0; --i) {
+        freeSlots.push_back(i - 1);
+    }
+    encoder = std::thread(&FrameExporter::encoderLoop, this);
+}
+
+FrameExporter::~FrameExporter() {
+    close();
+}
+
+bool FrameExporter::isVideoPath(const std::string& path) {
+    std::string ext = extensionOf(path);
+    return ext == "avi" || ext == "mp4" || ext == "mkv" || ext == "mov";
+}
+
+void FrameExporter::validatePath(const std::string& path) {
+    if (!isVideoPath(path)) {
+        parseSequencePattern(path);
+    }
+}
+
+FrameExporter::SequencePattern FrameExporter::parseSequencePattern(const std::string& path) {
+    // 路径由用户给出，不能当作printf格式；这里逐字符解析，只认%%、%d和%0Nd
+    SequencePattern pattern;
+    std::string literal;
+    bool numbered = false;
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (path[i] != '%') {
+            literal += path[i];
+            continue;
+        }
+        if (i + 1 < path.size() && path[i + 1] == '%') {
+            literal += '%';
+            ++i;
+            continue;
+        }
+        size_t end = i + 1;
+        size_t width = 0;
+        if (end < path.size() && path[end] == '0') {
+            ++end;
+            size_t digits = end;
+            while (end < path.size() && std::isdigit(static_cast<unsigned char>(path[end]))) {
+                width = width * 10 + static_cast<size_t>(path[end] - '0');
+                ++end;
+            }
+            if (end == digits || end - digits > 2 || width == 0 || width > 20) {
+                end = path.size();  // 按不支持的格式处理
+            }
+        }
+        if (end >= path.size() || path[end] != 'd') {
+            throw std::invalid_argument("导出路径第" + std::to_string(i + 1) + "个字符处的%格式不受支持，"
+                                        "帧号只能写成%d或%0Nd（N为1-20），字面的%请写成%%: " + path);
+        }
+        if (numbered) {
+            throw std::invalid_argument("导出路径只能包含一个帧号格式: " + path);
+        }
+        numbered = true;
+        pattern.prefix = literal;
+        pattern.width = width;
+        literal.clear();
+        i = end;
+    }
+    if (numbered) {
+        pattern.suffix = literal;
+        return pattern;
+    }
+
+    // 没有帧号格式：在扩展名前插入_000000这样的帧号，没有扩展名时写成.png
+    pattern.width = 6;
+    std::string ext = extensionOf(literal);
+    if (ext.empty()) {
+        pattern.prefix = literal + "_";
+        pattern.suffix = ".png";
+    } else {
+        pattern.prefix = literal.substr(0, literal.size() - ext.size() - 1) + "_";
+        pattern.suffix = literal.substr(literal.size() - ext.size() - 1);
+    }
+    return pattern;
+}
+
+bool FrameExporter::submit(const cv::Mat& frame) {
+    CV_Assert(frame.type() == CV_8UC3);
+
+    size_t slot = 0;
+    bool taken = false;
+    bool warn = false;
+    size_t newDrops = 0, dropped = 0, submitted = 0, depth = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++stats.submitted;
+        if (!closing && freeSlots.empty() && policy == FullPolicy::Wait) {
+            auto waitStart = std::chrono::steady_clock::now();
+            slotFree.wait(lock, [this] { return !freeSlots.empty() || closing; });
+            stats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+        }
+        if (!closing && !freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            taken = true;
+        } else {
+            ++stats.dropped;
+            auto now = std::chrono::steady_clock::now();
+            if (!closing && now - lastReport >= dropReportInterval) {
+                warn = true;
+                newDrops = stats.dropped - reportedDrops;
+                dropped = stats.dropped;
+                submitted = stats.submitted;
+                depth = readySlots.size();
+                reportedDrops = stats.dropped;
+                lastReport = now;
+            }
+        }
+    }
+    if (!taken) {
+        if (warn) {
+            std::cerr << "导出编码跟不上: 最近丢弃" << newDrops << "帧，累计丢弃" << dropped << "/" << submitted
+                      << "帧，队列深度 " << depth << "/" << slots.size() << std::endl;
+        }
+        return false;
+    }
+
+    // 槽位已归本线程所有，在锁外拷贝；尺寸不变时复用槽位的内存
+    frame.copyTo(slots[slot]);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readySlots.push_back(slot);
+        stats.queueDepth = readySlots.size();
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, stats.queueDepth);
+    }
+    frameReady.notify_one();
+    return true;
+}
+
+void FrameExporter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closing) return;
+        closing = true;
+    }
+    frameReady.notify_one();
+    slotFree.notify_all();
+    encoder.join();
+
+    Stats final = getStats();
+    std::cout << "导出完成: " << path << ", 写出" << final.written << "帧, 丢弃" << final.dropped << "帧";
+    if (final.failed > 0) {
+        std::cout << ", 写出失败" << final.failed << "帧";
+    }
+    std::cout << ", 最大队列深度 " << final.maxQueueDepth << "/" << slots.size();
+    if (policy == FullPolicy::Wait) {
+        std::cout << ", 等待编码 " << final.waitMs << " ms";
+    }
+    std::cout << std::endl;
+}
+
+FrameExporter::Stats FrameExporter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameExporter::encoderLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 关闭时先写完队列中剩余的帧
+        frameReady.wait(lock, [this] { return !readySlots.empty() || closing; });
+        if (readySlots.empty()) break;
+        size_t slot = readySlots.front();
+        readySlots.pop_front();
+        stats.queueDepth = readySlots.size();
+
+        lock.unlock();
+        bool ok = writeFrame(slots[slot]);
+        lock.lock();
+
+        ++(ok ? stats.written : stats.failed);
+        freeSlots.push_back(slot);
+        slotFree.notify_one();
+    }
+    lock.unlock();
+
+    if (video.isOpened()) {
+        video.release();
+    }
+}
+
+bool FrameExporter::writeFrame(const cv::Mat& frame) {
+    try {
+        if (videoOutput) {
+            // 首帧到达时才知道尺寸；打开失败时之后的帧都记为失败
+            if (!video.isOpened()) {
+                if (frameIndex > 0) return false;
+                ++frameIndex;
+                std::string ext = extensionOf(path);
+                int fourcc = (ext == "mp4" || ext == "mov") ? cv::VideoWriter::fourcc('m', 'p', '4', 'v')
+                                                            : cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+                if (!video.open(path, fourcc, fps, frame.size(), true)) {
+                    std::cerr << "无法打开视频文件: " << path << std::endl;
+                    return false;
+                }
+            }
+            video.write(frame);
+            return true;
+        }
+        return cv::imwrite(sequencePath(frameIndex++), frame);
+    }
+    catch (const cv::Exception& e) {
+        std::cerr << "导出帧失败: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::string FrameExporter::sequencePath(size_t index) const {
+    std::string number = std::to_string(index);
+    if (number.size() < sequence.width) {
+        number.insert(0, sequence.width - number.size(), '0');
+    }
+    return sequence.prefix + number + sequence.suffix;
+}
@@ -0,0 +1,101 @@
+#ifndef FRAME_EXPORTER_H
+#define FRAME_EXPORTER_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 把渲染好的帧交给后台编码线程写成视频或PNG序列，游戏循环只做一次整帧拷贝
+// 路径以.avi/.mp4/.mkv/.mov结尾时用cv::VideoWriter编码（首帧到达时按其尺寸打开），
+// 否则写PNG序列，帧号从0开始：路径中含一个%d或%0Nd（如frames/%06d.png，得到000000.png、000001.png…）时在该处填入帧号，
+// %%表示字面的%；不含帧号格式时在扩展名前插入_000000这样的帧号；其他%用法在构造时以std::invalid_argument拒绝
+// 帧通过有界队列传递，槽位预先分配并循环复用；队列满时按策略丢弃新帧（窗口模式，不拖慢帧率）
+// 或等待编码线程腾出槽位（无头模式，不丢帧）。丢帧时定期在标准错误输出丢帧数和队列深度
+// submit只允许同一时刻有一个线程调用
+class FrameExporter {
+public:
+    enum class FullPolicy {
+        Drop,  // 队列满时丢弃新帧
+        Wait   // 队列满时等待编码线程
+    };
+
+    struct Stats {
+        size_t submitted = 0;      // 提交的帧数（含丢弃的）
+        size_t written = 0;        // 已写出的帧数
+        size_t dropped = 0;        // 队列满被丢弃的帧数
+        size_t failed = 0;         // 写出失败的帧数
+        size_t queueDepth = 0;     // 当前等待编码的帧数
+        size_t maxQueueDepth = 0;  // 出现过的最大队列深度
+        double waitMs = 0.0;       // Wait策略下提交方等待的总时长
+    };
+
+    // fps只用于视频文件；queueCapacity为预分配的帧槽位数
+    FrameExporter(const std::string& path, double fps, size_t queueCapacity = 8,
+                  FullPolicy policy = FullPolicy::Drop);
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // 拷贝一帧（CV_8UC3）进队列，丢弃时返回false
+    bool submit(const cv::Mat& frame);
+    // 写完队列中剩余的帧、关闭文件并输出统计，之后的submit都会被丢弃；析构时自动调用
+    void close();
+
+    Stats getStats() const;
+    size_t getCapacity() const { return slots.size(); }
+    const std::string& getPath() const { return path; }
+    bool writesVideo() const { return videoOutput; }
+
+    // 路径按扩展名是否会写成视频文件
+    static bool isVideoPath(const std::string& path);
+    // 检查PNG序列路径中的帧号格式，不合法时抛出std::invalid_argument
+    static void validatePath(const std::string& path);
+
+private:
+    void encoderLoop();
+    // 在编码线程上写出一帧
+    bool writeFrame(const cv::Mat& frame);
+    std::string sequencePath(size_t index) const;
+
+    // PNG序列的文件名：prefix + 帧号（补零到width位）+ suffix
+    struct SequencePattern {
+        std::string prefix;
+        std::string suffix;
+        size_t width = 0;
+    };
+    static SequencePattern parseSequencePattern(const std::string& path);
+
+    std::string path;
+    double fps;
+    FullPolicy policy;
+    bool videoOutput;
+    SequencePattern sequence;
+
+    std::vector<cv::Mat> slots;
+    std::vector<size_t> freeSlots;
+    std::deque<size_t> readySlots;
+    bool closing;
+
+    mutable std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable slotFree;
+
+    Stats stats;
+    // 上一次输出丢帧警告时的丢帧数和时间，限制警告频率
+    size_t reportedDrops;
+    std::chrono::steady_clock::time_point lastReport;
+
+    // 只由编码线程访问
+    cv::VideoWriter video;
+    size_t frameIndex;
+
+    std::thread encoder;
+};
+
+#endif // FRAME_EXPORTER_H
@@ -0,0 +1,25 @@
+#include "HudLayer.h"
+
+void HudLayer::beginFrame() {
+    for (Line& line : lines) {
+        line.visible = false;
+    }
+}
+
+HudLayer::Line& HudLayer::touchLine(size_t line, const cv::Point& origin) {
+    if (line >= lines.size()) {
+        lines.resize(line + 1);
+    }
+    Line& entry = lines[line];
+    entry.visible = true;
+    entry.origin = origin;
+    return entry;
+}
+
+void HudLayer::composite(cv::Mat& canvas) const {
+    for (const Line& line : lines) {
+        if (line.visible) {
+            blendText(canvas, line.sprite, line.origin);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef HUD_LAYER_H
+#define HUD_LAYER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TextSprites.h"
+
+// 缓存的HUD文字层：每行文字光栅化成预乘alpha的精灵，之后每帧只把各行混合到画布上
+// 每帧先beginFrame()，再按行号setLine()；调用方给每行一个键，概括决定文字内容的状态
+// （如盾牌状态和剩余时间的0.1秒档、实体数量、连接状态），键和样式不变时不构造字符串也不重新光栅化
+// 本帧没有set的行不再显示
+class HudLayer {
+public:
+    HudLayer() : rasterizeCount(0) {}
+
+    void beginFrame();
+
+    // 设置第line行：makeText只在键或样式变化时调用，返回该行的文字
+    template <class MakeText>
+    void setLine(size_t line, uint64_t key, const cv::Point& origin, const TextStyle& style, MakeText&& makeText) {
+        Line& entry = touchLine(line, origin);
+        if (!entry.rasterized || entry.key != key || !(entry.style == style)) {
+            entry.sprite = rasterizeText(makeText(), style);
+            entry.key = key;
+            entry.style = style;
+            entry.rasterized = true;
+            ++rasterizeCount;
+        }
+    }
+
+    // 把本帧的各行混合到画布上
+    void composite(cv::Mat& canvas) const;
+
+    // 累计光栅化的行数，稳定状态下不再增长
+    size_t getRasterizeCount() const { return rasterizeCount; }
+
+    // 把value并入键
+    static uint64_t mixKey(uint64_t key, uint64_t value) {
+        return key ^ (value + 0x9E3779B97F4A7C15ull + (key << 6) + (key >> 2));
+    }
+
+private:
+    struct Line {
+        bool rasterized = false;
+        bool visible = false;
+        uint64_t key = 0;
+        TextStyle style;
+        cv::Point origin;
+        TextSprite sprite;
+    };
+
+    Line& touchLine(size_t line, const cv::Point& origin);
+
+    std::vector<Line> lines;
+    size_t rasterizeCount;
+};
+
+#endif // HUD_LAYER_H
@@ -0,0 +1,36 @@
+#include "RenderSnapshot.h"
+#include "../drawing.h"
+#include "../entities/BaseCell.h"
+#include "../simulation/ParticleSystem.h"
+
+void RenderSnapshot::capture(const std::vector<std::shared_ptr<BaseCell>>& entities, const ParticleSystem& particles) {
+    cells.clear();
+    for (const auto& entity : entities) {
+        cells.push_back(entity->makeView());
+    }
+
+    const size_t count = particles.size();
+    bloodX.assign(particles.posX.begin(), particles.posX.begin() + count);
+    bloodY.assign(particles.posY.begin(), particles.posY.begin() + count);
+    bloodSize.assign(particles.sizes.begin(), particles.sizes.begin() + count);
+    bloodRotation.assign(particles.rotation.begin(), particles.rotation.begin() + count);
+
+    publishTime = std::chrono::steady_clock::now();
+}
+
+void drawSnapshot(cv::Mat& canvas, const RenderSnapshot& snapshot, float alpha,
+                  const std::map<std::string, float>& config, float scale, float time,
+                  const std::vector<CellDetail>* details) {
+    for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+        const CellView& cell = snapshot.cells[i];
+        drawCell(canvas, cell, cell.interpolate(alpha), config, scale, time, cv::Rect(),
+                 details ? (*details)[i] : CellDetail::Full);
+    }
+
+    // 与drawBloodDrops一致的纯红色水滴
+    const cv::Scalar bloodColor(0, 0, 255);
+    for (size_t i = 0; i < snapshot.bloodX.size(); ++i) {
+        drawTeardropShape(canvas, cv::Point2f(snapshot.bloodX[i], snapshot.bloodY[i]),
+                          snapshot.bloodSize[i], snapshot.bloodRotation[i], bloodColor);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../structs.h"
+
+class BaseCell;
+class ParticleSystem;
+
+// 模拟线程发布给渲染线程的一帧世界状态
+// 只包含绘制需要的数据（细胞外观与位置、血滴、玩家盾牌状态），发布后不再修改；
+// 放在三缓冲中循环复用，capture时清空后重新填充，稳定运行时不再分配内存
+struct RenderSnapshot {
+    // 界面上显示的玩家盾牌状态
+    struct PlayerStatus {
+        bool shielding;
+        float shieldRemaining;
+        bool inParryWindow;
+        float cooldown;
+    };
+
+    uint64_t tick = 0;
+    // 发布时刻，渲染线程据此计算插值系数
+    std::chrono::steady_clock::time_point publishTime;
+
+    std::vector<CellView> cells;
+    std::vector<float> bloodX, bloodY, bloodSize, bloodRotation;
+    std::vector<PlayerStatus> players;
+
+    // 复制实体和血滴粒子，players由游戏自行填写
+    void capture(const std::vector<std::shared_ptr<BaseCell>>& entities, const ParticleSystem& particles);
+};
+
+// 绘制快照中的细胞和血滴，alpha为上一模拟步到最新模拟步之间的插值系数
+// details与cells一一对应给出各细胞的绘制档位，为空时全部完整绘制
+void drawSnapshot(cv::Mat& canvas, const RenderSnapshot& snapshot, float alpha,
+                  const std::map<std::string, float>& config, float scale, float time,
+                  const std::vector<CellDetail>* details = nullptr);
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,42 @@
+#include "ShieldSprites.h"
+#include "Compositor.h"
+
+namespace {
+
+// 缩放后转成预乘alpha的BGRA，没有alpha通道的图片视为完全不透明
+cv::Mat buildSprite(const cv::Mat& source, const cv::Size& size) {
+    cv::Mat resized;
+    cv::resize(source, resized, size);
+    if (resized.channels() == 4) {
+        return premultiplyAlpha(resized);
+    }
+
+    cv::Mat bgra(size, CV_8UC4);
+    for (int y = 0; y < resized.rows; ++y) {
+        const uchar* src = resized.ptr<uchar>(y);
+        uchar* dst = bgra.ptr<uchar>(y);
+        for (int x = 0; x < resized.cols; ++x, src += 3, dst += 4) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 255;
+        }
+    }
+    return bgra;
+}
+
+} // namespace
+
+ShieldSprites& ShieldSprites::instance() {
+    static ShieldSprites cache;
+    return cache;
+}
+
+const cv::Mat& ShieldSprites::get(const cv::Mat& source, const cv::Size& size) {
+    auto key = std::make_pair(size.width, size.height);
+    auto it = sprites.find(key);
+    if (it == sprites.end()) {
+        it = sprites.emplace(key, buildSprite(source, size)).first;
+    }
+    return it->second;
+}
@@ -0,0 +1,32 @@
+#ifndef SHIELD_SPRITES_H
+#define SHIELD_SPRITES_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <utility>
+
+// 预缩放的盾牌精灵缓存，进程内共用一个实例
+// 盾牌图片按目标尺寸缩放一次，转换成预乘alpha的BGRA后缓存；格挡高光在混合时着色，不单独缓存，
+// 之后每帧绘制盾牌只需把缓存的精灵混合到画布上，不再逐个细胞clone和resize
+// 多线程使用的约定见prepareCellSprites（drawing.h）
+class ShieldSprites {
+public:
+    static ShieldSprites& instance();
+
+    // 取source缩放到size后的精灵，第一次请求该尺寸时生成
+    const cv::Mat& get(const cv::Mat& source, const cv::Size& size);
+
+    // 盾牌图片更换后需要清空
+    void clear() { sprites.clear(); }
+    size_t size() const { return sprites.size(); }
+
+private:
+    ShieldSprites() = default;
+    ShieldSprites(const ShieldSprites&) = delete;
+    ShieldSprites& operator=(const ShieldSprites&) = delete;
+
+    // 键为(宽, 高)
+    std::map<std::pair<int, int>, cv::Mat> sprites;
+};
+
+#endif // SHIELD_SPRITES_H
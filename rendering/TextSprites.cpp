@@ -0,0 +1,38 @@
+#include "TextSprites.h"
+#include "Compositor.h"
+
+TextSprite rasterizeText(const std::string& text, const TextStyle& style) {
+    int baseline = 0;
+    cv::Size size = cv::getTextSize(text, style.fontFace, style.fontScale, style.thickness, &baseline);
+    // 笔画粗细和抗锯齿边缘会超出getTextSize的范围，四周留出透明边
+    const int margin = style.thickness + 2;
+
+    // 同细胞精灵，直接画在全透明的BGRA图上
+    TextSprite sprite;
+    sprite.origin = cv::Point(margin, margin + size.height);
+    sprite.image = cv::Mat::zeros(size.height + baseline + 2 * margin, size.width + 2 * margin, CV_8UC4);
+    cv::putText(sprite.image, text, sprite.origin, style.fontFace, style.fontScale,
+                cv::Scalar(style.color[0], style.color[1], style.color[2], 255), style.thickness, cv::LINE_AA);
+    return sprite;
+}
+
+void blendText(cv::Mat& canvas, const TextSprite& sprite, const cv::Point& origin) {
+    blendPremultiplied(canvas, sprite.image, origin - sprite.origin);
+}
+
+TextSprites& TextSprites::instance() {
+    static TextSprites cache;
+    return cache;
+}
+
+const TextSprite& TextSprites::get(const std::string& text, const TextStyle& style) {
+    auto key = std::make_tuple(text, style.fontScale, style.color[0], style.color[1], style.color[2],
+                               style.thickness, style.fontFace);
+    auto it = sprites.find(key);
+    if (it != sprites.end()) return it->second;
+
+    if (sprites.size() >= maxSprites) {
+        sprites.clear();
+    }
+    return sprites.emplace(std::move(key), rasterizeText(text, style)).first->second;
+}
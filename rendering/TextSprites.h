@@ -0,0 +1,62 @@
+#ifndef TEXT_SPRITES_H
+#define TEXT_SPRITES_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <tuple>
+
+// putText的字体参数，线型固定为LINE_AA
+struct TextStyle {
+    double fontScale;
+    cv::Scalar color;
+    int thickness;
+    int fontFace;
+
+    explicit TextStyle(double fontScale = 0.5, const cv::Scalar& color = cv::Scalar(0, 0, 0), int thickness = 1,
+                       int fontFace = cv::FONT_HERSHEY_SIMPLEX)
+        : fontScale(fontScale), color(color), thickness(thickness), fontFace(fontFace) {}
+
+    bool operator==(const TextStyle& other) const {
+        return fontScale == other.fontScale && color == other.color && thickness == other.thickness
+            && fontFace == other.fontFace;
+    }
+};
+
+// 预光栅化的文字：预乘alpha的BGRA图，origin为putText的文字原点（基线左端）在图中的位置
+struct TextSprite {
+    cv::Mat image;
+    cv::Point origin;
+};
+
+// 按putText的参数把文字画成精灵；用blendPremultiplied混合到origin处，与直接putText只差抗锯齿边缘的取整
+TextSprite rasterizeText(const std::string& text, const TextStyle& style);
+
+// 把精灵混合到画布上，文字原点落在origin
+void blendText(cv::Mat& canvas, const TextSprite& sprite, const cv::Point& origin);
+
+// 细胞名字等反复出现的短文字的精灵缓存，进程内共用一个实例
+// 多线程使用的约定见prepareCellSprites（drawing.h）
+class TextSprites {
+public:
+    // 超过这个数量时清空重建
+    static const size_t maxSprites = 256;
+
+    static TextSprites& instance();
+
+    // 取给定文字和样式的精灵，第一次请求时光栅化
+    const TextSprite& get(const std::string& text, const TextStyle& style);
+
+    void clear() { sprites.clear(); }
+    size_t size() const { return sprites.size(); }
+
+private:
+    TextSprites() = default;
+    TextSprites(const TextSprites&) = delete;
+    TextSprites& operator=(const TextSprites&) = delete;
+
+    // 键为(文字, 字号, 颜色BGR, 粗细, 字体)
+    std::map<std::tuple<std::string, double, double, double, double, int, int>, TextSprite> sprites;
+};
+
+#endif // TEXT_SPRITES_H
@@ -0,0 +1,123 @@
+#include "TiledRenderer.h"
+#include "RenderSnapshot.h"
+#include "CellSprites.h"
+#include "../drawing.h"
+#include <algorithm>
+
+namespace {
+
+// 每个绘制线程的草稿画布，跨帧保留；块之外的像素是之前各块留下的内容，不会被拷回
+thread_local cv::Mat scratchCanvas;
+
+} // namespace
+
+TiledRenderer::TiledRenderer(int workerCount, int tileSize)
+    : pool(workerCount), tileSize(std::max(16, tileSize)), tileColumns(0) {
+}
+
+void TiledRenderer::layoutTiles(const cv::Size& canvasSize) {
+    if (canvasSize == layoutSize) return;
+    layoutSize = canvasSize;
+    tileColumns = (canvasSize.width + tileSize - 1) / tileSize;
+    const int tileRows = (canvasSize.height + tileSize - 1) / tileSize;
+    const cv::Rect bounds(0, 0, canvasSize.width, canvasSize.height);
+
+    tiles.clear();
+    tiles.resize(static_cast<size_t>(tileColumns) * tileRows);
+    for (int row = 0; row < tileRows; ++row) {
+        for (int column = 0; column < tileColumns; ++column) {
+            tiles[row * tileColumns + column].rect =
+                cv::Rect(column * tileSize, row * tileSize, tileSize, tileSize) & bounds;
+        }
+    }
+}
+
+void TiledRenderer::addToTiles(const cv::Rect& bounds, std::vector<int> Tile::*list, int index) {
+    const cv::Rect visible = bounds & cv::Rect(0, 0, layoutSize.width, layoutSize.height);
+    if (visible.width <= 0 || visible.height <= 0) return;
+    const int firstColumn = visible.x / tileSize;
+    const int lastColumn = (visible.x + visible.width - 1) / tileSize;
+    const int firstRow = visible.y / tileSize;
+    const int lastRow = (visible.y + visible.height - 1) / tileSize;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            (tiles[row * tileColumns + column].*list).push_back(index);
+        }
+    }
+}
+
+void TiledRenderer::render(cv::Mat& canvas, const RenderSnapshot& snapshot, float alpha,
+                           const std::map<std::string, float>& config, float scale, float time,
+                           const std::vector<CellDetail>* details) {
+    // 只有一个线程时分块只会增加重复绘制的开销
+    if (pool.getWorkerCount() == 1) {
+        drawSnapshot(canvas, snapshot, alpha, config, scale, time, details);
+        return;
+    }
+
+    layoutTiles(canvas.size());
+    for (Tile& tile : tiles) {
+        tile.cells.clear();
+        tile.drops.clear();
+    }
+
+    // 并行绘制前在本线程上预热精灵缓存（见prepareCellSprites）
+    // 图集超过容量时会整体清空，本帧前面预热的精灵可能已被清掉，这一帧退回串行绘制
+    size_t atlasSize = 0;
+    bool atlasEvicted = false;
+    positions.resize(snapshot.cells.size());
+    for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+        const CellView& cell = snapshot.cells[i];
+        positions[i] = cell.interpolate(alpha);
+        // 圆点档不用精灵，包围盒也只有圆点本身
+        if (details && (*details)[i] == CellDetail::Dot) {
+            const int reach = static_cast<int>(cellBodySize(cell, config, scale).height * 0.6f) + 3;
+            const cv::Point center(static_cast<int>(positions[i].x), static_cast<int>(positions[i].y));
+            addToTiles(cv::Rect(center.x - reach, center.y - reach, 2 * reach + 1, 2 * reach + 1),
+                       &Tile::cells, static_cast<int>(i));
+            continue;
+        }
+        prepareCellSprites(cell, config, scale);
+        const size_t currentSize = CellSprites::instance().size();
+        atlasEvicted = atlasEvicted || currentSize < atlasSize;
+        atlasSize = currentSize;
+        addToTiles(cellBounds(cell, positions[i], config, scale), &Tile::cells, static_cast<int>(i));
+    }
+    if (atlasEvicted) {
+        drawSnapshot(canvas, snapshot, alpha, config, scale, time, details);
+        return;
+    }
+    tails.compute(snapshot.cells, positions, details, config, scale, time);
+    for (size_t i = 0; i < snapshot.bloodX.size(); ++i) {
+        addToTiles(teardropBounds(cv::Point2f(snapshot.bloodX[i], snapshot.bloodY[i]), snapshot.bloodSize[i]),
+                   &Tile::drops, static_cast<int>(i));
+    }
+
+    activeTiles.clear();
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        if (!tiles[t].cells.empty() || !tiles[t].drops.empty()) {
+            activeTiles.push_back(t);
+        }
+    }
+
+    pool.parallelFor(activeTiles.size(), 1, [&](size_t begin, size_t end) {
+        if (scratchCanvas.size() != canvas.size() || scratchCanvas.type() != canvas.type()) {
+            scratchCanvas.create(canvas.size(), canvas.type());
+        }
+        // 与drawSnapshot一致的纯红色水滴
+        const cv::Scalar bloodColor(0, 0, 255);
+        for (size_t k = begin; k < end; ++k) {
+            const Tile& tile = tiles[activeTiles[k]];
+            canvas(tile.rect).copyTo(scratchCanvas(tile.rect));
+            for (int i : tile.cells) {
+                drawCell(scratchCanvas, snapshot.cells[i], positions[i], config, scale, time, tile.rect,
+                         details ? (*details)[i] : CellDetail::Full, tails.curve(i));
+            }
+            for (int i : tile.drops) {
+                drawTeardropShape(scratchCanvas, cv::Point2f(snapshot.bloodX[i], snapshot.bloodY[i]),
+                                  snapshot.bloodSize[i], snapshot.bloodRotation[i], bloodColor);
+            }
+            scratchCanvas(tile.rect).copyTo(canvas(tile.rect));
+        }
+    });
+}
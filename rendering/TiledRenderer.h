@@ -0,0 +1,60 @@
+#ifndef TILED_RENDERER_H
+#define TILED_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "../structs.h"
+#include "../simulation/ThreadPool.h"
+#include "CellGeometry.h"
+
+struct RenderSnapshot;
+
+// 分块并行绘制快照，结果与drawSnapshot逐像素一致
+// 画布划分成互不重叠的tileSize见方的块，细胞和血滴按包围盒（含尾巴、矛、盾牌、血条和名字）登记到覆盖的块，
+// 各块在线程池上并行绘制：每个线程有一张与画布同尺寸的草稿画布，拷入本块的背景后按快照顺序绘制登记的物体，
+// 再只把本块拷回画布。线条和图形在草稿上完整光栅化，OpenCV的裁剪与直接画在画布上完全相同；
+// 精灵混合逐像素独立，只在本块内进行
+class TiledRenderer {
+public:
+    // workerCount为参与绘制的线程总数（含调用线程），0表示使用硬件并发数
+    explicit TiledRenderer(int workerCount = 0, int tileSize = 128);
+
+    TiledRenderer(const TiledRenderer&) = delete;
+    TiledRenderer& operator=(const TiledRenderer&) = delete;
+
+    // 与drawSnapshot参数相同；只允许同一时刻有一个线程调用
+    void render(cv::Mat& canvas, const RenderSnapshot& snapshot, float alpha,
+                const std::map<std::string, float>& config, float scale, float time,
+                const std::vector<CellDetail>* details = nullptr);
+
+    int getWorkerCount() const { return pool.getWorkerCount(); }
+    int getTileSize() const { return tileSize; }
+
+private:
+    // 一个块和登记到其中的细胞、血滴下标，下标按快照顺序排列
+    struct Tile {
+        cv::Rect rect;
+        std::vector<int> cells;
+        std::vector<int> drops;
+    };
+
+    ThreadPool pool;
+    int tileSize;
+    cv::Size layoutSize;
+    std::vector<Tile> tiles;
+    int tileColumns;
+
+    // 逐帧复用的缓冲；尾巴折线每帧批量算一次，细胞跨越的各块共用
+    std::vector<cv::Point2f> positions;
+    TailBatch tails;
+    std::vector<size_t> activeTiles;
+
+    // 画布尺寸变化时重新划分块
+    void layoutTiles(const cv::Size& canvasSize);
+    // 把下标登记到与bounds相交的所有块
+    void addToTiles(const cv::Rect& bounds, std::vector<int> Tile::*list, int index);
+};
+
+#endif // TILED_RENDERER_H
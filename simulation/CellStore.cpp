@@ -0,0 +1,386 @@
+#include "CellStore.h"
+#include "ThreadPool.h"
+#include "../entities/BaseCell.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// x86-64默认具备SSE2，批量内核据此选择向量化路径
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CELL_STORE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 所有float字段数组，搬移和弹出槽位时统一处理
+std::vector<float> CellStore::* const floatColumns[] = {
+    &CellStore::posX, &CellStore::posY,
+    &CellStore::prevX, &CellStore::prevY,
+    &CellStore::velX, &CellStore::velY,
+    &CellStore::accX, &CellStore::accY,
+    &CellStore::health, &CellStore::maxHealth,
+    &CellStore::attackTime,
+    &CellStore::shieldTime, &CellStore::shieldDuration, &CellStore::shieldCooldown, &CellStore::damageReduction,
+    &CellStore::parryTime,
+    &CellStore::sizeMultiplier, &CellStore::sharpnessMultiplier, &CellStore::speedMultiplier,
+    &CellStore::attackMultiplier, &CellStore::defenseMultiplier
+};
+
+} // namespace
+
+CellStore& CellStore::instance() {
+    static CellStore store;
+    return store;
+}
+
+int CellStore::allocate(BaseCell* owner, const cv::Point2f& position) {
+    int slot = static_cast<int>(owners.size());
+    owners.push_back(owner);
+
+    posX.push_back(position.x);
+    posY.push_back(position.y);
+    prevX.push_back(position.x);
+    prevY.push_back(position.y);
+    velX.push_back(0.0f);
+    velY.push_back(0.0f);
+    accX.push_back(0.0f);
+    accY.push_back(0.0f);
+    health.push_back(100.0f);
+    maxHealth.push_back(100.0f);
+    attackTime.push_back(0.0f);
+    shieldTime.push_back(0.0f);
+    shieldDuration.push_back(2.0f);
+    shieldCooldown.push_back(0.0f);
+    damageReduction.push_back(0.75f);
+    parryTime.push_back(0.0f);
+    flags.push_back(FACE_RIGHT);
+
+    sizeMultiplier.push_back(1.0f);
+    sharpnessMultiplier.push_back(1.0f);
+    speedMultiplier.push_back(1.0f);
+    attackMultiplier.push_back(1.0f);
+    defenseMultiplier.push_back(1.0f);
+
+    return slot;
+}
+
+void CellStore::release(int slot) {
+    size_t last = owners.size() - 1;
+    if (static_cast<size_t>(slot) != last) {
+        moveSlot(last, slot);
+    }
+    popBack();
+}
+
+void CellStore::moveSlot(size_t from, size_t to) {
+    for (auto column : floatColumns) {
+        (this->*column)[to] = (this->*column)[from];
+    }
+    flags[to] = flags[from];
+    owners[to] = owners[from];
+    owners[to]->slot = static_cast<int>(to);
+}
+
+void CellStore::popBack() {
+    for (auto column : floatColumns) {
+        (this->*column).pop_back();
+    }
+    flags.pop_back();
+    owners.pop_back();
+}
+
+void CellStore::step(float deltaTime, const GameConfig& config, const cv::Size& canvasSize) {
+    integrate(0, size(), deltaTime, config, canvasSize);
+}
+
+void CellStore::step(float deltaTime, const GameConfig& config, const cv::Size& canvasSize, ThreadPool& pool) {
+    // 分块取4的倍数，使每块都能完整走SIMD路径
+    const size_t grainSize = 4096;
+    pool.parallelFor(size(), grainSize, [&](size_t begin, size_t end) {
+        integrate(begin, end, deltaTime, config, canvasSize);
+    });
+}
+
+// 批量内核：每个槽位先算出新值，再按存活掩码选择性写回，循环体不含分支
+// SSE2路径一次处理4个槽位，剩余槽位和单个细胞的更新走标量路径；
+// 两条路径的取大取小与比较方式一一对应，结果逐位一致，逐实体更新与批量推进不会产生分歧
+namespace {
+
+// 与_mm_max_ps / _mm_min_ps的语义一致
+inline float maxLane(float a, float b) { return a > b ? a : b; }
+inline float minLane(float a, float b) { return a < b ? a : b; }
+
+struct KernelParams {
+    float maxSpeed;
+    float drag;       // 本步的阻力系数，已按步长换算
+    float stepScale;  // 本步相当于多少个基准步
+    float attackStep;
+    float deltaTime;
+    float width;
+    float height;
+};
+
+struct KernelArrays {
+    float* __restrict posX;
+    float* __restrict posY;
+    float* __restrict velX;
+    float* __restrict velY;
+    float* __restrict accX;
+    float* __restrict accY;
+    float* __restrict attackTime;
+    float* __restrict shieldTime;
+    float* __restrict shieldCooldown;
+    float* __restrict parryTime;
+    uint8_t* __restrict flags;
+    const float* __restrict health;
+    const float* __restrict shieldDuration;
+    const float* __restrict speedMultiplier;
+};
+
+void integrateScalar(const KernelArrays& a, const KernelParams& p, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const bool alive = a.health[i] > 0.0f;
+        const uint8_t oldFlags = a.flags[i];
+        uint8_t f = oldFlags;
+
+        // 基于加速度更新速度，并按基因调整后的最大速度限幅
+        const float limit = p.maxSpeed * a.speedMultiplier[i];
+        float vx = minLane(maxLane(a.velX[i] + a.accX[i] * p.stepScale, -limit), limit);
+        float vy = minLane(maxLane(a.velY[i] + a.accY[i] * p.stepScale, -limit), limit);
+
+        // 基于速度更新位置，然后应用阻力
+        float px = a.posX[i] + vx * p.stepScale;
+        float py = a.posY[i] + vy * p.stepScale;
+        vx *= p.drag;
+        vy *= p.drag;
+
+        // 边界检查，越界时贴边并反弹
+        const bool outX = (px < 0.0f) || (px > p.width);
+        const bool outY = (py < 0.0f) || (py > p.height);
+        px = minLane(maxLane(px, 0.0f), p.width);
+        py = minLane(maxLane(py, 0.0f), p.height);
+        vx = outX ? vx * -0.5f : vx;
+        vy = outY ? vy * -0.5f : vy;
+
+        // 速度超过阈值时才更新朝向，避免频繁切换
+        if (vx > 1.0f) f |= CellStore::FACE_RIGHT;
+        if (vx < -1.0f) f &= ~CellStore::FACE_RIGHT;
+
+        // 攻击动画完成后结束攻击
+        const bool attacking = (f & CellStore::ATTACKING) != 0;
+        float at = a.attackTime[i] + p.attackStep;
+        const bool attackDone = attacking && at >= 1.0f;
+        at = attacking ? (attackDone ? 0.0f : at) : a.attackTime[i];
+        if (attackDone) f &= ~CellStore::ATTACKING;
+
+        // 盾牌冷却随时间减少到0；持续时间超过限制后自动降下并进入冷却，未举盾时计时归零
+        const bool shielding = (f & CellStore::SHIELDING) != 0;
+        float st = a.shieldTime[i] + p.deltaTime;
+        const bool shieldExpired = shielding && st >= a.shieldDuration[i];
+        st = (shielding && !shieldExpired) ? st : 0.0f;
+        const float cooldown = shieldExpired ? 0.3f : maxLane(a.shieldCooldown[i] - p.deltaTime, 0.0f);
+        if (shieldExpired) f &= ~CellStore::SHIELDING;
+
+        // 格挡效果持续0.5秒
+        const bool parried = (f & CellStore::PARRIED) != 0;
+        float pt = a.parryTime[i] + p.deltaTime;
+        const bool parryDone = parried && pt >= 0.5f;
+        pt = parried ? (parryDone ? 0.0f : pt) : a.parryTime[i];
+        if (parryDone) f &= ~CellStore::PARRIED;
+
+        if (alive) {
+            a.posX[i] = px;
+            a.posY[i] = py;
+            a.velX[i] = vx;
+            a.velY[i] = vy;
+            a.accX[i] = 0.0f;
+            a.accY[i] = 0.0f;
+            a.attackTime[i] = at;
+            a.shieldTime[i] = st;
+            a.shieldCooldown[i] = cooldown;
+            a.parryTime[i] = pt;
+            a.flags[i] = f;
+        }
+    }
+}
+
+#ifdef CELL_STORE_SSE2
+
+inline __m128 selectPs(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128i selectSi(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// 返回处理到的位置，剩余不足4个的槽位交给标量路径
+size_t integrateSse2(const KernelArrays& a, const KernelParams& p, size_t begin, size_t end) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 bounce = _mm_set1_ps(-0.5f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 cooldownAfterExpire = _mm_set1_ps(0.3f);
+    const __m128 maxSpeed = _mm_set1_ps(p.maxSpeed);
+    const __m128 drag = _mm_set1_ps(p.drag);
+    const __m128 stepScale = _mm_set1_ps(p.stepScale);
+    const __m128 attackStep = _mm_set1_ps(p.attackStep);
+    const __m128 deltaTime = _mm_set1_ps(p.deltaTime);
+    const __m128 width = _mm_set1_ps(p.width);
+    const __m128 height = _mm_set1_ps(p.height);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    const __m128i zeroI = _mm_setzero_si128();
+    const __m128i faceRightBit = _mm_set1_epi32(CellStore::FACE_RIGHT);
+    const __m128i attackingBit = _mm_set1_epi32(CellStore::ATTACKING);
+    const __m128i shieldingBit = _mm_set1_epi32(CellStore::SHIELDING);
+    const __m128i parriedBit = _mm_set1_epi32(CellStore::PARRIED);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 alive = _mm_cmpgt_ps(_mm_loadu_ps(a.health + i), zero);
+
+        // 4个字节的标志展开为4个32位通道
+        int32_t packedFlags;
+        std::memcpy(&packedFlags, a.flags + i, sizeof(packedFlags));
+        const __m128i oldFlags = _mm_unpacklo_epi16(
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128(packedFlags), zeroI), zeroI);
+        __m128i f = oldFlags;
+
+        // 基于加速度更新速度，并按基因调整后的最大速度限幅
+        const __m128 limit = _mm_mul_ps(maxSpeed, _mm_loadu_ps(a.speedMultiplier + i));
+        const __m128 negLimit = _mm_xor_ps(limit, signBit);
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(a.velX + i), _mm_mul_ps(_mm_loadu_ps(a.accX + i), stepScale));
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(a.velY + i), _mm_mul_ps(_mm_loadu_ps(a.accY + i), stepScale));
+        vx = _mm_min_ps(_mm_max_ps(vx, negLimit), limit);
+        vy = _mm_min_ps(_mm_max_ps(vy, negLimit), limit);
+
+        // 基于速度更新位置，然后应用阻力
+        const __m128 oldPx = _mm_loadu_ps(a.posX + i);
+        const __m128 oldPy = _mm_loadu_ps(a.posY + i);
+        __m128 px = _mm_add_ps(oldPx, _mm_mul_ps(vx, stepScale));
+        __m128 py = _mm_add_ps(oldPy, _mm_mul_ps(vy, stepScale));
+        vx = _mm_mul_ps(vx, drag);
+        vy = _mm_mul_ps(vy, drag);
+
+        // 边界检查，越界时贴边并反弹
+        const __m128 outX = _mm_or_ps(_mm_cmplt_ps(px, zero), _mm_cmpgt_ps(px, width));
+        const __m128 outY = _mm_or_ps(_mm_cmplt_ps(py, zero), _mm_cmpgt_ps(py, height));
+        px = _mm_min_ps(_mm_max_ps(px, zero), width);
+        py = _mm_min_ps(_mm_max_ps(py, zero), height);
+        vx = selectPs(outX, _mm_mul_ps(vx, bounce), vx);
+        vy = selectPs(outY, _mm_mul_ps(vy, bounce), vy);
+
+        // 速度超过阈值时才更新朝向
+        const __m128i turnRight = _mm_castps_si128(_mm_cmpgt_ps(vx, one));
+        const __m128i turnLeft = _mm_castps_si128(_mm_cmplt_ps(vx, minusOne));
+        f = _mm_or_si128(f, _mm_and_si128(turnRight, faceRightBit));
+        f = _mm_andnot_si128(_mm_and_si128(turnLeft, faceRightBit), f);
+
+        // 攻击动画完成后结束攻击
+        const __m128 oldAt = _mm_loadu_ps(a.attackTime + i);
+        const __m128 attacking = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, attackingBit), attackingBit));
+        __m128 at = _mm_add_ps(oldAt, attackStep);
+        const __m128 attackDone = _mm_and_ps(attacking, _mm_cmpge_ps(at, one));
+        at = selectPs(attacking, _mm_andnot_ps(attackDone, at), oldAt);
+        f = _mm_andnot_si128(_mm_and_si128(_mm_castps_si128(attackDone), attackingBit), f);
+
+        // 盾牌冷却随时间减少到0；持续时间超过限制后自动降下并进入冷却，未举盾时计时归零
+        const __m128 shielding = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, shieldingBit), shieldingBit));
+        __m128 st = _mm_add_ps(_mm_loadu_ps(a.shieldTime + i), deltaTime);
+        const __m128 shieldExpired = _mm_and_ps(shielding, _mm_cmpge_ps(st, _mm_loadu_ps(a.shieldDuration + i)));
+        st = _mm_and_ps(_mm_andnot_ps(shieldExpired, shielding), st);
+        const __m128 cooldownLeft = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(a.shieldCooldown + i), deltaTime), zero);
+        const __m128 cooldown = selectPs(shieldExpired, cooldownAfterExpire, cooldownLeft);
+        f = _mm_andnot_si128(_mm_and_si128(_mm_castps_si128(shieldExpired), shieldingBit), f);
+
+        // 格挡效果持续0.5秒
+        const __m128 oldPt = _mm_loadu_ps(a.parryTime + i);
+        const __m128 parried = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, parriedBit), parriedBit));
+        __m128 pt = _mm_add_ps(oldPt, deltaTime);
+        const __m128 parryDone = _mm_and_ps(parried, _mm_cmpge_ps(pt, half));
+        pt = selectPs(parried, _mm_andnot_ps(parryDone, pt), oldPt);
+        f = _mm_andnot_si128(_mm_and_si128(_mm_castps_si128(parryDone), parriedBit), f);
+
+        // 按存活掩码写回
+        _mm_storeu_ps(a.posX + i, selectPs(alive, px, oldPx));
+        _mm_storeu_ps(a.posY + i, selectPs(alive, py, oldPy));
+        _mm_storeu_ps(a.velX + i, selectPs(alive, vx, _mm_loadu_ps(a.velX + i)));
+        _mm_storeu_ps(a.velY + i, selectPs(alive, vy, _mm_loadu_ps(a.velY + i)));
+        _mm_storeu_ps(a.accX + i, _mm_andnot_ps(alive, _mm_loadu_ps(a.accX + i)));
+        _mm_storeu_ps(a.accY + i, _mm_andnot_ps(alive, _mm_loadu_ps(a.accY + i)));
+        _mm_storeu_ps(a.attackTime + i, selectPs(alive, at, oldAt));
+        _mm_storeu_ps(a.shieldTime + i, selectPs(alive, st, _mm_loadu_ps(a.shieldTime + i)));
+        _mm_storeu_ps(a.shieldCooldown + i, selectPs(alive, cooldown, _mm_loadu_ps(a.shieldCooldown + i)));
+        _mm_storeu_ps(a.parryTime + i, selectPs(alive, pt, oldPt));
+
+        f = selectSi(_mm_castps_si128(alive), f, oldFlags);
+        __m128i packed = _mm_packs_epi32(f, f);
+        packed = _mm_packus_epi16(packed, packed);
+        packedFlags = _mm_cvtsi128_si32(packed);
+        std::memcpy(a.flags + i, &packedFlags, sizeof(packedFlags));
+    }
+    return i;
+}
+
+#endif // CELL_STORE_SSE2
+
+} // namespace
+
+void CellStore::integrate(size_t begin, size_t end, float deltaTime, const GameConfig& config, const cv::Size& canvasSize) {
+    KernelParams params;
+    // 加速度、速度和阻力按基准频率的一步标定；其他步长按比例换算，基准步长时stepScale正好为1，结果逐位不变
+    params.maxSpeed = config.maxSpeed;
+    params.stepScale = deltaTime * referenceTickRate;
+    params.drag = params.stepScale == 1.0f ? config.drag : std::pow(config.drag, params.stepScale);
+    params.attackStep = deltaTime / config.attackDuration;
+    params.deltaTime = deltaTime;
+    params.width = static_cast<float>(canvasSize.width);
+    params.height = static_cast<float>(canvasSize.height);
+
+    KernelArrays arrays{
+        posX.data(), posY.data(), velX.data(), velY.data(), accX.data(), accY.data(),
+        attackTime.data(), shieldTime.data(), shieldCooldown.data(), parryTime.data(),
+        flags.data(), health.data(), shieldDuration.data(), speedMultiplier.data()
+    };
+
+#ifdef CELL_STORE_SSE2
+    begin = integrateSse2(arrays, params, begin, end);
+#endif
+    integrateScalar(arrays, params, begin, end);
+}
+
+void CellStore::savePreviousPositions() {
+    std::copy(posX.begin(), posX.end(), prevX.begin());
+    std::copy(posY.begin(), posY.end(), prevY.begin());
+}
+
+void CellStore::collectAttackers(std::vector<BaseCell*>& out) const {
+    out.clear();
+    for (size_t i = 0; i < owners.size(); ++i) {
+        // 已死亡但对象仍被持有的细胞（如单人模式的玩家）不参与战斗
+        if ((flags[i] & ATTACKING) && attackTime[i] < 0.5f && health[i] > 0) {
+            out.push_back(owners[i]);
+        }
+    }
+}
+
+uint64_t CellStore::stateHash() const {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ULL;
+        }
+    };
+
+    const uint64_t count = owners.size();
+    mix(&count, sizeof(count));
+    for (auto column : floatColumns) {
+        mix((this->*column).data(), count * sizeof(float));
+    }
+    mix(flags.data(), count);
+    return hash;
+}
@@ -0,0 +1,95 @@
+#ifndef CELL_STORE_H
+#define CELL_STORE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <cstdint>
+#include "../GameConfig.h"
+
+class BaseCell;
+class ThreadPool;
+
+// 细胞热数据的结构体数组（SoA）存储，进程内所有细胞共用一个实例
+// 位置、速度、加速度、血量、计时器、状态标志和基因属性倍率各占一个连续数组，BaseCell只持有自己的槽位下标
+// 物理、攻击动画和盾牌计时按槽位区间批量推进；释放时把最后一个槽位搬到空位（swap-and-pop），数组始终紧凑
+class CellStore {
+public:
+    // 状态标志位
+    enum Flag : uint8_t {
+        FACE_RIGHT = 1 << 0,
+        ATTACKING  = 1 << 1,
+        SHIELDING  = 1 << 2,
+        PARRIED    = 1 << 3
+    };
+
+    // 速度以每个基准步（1/60秒）的像素数计，加速度和阻力也按基准步标定；
+    // 模拟频率不同时integrate按步长换算，移动速度不随tickRate变化
+    static constexpr float referenceTickRate = 60.0f;
+
+    static CellStore& instance();
+
+    // 为细胞分配槽位并写入默认状态，返回槽位下标
+    int allocate(BaseCell* owner, const cv::Point2f& position);
+    // 释放槽位，最后一个槽位的细胞会被搬到这里
+    void release(int slot);
+
+    size_t size() const { return owners.size(); }
+    BaseCell* getOwner(int slot) const { return owners[slot]; }
+
+    bool hasFlag(int slot, Flag flag) const { return (flags[slot] & flag) != 0; }
+    void setFlag(int slot, Flag flag, bool value) {
+        flags[slot] = value ? (flags[slot] | flag) : (flags[slot] & ~flag);
+    }
+
+    // 推进所有存活细胞的物理、攻击动画和盾牌状态
+    void step(float deltaTime, const GameConfig& config, const cv::Size& canvasSize);
+    // 同上，按槽位区间分块在线程池上并行推进；各槽位互不依赖，结果与串行推进一致
+    void step(float deltaTime, const GameConfig& config, const cv::Size& canvasSize, ThreadPool& pool);
+    // 推进[begin, end)区间内的存活细胞，单个细胞的update和批量step共用这一实现
+    void integrate(size_t begin, size_t end, float deltaTime, const GameConfig& config, const cv::Size& canvasSize);
+
+    // 固定步长模拟：每个模拟步开始前保存位置，渲染时在上一步与当前步之间插值
+    void savePreviousPositions();
+    void setRenderAlpha(float alpha) { renderAlpha = alpha; }
+    cv::Point2f interpolatedPosition(int slot) const {
+        return cv::Point2f(prevX[slot] + (posX[slot] - prevX[slot]) * renderAlpha,
+                           prevY[slot] + (posY[slot] - prevY[slot]) * renderAlpha);
+    }
+
+    // 收集处于前刺阶段（攻击进度小于0.5）的存活攻击者，按槽位顺序输出
+    void collectAttackers(std::vector<BaseCell*>& out) const;
+
+    // 所有槽位全部字段的FNV-1a哈希，回放时用来比对两次运行的世界状态是否一致
+    uint64_t stateHash() const;
+
+    // 各字段数组，下标为槽位
+    std::vector<float> posX, posY;
+    std::vector<float> prevX, prevY;
+    std::vector<float> velX, velY;
+    std::vector<float> accX, accY;
+    std::vector<float> health, maxHealth;
+    std::vector<float> attackTime;
+    std::vector<float> shieldTime, shieldDuration, shieldCooldown, damageReduction;
+    std::vector<float> parryTime;
+    std::vector<uint8_t> flags;
+
+    // 基因决定的属性倍率
+    std::vector<float> sizeMultiplier, sharpnessMultiplier, speedMultiplier;
+    std::vector<float> attackMultiplier, defenseMultiplier;
+
+private:
+    CellStore() = default;
+    CellStore(const CellStore&) = delete;
+    CellStore& operator=(const CellStore&) = delete;
+
+    std::vector<BaseCell*> owners;
+
+    // 渲染插值系数，1表示直接使用当前位置
+    float renderAlpha = 1.0f;
+
+    // 把槽位from的全部字段搬到槽位to
+    void moveSlot(size_t from, size_t to);
+    void popBack();
+};
+
+#endif // CELL_STORE_H
@@ -0,0 +1,39 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float rate, int maxTicks)
+    : tickRate(60.0f), tickDelta(1.0f / 60.0f), maxTicksPerFrame(std::max(maxTicks, 1)), accumulator(0.0f) {
+    setTickRate(rate);
+}
+
+void FixedTimestep::setTickRate(float rate) {
+    // 非法频率时保持原值
+    if (rate <= 0.0f) return;
+    tickRate = rate;
+    tickDelta = 1.0f / rate;
+}
+
+int FixedTimestep::advance(float frameSeconds) {
+    accumulator += std::max(frameSeconds, 0.0f);
+
+    int ticks = 0;
+    while (accumulator >= tickDelta && ticks < maxTicksPerFrame) {
+        accumulator -= tickDelta;
+        ++ticks;
+    }
+
+    // 追赶上限已到仍有积压：丢弃整步部分，只保留不足一步的余量用于插值
+    if (accumulator >= tickDelta) {
+        accumulator = std::fmod(accumulator, tickDelta);
+    }
+    return ticks;
+}
+
+float FixedTimestep::getAlpha() const {
+    return std::min(accumulator / tickDelta, 1.0f);
+}
+
+void FixedTimestep::reset() {
+    accumulator = 0.0f;
+}
@@ -0,0 +1,34 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+// 固定步长调度器（累加器模式）
+// 每个渲染帧把真实经过的时间累加进来，按固定步长换算出本帧要执行的模拟步数（可以为0或多步），
+// 剩余不足一步的时间占步长的比例作为渲染插值系数。模拟结果因此与帧率和机器快慢无关
+class FixedTimestep {
+public:
+    // tickRate为模拟频率(Hz)；单帧最多追赶maxTicksPerFrame步，超出部分直接丢弃，避免卡顿后越追越慢
+    explicit FixedTimestep(float tickRate = 60.0f, int maxTicksPerFrame = 8);
+
+    void setTickRate(float tickRate);
+    float getTickRate() const { return tickRate; }
+
+    // 每个模拟步推进的时间（秒）
+    float getTickDelta() const { return tickDelta; }
+
+    // 累加一帧的真实耗时，返回本帧应执行的模拟步数
+    int advance(float frameSeconds);
+
+    // 上一步与当前步之间的插值系数，范围[0, 1)
+    float getAlpha() const;
+
+    // 清空累加器，例如暂停恢复后避免一次性补跑大量步数
+    void reset();
+
+private:
+    float tickRate;
+    float tickDelta;
+    int maxTicksPerFrame;
+    float accumulator;
+};
+
+#endif // FIXED_TIMESTEP_H
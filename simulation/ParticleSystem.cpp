@@ -0,0 +1,79 @@
+#include "ParticleSystem.h"
+
+namespace {
+
+// 重力加速度，与原先逐细胞更新血滴时一致
+const float gravity = 9.8f;
+
+// 默认池容量，远大于正常对战中同时存在的血滴数
+const size_t defaultCapacity = 4096;
+
+} // namespace
+
+ParticleSystem& ParticleSystem::instance() {
+    static ParticleSystem system;
+    return system;
+}
+
+ParticleSystem::ParticleSystem() : maxParticles(0), count(0) {
+    setCapacity(defaultCapacity);
+}
+
+void ParticleSystem::setCapacity(size_t capacity) {
+    maxParticles = capacity;
+    count = 0;
+    for (auto* column : {&posX, &posY, &velX, &velY, &sizes, &lifetime, &maxLifetime, &rotation}) {
+        column->assign(capacity, 0.0f);
+    }
+}
+
+bool ParticleSystem::spawn(const cv::Point2f& position, const cv::Point2f& velocity, float size, float life, float rot) {
+    if (count >= maxParticles) return false;
+
+    const size_t i = count++;
+    posX[i] = position.x;
+    posY[i] = position.y;
+    velX[i] = velocity.x;
+    velY[i] = velocity.y;
+    sizes[i] = size;
+    lifetime[i] = life;
+    maxLifetime[i] = life;
+    rotation[i] = rot;
+    return true;
+}
+
+void ParticleSystem::update(float deltaTime) {
+    // 批量推进：循环体无分支，编译器可以向量化
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    const float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+    float* __restrict life = lifetime.data();
+    const size_t n = count;
+    for (size_t i = 0; i < n; ++i) {
+        life[i] -= deltaTime;
+        px[i] += vx[i] * deltaTime;
+        py[i] += vy[i] * deltaTime;
+        vy[i] += gravity * deltaTime;
+    }
+
+    // 移除过期粒子：用末尾粒子填补空位，填过来的粒子需要再检查一次
+    size_t i = 0;
+    while (i < count) {
+        if (life[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        const size_t last = --count;
+        if (i != last) {
+            posX[i] = posX[last];
+            posY[i] = posY[last];
+            velX[i] = velX[last];
+            velY[i] = velY[last];
+            sizes[i] = sizes[last];
+            lifetime[i] = lifetime[last];
+            maxLifetime[i] = maxLifetime[last];
+            rotation[i] = rotation[last];
+        }
+    }
+}
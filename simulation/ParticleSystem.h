@@ -0,0 +1,45 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 世界级的血滴粒子系统，进程内共用一个实例
+// 粒子按字段分数组（SoA）存放在固定容量的池中，启动时一次性分配，运行中不再申请内存；
+// 池满时丢弃新粒子。过期粒子用最后一个粒子填补空位（swap-and-pop），数组始终紧凑
+// 粒子不再归属于某个细胞，细胞死亡后血滴照常播放完，引擎也不必为了血滴继续遍历死亡细胞
+class ParticleSystem {
+public:
+    static ParticleSystem& instance();
+
+    // 重新设置池容量，会清空现有粒子
+    void setCapacity(size_t capacity);
+    size_t capacity() const { return maxParticles; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 生成一个血滴，池满时返回false
+    bool spawn(const cv::Point2f& position, const cv::Point2f& velocity, float size, float lifetime, float rotation);
+
+    // 推进所有粒子并移除过期粒子
+    void update(float deltaTime);
+
+    void clear() { count = 0; }
+
+    // 各字段数组，只有前size()个元素有效
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> sizes;
+    std::vector<float> lifetime, maxLifetime;
+    std::vector<float> rotation;
+
+private:
+    ParticleSystem();
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    size_t maxParticles;
+    size_t count;
+};
+
+#endif // PARTICLE_SYSTEM_H
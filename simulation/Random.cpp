@@ -0,0 +1,70 @@
+#include "Random.h"
+#include <atomic>
+#include <random>
+
+namespace {
+
+// splitmix64，把相邻的种子/编号打散成互不相关的64位值
+uint64_t splitMix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// 世界流固定使用的编号，不会和makeStream()按顺序分配的编号冲突
+const uint64_t worldStreamId = UINT64_MAX;
+
+// 未显式设置时，进程启动后只读取一次random_device作为世界种子
+uint64_t entropySeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+Pcg32 deriveStream(uint64_t seed, uint64_t streamId) {
+    return Pcg32(splitMix64(seed ^ splitMix64(streamId)), streamId);
+}
+
+struct RandomState {
+    uint64_t seed = entropySeed();
+    std::atomic<uint64_t> nextStreamId{0};
+    Pcg32 world = deriveStream(seed, worldStreamId);
+};
+
+RandomState& state() {
+    static RandomState randomState;
+    return randomState;
+}
+
+} // namespace
+
+void Random::setWorldSeed(uint64_t seed) {
+    RandomState& s = state();
+    s.seed = seed;
+    s.nextStreamId.store(0, std::memory_order_relaxed);
+    s.world = deriveStream(seed, worldStreamId);
+}
+
+uint64_t Random::getWorldSeed() {
+    return state().seed;
+}
+
+uint64_t Random::beginWorld(uint64_t seed) {
+    if (seed == 0) {
+        seed = getWorldSeed();
+    }
+    setWorldSeed(seed);
+    return seed;
+}
+
+Pcg32 Random::makeStream(uint64_t streamId) {
+    return deriveStream(getWorldSeed(), streamId);
+}
+
+Pcg32 Random::makeStream() {
+    return makeStream(state().nextStreamId.fetch_add(1, std::memory_order_relaxed));
+}
+
+Pcg32& Random::world() {
+    return state().world;
+}
@@ -0,0 +1,77 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// 小状态、快速的伪随机数生成器（PCG32，XSH-RR输出变换），状态只有16字节
+// 满足UniformRandomBitGenerator要求，可以直接配合<random>中的分布使用；
+// 热路径上优先用自带的nextFloat/uniform/uniformInt/chance，开销只有一次乘加和移位
+class Pcg32 {
+public:
+    using result_type = uint32_t;
+
+    explicit Pcg32(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL) {
+        reseed(seed, stream);
+    }
+
+    // stream决定增量，不同stream的序列互不重叠
+    void reseed(uint64_t seed, uint64_t stream = 0) {
+        state = 0;
+        increment = (stream << 1u) | 1u;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    result_type operator()() { return next(); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    // [0, 1)，取高24位正好填满float尾数
+    float nextFloat() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+
+    // [lo, hi)
+    float uniform(float lo, float hi) { return lo + (hi - lo) * nextFloat(); }
+
+    // [lo, hi]闭区间，用乘法取高位代替取模，偏差在游戏中可以忽略
+    int uniformInt(int lo, int hi) {
+        uint32_t range = static_cast<uint32_t>(hi - lo) + 1u;
+        return lo + static_cast<int>((static_cast<uint64_t>(next()) * range) >> 32);
+    }
+
+    bool chance(float probability) { return nextFloat() < probability; }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+// 全局随机数设施：所有随机流都从同一个世界种子派生
+// world()供串行阶段（初始化、战斗、繁殖等）共用；并行阶段中每个实体持有自己的流，
+// 互不共享状态，也就不需要加锁
+class Random {
+public:
+    // 设置世界种子，并把流编号计数归零，之后派生的流序列完全由种子决定
+    static void setWorldSeed(uint64_t seed);
+    static uint64_t getWorldSeed();
+    // 开始一局新世界：seed为0时沿用当前世界种子，并重置流编号；返回实际使用的种子
+    static uint64_t beginWorld(uint64_t seed);
+
+    // 按编号派生一条独立的流，同一种子同一编号总是得到相同的序列
+    static Pcg32 makeStream(uint64_t streamId);
+    // 按创建顺序分配下一个编号并派生流，线程安全
+    static Pcg32 makeStream();
+
+    // 串行阶段共用的世界流，不是线程安全的
+    static Pcg32& world();
+};
+
+#endif // RANDOM_H
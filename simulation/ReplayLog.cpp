@@ -0,0 +1,161 @@
+#include "ReplayLog.h"
+#include "CellStore.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char* const header = "DTCELL-REPLAY 1";
+
+std::string toHex(const std::vector<uint8_t>& bytes) {
+    std::ostringstream out;
+    out << std::hex << std::setfill('0');
+    for (uint8_t b : bytes) {
+        out << std::setw(2) << static_cast<int>(b);
+    }
+    return out.str();
+}
+
+bool fromHex(const std::string& text, std::vector<uint8_t>& bytes) {
+    if (text.size() % 2 != 0) return false;
+    bytes.clear();
+    for (size_t i = 0; i < text.size(); i += 2) {
+        try {
+            bytes.push_back(static_cast<uint8_t>(std::stoul(text.substr(i, 2), nullptr, 16)));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void ReplayLog::recordKey(uint64_t tick, int key) {
+    events.push_back(Event{tick, EventType::KEY, key, {}});
+}
+
+void ReplayLog::recordMessage(uint64_t tick, EventType type, const std::vector<uint8_t>& payload) {
+    events.push_back(Event{tick, type, 0, payload});
+}
+
+void ReplayLog::recordPlayer(uint64_t tick, EventType type, int playerNumber) {
+    events.push_back(Event{tick, type, playerNumber, {}});
+}
+
+void ReplayLog::recordTick(uint64_t tick) {
+    tickCount = tick;
+    if (hashInterval > 0 && tick % hashInterval == 0) {
+        checkpoints.push_back(Checkpoint{tick, CellStore::instance().stateHash()});
+    }
+}
+
+bool ReplayLog::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "无法写入录像文件: " << path << std::endl;
+        return false;
+    }
+
+    // 浮点按十六进制写出，读回后与录制时逐位相同
+    out << header << "\n"
+        << "game " << game << " " << mode << "\n"
+        << "seed " << seed << "\n"
+        << "tickRate " << std::hexfloat << tickRate << std::defaultfloat << "\n"
+        << "hashInterval " << hashInterval << "\n"
+        << "ticks " << tickCount << "\n";
+    for (const auto& event : events) {
+        out << "e " << event.tick << " " << static_cast<int>(event.type) << " " << event.key;
+        if (!event.payload.empty()) {
+            out << " " << toHex(event.payload);
+        }
+        out << "\n";
+    }
+    for (const auto& checkpoint : checkpoints) {
+        out << "h " << checkpoint.tick << " " << checkpoint.hash << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool ReplayLog::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "无法打开录像文件: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != header) {
+        std::cerr << "不是有效的录像文件: " << path << std::endl;
+        return false;
+    }
+
+    events.clear();
+    checkpoints.clear();
+    int lineNumber = 1;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty()) continue;
+
+        std::istringstream fields(line);
+        std::string tag;
+        fields >> tag;
+        bool ok = true;
+        if (tag == "game") {
+            ok = static_cast<bool>(fields >> game >> mode);
+        } else if (tag == "seed") {
+            ok = static_cast<bool>(fields >> seed);
+        } else if (tag == "tickRate") {
+            std::string value;
+            ok = static_cast<bool>(fields >> value);
+            if (ok) tickRate = std::strtof(value.c_str(), nullptr);
+        } else if (tag == "hashInterval") {
+            ok = static_cast<bool>(fields >> hashInterval);
+        } else if (tag == "ticks") {
+            ok = static_cast<bool>(fields >> tickCount);
+        } else if (tag == "e") {
+            Event event;
+            int type = 0;
+            ok = static_cast<bool>(fields >> event.tick >> type >> event.key);
+            event.type = static_cast<EventType>(type);
+            std::string payload;
+            if (ok && fields >> payload) {
+                ok = fromHex(payload, event.payload);
+            }
+            if (ok) events.push_back(std::move(event));
+        } else if (tag == "h") {
+            Checkpoint checkpoint;
+            ok = static_cast<bool>(fields >> checkpoint.tick >> checkpoint.hash);
+            if (ok) checkpoints.push_back(checkpoint);
+        }
+
+        if (!ok) {
+            std::cerr << "录像文件第" << lineNumber << "行格式错误: " << line << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+const ReplayLog::Event* ReplayCursor::takeEvent(uint64_t tick) {
+    if (nextEvent < log.events.size() && log.events[nextEvent].tick <= tick) {
+        return &log.events[nextEvent++];
+    }
+    return nullptr;
+}
+
+bool ReplayCursor::verifyTick(uint64_t tick, uint64_t& expected, uint64_t& actual) {
+    while (nextCheckpoint < log.checkpoints.size() && log.checkpoints[nextCheckpoint].tick < tick) {
+        ++nextCheckpoint;
+    }
+    if (nextCheckpoint >= log.checkpoints.size() || log.checkpoints[nextCheckpoint].tick != tick) {
+        return true;
+    }
+
+    expected = log.checkpoints[nextCheckpoint++].hash;
+    actual = CellStore::instance().stateHash();
+    return expected == actual;
+}
@@ -0,0 +1,72 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 一局游戏的输入录像：世界种子、模拟频率、按tick排列的输入事件和定期记录的世界状态哈希
+// 相同种子下在相同tick施加相同输入，模拟逐tick一致，因此录像可以在无头模式下原样重放，
+// 作为每次完全相同的性能回归负载；重放时比对状态哈希，第一次不一致即报告分歧
+class ReplayLog {
+public:
+    enum class EventType : uint8_t {
+        KEY = 0,        // 本地键盘输入，key为按键码
+        NET_INPUT = 1,  // 收到的PLAYER_INPUT消息，payload为消息数据
+        NET_STATE = 2,  // 收到的PLAYER_STATE消息，payload为消息数据
+        NET_JOIN = 3,   // 远程玩家加入（客户端上为分配到本机的编号），key为玩家编号
+        NET_LEAVE = 4,  // 远程玩家离开，key为玩家编号
+        NET_WORLD = 5   // 客户端收到的GAME_STATE世界快照，payload为消息数据
+    };
+
+    // tick为事件施加前已完成的模拟步数，重放时在执行第tick步之前施加
+    struct Event {
+        uint64_t tick;
+        EventType type;
+        int key;
+        std::vector<uint8_t> payload;
+    };
+
+    struct Checkpoint {
+        uint64_t tick;
+        uint64_t hash;
+    };
+
+    std::string game = "single";  // "single"或"multi"
+    int mode = 0;                 // 多人游戏录制时的NetGameMode
+    uint64_t seed = 0;
+    float tickRate = 60.0f;
+    uint64_t hashInterval = 60;   // 每隔多少步记录一次状态哈希
+    uint64_t tickCount = 0;
+    std::vector<Event> events;
+    std::vector<Checkpoint> checkpoints;
+
+    void recordKey(uint64_t tick, int key);
+    void recordMessage(uint64_t tick, EventType type, const std::vector<uint8_t>& payload);
+    void recordPlayer(uint64_t tick, EventType type, int playerNumber);
+    // 每个模拟步结束后调用，tick为已完成的步数；到达哈希间隔时记录CellStore的状态哈希
+    void recordTick(uint64_t tick);
+
+    // 文本格式读写，失败时输出原因并返回false
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// 按顺序取出录像中的事件，并在检查点上比对状态哈希
+class ReplayCursor {
+public:
+    explicit ReplayCursor(const ReplayLog& log) : log(log), nextEvent(0), nextCheckpoint(0) {}
+
+    // 取出执行第tick步之前要施加的下一个事件，没有则返回nullptr
+    const ReplayLog::Event* takeEvent(uint64_t tick);
+
+    // 第tick步结束后调用；该步有检查点且哈希不一致时返回false，并给出录制时的哈希和当前哈希
+    bool verifyTick(uint64_t tick, uint64_t& expected, uint64_t& actual);
+
+private:
+    const ReplayLog& log;
+    size_t nextEvent;
+    size_t nextCheckpoint;
+};
+
+#endif // REPLAY_LOG_H
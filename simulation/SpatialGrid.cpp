@@ -0,0 +1,128 @@
+#include "SpatialGrid.h"
+#include "../entities/BaseCell.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid()
+    : cellSize(1.0f), inverseCellSize(1.0f), bucketMask(0) {
+}
+
+int SpatialGrid::toCellCoord(float value) const {
+    return static_cast<int>(std::floor(value * inverseCellSize));
+}
+
+int64_t SpatialGrid::packCellKey(int cellX, int cellY) {
+    return (static_cast<int64_t>(cellX) << 32) ^ static_cast<uint32_t>(cellY);
+}
+
+uint32_t SpatialGrid::hashCell(int cellX, int cellY) const {
+    // 经典的空间哈希质数组合
+    uint32_t h = (static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u);
+    return h & bucketMask;
+}
+
+void SpatialGrid::build(const std::vector<std::shared_ptr<BaseCell>>& entities, float newCellSize) {
+    entityPositions.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        entityPositions[i] = entities[i]->getPosition();
+    }
+    buildFromPositions(newCellSize);
+}
+
+void SpatialGrid::buildFromPositions(float newCellSize) {
+    cellSize = std::max(newCellSize, 1.0f);
+    inverseCellSize = 1.0f / cellSize;
+
+    const size_t count = entityPositions.size();
+
+    // 桶数量取不小于实体数两倍的2的幂，使平均负载低于0.5
+    uint32_t bucketCount = 16;
+    while (bucketCount < count * 2) {
+        bucketCount <<= 1;
+    }
+    bucketMask = bucketCount - 1;
+
+    // 第一遍：统计每个桶的实体数
+    bucketStart.assign(bucketCount + 1, 0);
+    entityCellKeys.resize(count);
+    std::vector<uint32_t> entityBuckets(count);
+    for (size_t i = 0; i < count; ++i) {
+        const cv::Point2f& pos = entityPositions[i];
+        int cellX = toCellCoord(pos.x);
+        int cellY = toCellCoord(pos.y);
+        entityCellKeys[i] = packCellKey(cellX, cellY);
+        entityBuckets[i] = hashCell(cellX, cellY);
+        bucketStart[entityBuckets[i] + 1]++;
+    }
+
+    // 前缀和得到每个桶的起始位置
+    for (uint32_t b = 0; b < bucketCount; ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // 第二遍：按实体下标顺序写入，保证每个桶内下标升序
+    items.resize(count);
+    itemCellKeys.resize(count);
+    std::vector<int> cursor(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        int slot = cursor[entityBuckets[i]]++;
+        items[slot] = static_cast<int>(i);
+        itemCellKeys[slot] = entityCellKeys[i];
+    }
+}
+
+void SpatialGrid::queryRadius(const cv::Point2f& center, float radius, std::vector<int>& out) const {
+    out.clear();
+    if (items.empty()) return;
+
+    int minX = toCellCoord(center.x - radius);
+    int maxX = toCellCoord(center.x + radius);
+    int minY = toCellCoord(center.y - radius);
+    int maxY = toCellCoord(center.y + radius);
+
+    for (int cellY = minY; cellY <= maxY; ++cellY) {
+        for (int cellX = minX; cellX <= maxX; ++cellX) {
+            uint32_t bucket = hashCell(cellX, cellY);
+            int64_t key = packCellKey(cellX, cellY);
+            for (int k = bucketStart[bucket]; k < bucketStart[bucket + 1]; ++k) {
+                // 过滤哈希冲突带来的其它格子的实体
+                if (itemCellKeys[k] == key) {
+                    out.push_back(items[k]);
+                }
+            }
+        }
+    }
+
+    // 多个桶的结果合并后恢复为实体顺序，使命中处理顺序与逐一遍历时一致
+    std::sort(out.begin(), out.end());
+}
+
+void SpatialGrid::findPairsWithin(float radius, std::vector<std::pair<int, int>>& out) const {
+    out.clear();
+    const float radiusSquared = radius * radius;
+
+    // 半径远大于格子时逐格查询会扫过大量空格子，改用以半径为格子尺寸的粗网格，每次只查3x3个格子
+    const SpatialGrid* grid = this;
+    if (radius > cellSize * 2.0f) {
+        if (!coarseGrid) {
+            coarseGrid = std::make_unique<SpatialGrid>();
+        }
+        coarseGrid->entityPositions = entityPositions;
+        coarseGrid->buildFromPositions(radius);
+        grid = coarseGrid.get();
+    }
+
+    for (size_t i = 0; i < entityPositions.size(); ++i) {
+        const cv::Point2f& center = entityPositions[i];
+        grid->queryRadius(center, radius, scratch);
+
+        // 候选已按下标升序，只保留j > i的一半以避免重复
+        auto first = std::upper_bound(scratch.begin(), scratch.end(), static_cast<int>(i));
+        for (auto it = first; it != scratch.end(); ++it) {
+            cv::Point2f delta = entityPositions[*it] - center;
+            if (delta.x * delta.x + delta.y * delta.y <= radiusSquared) {
+                out.emplace_back(static_cast<int>(i), *it);
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+
+class BaseCell;
+
+// 均匀空间哈希网格，每帧按实体位置重建，用于快速查询某点附近的实体
+// 引擎每帧在实体更新后构建一次，战斗、繁殖等跨实体阶段共用同一份索引
+// 内部采用计数排序得到的紧凑布局（每个桶在items中占一段连续区间），重建不产生逐实体的堆分配
+class SpatialGrid {
+public:
+    SpatialGrid();
+
+    // 按实体当前位置重建网格，cellSize通常取 cell_width * scale
+    void build(const std::vector<std::shared_ptr<BaseCell>>& entities, float cellSize);
+
+    // 查询与以center为圆心、radius为半径的圆所覆盖格子中的实体
+    // 结果为升序的实体下标（与entities中的顺序一致），调用方需自行做精确距离判断
+    void queryRadius(const cv::Point2f& center, float radius, std::vector<int>& out) const;
+
+    // 找出所有距离不超过radius的实体对(i, j)，i < j，按(i, j)字典序输出
+    // 距离按构建时记录的位置精确计算，开销随局部密度而非实体总数的平方增长
+    void findPairsWithin(float radius, std::vector<std::pair<int, int>>& out) const;
+
+    // 构建时记录的实体位置
+    const cv::Point2f& getPosition(int index) const { return entityPositions[index]; }
+
+    float getCellSize() const { return cellSize; }
+    size_t size() const { return items.size(); }
+
+private:
+    float cellSize;
+    float inverseCellSize;
+
+    // 桶数量为2的幂，bucketStart[b]..bucketStart[b+1]为第b个桶在items中的区间
+    uint32_t bucketMask;
+    std::vector<int> bucketStart;
+    std::vector<int> items;
+
+    // 每个实体所在格子的坐标，用于排除哈希冲突带来的其它格子的实体
+    std::vector<int64_t> itemCellKeys;
+    std::vector<int64_t> entityCellKeys;
+    std::vector<cv::Point2f> entityPositions;
+
+    // 查询时复用的临时缓冲
+    mutable std::vector<int> scratch;
+
+    // 大半径配对查询使用的粗网格，按需创建并复用
+    mutable std::unique_ptr<SpatialGrid> coarseGrid;
+
+    // 按entityPositions中已记录的位置重建桶
+    void buildFromPositions(float cellSize);
+
+    int toCellCoord(float value) const;
+    static int64_t packCellKey(int cellX, int cellY);
+    uint32_t hashCell(int cellX, int cellY) const;
+};
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,119 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+int ThreadPool::defaultWorkerCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+ThreadPool::ThreadPool(int workerCount)
+    : currentBody(nullptr), pendingTasks(0), generation(0), stopping(false) {
+    if (workerCount <= 0) {
+        workerCount = defaultWorkerCount();
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+
+    // 调用线程本身也参与计算，只需创建workerCount - 1个工作线程
+    for (int i = 1; i < workerCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    // 只有一个分块或没有工作线程时直接在调用线程执行，避免调度开销
+    if (threads.empty() || count <= grainSize) {
+        body(0, count);
+        return;
+    }
+
+    // 分块轮流放入各队列，保证开始时每个线程都有活干
+    const size_t taskCount = (count + grainSize - 1) / grainSize;
+    currentBody = &body;
+    pendingTasks.store(taskCount, std::memory_order_relaxed);
+    for (size_t t = 0; t < taskCount; ++t) {
+        TaskQueue& queue = *queues[t % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{t * grainSize, std::min(count, (t + 1) * grainSize)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    // 调用线程同样取任务执行，队列都空后等待其它线程手上的分块完成
+    Task task;
+    while (pendingTasks.load(std::memory_order_acquire) > 0) {
+        if (takeTask(0, task)) {
+            runTask(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    currentBody = nullptr;
+}
+
+bool ThreadPool::takeTask(int index, Task& task) {
+    {
+        TaskQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    const int queueCount = static_cast<int>(queues.size());
+    for (int offset = 1; offset < queueCount; ++offset) {
+        TaskQueue& victim = *queues[(index + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(const Task& task) {
+    (*currentBody)(task.begin, task.end);
+    pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::workerLoop(int index) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        // 把能拿到的任务全部做完再回去休眠
+        Task task;
+        while (takeTask(index, task)) {
+            runTask(task);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池，用于并行执行逐实体的更新阶段
+// 每个参与者（调用线程 + 工作线程）各有一个任务队列：自己从队尾取，空闲时从别人的队首窃取，
+// 负载不均（例如只有部分AI细胞触发行为分支）时空闲线程会自动分担
+// parallelFor阻塞到所有分块执行完毕，相当于一道屏障；跨实体的阶段（战斗、繁殖）在屏障之后串行执行
+class ThreadPool {
+public:
+    // workerCount为参与计算的线程总数（含调用线程），0表示使用硬件并发数，1表示不创建工作线程
+    explicit ThreadPool(int workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 参与计算的线程总数（含调用线程）
+    int getWorkerCount() const { return static_cast<int>(queues.size()); }
+
+    // 把[0, count)按grainSize切块并行执行body(begin, end)，返回时所有分块均已完成
+    // 只允许同一时刻有一个线程调用；body不得再调用parallelFor
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+    // 未指定线程数时使用的默认值
+    static int defaultWorkerCount();
+
+private:
+    struct Task {
+        size_t begin;
+        size_t end;
+    };
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;  // 下标0属于调用线程
+    std::vector<std::thread> threads;
+
+    // 当前批次的任务体和剩余分块数
+    const std::function<void(size_t, size_t)>* currentBody;
+    std::atomic<size_t> pendingTasks;
+
+    // 唤醒工作线程：每提交一批任务generation加一
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    uint64_t generation;
+    bool stopping;
+
+    void workerLoop(int index);
+    // 先取自己队列的队尾，再依次窃取其它队列的队首；取到任务返回true
+    bool takeTask(int index, Task& task);
+    void runTask(const Task& task);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// 单生产者单消费者的无锁三缓冲
+// 生产者始终独占一块写缓冲，消费者独占一块读缓冲，第三块在两者之间交换：
+// publish()把写好的缓冲换到中间并标记为新，update()在有新数据时把它换成读缓冲。
+// 双方都不会等待对方；生产者比消费者快时，中间未被取走的旧数据直接被覆盖
+template <class T>
+class TripleBuffer {
+public:
+    TripleBuffer() : writeIndex(0), readIndex(1), middle(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // 生产者：当前的写缓冲，内容是若干次发布之前的旧数据，可以直接复用其容量
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    // 生产者：发布写缓冲
+    void publish() {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // 消费者：有新发布的数据时换入，返回是否换入了新数据
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // 消费者：最近一次update()换入的数据
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int indexMask = 3;
+    static const int freshBit = 4;
+
+    T buffers[3];
+    // 两端各自的下标只由本端访问；中间下标的第3位表示是否有未取走的新数据
+    alignas(64) int writeIndex;
+    alignas(64) int readIndex;
+    alignas(64) std::atomic<int> middle;
+};
+
+#endif // TRIPLE_BUFFER_H
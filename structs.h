@@ -76,4 +76,36 @@ struct Cell {
         damageReduction(0.75f) {} // 75% damage reduction while shielding
 };
 
+// Everything needed to draw one cell, copied out of the simulation so it can be
+// drawn on another thread
+struct CellView {
+    cv::Point2f position;       // Position after the latest simulation step
+    cv::Point2f prevPosition;   // Position after the step before, for interpolation
+    cv::Vec3b color;
+    float tailPhaseOffset;
+    float aggressionLevel;
+    float sizeMultiplier;
+    float sharpnessMultiplier;
+    float health;
+    float maxHealth;
+    float attackTime;
+    float parryTime;
+    int playerNumber;
+    bool faceRight;
+    bool isAttacking;
+    bool isShielding;
+    bool hasParried;
+
+    cv::Point2f interpolate(float alpha) const {
+        return prevPosition + (position - prevPosition) * alpha;
+    }
+};
+
+// How much of a cell gets drawn; large populations fall back to the cheaper tiers
+enum class CellDetail {
+    Full,        // Body, wavy tail, equipment, health bar and label
+    Simplified,  // Body, short tail and equipment
+    Dot          // A filled dot in the body color
+};
+
 #endif // STRUCTS_H